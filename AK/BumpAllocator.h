@@ -0,0 +1,157 @@
+#pragma once
+
+#include <AK/Assertions.h>
+#include <AK/Noncopyable.h>
+#include <AK/StdLibExtras.h>
+#include <AK/Types.h>
+#include <AK/kmalloc.h>
+
+#ifndef __serenity__
+#    include <new>
+#endif
+
+namespace AK {
+
+// BumpAllocator is an arena: it hands out memory from big chunks by bumping a pointer, and
+// frees everything at once when it's cleared or destroyed. Individual allocations can't
+// be freed. It suits lots of small, short-lived objects that all die together, like the
+// nodes of a tree that's thrown away as a whole.
+//
+// Objects created with make() have their destructors run (newest first) when the arena is
+// cleared, so they can own other resources. Memory from allocate() is just memory.
+//
+// Like the other AK containers, it isn't locked.
+
+class BumpAllocator {
+    AK_MAKE_NONCOPYABLE(BumpAllocator)
+public:
+    static constexpr size_t default_chunk_size = 16 * KB;
+
+    explicit BumpAllocator(size_t chunk_size = default_chunk_size)
+        : m_chunk_size(chunk_size)
+    {
+    }
+
+    ~BumpAllocator() { clear(); }
+
+    void* allocate(size_t size, size_t alignment = alignof(void*))
+    {
+        ASSERT(alignment && !(alignment & (alignment - 1)));
+        u8* aligned = align(m_next, alignment);
+        if (!m_current_chunk || aligned + size > m_end) {
+            add_chunk(size + alignment);
+            aligned = align(m_next, alignment);
+        }
+        m_next = aligned + size;
+        m_allocated_bytes += size;
+        return aligned;
+    }
+
+    template<typename T, typename... Args>
+    T* make(Args&&... args)
+    {
+        if (__has_trivial_destructor(T))
+            return new (allocate(sizeof(T), alignof(T))) T(forward<Args>(args)...);
+
+        // Objects that need destroying get a record in front of them, and the records are
+        // chained together, newest first.
+        auto* record = new (allocate(sizeof(DestructorRecord), alignof(DestructorRecord))) DestructorRecord;
+        T* object = new (allocate(sizeof(T), alignof(T))) T(forward<Args>(args)...);
+        record->object = object;
+        record->destroy = [](void* object) { static_cast<T*>(object)->~T(); };
+        record->next = m_destructors;
+        m_destructors = record;
+        return object;
+    }
+
+    // Destroys everything made with make(), and frees all chunks but the first one, so an
+    // arena that's reused for similar work doesn't have to go back to the heap.
+    void clear_and_keep_first_chunk()
+    {
+        run_destructors();
+        Chunk* first = nullptr;
+        for (auto* chunk = m_current_chunk; chunk;) {
+            auto* previous = chunk->previous;
+            if (previous)
+                kfree(chunk);
+            else
+                first = chunk;
+            chunk = previous;
+        }
+        m_current_chunk = first;
+        m_next = first ? first->data() : nullptr;
+        m_end = first ? first->end() : nullptr;
+        m_allocated_bytes = 0;
+    }
+
+    void clear()
+    {
+        clear_and_keep_first_chunk();
+        if (m_current_chunk)
+            kfree(m_current_chunk);
+        m_current_chunk = nullptr;
+        m_next = nullptr;
+        m_end = nullptr;
+    }
+
+    size_t allocated_bytes() const { return m_allocated_bytes; }
+
+    int chunk_count() const
+    {
+        int count = 0;
+        for (auto* chunk = m_current_chunk; chunk; chunk = chunk->previous)
+            ++count;
+        return count;
+    }
+
+private:
+    struct Chunk {
+        Chunk* previous;
+        size_t size;
+
+        u8* data() { return reinterpret_cast<u8*>(this + 1); }
+        u8* end() { return data() + size; }
+    };
+
+    struct DestructorRecord {
+        DestructorRecord* next;
+        void* object;
+        void (*destroy)(void*);
+    };
+
+    static u8* align(u8* pointer, size_t alignment)
+    {
+        return reinterpret_cast<u8*>(((size_t)pointer + alignment - 1) & ~(alignment - 1));
+    }
+
+    void add_chunk(size_t minimum_size)
+    {
+        // Allocations too big for a normal chunk get a chunk as big as they need.
+        size_t size = max(m_chunk_size, minimum_size);
+        auto* chunk = static_cast<Chunk*>(kmalloc(sizeof(Chunk) + size));
+        ASSERT(chunk);
+        chunk->previous = m_current_chunk;
+        chunk->size = size;
+        m_current_chunk = chunk;
+        m_next = chunk->data();
+        m_end = chunk->end();
+    }
+
+    void run_destructors()
+    {
+        for (auto* record = m_destructors; record; record = record->next)
+            record->destroy(record->object);
+        m_destructors = nullptr;
+    }
+
+    size_t m_chunk_size { default_chunk_size };
+    Chunk* m_current_chunk { nullptr };
+    u8* m_next { nullptr };
+    u8* m_end { nullptr };
+    size_t m_allocated_bytes { 0 };
+    DestructorRecord* m_destructors { nullptr };
+};
+
+}
+
+using AK::BumpAllocator;
@@ -0,0 +1,455 @@
+#include <AK/ELF/ELFDynamicObject.h>
+#include <AK/ELF/ELFImage.h>
+#include <AK/kstdio.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+//#define DYNAMIC_LOAD_DEBUG
+
+static const u32 page_size = 4096;
+
+static u32 page_round_down(u32 address)
+{
+    return address & ~(page_size - 1);
+}
+
+static u32 page_round_up(u32 address)
+{
+    return (address + page_size - 1) & ~(page_size - 1);
+}
+
+// The first time a function is called through the PLT, its GOT slot still points back
+// into the PLT, which pushes the relocation offset and jumps to PLT0. PLT0 pushes GOT[1]
+// (the object) and jumps to GOT[2], which is this. We bind the slot, and then jump to the
+// target as if the caller had called it directly.
+asm(
+    ".pushsection .text\n"
+    ".globl __dl_plt_trampoline\n"
+    "__dl_plt_trampoline:\n"
+    "    pushl %eax\n"
+    "    pushl %ecx\n"
+    "    pushl %edx\n"
+    "    pushl 16(%esp)\n" // relocation offset
+    "    pushl 16(%esp)\n" // object
+    "    call __dl_bind_jump_slot\n"
+    "    addl $8, %esp\n"
+    "    movl %eax, 16(%esp)\n"
+    "    popl %edx\n"
+    "    popl %ecx\n"
+    "    popl %eax\n"
+    "    addl $4, %esp\n"
+    "    ret\n"
+    ".popsection\n");
+
+extern "C" {
+void __dl_plt_trampoline();
+
+u32 __dl_bind_jump_slot(ELFDynamicObject* object, u32 relocation_offset)
+{
+    return object->bind_jump_slot(relocation_offset);
+}
+}
+
+ELFDynamicObject::ELFDynamicObject(const char* path)
+    : m_path(path)
+{
+}
+
+ELFDynamicObject::~ELFDynamicObject()
+{
+    if (m_initialized)
+        call_finalizers();
+    for (auto& mapping : m_mappings)
+        munmap(mapping.address, mapping.size);
+}
+
+RefPtr<ELFDynamicObject> ELFDynamicObject::load(const char* path, String& error)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        error = String::format("%s: %s", path, strerror(errno));
+        return nullptr;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+        error = String::format("%s: %s", path, strerror(errno));
+        close(fd);
+        return nullptr;
+    }
+    if ((size_t)st.st_size < sizeof(Elf32_Ehdr)) {
+        error = String::format("%s: Not an ELF file", path);
+        close(fd);
+        return nullptr;
+    }
+
+    // This mapping is only used to look at the headers and copy out the writable segments.
+    auto* file_data = (const u8*)mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (file_data == MAP_FAILED) {
+        error = String::format("%s: %s", path, strerror(errno));
+        close(fd);
+        return nullptr;
+    }
+
+    auto object = adopt(*new ELFDynamicObject(path));
+    bool success = object->map_segments(fd, file_data, st.st_size, error) && object->parse_dynamic_section(error);
+    munmap(const_cast<u8*>(file_data), st.st_size);
+    close(fd);
+    if (!success)
+        return nullptr;
+    return object;
+}
+
+bool ELFDynamicObject::map_segments(int fd, const u8* file_data, size_t file_size, String& error)
+{
+    auto& header = *(const Elf32_Ehdr*)file_data;
+    if (!IS_ELF(header) || header.e_phoff + header.e_phnum * sizeof(Elf32_Phdr) > file_size || header.e_shoff + header.e_shnum * sizeof(Elf32_Shdr) > file_size) {
+        error = String::format("%s: Not an ELF file", m_path.characters());
+        return false;
+    }
+
+    ELFImage image(file_data);
+    if (!image.is_valid() || !image.is_dynamic()) {
+        error = String::format("%s: Not a shared object", m_path.characters());
+        return false;
+    }
+
+    u32 lowest_address = 0xffffffff;
+    u32 highest_address = 0;
+    image.for_each_program_header([&](const ELFImage::ProgramHeader& program_header) {
+        if (program_header.type() == PT_DYNAMIC)
+            m_dynamic_section_vaddr = program_header.vaddr().get();
+        if (program_header.type() != PT_LOAD)
+            return;
+        lowest_address = min(lowest_address, page_round_down(program_header.vaddr().get()));
+        highest_address = max(highest_address, page_round_up(program_header.vaddr().get() + program_header.size_in_memory()));
+    });
+    if (highest_address <= lowest_address || !m_dynamic_section_vaddr) {
+        error = String::format("%s: Nothing to load", m_path.characters());
+        return false;
+    }
+
+    // Find a hole big enough for the whole object, then map its segments into it one by one.
+    void* reservation = mmap(nullptr, highest_address - lowest_address, PROT_READ, MAP_ANONYMOUS | MAP_PRIVATE, 0, 0);
+    if (reservation == MAP_FAILED) {
+        error = String::format("%s: %s", m_path.characters(), strerror(errno));
+        return false;
+    }
+    munmap(reservation, highest_address - lowest_address);
+    m_base = (u32)reservation - lowest_address;
+
+    bool failed = false;
+    image.for_each_program_header([&](const ELFImage::ProgramHeader& program_header) {
+        if (failed || program_header.type() != PT_LOAD)
+            return;
+        u32 start = page_round_down(m_base + program_header.vaddr().get());
+        u32 end = page_round_up(m_base + program_header.vaddr().get() + program_header.size_in_memory());
+        int prot = 0;
+        if (program_header.is_readable())
+            prot |= PROT_READ;
+        if (program_header.is_writable())
+            prot |= PROT_WRITE;
+        if (program_header.is_executable())
+            prot |= PROT_EXEC;
+        auto name = String::format("%s: %s", m_path.characters(), program_header.is_writable() ? "data" : program_header.is_executable() ? "text" : "rodata");
+
+        void* address;
+        if (!program_header.is_writable()) {
+            // Read-only segments come straight out of the file, and are shared with everyone.
+            if (program_header.size_in_memory() != program_header.size_in_image()
+                || program_header.offset() % page_size != program_header.vaddr().get() % page_size) {
+                error = String::format("%s: Read-only segment can't be mapped from the file", m_path.characters());
+                failed = true;
+                return;
+            }
+            address = mmap_with_name((void*)start, end - start, prot, MAP_PRIVATE | MAP_FIXED, fd, page_round_down(program_header.offset()), name.characters());
+        } else {
+            address = mmap_with_name((void*)start, end - start, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE | MAP_FIXED, 0, 0, name.characters());
+            if (address != MAP_FAILED)
+                memcpy(address_of<u8>(program_header.vaddr().get()), file_data + program_header.offset(), program_header.size_in_image());
+        }
+        if (address == MAP_FAILED || (u32)address != start) {
+            error = String::format("%s: Failed to map segment at %p", m_path.characters(), start);
+            failed = true;
+            return;
+        }
+        m_mappings.append({ address, end - start });
+#ifdef DYNAMIC_LOAD_DEBUG
+        dbgprintf("ELFDynamicObject: Mapped %s at %p-%p\n", name.characters(), start, end);
+#endif
+    });
+    return !failed;
+}
+
+bool ELFDynamicObject::parse_dynamic_section(String& error)
+{
+    for (auto* entry = address_of<const Elf32_Dyn>(m_dynamic_section_vaddr); entry->d_tag != DT_NULL; ++entry) {
+        switch (entry->d_tag) {
+        case DT_NEEDED:
+            m_needed_library_names.append(entry->d_un.d_val);
+            break;
+        case DT_HASH:
+            m_sysv_hash_table = address_of<const u32>(entry->d_un.d_ptr);
+            break;
+        case DT_GNU_HASH:
+            m_gnu_hash_table = address_of<const u32>(entry->d_un.d_ptr);
+            break;
+        case DT_STRTAB:
+            m_string_table = address_of<const char>(entry->d_un.d_ptr);
+            break;
+        case DT_SYMTAB:
+            m_symbol_table = address_of<const Elf32_Sym>(entry->d_un.d_ptr);
+            break;
+        case DT_REL:
+            m_relocations = address_of<const Elf32_Rel>(entry->d_un.d_ptr);
+            break;
+        case DT_RELSZ:
+            m_relocations_size = entry->d_un.d_val;
+            break;
+        case DT_JMPREL:
+            m_plt_relocations = address_of<const Elf32_Rel>(entry->d_un.d_ptr);
+            break;
+        case DT_PLTRELSZ:
+            m_plt_relocations_size = entry->d_un.d_val;
+            break;
+        case DT_PLTGOT:
+            m_global_offset_table = address_of<u32>(entry->d_un.d_ptr);
+            break;
+        case DT_INIT:
+            m_init = entry->d_un.d_ptr;
+            break;
+        case DT_FINI:
+            m_fini = entry->d_un.d_ptr;
+            break;
+        case DT_INIT_ARRAY:
+            m_init_array = entry->d_un.d_ptr;
+            break;
+        case DT_INIT_ARRAYSZ:
+            m_init_array_size = entry->d_un.d_val;
+            break;
+        case DT_FINI_ARRAY:
+            m_fini_array = entry->d_un.d_ptr;
+            break;
+        case DT_FINI_ARRAYSZ:
+            m_fini_array_size = entry->d_un.d_val;
+            break;
+        case DT_RELA:
+            error = String::format("%s: RELA relocations are not supported", m_path.characters());
+            return false;
+        case DT_TEXTREL:
+            error = String::format("%s: Object has text relocations, build it with -fPIC", m_path.characters());
+            return false;
+        case DT_FLAGS:
+            if (entry->d_un.d_val & DF_TEXTREL) {
+                error = String::format("%s: Object has text relocations, build it with -fPIC", m_path.characters());
+                return false;
+            }
+            break;
+        }
+    }
+    if (!m_symbol_table || !m_string_table || (!m_sysv_hash_table && !m_gnu_hash_table)) {
+        error = String::format("%s: Object has no dynamic symbol table", m_path.characters());
+        return false;
+    }
+    return true;
+}
+
+bool ELFDynamicObject::link(SymbolResolver resolver, bool bind_now, String& error)
+{
+    ASSERT(!m_initialized);
+    m_resolver = resolver;
+
+    for (size_t i = 0; i < m_relocations_size / sizeof(Elf32_Rel); ++i) {
+        if (!perform_relocation(m_relocations[i], false, bind_now, error))
+            return false;
+    }
+
+    if (m_plt_relocations_size && !bind_now) {
+        ASSERT(m_global_offset_table);
+        m_global_offset_table[1] = (u32)this;
+        m_global_offset_table[2] = (u32)&__dl_plt_trampoline;
+    }
+    for (size_t i = 0; i < m_plt_relocations_size / sizeof(Elf32_Rel); ++i) {
+        if (!perform_relocation(m_plt_relocations[i], true, bind_now, error))
+            return false;
+    }
+
+    m_initialized = true;
+    call_initializers();
+    return true;
+}
+
+bool ELFDynamicObject::perform_relocation(const Elf32_Rel& relocation, bool is_jump_slot, bool bind_now, String& error)
+{
+    auto* where = address_of<u32>(relocation.r_offset);
+    unsigned type = ELF32_R_TYPE(relocation.r_info);
+    if (is_jump_slot && type != R_386_JMP_SLOT) {
+        error = String::format("%s: Unexpected PLT relocation type %u", m_path.characters(), type);
+        return false;
+    }
+
+    u32 symbol_value = 0;
+    switch (type) {
+    case R_386_NONE:
+        break;
+    case R_386_RELATIVE:
+        *where += m_base;
+        break;
+    case R_386_JMP_SLOT:
+        if (!bind_now) {
+            // Leave it pointing into the PLT, so the first call goes through the trampoline.
+            *where += m_base;
+            break;
+        }
+        [[fallthrough]];
+    case R_386_GLOB_DAT:
+        if (!resolve_symbol(ELF32_R_SYM(relocation.r_info), symbol_value, error))
+            return false;
+        *where = symbol_value;
+        break;
+    case R_386_32:
+        if (!resolve_symbol(ELF32_R_SYM(relocation.r_info), symbol_value, error))
+            return false;
+        *where += symbol_value;
+        break;
+    case R_386_PC32:
+        if (!resolve_symbol(ELF32_R_SYM(relocation.r_info), symbol_value, error))
+            return false;
+        *where += symbol_value - (u32)where;
+        break;
+    default:
+        error = String::format("%s: Unsupported relocation type %u", m_path.characters(), type);
+        return false;
+    }
+    return true;
+}
+
+// Symbols the object defines itself always bind locally, as if it had been linked with
+// -Bsymbolic. Everything else is up to the resolver we were linked with.
+bool ELFDynamicObject::resolve_symbol(unsigned symbol_index, u32& value, String& error) const
+{
+    auto& symbol = m_symbol_table[symbol_index];
+    if (symbol.st_shndx != SHN_UNDEF) {
+        value = m_base + symbol.st_value;
+        return true;
+    }
+    const char* name = string_at(symbol.st_name);
+    if (auto* address = m_resolver ? m_resolver(name) : nullptr) {
+        value = (u32)address;
+        return true;
+    }
+    if (ELF32_ST_BIND(symbol.st_info) == STB_WEAK) {
+        value = 0;
+        return true;
+    }
+    error = String::format("%s: Undefined symbol '%s'", m_path.characters(), name);
+    return false;
+}
+
+u32 ELFDynamicObject::bind_jump_slot(u32 relocation_offset)
+{
+    auto& relocation = *(const Elf32_Rel*)((const u8*)m_plt_relocations + relocation_offset);
+    u32 value = 0;
+    String error;
+    if (!resolve_symbol(ELF32_R_SYM(relocation.r_info), value, error)) {
+        dbgprintf("ELFDynamicObject: %s\n", error.characters());
+        ASSERT_NOT_REACHED();
+    }
+#ifdef DYNAMIC_LOAD_DEBUG
+    dbgprintf("ELFDynamicObject: Bound %s to %p\n", string_at(m_symbol_table[ELF32_R_SYM(relocation.r_info)].st_name), value);
+#endif
+    *address_of<u32>(relocation.r_offset) = value;
+    return value;
+}
+
+static u32 sysv_hash(const char* name)
+{
+    u32 hash = 0;
+    for (; *name; ++name) {
+        hash = (hash << 4) + (u8)*name;
+        u32 high = hash & 0xf0000000;
+        if (high)
+            hash ^= high >> 24;
+        hash &= ~high;
+    }
+    return hash;
+}
+
+static u32 gnu_hash(const char* name)
+{
+    u32 hash = 5381;
+    for (; *name; ++name)
+        hash = hash * 33 + (u8)*name;
+    return hash;
+}
+
+const Elf32_Sym* ELFDynamicObject::lookup_sysv_hash(const char* name) const
+{
+    u32 bucket_count = m_sysv_hash_table[0];
+    const u32* buckets = &m_sysv_hash_table[2];
+    const u32* chains = &buckets[bucket_count];
+    for (u32 index = buckets[sysv_hash(name) % bucket_count]; index != STN_UNDEF; index = chains[index]) {
+        if (!strcmp(name, string_at(m_symbol_table[index].st_name)))
+            return &m_symbol_table[index];
+    }
+    return nullptr;
+}
+
+const Elf32_Sym* ELFDynamicObject::lookup_gnu_hash(const char* name) const
+{
+    u32 bucket_count = m_gnu_hash_table[0];
+    u32 first_hashed_symbol = m_gnu_hash_table[1];
+    u32 bloom_size = m_gnu_hash_table[2];
+    u32 bloom_shift = m_gnu_hash_table[3];
+    const u32* bloom = &m_gnu_hash_table[4];
+    const u32* buckets = &bloom[bloom_size];
+    const u32* chains = &buckets[bucket_count];
+
+    u32 hash = gnu_hash(name);
+    u32 bloom_word = bloom[(hash / 32) % bloom_size];
+    u32 bloom_mask = (1u << (hash % 32)) | (1u << ((hash >> bloom_shift) % 32));
+    if ((bloom_word & bloom_mask) != bloom_mask)
+        return nullptr;
+
+    u32 index = buckets[hash % bucket_count];
+    if (index < first_hashed_symbol)
+        return nullptr;
+    for (;; ++index) {
+        u32 chain_hash = chains[index - first_hashed_symbol];
+        if ((hash | 1) == (chain_hash | 1) && !strcmp(name, string_at(m_symbol_table[index].st_name)))
+            return &m_symbol_table[index];
+        // The low bit marks the end of a chain.
+        if (chain_hash & 1)
+            return nullptr;
+    }
+}
+
+void* ELFDynamicObject::symbol_for_name(const char* name) const
+{
+    auto* symbol = m_gnu_hash_table ? lookup_gnu_hash(name) : lookup_sysv_hash(name);
+    if (!symbol || symbol->st_shndx == SHN_UNDEF)
+        return nullptr;
+    return address_of<void>(symbol->st_value);
+}
+
+void ELFDynamicObject::call_initializers()
+{
+    if (m_init)
+        address_of<void()>(m_init)();
+    auto* init_array = address_of<void (*)()>(m_init_array);
+    for (size_t i = 0; i < m_init_array_size / sizeof(u32); ++i)
+        init_array[i]();
+}
+
+void ELFDynamicObject::call_finalizers()
+{
+    auto* fini_array = address_of<void (*)()>(m_fini_array);
+    for (size_t i = m_fini_array_size / sizeof(u32); i > 0; --i)
+        fini_array[i - 1]();
+    if (m_fini)
+        address_of<void()>(m_fini)();
+}
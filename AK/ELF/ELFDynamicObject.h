@@ -0,0 +1,90 @@
+#pragma once
+
+#include <AK/AKString.h>
+#include <AK/ELF/exec_elf.h>
+#include <AK/RefCounted.h>
+#include <AK/RefPtr.h>
+#include <AK/Vector.h>
+
+// A position-independent ELF shared object, loaded into the current process.
+//
+// Read-only segments are mapped straight from the file, so their pages come out of the
+// inode's VMObject and are shared by every process that maps the same object. Writable
+// segments get private memory with the file contents copied in. Calls through the PLT
+// are bound lazily on first use, unless the object is linked with bind_now.
+class ELFDynamicObject : public RefCounted<ELFDynamicObject> {
+public:
+    // Looks up symbols that an object uses but doesn't define itself.
+    typedef void* (*SymbolResolver)(const char* name);
+
+    // Map the object at `path` and read its dynamic section. It can't be used until it's linked.
+    static RefPtr<ELFDynamicObject> load(const char* path, String& error);
+    ~ELFDynamicObject();
+
+    const String& path() const { return m_path; }
+
+    template<typename Callback>
+    void for_each_needed_library(Callback) const;
+
+    // Apply relocations and run the object's initializers.
+    bool link(SymbolResolver, bool bind_now, String& error);
+
+    // Find a symbol defined by this object, or return null.
+    void* symbol_for_name(const char* name) const;
+
+    // Called from the PLT trampoline the first time a function is called through the PLT.
+    u32 bind_jump_slot(u32 relocation_offset);
+
+private:
+    ELFDynamicObject(const char* path);
+
+    bool map_segments(int fd, const u8* file_data, size_t file_size, String& error);
+    bool parse_dynamic_section(String& error);
+    bool perform_relocation(const Elf32_Rel&, bool is_jump_slot, bool bind_now, String& error);
+    bool resolve_symbol(unsigned symbol_index, u32& value, String& error) const;
+    const Elf32_Sym* lookup_sysv_hash(const char* name) const;
+    const Elf32_Sym* lookup_gnu_hash(const char* name) const;
+    void call_initializers();
+    void call_finalizers();
+
+    template<typename T>
+    T* address_of(u32 vaddr) const { return reinterpret_cast<T*>(m_base + vaddr); }
+    const char* string_at(u32 offset) const { return m_string_table + offset; }
+
+    String m_path;
+    u32 m_base { 0 };
+
+    struct Mapping {
+        void* address;
+        size_t size;
+    };
+    Vector<Mapping> m_mappings;
+
+    u32 m_dynamic_section_vaddr { 0 };
+    const Elf32_Sym* m_symbol_table { nullptr };
+    const char* m_string_table { nullptr };
+    const u32* m_sysv_hash_table { nullptr };
+    const u32* m_gnu_hash_table { nullptr };
+    const Elf32_Rel* m_relocations { nullptr };
+    size_t m_relocations_size { 0 };
+    const Elf32_Rel* m_plt_relocations { nullptr };
+    size_t m_plt_relocations_size { 0 };
+    u32* m_global_offset_table { nullptr };
+    u32 m_init { 0 };
+    u32 m_fini { 0 };
+    u32 m_init_array { 0 };
+    size_t m_init_array_size { 0 };
+    u32 m_fini_array { 0 };
+    size_t m_fini_array_size { 0 };
+    Vector<u32> m_needed_library_names;
+
+    SymbolResolver m_resolver { nullptr };
+    bool m_initialized { false };
+};
+
+template<typename Callback>
+inline void ELFDynamicObject::for_each_needed_library(Callback callback) const
+{
+    for (u32 name_offset : m_needed_library_names)
+        callback(string_at(name_offset));
+}
@@ -96,22 +96,25 @@ unsigned ELFImage::program_header_count() const
 
 bool ELFImage::parse()
 {
+    if (!IS_ELF(header())) {
+        kprintf("ELFImage::parse(): Not an ELF image!\n");
+        return false;
+    }
+
     // We only support i386.
     if (header().e_machine != 3) {
-        kprintf("ELFImage::parse(): e_machine=%u not supported!\n");
+        kprintf("ELFImage::parse(): e_machine=%u not supported!\n", header().e_machine);
         return false;
     }
 
-    // First locate the string tables.
+    // First locate the symbol table, and the string table that goes with it.
+    // (Shared objects have a second string table for their dynamic symbols.)
     for (unsigned i = 0; i < section_count(); ++i) {
         auto& sh = section_header(i);
         if (sh.sh_type == SHT_SYMTAB) {
             ASSERT(!m_symbol_table_section_index);
             m_symbol_table_section_index = i;
-        }
-        if (sh.sh_type == SHT_STRTAB && i != header().e_shstrndx) {
-            ASSERT(!m_string_table_section_index);
-            m_string_table_section_index = i;
+            m_string_table_section_index = sh.sh_link;
         }
     }
     return true;
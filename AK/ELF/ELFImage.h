@@ -4,6 +4,7 @@
 #include <AK/ELF/exec_elf.h>
 #include <AK/HashMap.h>
 #include <AK/OwnPtr.h>
+#include <Kernel/VM/VirtualAddress.h>
 
 class ELFImage {
 public:
@@ -35,6 +36,7 @@ public:
         unsigned size() const { return m_sym.st_size; }
         unsigned index() const { return m_index; }
         unsigned type() const { return ELF32_ST_TYPE(m_sym.st_info); }
+        unsigned bind() const { return ELF32_ST_BIND(m_sym.st_info); }
         const Section section() const { return m_image.section(section_index()); }
 
     private:
@@ -121,6 +123,7 @@ public:
 
     bool is_executable() const { return header().e_type == ET_EXEC; }
     bool is_relocatable() const { return header().e_type == ET_REL; }
+    bool is_dynamic() const { return header().e_type == ET_DYN; }
 
     VirtualAddress entry() const { return VirtualAddress(header().e_entry); }
 
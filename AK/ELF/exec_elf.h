@@ -401,6 +401,15 @@ typedef struct {
 #define ELF32_R_TYPE(i) ((unsigned char)(i))
 #define ELF32_R_INFO(s, t) (((s) << 8) + (unsigned char)(t))
 
+/* i386 relocation types */
+#define R_386_NONE 0
+#define R_386_32 1
+#define R_386_PC32 2
+#define R_386_COPY 5
+#define R_386_GLOB_DAT 6
+#define R_386_JMP_SLOT 7
+#define R_386_RELATIVE 8
+
 typedef struct {
     Elf64_Xword r_offset; /* where to do it */
     Elf64_Xword r_info;   /* index & type of relocation */
@@ -0,0 +1,82 @@
+#include <AK/FlyString.h>
+#include <AK/HashTable.h>
+
+namespace AK {
+
+// The table holds raw pointers, and hashes by contents so a StringView can find the
+// StringImpl it would have become.
+struct FlyStringImplTraits : public AK::Traits<StringImpl*> {
+    static unsigned hash(const StringImpl* impl) { return impl->hash(); }
+    static bool equals(const StringImpl* a, const StringImpl* b) { return a == b; }
+};
+
+static HashTable<StringImpl*, FlyStringImplTraits>& fly_impls()
+{
+    // Never destroyed, since StringImpls may still be unregistering themselves while
+    // other globals are torn down.
+    static HashTable<StringImpl*, FlyStringImplTraits>* table;
+    if (!table)
+        table = new HashTable<StringImpl*, FlyStringImplTraits>;
+    return *table;
+}
+
+static StringImpl* find_fly_impl(const StringView& view)
+{
+    auto& table = fly_impls();
+    auto it = table.find(view.hash(), [&](auto* impl) {
+        return impl->length() == view.length() && !memcmp(impl->characters(), view.characters_without_null_termination(), view.length());
+    });
+    if (it == table.end())
+        return nullptr;
+    return *it;
+}
+
+void FlyString::intern(const StringImpl& impl)
+{
+    impl.set_fly({}, true);
+    fly_impls().set(const_cast<StringImpl*>(&impl));
+    m_impl = const_cast<StringImpl&>(impl);
+}
+
+FlyString::FlyString(const String& string)
+{
+    if (string.is_null())
+        return;
+    if (string.impl()->is_fly()) {
+        m_impl = const_cast<StringImpl*>(string.impl());
+        return;
+    }
+    if (auto* impl = find_fly_impl(string.view())) {
+        m_impl = impl;
+        return;
+    }
+    intern(*string.impl());
+}
+
+FlyString::FlyString(const StringView& view)
+{
+    if (view.is_null())
+        return;
+    if (auto* impl = find_fly_impl(view)) {
+        m_impl = impl;
+        return;
+    }
+    // Only allocate once we know we have to. If the view was taken from a String, this
+    // reuses its StringImpl.
+    intern(*String(view).impl());
+}
+
+FlyString::FlyString(const char* cstring)
+    : FlyString(StringView(cstring))
+{
+}
+
+void FlyString::did_destroy_impl(Badge<StringImpl>, StringImpl& impl)
+{
+    auto& table = fly_impls();
+    auto it = table.find(impl.hash(), [&](auto* other) { return other == &impl; });
+    ASSERT(it != table.end());
+    table.remove(it);
+}
+
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <AK/AKString.h>
+
+namespace AK {
+
+// FlyString is an interned string: all FlyStrings with the same characters share a single
+// StringImpl. That makes comparing two of them a pointer comparison, and since the
+// StringImpl is shared, its hash is only ever computed once.
+//
+// It's meant for strings that get compared and hashed far more often than they're created,
+// and that tend to repeat, like JSON object keys, property names or file extensions.
+// Creating one costs a hash table lookup, but no allocation if an equal string is already
+// interned.
+//
+// The table only holds on to StringImpls weakly: when the last FlyString or String using
+// one goes away, the StringImpl removes itself from the table.
+//
+// Note that the table isn't locked, so FlyStrings shouldn't be shared between threads.
+
+class FlyString {
+public:
+    FlyString() {}
+    FlyString(const String&);
+    FlyString(const StringView&);
+    FlyString(const char*);
+
+    bool is_null() const { return !m_impl; }
+    bool is_empty() const { return length() == 0; }
+    int length() const { return m_impl ? m_impl->length() : 0; }
+    const char* characters() const { return m_impl ? m_impl->characters() : nullptr; }
+    unsigned hash() const { return m_impl ? m_impl->hash() : 0; }
+    const StringImpl* impl() const { return m_impl.ptr(); }
+
+    StringView view() const { return { characters(), length() }; }
+    String to_string() const { return String(m_impl.ptr()); }
+
+    bool operator==(const FlyString& other) const { return m_impl.ptr() == other.m_impl.ptr(); }
+    bool operator!=(const FlyString& other) const { return !(*this == other); }
+
+    bool operator==(const String& string) const { return m_impl.ptr() == string.impl() || view() == string; }
+    bool operator!=(const String& string) const { return !(*this == string); }
+
+    bool operator==(const StringView& other) const { return view() == other; }
+    bool operator!=(const StringView& other) const { return !(*this == other); }
+
+    bool operator==(const char* cstring) const { return view() == cstring; }
+    bool operator!=(const char* cstring) const { return !(*this == cstring); }
+
+    static void did_destroy_impl(Badge<StringImpl>, StringImpl&);
+
+private:
+    void intern(const StringImpl&);
+
+    RefPtr<StringImpl> m_impl;
+};
+
+template<>
+struct Traits<FlyString> : public GenericTraits<FlyString> {
+    static unsigned hash(const FlyString& s) { return s.hash(); }
+    static void dump(const FlyString& s) { kprintf("%s", s.characters()); }
+};
+
+}
+
+using AK::FlyString;
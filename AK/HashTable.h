@@ -1,84 +1,78 @@
 #pragma once
 
 #include <AK/Assertions.h>
-#include <AK/SinglyLinkedList.h>
 #include <AK/StdLibExtras.h>
-#include <AK/TemporaryChange.h>
 #include <AK/Traits.h>
+#include <AK/kmalloc.h>
 #include <AK/kstdio.h>
 
 namespace AK {
 
+// An open addressing hash table with Robin Hood probing:
+//
+// - Values live directly in one array of buckets, so inserting doesn't allocate (unless
+//   we grow), and looking something up touches a few neighbouring buckets.
+// - Each bucket remembers the hash of its value, and how far it is from the bucket the
+//   hash points at. An insert that's further from home than the value in its way takes
+//   that bucket and carries the displaced value along instead. That keeps probe lengths
+//   short and even, and lets a lookup stop as soon as it passes values that are closer
+//   to home than it would be.
+// - Removing shifts the following values back by one until one of them is already at
+//   home, so there are no tombstones to clean up later.
+//
+// Like Vector, setting or removing a value may move the others around, which invalidates
+// iterators and references into the table.
+
 template<typename T, typename = Traits<T>>
 class HashTable;
 
-template<typename HashTableType, typename ElementType, typename BucketIteratorType>
+template<typename HashTableType, typename ElementType>
 class HashTableIterator {
 public:
-    bool operator!=(const HashTableIterator& other) const
-    {
-        if (m_is_end && other.m_is_end)
-            return false;
-        return &m_table != &other.m_table
-            || m_is_end != other.m_is_end
-            || m_bucket_index != other.m_bucket_index
-            || m_bucket_iterator != other.m_bucket_iterator;
-    }
-    bool operator==(const HashTableIterator& other) const { return !(*this != other); }
-    ElementType& operator*() { return *m_bucket_iterator; }
-    ElementType* operator->() { return m_bucket_iterator.operator->(); }
+    bool operator!=(const HashTableIterator& other) const { return m_bucket_index != other.m_bucket_index; }
+    bool operator==(const HashTableIterator& other) const { return m_bucket_index == other.m_bucket_index; }
+    ElementType& operator*() { return m_table.bucket(m_bucket_index).value(); }
+    ElementType* operator->() { return &m_table.bucket(m_bucket_index).value(); }
     HashTableIterator& operator++()
     {
-        skip_to_next();
+        ++m_bucket_index;
+        skip_unused_buckets();
         return *this;
     }
 
-    void skip_to_next()
-    {
-        while (!m_is_end) {
-            if (m_bucket_iterator.is_end()) {
-                ++m_bucket_index;
-                if (m_bucket_index >= m_table.capacity()) {
-                    m_is_end = true;
-                    return;
-                }
-                m_bucket_iterator = m_table.bucket(m_bucket_index).begin();
-            } else {
-                ++m_bucket_iterator;
-            }
-            if (!m_bucket_iterator.is_end())
-                return;
-        }
-    }
-
 private:
     friend HashTableType;
 
-    explicit HashTableIterator(HashTableType& table, bool is_end, BucketIteratorType bucket_iterator = BucketIteratorType::universal_end(), int bucket_index = 0)
+    HashTableIterator(HashTableType& table, int bucket_index)
         : m_table(table)
         , m_bucket_index(bucket_index)
-        , m_is_end(is_end)
-        , m_bucket_iterator(bucket_iterator)
     {
-        ASSERT(!table.m_clearing);
-        ASSERT(!table.m_rehashing);
-        if (!is_end && !m_table.is_empty() && !(m_bucket_iterator != BucketIteratorType::universal_end())) {
-            m_bucket_iterator = m_table.bucket(0).begin();
-            if (m_bucket_iterator.is_end())
-                skip_to_next();
-        }
+        skip_unused_buckets();
+    }
+
+    void skip_unused_buckets()
+    {
+        while (m_bucket_index < m_table.capacity() && !m_table.bucket(m_bucket_index).is_used())
+            ++m_bucket_index;
     }
 
     HashTableType& m_table;
     int m_bucket_index { 0 };
-    bool m_is_end { false };
-    BucketIteratorType m_bucket_iterator;
 };
 
 template<typename T, typename TraitsForT>
 class HashTable {
 private:
-    using Bucket = SinglyLinkedList<T>;
+    struct Bucket {
+        // 0 for an empty bucket, otherwise 1 + the distance from the value's home bucket.
+        u32 distance { 0 };
+        unsigned hash;
+        alignas(T) u8 storage[sizeof(T)];
+
+        bool is_used() const { return distance; }
+        T& value() { return *reinterpret_cast<T*>(storage); }
+        const T& value() const { return *reinterpret_cast<const T*>(storage); }
+    };
 
 public:
     HashTable() {}
@@ -102,9 +96,11 @@ public:
         : m_buckets(other.m_buckets)
         , m_size(other.m_size)
         , m_capacity(other.m_capacity)
+        , m_shift(other.m_shift)
     {
         other.m_size = 0;
         other.m_capacity = 0;
+        other.m_shift = 32;
         other.m_buckets = nullptr;
     }
     HashTable& operator=(HashTable&& other)
@@ -114,8 +110,10 @@ public:
             m_buckets = other.m_buckets;
             m_size = other.m_size;
             m_capacity = other.m_capacity;
+            m_shift = other.m_shift;
             other.m_size = 0;
             other.m_capacity = 0;
+            other.m_shift = 32;
             other.m_buckets = nullptr;
         }
         return *this;
@@ -129,7 +127,11 @@ public:
     void ensure_capacity(int capacity)
     {
         ASSERT(capacity >= size());
-        rehash(capacity);
+        int new_capacity = minimum_capacity;
+        while (!fits(capacity, new_capacity))
+            new_capacity *= 2;
+        if (new_capacity > m_capacity)
+            rehash(new_capacity);
     }
 
     void set(const T&);
@@ -139,40 +141,28 @@ public:
 
     void dump() const;
 
-    using Iterator = HashTableIterator<HashTable, T, typename Bucket::Iterator>;
+    using Iterator = HashTableIterator<HashTable, T>;
     friend Iterator;
-    Iterator begin() { return Iterator(*this, is_empty()); }
-    Iterator end() { return Iterator(*this, true); }
+    Iterator begin() { return Iterator(*this, 0); }
+    Iterator end() { return Iterator(*this, m_capacity); }
 
-    using ConstIterator = HashTableIterator<const HashTable, const T, typename Bucket::ConstIterator>;
+    using ConstIterator = HashTableIterator<const HashTable, const T>;
     friend ConstIterator;
-    ConstIterator begin() const { return ConstIterator(*this, is_empty()); }
-    ConstIterator end() const { return ConstIterator(*this, true); }
+    ConstIterator begin() const { return ConstIterator(*this, 0); }
+    ConstIterator end() const { return ConstIterator(*this, m_capacity); }
 
+    // Looks for a value with the given hash that the finder accepts. This is for callers
+    // that can compute a hash without building a T, like HashMap looking up by key.
     template<typename Finder>
     Iterator find(unsigned hash, Finder finder)
     {
-        if (is_empty())
-            return end();
-        int bucket_index;
-        auto& bucket = lookup_with_hash(hash, &bucket_index);
-        auto bucket_iterator = bucket.find(finder);
-        if (bucket_iterator != bucket.end())
-            return Iterator(*this, false, bucket_iterator, bucket_index);
-        return end();
+        return Iterator(*this, lookup(hash, finder));
     }
 
     template<typename Finder>
     ConstIterator find(unsigned hash, Finder finder) const
     {
-        if (is_empty())
-            return end();
-        int bucket_index;
-        auto& bucket = lookup_with_hash(hash, &bucket_index);
-        auto bucket_iterator = bucket.find(finder);
-        if (bucket_iterator != bucket.end())
-            return ConstIterator(*this, false, bucket_iterator, bucket_index);
-        return end();
+        return ConstIterator(*this, lookup(hash, finder));
     }
 
     Iterator find(const T& value)
@@ -195,26 +185,36 @@ public:
     void remove(Iterator);
 
 private:
-    Bucket& lookup(const T&, int* bucket_index = nullptr);
-    const Bucket& lookup(const T&, int* bucket_index = nullptr) const;
+    static constexpr int minimum_capacity = 8;
 
-    Bucket& lookup_with_hash(unsigned hash, int* bucket_index)
-    {
-        if (bucket_index)
-            *bucket_index = hash % m_capacity;
-        return m_buckets[hash % m_capacity];
-    }
+    // We grow when the table would be more than 7/8 full.
+    static bool fits(int size, int capacity) { return size * 8 <= capacity * 7; }
 
-    const Bucket& lookup_with_hash(unsigned hash, int* bucket_index) const
+    // Fibonacci hashing: multiplying by 2^32 / phi and keeping the top bits spreads out
+    // hashes that only differ in their high bits, like pointers often do.
+    int home_bucket(unsigned hash) const { return (hash * 2654435769u) >> m_shift; }
+    int next_bucket(int index) const { return (index + 1) & (m_capacity - 1); }
+
+    // Returns the index of the matching bucket, or m_capacity if there isn't one.
+    template<typename Finder>
+    int lookup(unsigned hash, Finder& finder) const
     {
-        if (bucket_index)
-            *bucket_index = hash % m_capacity;
-        return m_buckets[hash % m_capacity];
+        if (is_empty())
+            return m_capacity;
+        int index = home_bucket(hash);
+        for (u32 distance = 1;; ++distance) {
+            auto& bucket = m_buckets[index];
+            // Past this point, anything with our hash would have displaced this bucket.
+            if (bucket.distance < distance)
+                return m_capacity;
+            if (bucket.hash == hash && finder(bucket.value()))
+                return index;
+            index = next_bucket(index);
+        }
     }
 
     void rehash(int capacity);
-    void insert(const T&);
-    void insert(T&&);
+    void insert(unsigned hash, T&&);
 
     Bucket& bucket(int index) { return m_buckets[index]; }
     const Bucket& bucket(int index) const { return m_buckets[index]; }
@@ -223,67 +223,75 @@ private:
 
     int m_size { 0 };
     int m_capacity { 0 };
-    bool m_clearing { false };
-    bool m_rehashing { false };
+    int m_shift { 32 };
 };
 
 template<typename T, typename TraitsForT>
 void HashTable<T, TraitsForT>::set(T&& value)
 {
-    if (!m_capacity)
-        rehash(1);
-    auto& bucket = lookup(value);
-    for (auto& e : bucket) {
-        if (TraitsForT::equals(e, value)) {
-            e = move(value);
-            return;
-        }
-    }
-    if (size() >= capacity()) {
-        rehash(size() + 1);
-        insert(move(value));
-    } else {
-        bucket.append(move(value));
+    unsigned hash = TraitsForT::hash(value);
+    auto finder = [&](auto& other) { return TraitsForT::equals(other, value); };
+    int index = lookup(hash, finder);
+    if (index != m_capacity) {
+        m_buckets[index].value() = move(value);
+        return;
     }
+    if (!fits(m_size + 1, m_capacity))
+        rehash(m_capacity ? m_capacity * 2 : minimum_capacity);
+    insert(hash, move(value));
     m_size++;
 }
 
 template<typename T, typename TraitsForT>
 void HashTable<T, TraitsForT>::set(const T& value)
 {
-    if (!m_capacity)
-        rehash(1);
-    auto& bucket = lookup(value);
-    for (auto& e : bucket) {
-        if (TraitsForT::equals(e, value)) {
-            e = value;
+    T copy = value;
+    set(move(copy));
+}
+
+template<typename T, typename TraitsForT>
+void HashTable<T, TraitsForT>::insert(unsigned hash, T&& value)
+{
+    int index = home_bucket(hash);
+    u32 distance = 1;
+    for (;;) {
+        auto& bucket = m_buckets[index];
+        if (!bucket.is_used()) {
+            new (bucket.storage) T(move(value));
+            bucket.hash = hash;
+            bucket.distance = distance;
             return;
         }
+        if (bucket.distance < distance) {
+            // Take from the rich: we're further from home than this one, so it moves on
+            // instead of us.
+            swap(bucket.value(), value);
+            swap(bucket.hash, hash);
+            swap(bucket.distance, distance);
+        }
+        index = next_bucket(index);
+        ++distance;
     }
-    if (size() >= capacity()) {
-        rehash(size() + 1);
-        insert(value);
-    } else {
-        bucket.append(value);
-    }
-    m_size++;
 }
 
 template<typename T, typename TraitsForT>
 void HashTable<T, TraitsForT>::rehash(int new_capacity)
 {
-    TemporaryChange<bool> change(m_rehashing, true);
-    new_capacity *= 2;
-    auto* new_buckets = new Bucket[new_capacity];
+    ASSERT(new_capacity && !(new_capacity & (new_capacity - 1)));
     auto* old_buckets = m_buckets;
     int old_capacity = m_capacity;
-    m_buckets = new_buckets;
+    m_buckets = new Bucket[new_capacity];
     m_capacity = new_capacity;
+    m_shift = 32;
+    for (int i = new_capacity; i > 1; i >>= 1)
+        --m_shift;
 
     for (int i = 0; i < old_capacity; ++i) {
-        for (auto& value : old_buckets[i]) {
-            insert(move(value));
-        }
+        auto& bucket = old_buckets[i];
+        if (!bucket.is_used())
+            continue;
+        insert(bucket.hash, move(bucket.value()));
+        bucket.value().~T();
     }
 
     delete[] old_buckets;
@@ -292,80 +300,62 @@ void HashTable<T, TraitsForT>::rehash(int new_capacity)
 template<typename T, typename TraitsForT>
 void HashTable<T, TraitsForT>::clear()
 {
-    TemporaryChange<bool> change(m_clearing, true);
     if (m_buckets) {
+        for (int i = 0; i < m_capacity; ++i) {
+            if (m_buckets[i].is_used())
+                m_buckets[i].value().~T();
+        }
         delete[] m_buckets;
         m_buckets = nullptr;
     }
     m_capacity = 0;
+    m_shift = 32;
     m_size = 0;
 }
 
-template<typename T, typename TraitsForT>
-void HashTable<T, TraitsForT>::insert(T&& value)
-{
-    auto& bucket = lookup(value);
-    bucket.append(move(value));
-}
-
-template<typename T, typename TraitsForT>
-void HashTable<T, TraitsForT>::insert(const T& value)
-{
-    auto& bucket = lookup(value);
-    bucket.append(value);
-}
-
 template<typename T, typename TraitsForT>
 bool HashTable<T, TraitsForT>::contains(const T& value) const
 {
-    if (is_empty())
-        return false;
-    auto& bucket = lookup(value);
-    for (auto& e : bucket) {
-        if (TraitsForT::equals(e, value))
-            return true;
-    }
-    return false;
+    return find(value) != end();
 }
 
 template<typename T, typename TraitsForT>
 void HashTable<T, TraitsForT>::remove(Iterator it)
 {
     ASSERT(!is_empty());
-    m_buckets[it.m_bucket_index].remove(it.m_bucket_iterator);
+    int index = it.m_bucket_index;
+    ASSERT(index < m_capacity && m_buckets[index].is_used());
+    m_buckets[index].value().~T();
+    m_buckets[index].distance = 0;
+
+    // Shift everything after it back, until we find a value that's at home (or nothing).
+    for (;;) {
+        int next = next_bucket(index);
+        auto& following = m_buckets[next];
+        if (following.distance <= 1)
+            break;
+        auto& bucket = m_buckets[index];
+        new (bucket.storage) T(move(following.value()));
+        following.value().~T();
+        bucket.hash = following.hash;
+        bucket.distance = following.distance - 1;
+        following.distance = 0;
+        index = next;
+    }
     --m_size;
 }
 
-template<typename T, typename TraitsForT>
-auto HashTable<T, TraitsForT>::lookup(const T& value, int* bucket_index) -> Bucket&
-{
-    unsigned hash = TraitsForT::hash(value);
-    if (bucket_index)
-        *bucket_index = hash % m_capacity;
-    return m_buckets[hash % m_capacity];
-}
-
-template<typename T, typename TraitsForT>
-auto HashTable<T, TraitsForT>::lookup(const T& value, int* bucket_index) const -> const Bucket&
-{
-    unsigned hash = TraitsForT::hash(value);
-    if (bucket_index)
-        *bucket_index = hash % m_capacity;
-    return m_buckets[hash % m_capacity];
-}
-
 template<typename T, typename TraitsForT>
 void HashTable<T, TraitsForT>::dump() const
 {
     kprintf("HashTable{%p} m_size=%u, m_capacity=%u, m_buckets=%p\n", this, m_size, m_capacity, m_buckets);
     for (int i = 0; i < m_capacity; ++i) {
         auto& bucket = m_buckets[i];
-        kprintf("Bucket %u\n", i);
-        for (auto& e : bucket) {
-            kprintf("  > ");
-            TraitsForT::dump(e);
-            kprintf("\n");
-        }
+        if (!bucket.is_used())
+            continue;
+        kprintf("Bucket %u (distance %u): ", i, bucket.distance - 1);
+        TraitsForT::dump(bucket.value());
+        kprintf("\n");
     }
 }
 
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <AK/Assertions.h>
+#include <AK/NetworkOrdered.h>
+#include <AK/Types.h>
+
+namespace AK {
+
+// The 16-bit ones' complement sum from RFC 1071, used by IPv4, ICMP, UDP and TCP.
+//
+// The sum doesn't care about byte order (RFC 1071, section 2B), so we add up words in
+// host order and only swap the final result. Data is consumed 32 bits at a time into a
+// 64-bit accumulator, four words per round, which can't overflow for any packet we'd
+// ever see and lets us fold the carries just once at the end.
+class InternetChecksum {
+public:
+    // Every chunk but the last one must have an even size.
+    void add(const void* data, size_t size)
+    {
+        ASSERT(!m_has_odd_tail);
+        auto* bytes = (const u8*)data;
+        u64 sum = m_sum;
+        while (size >= 16) {
+            sum += load32(bytes);
+            sum += load32(bytes + 4);
+            sum += load32(bytes + 8);
+            sum += load32(bytes + 12);
+            bytes += 16;
+            size -= 16;
+        }
+        while (size >= 4) {
+            sum += load32(bytes);
+            bytes += 4;
+            size -= 4;
+        }
+        if (size >= 2) {
+            sum += load16(bytes[0], bytes[1]);
+            bytes += 2;
+            size -= 2;
+        }
+        if (size) {
+            // A trailing byte is padded with a zero byte to make a full word.
+            sum += load16(bytes[0], 0);
+            m_has_odd_tail = true;
+        }
+        m_sum = sum;
+    }
+
+    // The folded but uncomplemented sum so far, in host byte order. This is what hardware
+    // checksum offload expects to find pre-seeded in the checksum field.
+    u16 partial_sum() const
+    {
+        u64 sum = m_sum;
+        sum = (sum & 0xffffffff) + (sum >> 32);
+        sum = (sum & 0xffffffff) + (sum >> 32);
+        sum = (sum & 0xffff) + (sum >> 16);
+        sum = (sum & 0xffff) + (sum >> 16);
+        return convert_between_host_and_network((u16)sum);
+    }
+
+    // The value for the checksum field, in host byte order.
+    u16 finish() const
+    {
+        return ~partial_sum() & 0xffff;
+    }
+
+private:
+    static u32 load32(const u8* bytes)
+    {
+        u32 value;
+        __builtin_memcpy(&value, bytes, sizeof(value));
+        return value;
+    }
+
+    static u16 load16(u8 first, u8 second)
+    {
+        u8 bytes[2] = { first, second };
+        u16 value;
+        __builtin_memcpy(&value, bytes, sizeof(value));
+        return value;
+    }
+
+    u64 m_sum { 0 };
+    bool m_has_odd_tail { false };
+};
+
+inline u16 internet_checksum(const void* data, size_t size)
+{
+    InternetChecksum checksum;
+    checksum.add(data, size);
+    return checksum.finish();
+}
+
+}
+
+using AK::internet_checksum;
+using AK::InternetChecksum;
@@ -0,0 +1,233 @@
+#pragma once
+
+#include <AK/JsonObject.h>
+
+namespace AK {
+
+// JsonObjectSerializer and JsonArraySerializer write JSON straight into a builder
+// (StringBuilder, KBufferBuilder, ...) as you go, instead of building a tree of
+// JsonObjects and JsonArrays first and serializing that:
+//
+//     StringBuilder builder;
+//     {
+//         JsonArraySerializer array { builder };
+//         for (auto& process : processes) {
+//             auto object = array.add_object();
+//             object.add("pid", process.pid());
+//             object.add("name", process.name());
+//         }
+//     }
+//     return builder.build();
+//
+// A serializer writes its closing bracket when it's finish()ed or destroyed, so nested
+// ones should be done before their parent writes anything else. The output is the same
+// as JsonValue::serialize() would produce for the equivalent tree.
+
+template<typename Builder>
+class JsonObjectSerializer;
+
+template<typename Builder>
+class JsonArraySerializer {
+public:
+    explicit JsonArraySerializer(Builder& builder)
+        : m_builder(builder)
+    {
+        m_builder.append('[');
+    }
+
+    JsonArraySerializer(const JsonArraySerializer&) = delete;
+    JsonArraySerializer& operator=(const JsonArraySerializer&) = delete;
+
+    ~JsonArraySerializer()
+    {
+        if (!m_finished)
+            finish();
+    }
+
+    void add(const JsonValue& value)
+    {
+        begin_item();
+        value.serialize(m_builder);
+    }
+
+    void add(const char* value)
+    {
+        begin_item();
+        m_builder.append('"');
+        m_builder.append(value);
+        m_builder.append('"');
+    }
+
+    void add(const String& value)
+    {
+        begin_item();
+        m_builder.append('"');
+        m_builder.append(value);
+        m_builder.append('"');
+    }
+
+    void add(int value)
+    {
+        begin_item();
+        m_builder.appendf("%d", value);
+    }
+
+    void add(unsigned value)
+    {
+        begin_item();
+        m_builder.appendf("%u", value);
+    }
+
+    void add(long unsigned value)
+    {
+        begin_item();
+        m_builder.appendf("%Q", (u64)value);
+    }
+
+    void add(bool value)
+    {
+        begin_item();
+        m_builder.append(value ? "true" : "false");
+    }
+
+    JsonArraySerializer<Builder> add_array()
+    {
+        begin_item();
+        return JsonArraySerializer(m_builder);
+    }
+
+    // Implemented after JsonObjectSerializer is complete.
+    JsonObjectSerializer<Builder> add_object();
+
+    void finish()
+    {
+        ASSERT(!m_finished);
+        m_finished = true;
+        m_builder.append(']');
+    }
+
+private:
+    void begin_item()
+    {
+        ASSERT(!m_finished);
+        if (!m_empty)
+            m_builder.append(',');
+        m_empty = false;
+    }
+
+    Builder& m_builder;
+    bool m_empty { true };
+    bool m_finished { false };
+};
+
+template<typename Builder>
+class JsonObjectSerializer {
+public:
+    explicit JsonObjectSerializer(Builder& builder)
+        : m_builder(builder)
+    {
+        m_builder.append('{');
+    }
+
+    JsonObjectSerializer(const JsonObjectSerializer&) = delete;
+    JsonObjectSerializer& operator=(const JsonObjectSerializer&) = delete;
+
+    ~JsonObjectSerializer()
+    {
+        if (!m_finished)
+            finish();
+    }
+
+    void add(const StringView& key, const JsonValue& value)
+    {
+        begin_item(key);
+        value.serialize(m_builder);
+    }
+
+    void add(const StringView& key, const char* value)
+    {
+        begin_item(key);
+        m_builder.append('"');
+        m_builder.append(value);
+        m_builder.append('"');
+    }
+
+    void add(const StringView& key, const String& value)
+    {
+        begin_item(key);
+        m_builder.append('"');
+        m_builder.append(value);
+        m_builder.append('"');
+    }
+
+    void add(const StringView& key, int value)
+    {
+        begin_item(key);
+        m_builder.appendf("%d", value);
+    }
+
+    void add(const StringView& key, unsigned value)
+    {
+        begin_item(key);
+        m_builder.appendf("%u", value);
+    }
+
+    void add(const StringView& key, long unsigned value)
+    {
+        begin_item(key);
+        m_builder.appendf("%Q", (u64)value);
+    }
+
+    void add(const StringView& key, bool value)
+    {
+        begin_item(key);
+        m_builder.append(value ? "true" : "false");
+    }
+
+    JsonArraySerializer<Builder> add_array(const StringView& key)
+    {
+        begin_item(key);
+        return JsonArraySerializer<Builder>(m_builder);
+    }
+
+    JsonObjectSerializer<Builder> add_object(const StringView& key)
+    {
+        begin_item(key);
+        return JsonObjectSerializer(m_builder);
+    }
+
+    void finish()
+    {
+        ASSERT(!m_finished);
+        m_finished = true;
+        m_builder.append('}');
+    }
+
+private:
+    void begin_item(const StringView& key)
+    {
+        ASSERT(!m_finished);
+        if (!m_empty)
+            m_builder.append(',');
+        m_empty = false;
+        m_builder.append('"');
+        m_builder.append(key);
+        m_builder.append("\":");
+    }
+
+    Builder& m_builder;
+    bool m_empty { true };
+    bool m_finished { false };
+};
+
+template<typename Builder>
+JsonObjectSerializer<Builder> JsonArraySerializer<Builder>::add_object()
+{
+    begin_item();
+    return JsonObjectSerializer<Builder>(m_builder);
+}
+
+}
+
+using AK::JsonArraySerializer;
+using AK::JsonObjectSerializer;
@@ -1,3 +1,4 @@
+#include <AK/FlyString.h>
 #include <AK/JsonArray.h>
 #include <AK/JsonObject.h>
 #include <AK/JsonParser.h>
@@ -41,10 +42,9 @@ void JsonParser::consume_specific(char expected_ch)
     ASSERT(consumed_ch == expected_ch);
 }
 
-String JsonParser::consume_quoted_string()
+void JsonParser::consume_quoted_string_into(Vector<char, 1024>& buffer)
 {
     consume_specific('"');
-    Vector<char, 1024> buffer;
 
     for (;;) {
         int peek_index = m_index;
@@ -99,6 +99,12 @@ String JsonParser::consume_quoted_string()
         }
     }
     consume_specific('"');
+}
+
+String JsonParser::consume_quoted_string()
+{
+    Vector<char, 1024> buffer;
+    consume_quoted_string_into(buffer);
 
     if (buffer.is_empty())
         return String::empty();
@@ -113,6 +119,16 @@ String JsonParser::consume_quoted_string()
     return last_string_starting_with_character;
 }
 
+String JsonParser::consume_object_key()
+{
+    // Objects parsed from the same source tend to have the same few keys over and over
+    // (think of an array of processes), so we intern them. Only the first of each costs
+    // an allocation, and they all hash and compare quickly afterwards.
+    Vector<char, 1024> buffer;
+    consume_quoted_string_into(buffer);
+    return FlyString(StringView(buffer.data(), buffer.size())).to_string();
+}
+
 JsonObject JsonParser::parse_object()
 {
     JsonObject object;
@@ -122,7 +138,7 @@ JsonObject JsonParser::parse_object()
         if (peek() == '}')
             break;
         consume_whitespace();
-        auto name = consume_quoted_string();
+        auto name = consume_object_key();
         consume_whitespace();
         consume_specific(':');
         consume_whitespace();
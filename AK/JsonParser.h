@@ -22,7 +22,9 @@ private:
     void consume_whitespace();
     void consume_specific(char expected_ch);
     void consume_string(const char*);
+    void consume_quoted_string_into(Vector<char, 1024>&);
     String consume_quoted_string();
+    String consume_object_key();
     JsonArray parse_array();
     JsonObject parse_object();
     JsonValue parse_number();
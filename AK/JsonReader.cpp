@@ -0,0 +1,227 @@
+#include <AK/JsonReader.h>
+#include <AK/StringBuilder.h>
+
+namespace AK {
+
+static inline bool is_whitespace(char ch)
+{
+    return ch == ' ' || ch == '\n' || ch == '\t' || ch == '\v' || ch == '\r';
+}
+
+static inline bool is_number_character(char ch)
+{
+    return (ch >= '0' && ch <= '9') || ch == '-' || ch == '+' || ch == '.' || ch == 'e' || ch == 'E';
+}
+
+void JsonReader::skip_whitespace()
+{
+    while (m_index < m_input.length() && is_whitespace(m_input[m_index]))
+        ++m_index;
+}
+
+JsonReader::Token JsonReader::fail()
+{
+    m_failed = true;
+    return Token::Error;
+}
+
+JsonReader::Token JsonReader::next()
+{
+    if (m_failed)
+        return Token::Error;
+
+    skip_whitespace();
+    if (m_index == m_input.length()) {
+        // We're done once there's exactly one complete value.
+        if (m_containers.is_empty() && m_need_separator)
+            return Token::End;
+        return fail();
+    }
+
+    char ch = m_input[m_index];
+    if (ch == '}' || ch == ']') {
+        char opening = ch == '}' ? '{' : '[';
+        if (m_containers.is_empty() || m_containers.last() != opening || m_after_key)
+            return fail();
+        ++m_index;
+        m_containers.take_last();
+        m_need_separator = true;
+        return ch == '}' ? Token::EndObject : Token::EndArray;
+    }
+
+    if (m_need_separator) {
+        if (m_containers.is_empty() || ch != ',')
+            return fail();
+        ++m_index;
+        skip_whitespace();
+        if (m_index == m_input.length())
+            return fail();
+        ch = m_input[m_index];
+        m_need_separator = false;
+    }
+
+    if (in_object() && !m_after_key) {
+        if (ch != '"' || consume_string(Token::Key) == Token::Error)
+            return fail();
+        skip_whitespace();
+        if (m_index == m_input.length() || m_input[m_index] != ':')
+            return fail();
+        ++m_index;
+        m_after_key = true;
+        return Token::Key;
+    }
+
+    m_after_key = false;
+    switch (ch) {
+    case '{':
+    case '[':
+        ++m_index;
+        m_containers.append(ch);
+        return ch == '{' ? Token::BeginObject : Token::BeginArray;
+    case '"':
+        return did_consume_value(consume_string(Token::String));
+    case 't':
+        return did_consume_value(consume_literal("true", Token::True));
+    case 'f':
+        return did_consume_value(consume_literal("false", Token::False));
+    case 'n':
+        return did_consume_value(consume_literal("null", Token::Null));
+    case '-':
+    case '0':
+    case '1':
+    case '2':
+    case '3':
+    case '4':
+    case '5':
+    case '6':
+    case '7':
+    case '8':
+    case '9':
+        return did_consume_value(consume_number());
+    default:
+        return fail();
+    }
+}
+
+JsonReader::Token JsonReader::did_consume_value(Token token)
+{
+    if (token != Token::Error)
+        m_need_separator = true;
+    return token;
+}
+
+JsonReader::Token JsonReader::consume_string(Token token)
+{
+    // Skip the opening quote.
+    int start = ++m_index;
+    int index = start;
+    m_text_has_escapes = false;
+    while (index < m_input.length()) {
+        char ch = m_input[index];
+        if (ch == '"')
+            break;
+        if (ch == '\\') {
+            m_text_has_escapes = true;
+            index += 2;
+            continue;
+        }
+        ++index;
+    }
+    if (index >= m_input.length())
+        return fail();
+    m_text = m_input.substring_view(start, index - start);
+    m_index = index + 1;
+    return token;
+}
+
+JsonReader::Token JsonReader::consume_number()
+{
+    int start = m_index;
+    while (m_index < m_input.length() && is_number_character(m_input[m_index]))
+        ++m_index;
+    m_text = m_input.substring_view(start, m_index - start);
+    m_text_has_escapes = false;
+    return Token::Number;
+}
+
+JsonReader::Token JsonReader::consume_literal(const char* literal, Token token)
+{
+    int length = strlen(literal);
+    if (m_input.length() - m_index < length || memcmp(m_input.characters_without_null_termination() + m_index, literal, length))
+        return fail();
+    m_index += length;
+    return token;
+}
+
+bool JsonReader::skip_value()
+{
+    switch (next()) {
+    case Token::BeginObject:
+    case Token::BeginArray:
+        return skip_container();
+    case Token::String:
+    case Token::Number:
+    case Token::True:
+    case Token::False:
+    case Token::Null:
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool JsonReader::skip_container()
+{
+    ASSERT(depth());
+    int depth = this->depth();
+    while (this->depth() >= depth) {
+        auto token = next();
+        if (token == Token::End || token == Token::Error)
+            return false;
+    }
+    return true;
+}
+
+String JsonReader::string() const
+{
+    if (!m_text_has_escapes)
+        return m_text;
+
+    StringBuilder builder(m_text.length());
+    for (int i = 0; i < m_text.length(); ++i) {
+        char ch = m_text[i];
+        if (ch != '\\' || i + 1 == m_text.length()) {
+            builder.append(ch);
+            continue;
+        }
+        char escaped_ch = m_text[++i];
+        switch (escaped_ch) {
+        case 'n':
+            builder.append('\n');
+            break;
+        case 'r':
+            builder.append('\r');
+            break;
+        case 't':
+            builder.append('\t');
+            break;
+        case 'b':
+            builder.append('\b');
+            break;
+        case 'f':
+            builder.append('\f');
+            break;
+        case 'u':
+            // FIXME: Like JsonParser, we don't have non-ASCII support yet.
+            i += min(4, m_text.length() - i - 1);
+            builder.append('?');
+            break;
+        default:
+            builder.append(escaped_ch);
+            break;
+        }
+    }
+    return builder.to_string();
+}
+
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <AK/AKString.h>
+#include <AK/StringView.h>
+#include <AK/Vector.h>
+
+namespace AK {
+
+// JsonReader is a pull parser: instead of building a JsonValue tree like JsonParser, it
+// hands out one token at a time, and it's up to the caller to pick out what it needs.
+//
+//     JsonReader reader(json);
+//     while (reader.next() != JsonReader::Token::End) { ... }
+//
+// The text of keys, strings and numbers is a StringView into the input, so nothing is
+// copied unless the caller asks for a String. A string that contains escapes is handed
+// out as-is (without the quotes); string() decodes it.
+//
+// Malformed input makes next() return Token::Error, and keep returning it.
+
+class JsonReader {
+public:
+    enum class Token {
+        End,
+        Error,
+        BeginObject,
+        EndObject,
+        BeginArray,
+        EndArray,
+        Key,
+        String,
+        Number,
+        True,
+        False,
+        Null,
+    };
+
+    explicit JsonReader(const StringView& input)
+        : m_input(input)
+    {
+    }
+
+    Token next();
+
+    // Skips over the next value, including everything inside it if it's an object or an
+    // array. Returns false if the input was malformed.
+    bool skip_value();
+
+    // Having just read a BeginObject or BeginArray, skips to just past its end.
+    bool skip_container();
+
+    // The text of the last Key, String or Number token.
+    StringView text() const { return m_text; }
+    bool text_has_escapes() const { return m_text_has_escapes; }
+
+    // The last Key or String token with its escapes decoded.
+    String string() const;
+
+    // How many objects and arrays we're inside of.
+    int depth() const { return m_containers.size(); }
+
+private:
+    bool in_object() const { return !m_containers.is_empty() && m_containers.last() == '{'; }
+
+    void skip_whitespace();
+    Token fail();
+    Token consume_string(Token);
+    Token consume_number();
+    Token consume_literal(const char*, Token);
+    Token did_consume_value(Token);
+
+    StringView m_input;
+    int m_index { 0 };
+
+    Vector<char, 16> m_containers;
+    bool m_need_separator { false };
+    bool m_after_key { false };
+    bool m_failed { false };
+
+    StringView m_text;
+    bool m_text_has_escapes { false };
+};
+
+}
+
+using AK::JsonReader;
@@ -20,6 +20,22 @@ MappedFile::MappedFile(const StringView& file_name)
         return;
     }
 
+    map(fd);
+
+#ifdef DEBUG_MAPPED_FILE
+    dbgprintf("MappedFile{%s} := { fd=%d, m_size=%u, m_map=%p }\n", file_name.characters(), fd, m_size, m_map);
+#endif
+
+    close(fd);
+}
+
+MappedFile::MappedFile(int fd)
+{
+    map(fd);
+}
+
+void MappedFile::map(int fd)
+{
     struct stat st;
     fstat(fd, &st);
     m_size = st.st_size;
@@ -27,12 +43,6 @@ MappedFile::MappedFile(const StringView& file_name)
 
     if (m_map == MAP_FAILED)
         perror("mmap");
-
-#ifdef DEBUG_MAPPED_FILE
-    dbgprintf("MappedFile{%s} := { fd=%d, m_size=%u, m_map=%p }\n", file_name.characters(), fd, m_size, m_map);
-#endif
-
-    close(fd);
 }
 
 MappedFile::~MappedFile()
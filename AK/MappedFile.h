@@ -10,6 +10,8 @@ class MappedFile {
 public:
     MappedFile() {}
     explicit MappedFile(const StringView& file_name);
+    // Maps an already open file. The caller keeps ownership of the fd.
+    explicit MappedFile(int fd);
     MappedFile(MappedFile&&);
     ~MappedFile();
 
@@ -23,6 +25,8 @@ public:
     size_t size() const { return m_size; }
 
 private:
+    void map(int fd);
+
     size_t m_size { 0 };
     void* m_map { (void*)-1 };
 };
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <AK/QuickSort.h>
+#include <AK/Vector.h>
+
+namespace AK {
+
+// A stable sort: elements that compare equal stay in the order they came in.
+//
+// It's a bottom-up merge sort. Short runs are sorted with insertion sort first, and then
+// merged pairwise until there's only one left. Merging moves the left run out into a
+// scratch buffer and merges back into place, so we need room for half the input on the
+// side. Runs that are already in order relative to each other aren't merged at all, which
+// makes sorted input O(n).
+//
+// Iterators must point into contiguous storage, like pointers or Vector iterators.
+
+namespace MergeSort {
+
+constexpr int run_size = 16;
+
+// Merges the sorted ranges [begin, middle) and [middle, end) into one.
+template<typename T, typename LessThan>
+void merge(T* begin, T* middle, T* end, Vector<T>& buffer, LessThan& less_than)
+{
+    if (begin == middle || middle == end || !less_than(*middle, *(middle - 1)))
+        return;
+
+    buffer.clear_with_capacity();
+    for (T* it = begin; it != middle; ++it)
+        buffer.append(move(*it));
+
+    T* left = buffer.data();
+    T* left_end = left + buffer.size();
+    T* right = middle;
+    T* out = begin;
+    while (left != left_end && right != end) {
+        // Taking from the left on ties is what keeps this stable.
+        if (less_than(*right, *left))
+            *out++ = move(*right++);
+        else
+            *out++ = move(*left++);
+    }
+    while (left != left_end)
+        *out++ = move(*left++);
+}
+
+template<typename T, typename LessThan>
+void sort(T* begin, int size, LessThan& less_than)
+{
+    for (int i = 0; i < size; i += run_size)
+        QuickSort::insertion_sort(begin + i, begin + min(i + run_size, size), less_than);
+
+    Vector<T> buffer;
+    for (int width = run_size; width < size; width *= 2) {
+        for (int i = 0; i + width < size; i += width * 2)
+            merge(begin + i, begin + i + width, begin + min(i + width * 2, size), buffer, less_than);
+    }
+}
+
+}
+
+template<typename Iterator, typename LessThan>
+void merge_sort(Iterator start, Iterator end, LessThan less_than)
+{
+    int size = end - start;
+    if (size <= 1)
+        return;
+    MergeSort::sort(&*start, size, less_than);
+}
+
+}
+
+using AK::merge_sort;
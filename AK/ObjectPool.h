@@ -0,0 +1,156 @@
+#pragma once
+
+#include <AK/Assertions.h>
+#include <AK/Noncopyable.h>
+#include <AK/StdLibExtras.h>
+#include <AK/Types.h>
+#include <AK/kmalloc.h>
+
+#ifndef __serenity__
+#    include <new>
+#endif
+
+namespace AK {
+
+// FixedSizePool hands out slots of one size. Slots are carved out of chunks that double in
+// size as the pool grows, and freed slots go on a free list to be handed out again first,
+// so allocating and freeing are a couple of pointer moves once the pool has warmed up.
+// Memory only goes back to the heap when the pool is destroyed.
+//
+// It isn't locked, so a pool must only be used from one thread at a time.
+
+template<size_t size, size_t alignment = alignof(void*)>
+class FixedSizePool {
+    AK_MAKE_NONCOPYABLE(FixedSizePool)
+public:
+    FixedSizePool() {}
+
+    FixedSizePool(FixedSizePool&& other)
+        : m_chunks(exchange(other.m_chunks, nullptr))
+        , m_free_list(exchange(other.m_free_list, nullptr))
+        , m_next_unused(exchange(other.m_next_unused, nullptr))
+        , m_unused_end(exchange(other.m_unused_end, nullptr))
+        , m_next_chunk_slot_count(exchange(other.m_next_chunk_slot_count, first_chunk_slot_count))
+    {
+    }
+
+    ~FixedSizePool()
+    {
+        for (auto* chunk = m_chunks; chunk;) {
+            auto* next = chunk->next;
+            kfree(chunk);
+            chunk = next;
+        }
+    }
+
+    void* allocate()
+    {
+        if (m_free_list) {
+            auto* slot = m_free_list;
+            m_free_list = slot->next;
+            return slot;
+        }
+        if (m_next_unused == m_unused_end)
+            add_chunk();
+        void* slot = m_next_unused;
+        m_next_unused += slot_size;
+        return slot;
+    }
+
+    void deallocate(void* pointer)
+    {
+        auto* slot = static_cast<FreeSlot*>(pointer);
+        slot->next = m_free_list;
+        m_free_list = slot;
+    }
+
+private:
+    struct FreeSlot {
+        FreeSlot* next;
+    };
+
+    struct Chunk {
+        Chunk* next;
+    };
+
+    static constexpr size_t round_up(size_t value, size_t multiple) { return (value + multiple - 1) / multiple * multiple; }
+    static constexpr size_t slot_alignment = alignment > alignof(FreeSlot) ? alignment : alignof(FreeSlot);
+    static constexpr size_t slot_size = round_up(size > sizeof(FreeSlot) ? size : sizeof(FreeSlot), slot_alignment);
+    static constexpr size_t chunk_header_size = round_up(sizeof(Chunk), slot_alignment);
+    static constexpr size_t first_chunk_slot_count = 8;
+    static constexpr size_t max_chunk_size = 64 * KB;
+
+    void add_chunk()
+    {
+        size_t slot_count = m_next_chunk_slot_count;
+        auto* chunk = static_cast<Chunk*>(kmalloc(chunk_header_size + slot_count * slot_size));
+        ASSERT(chunk);
+        ASSERT(!((size_t)chunk & (slot_alignment - 1)));
+        chunk->next = m_chunks;
+        m_chunks = chunk;
+        m_next_unused = reinterpret_cast<u8*>(chunk) + chunk_header_size;
+        m_unused_end = m_next_unused + slot_count * slot_size;
+        if ((slot_count * 2) * slot_size <= max_chunk_size)
+            m_next_chunk_slot_count = slot_count * 2;
+    }
+
+    Chunk* m_chunks { nullptr };
+    FreeSlot* m_free_list { nullptr };
+    u8* m_next_unused { nullptr };
+    u8* m_unused_end { nullptr };
+    size_t m_next_chunk_slot_count { first_chunk_slot_count };
+};
+
+// ObjectPool is a FixedSizePool for one type, which constructs and destroys the objects.
+template<typename T>
+class ObjectPool {
+public:
+    template<typename... Args>
+    T* construct(Args&&... args)
+    {
+        return new (m_pool.allocate()) T(forward<Args>(args)...);
+    }
+
+    void destroy(T* object)
+    {
+        object->~T();
+        m_pool.deallocate(object);
+    }
+
+private:
+    FixedSizePool<sizeof(T), alignof(T)> m_pool;
+};
+
+// The pool behind AK_MAKE_POOL_ALLOCATED. It's never destroyed, so objects may outlive
+// static destructors.
+template<typename T>
+FixedSizePool<sizeof(T), alignof(T)>& class_object_pool()
+{
+    static auto* pool = new FixedSizePool<sizeof(T), alignof(T)>;
+    return *pool;
+}
+
+}
+
+// Makes new and delete of a class use a FixedSizePool shared by all its instances. Since
+// subclasses inherit these operators, anything that isn't exactly the class's size falls
+// back to kmalloc().
+#define AK_MAKE_POOL_ALLOCATED(klass)                          \
+public:                                                        \
+    void* operator new(size_t size)                            \
+    {                                                          \
+        if (size != sizeof(klass))                             \
+            return kmalloc(size);                              \
+        return AK::class_object_pool<klass>().allocate();      \
+    }                                                          \
+    void operator delete(void* pointer, size_t size)           \
+    {                                                          \
+        if (size != sizeof(klass))                             \
+            return kfree(pointer);                             \
+        AK::class_object_pool<klass>().deallocate(pointer);    \
+    }                                                          \
+                                                               \
+private:
+
+using AK::FixedSizePool;
+using AK::ObjectPool;
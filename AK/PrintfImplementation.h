@@ -12,13 +12,131 @@ extern "C" size_t strlen(const char*);
 #include <string.h>
 #endif
 
-template<typename PutChFunc, typename T>
-[[gnu::always_inline]] inline int print_hex(PutChFunc putch, char*& bufptr, T number, bool upper_case, bool alternate_form, bool left_pad, bool zeroPad, u8 width)
+// The formatting functions below write to a "sink", which takes whole runs of characters
+// at once. Callers that have somewhere to memcpy() those runs to (stdio buffers, string
+// builders) can provide their own sink with printf_to_sink(). printf_internal() wraps the
+// classic one-character-at-a-time callback in a sink for everyone else.
+//
+// A sink has three functions:
+//     void put(char);
+//     void put(const char*, size_t);
+//     void put_repeated(char, size_t);
+
+template<typename PutChFunc>
+class PrintfCallbackSink {
+public:
+    PrintfCallbackSink(PutChFunc putch, char* buffer)
+        : m_putch(putch)
+        , m_bufptr(buffer)
+    {
+    }
+
+    void put(char ch) { m_putch(m_bufptr, ch); }
+
+    void put(const char* characters, size_t length)
+    {
+        for (size_t i = 0; i < length; ++i)
+            m_putch(m_bufptr, characters[i]);
+    }
+
+    void put_repeated(char ch, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+            m_putch(m_bufptr, ch);
+    }
+
+private:
+    PutChFunc m_putch;
+    char* m_bufptr;
+};
+
+// A sink for the string builders (StringBuilder, KBufferBuilder, ...), which can take
+// whole runs of characters with append(const char*, length).
+template<typename Builder>
+class BuilderSink {
+public:
+    explicit BuilderSink(Builder& builder)
+        : m_builder(builder)
+    {
+    }
+
+    void put(char ch) { m_builder.append(ch); }
+    void put(const char* characters, size_t length) { m_builder.append(characters, length); }
+    void put_repeated(char ch, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+            m_builder.append(ch);
+    }
+
+private:
+    Builder& m_builder;
+};
+
+static constexpr const char* printf_decimal_digit_pairs = "00010203040506070809"
+                                                          "10111213141516171819"
+                                                          "20212223242526272829"
+                                                          "30313233343536373839"
+                                                          "40414243444546474849"
+                                                          "50515253545556575859"
+                                                          "60616263646566676869"
+                                                          "70717273747576777879"
+                                                          "80818283848586878889"
+                                                          "90919293949596979899";
+
+// Writes the decimal digits of number so that they end just before end, two at a time,
+// and returns a pointer to the first one.
+[[gnu::always_inline]] inline char* printf_decimal_digits(char* end, u32 number)
+{
+    char* p = end;
+    while (number >= 100) {
+        const char* pair = &printf_decimal_digit_pairs[(number % 100) * 2];
+        number /= 100;
+        *--p = pair[1];
+        *--p = pair[0];
+    }
+    if (number >= 10) {
+        const char* pair = &printf_decimal_digit_pairs[number * 2];
+        *--p = pair[1];
+        *--p = pair[0];
+    } else {
+        *--p = '0' + number;
+    }
+    return p;
+}
+
+[[gnu::always_inline]] inline char* printf_decimal_digits(char* end, u64 number)
+{
+    // 64-bit division is slow on i386, so only do it until what's left fits in 32 bits.
+    char* p = end;
+    while (number > 0xffffffff) {
+        const char* pair = &printf_decimal_digit_pairs[(number % 100) * 2];
+        number /= 100;
+        *--p = pair[1];
+        *--p = pair[0];
+    }
+    return printf_decimal_digits(p, (u32)number);
+}
+
+template<typename Sink>
+[[gnu::always_inline]] inline u32 print_padded_digits(Sink& sink, const char* digits, size_t numlen, bool leftPad, bool zeroPad, u32 fieldWidth)
+{
+    if (!fieldWidth || fieldWidth < numlen)
+        fieldWidth = numlen;
+    if (!leftPad && fieldWidth > numlen)
+        sink.put_repeated(zeroPad ? '0' : ' ', fieldWidth - numlen);
+    sink.put(digits, numlen);
+    if (leftPad && fieldWidth > numlen)
+        sink.put_repeated(' ', fieldWidth - numlen);
+    return fieldWidth;
+}
+
+template<typename Sink, typename T>
+[[gnu::always_inline]] inline int print_hex(Sink& sink, T number, bool upper_case, bool alternate_form, bool left_pad, bool zeroPad, u8 width)
 {
     int ret = 0;
 
     int digits = 0;
-    for (T n = number; n > 0; n /= 0x0f)
+    for (T n = number; n > 0; n /= 16)
         ++digits;
     if (digits == 0)
         digits = 1;
@@ -27,214 +145,105 @@ template<typename PutChFunc, typename T>
         int stop_at = width - digits;
         if (alternate_form)
             stop_at -= 2;
-
-        while (ret < stop_at) {
-            putch(bufptr, ' ');
-            ++ret;
+        if (stop_at > 0) {
+            sink.put_repeated(' ', stop_at);
+            ret += stop_at;
         }
     }
 
     if (alternate_form) {
-        putch(bufptr, '0');
-        putch(bufptr, 'x');
+        sink.put("0x", 2);
         ret += 2;
     }
 
-    if (zeroPad) {
-        while (ret < width - digits) {
-            putch(bufptr, '0');
-            ++ret;
-        }
+    if (zeroPad && ret < width - digits) {
+        sink.put_repeated('0', width - digits - ret);
+        ret = width - digits;
     }
 
-    if (number == 0) {
-        putch(bufptr, '0');
-        ++ret;
-    } else {
-        u8 shift_count = digits * 4;
-        while (shift_count) {
-            shift_count -= 4;
-            putch(bufptr,
-                upper_case
-                    ? printf_hex_digits_upper[(number >> shift_count) & 0x0f]
-                    : printf_hex_digits_lower[(number >> shift_count) & 0x0f]);
-            ++ret;
-        }
+    char buf[16];
+    const char* hex_digits = upper_case ? printf_hex_digits_upper : printf_hex_digits_lower;
+    for (int i = digits - 1; i >= 0; --i) {
+        buf[i] = hex_digits[number & 0x0f];
+        number >>= 4;
     }
+    sink.put(buf, digits);
+    ret += digits;
 
     return ret;
 }
 
-template<typename PutChFunc>
-[[gnu::always_inline]] inline int print_number(PutChFunc putch, char*& bufptr, u32 number, bool leftPad, bool zeroPad, u32 fieldWidth)
+template<typename Sink>
+[[gnu::always_inline]] inline int print_number(Sink& sink, u32 number, bool leftPad, bool zeroPad, u32 fieldWidth)
 {
-    u32 divisor = 1000000000;
-    char ch;
-    char padding = 1;
     char buf[16];
-    char* p = buf;
-
-    for (;;) {
-        ch = '0' + (number / divisor);
-        number %= divisor;
-        if (ch != '0')
-            padding = 0;
-        if (!padding || divisor == 1)
-            *(p++) = ch;
-        if (divisor == 1)
-            break;
-        divisor /= 10;
-    }
-
-    size_t numlen = p - buf;
-    if (!fieldWidth || fieldWidth < numlen)
-        fieldWidth = numlen;
-    if (!leftPad) {
-        for (unsigned i = 0; i < fieldWidth - numlen; ++i) {
-            putch(bufptr, zeroPad ? '0' : ' ');
-        }
-    }
-    for (unsigned i = 0; i < numlen; ++i) {
-        putch(bufptr, buf[i]);
-    }
-    if (leftPad) {
-        for (unsigned i = 0; i < fieldWidth - numlen; ++i) {
-            putch(bufptr, ' ');
-        }
-    }
-
-    return fieldWidth;
+    char* end = buf + sizeof(buf);
+    char* p = printf_decimal_digits(end, number);
+    return print_padded_digits(sink, p, end - p, leftPad, zeroPad, fieldWidth);
 }
 
-template<typename PutChFunc>
-[[gnu::always_inline]] inline int print_u64(PutChFunc putch, char*& bufptr, u64 number, bool leftPad, bool zeroPad, u32 fieldWidth)
+template<typename Sink>
+[[gnu::always_inline]] inline int print_u64(Sink& sink, u64 number, bool leftPad, bool zeroPad, u32 fieldWidth)
 {
-    u64 divisor = 10000000000000000000LLU;
-    char ch;
-    char padding = 1;
-    char buf[16];
-    char* p = buf;
-
-    for (;;) {
-        ch = '0' + (number / divisor);
-        number %= divisor;
-        if (ch != '0')
-            padding = 0;
-        if (!padding || divisor == 1)
-            *(p++) = ch;
-        if (divisor == 1)
-            break;
-        divisor /= 10;
-    }
-
-    size_t numlen = p - buf;
-    if (!fieldWidth || fieldWidth < numlen)
-        fieldWidth = numlen;
-    if (!leftPad) {
-        for (unsigned i = 0; i < fieldWidth - numlen; ++i) {
-            putch(bufptr, zeroPad ? '0' : ' ');
-        }
-    }
-    for (unsigned i = 0; i < numlen; ++i) {
-        putch(bufptr, buf[i]);
-    }
-    if (leftPad) {
-        for (unsigned i = 0; i < fieldWidth - numlen; ++i) {
-            putch(bufptr, ' ');
-        }
-    }
-
-    return fieldWidth;
+    char buf[24];
+    char* end = buf + sizeof(buf);
+    char* p = printf_decimal_digits(end, number);
+    return print_padded_digits(sink, p, end - p, leftPad, zeroPad, fieldWidth);
 }
 
-template<typename PutChFunc>
-[[gnu::always_inline]] inline int print_i64(PutChFunc putch, char*& bufptr, i64 number, bool leftPad, bool zeroPad, u32 fieldWidth)
+template<typename Sink>
+[[gnu::always_inline]] inline int print_i64(Sink& sink, i64 number, bool leftPad, bool zeroPad, u32 fieldWidth)
 {
     if (number < 0) {
-        putch(bufptr, '-');
-        return print_u64(putch, bufptr, 0 - number, leftPad, zeroPad, fieldWidth) + 1;
+        sink.put('-');
+        return print_u64(sink, 0 - number, leftPad, zeroPad, fieldWidth) + 1;
     }
-    return print_u64(putch, bufptr, number, leftPad, zeroPad, fieldWidth);
+    return print_u64(sink, number, leftPad, zeroPad, fieldWidth);
 }
 
-template<typename PutChFunc>
-[[gnu::always_inline]] inline int print_octal_number(PutChFunc putch, char*& bufptr, u32 number, bool leftPad, bool zeroPad, u32 fieldWidth)
+template<typename Sink>
+[[gnu::always_inline]] inline int print_octal_number(Sink& sink, u32 number, bool leftPad, bool zeroPad, u32 fieldWidth)
 {
-    u32 divisor = 134217728;
-    char ch;
-    char padding = 1;
-    char buf[32];
-    char* p = buf;
-
-    for (;;) {
-        ch = '0' + (number / divisor);
-        number %= divisor;
-        if (ch != '0')
-            padding = 0;
-        if (!padding || divisor == 1)
-            *(p++) = ch;
-        if (divisor == 1)
-            break;
-        divisor /= 8;
-    }
-
-    size_t numlen = p - buf;
-    if (!fieldWidth || fieldWidth < numlen)
-        fieldWidth = numlen;
-    if (!leftPad) {
-        for (unsigned i = 0; i < fieldWidth - numlen; ++i) {
-            putch(bufptr, zeroPad ? '0' : ' ');
-        }
-    }
-    for (unsigned i = 0; i < numlen; ++i) {
-        putch(bufptr, buf[i]);
-    }
-    if (leftPad) {
-        for (unsigned i = 0; i < fieldWidth - numlen; ++i) {
-            putch(bufptr, ' ');
-        }
-    }
-
-    return fieldWidth;
+    char buf[16];
+    char* end = buf + sizeof(buf);
+    char* p = end;
+    do {
+        *--p = '0' + (number & 7);
+        number >>= 3;
+    } while (number);
+    return print_padded_digits(sink, p, end - p, leftPad, zeroPad, fieldWidth);
 }
 
-template<typename PutChFunc>
-[[gnu::always_inline]] inline int print_string(PutChFunc putch, char*& bufptr, const char* str, bool leftPad, u32 fieldWidth)
+template<typename Sink>
+[[gnu::always_inline]] inline int print_string(Sink& sink, const char* str, bool leftPad, u32 fieldWidth)
 {
     size_t len = strlen(str);
     if (!fieldWidth || fieldWidth < len)
         fieldWidth = len;
-    if (!leftPad) {
-        for (unsigned i = 0; i < fieldWidth - len; ++i)
-            putch(bufptr, ' ');
-    }
-    for (unsigned i = 0; i < len; ++i) {
-        putch(bufptr, str[i]);
-    }
-    if (leftPad) {
-        for (unsigned i = 0; i < fieldWidth - len; ++i)
-            putch(bufptr, ' ');
-    }
+    if (!leftPad && fieldWidth > len)
+        sink.put_repeated(' ', fieldWidth - len);
+    sink.put(str, len);
+    if (leftPad && fieldWidth > len)
+        sink.put_repeated(' ', fieldWidth - len);
     return fieldWidth;
 }
 
-template<typename PutChFunc>
-[[gnu::always_inline]] inline int print_signed_number(PutChFunc putch, char*& bufptr, int number, bool leftPad, bool zeroPad, u32 fieldWidth)
+template<typename Sink>
+[[gnu::always_inline]] inline int print_signed_number(Sink& sink, int number, bool leftPad, bool zeroPad, u32 fieldWidth)
 {
     if (number < 0) {
-        putch(bufptr, '-');
-        return print_number(putch, bufptr, 0 - number, leftPad, zeroPad, fieldWidth) + 1;
+        sink.put('-');
+        return print_number(sink, 0 - number, leftPad, zeroPad, fieldWidth) + 1;
     }
-    return print_number(putch, bufptr, number, leftPad, zeroPad, fieldWidth);
+    return print_number(sink, number, leftPad, zeroPad, fieldWidth);
 }
 
-template<typename PutChFunc>
-[[gnu::always_inline]] inline int printf_internal(PutChFunc putch, char* buffer, const char*& fmt, va_list ap)
+template<typename Sink>
+[[gnu::always_inline]] inline int printf_to_sink(Sink& sink, const char*& fmt, va_list ap)
 {
     const char* p;
 
     int ret = 0;
-    char* bufptr = buffer;
 
     for (p = fmt; *p; ++p) {
         bool left_pad = false;
@@ -286,73 +295,84 @@ template<typename PutChFunc>
             switch (*p) {
             case 's': {
                 const char* sp = va_arg(ap, const char*);
-                ret += print_string(putch, bufptr, sp ? sp : "(null)", left_pad, fieldWidth);
+                ret += print_string(sink, sp ? sp : "(null)", left_pad, fieldWidth);
             } break;
 
             case 'd':
-                ret += print_signed_number(putch, bufptr, va_arg(ap, int), left_pad, zeroPad, fieldWidth);
+                ret += print_signed_number(sink, va_arg(ap, int), left_pad, zeroPad, fieldWidth);
                 break;
 
             case 'u':
-                ret += print_number(putch, bufptr, va_arg(ap, u32), left_pad, zeroPad, fieldWidth);
+                ret += print_number(sink, va_arg(ap, u32), left_pad, zeroPad, fieldWidth);
                 break;
 
             case 'Q':
-                ret += print_u64(putch, bufptr, va_arg(ap, u64), left_pad, zeroPad, fieldWidth);
+                ret += print_u64(sink, va_arg(ap, u64), left_pad, zeroPad, fieldWidth);
                 break;
 
             case 'q':
-                ret += print_hex(putch, bufptr, va_arg(ap, u64), false, false, left_pad, zeroPad, 16);
+                ret += print_hex(sink, va_arg(ap, u64), false, false, left_pad, zeroPad, 16);
                 break;
 
 #ifndef KERNEL
             case 'g':
             case 'f':
                 // FIXME: Print as float!
-                ret += print_i64(putch, bufptr, (u64)va_arg(ap, double), left_pad, zeroPad, fieldWidth);
+                ret += print_i64(sink, (u64)va_arg(ap, double), left_pad, zeroPad, fieldWidth);
                 break;
 #endif
 
             case 'o':
                 if (alternate_form) {
-                    putch(bufptr, '0');
+                    sink.put('0');
                     ++ret;
                 }
-                ret += print_octal_number(putch, bufptr, va_arg(ap, u32), left_pad, zeroPad, fieldWidth);
+                ret += print_octal_number(sink, va_arg(ap, u32), left_pad, zeroPad, fieldWidth);
                 break;
 
             case 'X':
             case 'x':
-                ret += print_hex(putch, bufptr, va_arg(ap, u32), *p == 'X', alternate_form, left_pad, zeroPad, fieldWidth);
+                ret += print_hex(sink, va_arg(ap, u32), *p == 'X', alternate_form, left_pad, zeroPad, fieldWidth);
                 break;
 
             case 'w':
-                ret += print_hex(putch, bufptr, va_arg(ap, int), false, alternate_form, left_pad, zeroPad, 4);
+                ret += print_hex(sink, va_arg(ap, int), false, alternate_form, left_pad, zeroPad, 4);
                 break;
 
             case 'b':
-                ret += print_hex(putch, bufptr, va_arg(ap, int), false, alternate_form, left_pad, zeroPad, 2);
+                ret += print_hex(sink, va_arg(ap, int), false, alternate_form, left_pad, zeroPad, 2);
                 break;
 
             case 'c':
-                putch(bufptr, (char)va_arg(ap, int));
+                sink.put((char)va_arg(ap, int));
                 ++ret;
                 break;
 
             case '%':
-                putch(bufptr, '%');
+                sink.put('%');
                 ++ret;
                 break;
 
             case 'P':
             case 'p':
-                ret += print_hex(putch, bufptr, va_arg(ap, u32), *p == 'P', true, false, true, 8);
+                ret += print_hex(sink, va_arg(ap, u32), *p == 'P', true, false, true, 8);
                 break;
             }
         } else {
-            putch(bufptr, *p);
-            ++ret;
+            // Hand over everything up to the next conversion in one go.
+            const char* run = p;
+            while (*(p + 1) && *(p + 1) != '%')
+                ++p;
+            sink.put(run, p - run + 1);
+            ret += p - run + 1;
         }
     }
     return ret;
 }
+
+template<typename PutChFunc>
+[[gnu::always_inline]] inline int printf_internal(PutChFunc putch, char* buffer, const char*& fmt, va_list ap)
+{
+    PrintfCallbackSink<PutChFunc> sink(putch, buffer);
+    return printf_to_sink(sink, fmt, ap);
+}
@@ -10,30 +10,303 @@ bool is_less_than(const T& a, const T& b)
     return a < b;
 }
 
-template<typename Iterator, typename LessThan>
-void quick_sort(Iterator start, Iterator end, LessThan less_than = is_less_than)
+// This is a pattern-defeating quicksort (pdqsort, Orson Peters, 2016):
+//
+// - Small ranges are finished off with insertion sort.
+// - The pivot is the median of 3, or the median of 3 medians of 3 for large ranges.
+// - Ranges where everything is equal to the previous pivot are skipped in one pass.
+// - A partition that didn't have to move anything is probably part of an already sorted
+//   run, so we try an insertion sort that gives up after a handful of moves.
+// - Badly unbalanced partitions shuffle a few elements around to break up whatever
+//   pattern caused them, and after log2(n) of those we fall back to heapsort.
+//
+// That makes it O(n log n) in the worst case, and O(n) on sorted, reverse sorted and
+// all-equal input. It's not stable; use merge_sort() from AK/MergeSort.h for that.
+//
+// Iterators must point into contiguous storage, like pointers or Vector iterators.
+// less_than must be a strict weak ordering (like operator<): the partitioning scans rely
+// on it to stay inside the range.
+
+namespace QuickSort {
+
+constexpr int insertion_sort_threshold = 24;
+constexpr int ninther_threshold = 128;
+constexpr int partial_insertion_sort_limit = 8;
+
+template<typename T, typename LessThan>
+void insertion_sort(T* begin, T* end, LessThan& less_than)
 {
-    int size = end - start;
-    if (size <= 1)
+    if (begin == end)
+        return;
+    for (T* current = begin + 1; current != end; ++current) {
+        T* sift = current;
+        T* sift_1 = current - 1;
+        if (less_than(*sift, *sift_1)) {
+            T tmp = move(*sift);
+            do {
+                *sift-- = move(*sift_1);
+            } while (sift != begin && less_than(tmp, *--sift_1));
+            *sift = move(tmp);
+        }
+    }
+}
+
+// Like insertion_sort(), but relies on the element just before begin being no greater
+// than anything in the range, which saves a bounds check in the inner loop.
+template<typename T, typename LessThan>
+void unguarded_insertion_sort(T* begin, T* end, LessThan& less_than)
+{
+    if (begin == end)
         return;
+    for (T* current = begin + 1; current != end; ++current) {
+        T* sift = current;
+        T* sift_1 = current - 1;
+        if (less_than(*sift, *sift_1)) {
+            T tmp = move(*sift);
+            do {
+                *sift-- = move(*sift_1);
+            } while (less_than(tmp, *--sift_1));
+            *sift = move(tmp);
+        }
+    }
+}
 
-    int pivot_point = size / 2;
-    auto pivot = *(start + pivot_point);
+// Returns false, leaving the range partially sorted, if it would take more than
+// partial_insertion_sort_limit moves to sort it.
+template<typename T, typename LessThan>
+bool partial_insertion_sort(T* begin, T* end, LessThan& less_than)
+{
+    if (begin == end)
+        return true;
+    int moves = 0;
+    for (T* current = begin + 1; current != end; ++current) {
+        T* sift = current;
+        T* sift_1 = current - 1;
+        if (less_than(*sift, *sift_1)) {
+            T tmp = move(*sift);
+            do {
+                *sift-- = move(*sift_1);
+            } while (sift != begin && less_than(tmp, *--sift_1));
+            *sift = move(tmp);
+            moves += current - sift;
+        }
+        if (moves > partial_insertion_sort_limit)
+            return false;
+    }
+    return true;
+}
 
-    if (pivot_point)
-        swap(*(start + pivot_point), *start);
+template<typename T, typename LessThan>
+void sort2(T* a, T* b, LessThan& less_than)
+{
+    if (less_than(*b, *a))
+        swap(*a, *b);
+}
+
+template<typename T, typename LessThan>
+void sort3(T* a, T* b, T* c, LessThan& less_than)
+{
+    sort2(a, b, less_than);
+    sort2(b, c, less_than);
+    sort2(a, b, less_than);
+}
+
+template<typename T, typename LessThan>
+void sift_down(T* heap, int size, int index, LessThan& less_than)
+{
+    for (;;) {
+        int child = index * 2 + 1;
+        if (child >= size)
+            return;
+        if (child + 1 < size && less_than(heap[child], heap[child + 1]))
+            ++child;
+        if (!less_than(heap[index], heap[child]))
+            return;
+        swap(heap[index], heap[child]);
+        index = child;
+    }
+}
+
+template<typename T, typename LessThan>
+void heap_sort(T* begin, T* end, LessThan& less_than)
+{
+    int size = end - begin;
+    for (int i = size / 2 - 1; i >= 0; --i)
+        sift_down(begin, size, i, less_than);
+    for (int i = size - 1; i > 0; --i) {
+        swap(begin[0], begin[i]);
+        sift_down(begin, i, 0, less_than);
+    }
+}
+
+// Partitions around the pivot at *begin, putting elements equal to it on the right.
+// The median-of-3 selection guarantees that both scans stop inside the range.
+template<typename T, typename LessThan>
+T* partition_right(T* begin, T* end, LessThan& less_than, bool& already_partitioned)
+{
+    T pivot = move(*begin);
+    T* first = begin;
+    T* last = end;
+
+    while (less_than(*++first, pivot))
+        ;
+    if (first - 1 == begin) {
+        while (first < last && !less_than(*--last, pivot))
+            ;
+    } else {
+        while (!less_than(*--last, pivot))
+            ;
+    }
+
+    already_partitioned = first >= last;
+    while (first < last) {
+        swap(*first, *last);
+        while (less_than(*++first, pivot))
+            ;
+        while (!less_than(*--last, pivot))
+            ;
+    }
 
-    int i = 1;
-    for (int j = 1; j < size; ++j) {
-        if (less_than(*(start + j), pivot)) {
-            swap(*(start + j), *(start + i));
-            ++i;
+    T* pivot_position = first - 1;
+    *begin = move(*pivot_position);
+    *pivot_position = move(pivot);
+    return pivot_position;
+}
+
+// Partitions around the pivot at *begin, putting elements equal to it on the left.
+// We only do this when the pivot is equal to the previous one, so everything on the
+// left is equal to it and doesn't need sorting.
+template<typename T, typename LessThan>
+T* partition_left(T* begin, T* end, LessThan& less_than)
+{
+    T pivot = move(*begin);
+    T* first = begin;
+    T* last = end;
+
+    while (less_than(pivot, *--last))
+        ;
+    if (last + 1 == end) {
+        while (first < last && !less_than(pivot, *++first))
+            ;
+    } else {
+        while (!less_than(pivot, *++first))
+            ;
+    }
+
+    while (first < last) {
+        swap(*first, *last);
+        while (less_than(pivot, *--last))
+            ;
+        while (!less_than(pivot, *++first))
+            ;
+    }
+
+    T* pivot_position = last;
+    *begin = move(*pivot_position);
+    *pivot_position = move(pivot);
+    return pivot_position;
+}
+
+// Swaps a few elements around in one side of a lopsided partition, so that the next
+// pivot selection sees something different.
+template<typename T>
+void break_patterns(T* begin, T* end)
+{
+    int size = end - begin;
+    if (size < insertion_sort_threshold)
+        return;
+    int quarter = size / 4;
+    swap(begin[0], begin[quarter]);
+    swap(end[-1], end[-quarter]);
+    if (size > ninther_threshold) {
+        swap(begin[1], begin[quarter + 1]);
+        swap(begin[2], begin[quarter + 2]);
+        swap(end[-2], end[-quarter - 1]);
+        swap(end[-3], end[-quarter - 2]);
+    }
+}
+
+template<typename T, typename LessThan>
+void sort(T* begin, T* end, LessThan& less_than, int bad_partitions_allowed, bool leftmost)
+{
+    for (;;) {
+        int size = end - begin;
+        if (size < insertion_sort_threshold) {
+            if (leftmost)
+                insertion_sort(begin, end, less_than);
+            else
+                unguarded_insertion_sort(begin, end, less_than);
+            return;
+        }
+
+        int middle = size / 2;
+        if (size > ninther_threshold) {
+            sort3(begin, begin + middle, end - 1, less_than);
+            sort3(begin + 1, begin + middle - 1, end - 2, less_than);
+            sort3(begin + 2, begin + middle + 1, end - 3, less_than);
+            sort3(begin + middle - 1, begin + middle, begin + middle + 1, less_than);
+            swap(*begin, *(begin + middle));
+        } else {
+            sort3(begin + middle, begin, end - 1, less_than);
+        }
+
+        // The element before us was the pivot of an enclosing partition, and is no
+        // greater than anything in here. If it's equal to our pivot, so is everything
+        // that partition_left() will put left of our pivot.
+        if (!leftmost && !less_than(*(begin - 1), *begin)) {
+            begin = partition_left(begin, end, less_than) + 1;
+            continue;
+        }
+
+        bool already_partitioned = false;
+        T* pivot = partition_right(begin, end, less_than, already_partitioned);
+        int left_size = pivot - begin;
+        int right_size = end - (pivot + 1);
+
+        if (left_size < size / 8 || right_size < size / 8) {
+            if (--bad_partitions_allowed == 0) {
+                heap_sort(begin, end, less_than);
+                return;
+            }
+            break_patterns(begin, pivot);
+            break_patterns(pivot + 1, end);
+        } else if (already_partitioned
+            && partial_insertion_sort(begin, pivot, less_than)
+            && partial_insertion_sort(pivot + 1, end, less_than)) {
+            return;
+        }
+
+        // Recurse into the smaller half and loop on the larger one, which keeps the
+        // stack depth logarithmic.
+        if (left_size < right_size) {
+            sort(begin, pivot, less_than, bad_partitions_allowed, leftmost);
+            begin = pivot + 1;
+            leftmost = false;
+        } else {
+            sort(pivot + 1, end, less_than, bad_partitions_allowed, false);
+            end = pivot;
         }
     }
+}
 
-    swap(*start, *(start + i - 1));
-    quick_sort(start, start + i - 1, less_than);
-    quick_sort(start + i, end, less_than);
+inline int floor_log2(int size)
+{
+    int log = 0;
+    while (size >>= 1)
+        ++log;
+    return log;
+}
+
+}
+
+template<typename Iterator, typename LessThan>
+void quick_sort(Iterator start, Iterator end, LessThan less_than = is_less_than)
+{
+    int size = end - start;
+    if (size <= 1)
+        return;
+    auto* begin = &*start;
+    QuickSort::sort(begin, begin + size, less_than, QuickSort::floor_log2(size), true);
 }
 
 }
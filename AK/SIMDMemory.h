@@ -0,0 +1,428 @@
+#pragma once
+
+#include <AK/Types.h>
+
+#if defined(__i386__) || defined(__x86_64__)
+
+// SSE2 and AVX2 versions of the hot mem*() and str*() functions.
+//
+// None of this is compiled for any particular instruction set: every function carries
+// its own target attribute, so the caller has to check detect_cpu_features() before
+// calling anything in here. LibC does that once and dispatches through function pointers.
+//
+// The bulk copy and fill loops are written in inline assembly rather than with vector
+// types. Otherwise the compiler is liable to recognize them as a memcpy() or memset()
+// loop and helpfully replace them with a call to the very function we're implementing.
+//
+// The scanning functions (strlen() and memchr()) read whole aligned vectors, which can
+// run past the end of the string or buffer, but never past the end of the page it's in.
+
+namespace AK {
+namespace SIMD {
+
+struct CPUFeatures {
+    bool sse2 { false };
+    bool avx2 { false };
+};
+
+inline void cpuid(u32 function, u32 subfunction, u32& eax, u32& ebx, u32& ecx, u32& edx)
+{
+    asm volatile("cpuid"
+                 : "=a"(eax), "=b"(ebx), "=c"(ecx), "=d"(edx)
+                 : "a"(function), "c"(subfunction));
+}
+
+inline CPUFeatures detect_cpu_features()
+{
+    CPUFeatures features;
+    u32 eax, ebx, ecx, edx;
+    cpuid(0, 0, eax, ebx, ecx, edx);
+    u32 max_function = eax;
+    if (max_function < 1)
+        return features;
+
+    cpuid(1, 0, eax, ebx, ecx, edx);
+    features.sse2 = edx & (1 << 26);
+
+    // AVX needs the OS to save the upper halves of the YMM registers for us, which we
+    // can only tell from XCR0 once OSXSAVE says we're allowed to read it.
+    bool has_osxsave = ecx & (1 << 27);
+    bool has_avx = ecx & (1 << 28);
+    if (!has_osxsave || !has_avx || max_function < 7)
+        return features;
+    u32 xcr0_low, xcr0_high;
+    asm volatile("xgetbv"
+                 : "=a"(xcr0_low), "=d"(xcr0_high)
+                 : "c"(0));
+    if ((xcr0_low & 0x6) != 0x6)
+        return features;
+
+    cpuid(7, 0, eax, ebx, ecx, edx);
+    features.avx2 = ebx & (1 << 5);
+    return features;
+}
+
+typedef char v16i8 __attribute__((vector_size(16), may_alias));
+typedef char v16i8_unaligned __attribute__((vector_size(16), may_alias, aligned(1)));
+typedef char v32i8 __attribute__((vector_size(32), may_alias));
+typedef char v32i8_unaligned __attribute__((vector_size(32), may_alias, aligned(1)));
+
+// Copies and fills of up to 16 bytes, done as two overlapping stores from either end.
+inline void copy_small(u8* dest, const u8* src, size_t n)
+{
+    if (n >= 8) {
+        u64 head, tail;
+        __builtin_memcpy(&head, src, 8);
+        __builtin_memcpy(&tail, src + n - 8, 8);
+        __builtin_memcpy(dest, &head, 8);
+        __builtin_memcpy(dest + n - 8, &tail, 8);
+    } else if (n >= 4) {
+        u32 head, tail;
+        __builtin_memcpy(&head, src, 4);
+        __builtin_memcpy(&tail, src + n - 4, 4);
+        __builtin_memcpy(dest, &head, 4);
+        __builtin_memcpy(dest + n - 4, &tail, 4);
+    } else if (n >= 2) {
+        u16 head, tail;
+        __builtin_memcpy(&head, src, 2);
+        __builtin_memcpy(&tail, src + n - 2, 2);
+        __builtin_memcpy(dest, &head, 2);
+        __builtin_memcpy(dest + n - 2, &tail, 2);
+    } else if (n) {
+        *dest = *src;
+    }
+}
+
+inline void fill_small(u8* dest, u8 c, size_t n)
+{
+    u64 pattern = c * 0x0101010101010101ull;
+    if (n >= 8) {
+        __builtin_memcpy(dest, &pattern, 8);
+        __builtin_memcpy(dest + n - 8, &pattern, 8);
+    } else if (n >= 4) {
+        __builtin_memcpy(dest, &pattern, 4);
+        __builtin_memcpy(dest + n - 4, &pattern, 4);
+    } else if (n >= 2) {
+        __builtin_memcpy(dest, &pattern, 2);
+        __builtin_memcpy(dest + n - 2, &pattern, 2);
+    } else if (n) {
+        *dest = c;
+    }
+}
+
+[[gnu::target("sse2")]] inline void* sse2_memcpy(void* dest_ptr, const void* src_ptr, size_t n)
+{
+    auto* dest = (u8*)dest_ptr;
+    auto* src = (const u8*)src_ptr;
+    if (n <= 16) {
+        copy_small(dest, src, n);
+        return dest_ptr;
+    }
+
+    // The first and last 16 bytes are copied unaligned, and everything in between with
+    // aligned stores. The head and tail overlap the body, which is fine since we're
+    // writing the same bytes twice.
+    u8* end = dest + n;
+    auto head = *(const v16i8_unaligned*)src;
+    auto tail = *(const v16i8_unaligned*)(src + n - 16);
+    *(v16i8_unaligned*)dest = head;
+
+    size_t skip = 16 - ((size_t)dest & 15);
+    dest += skip;
+    src += skip;
+    n -= skip;
+    for (size_t i = n / 64; i; --i) {
+        asm volatile(
+            "movdqu (%0), %%xmm0\n"
+            "movdqu 16(%0), %%xmm1\n"
+            "movdqu 32(%0), %%xmm2\n"
+            "movdqu 48(%0), %%xmm3\n"
+            "movdqa %%xmm0, (%1)\n"
+            "movdqa %%xmm1, 16(%1)\n"
+            "movdqa %%xmm2, 32(%1)\n"
+            "movdqa %%xmm3, 48(%1)\n" ::"r"(src),
+            "r"(dest)
+            : "memory", "xmm0", "xmm1", "xmm2", "xmm3");
+        src += 64;
+        dest += 64;
+    }
+    for (size_t i = (n % 64) / 16; i; --i) {
+        asm volatile(
+            "movdqu (%0), %%xmm0\n"
+            "movdqa %%xmm0, (%1)\n" ::"r"(src),
+            "r"(dest)
+            : "memory", "xmm0");
+        src += 16;
+        dest += 16;
+    }
+    *(v16i8_unaligned*)(end - 16) = tail;
+    return dest_ptr;
+}
+
+[[gnu::target("avx2")]] inline void* avx2_memcpy(void* dest_ptr, const void* src_ptr, size_t n)
+{
+    auto* dest = (u8*)dest_ptr;
+    auto* src = (const u8*)src_ptr;
+    if (n <= 16) {
+        copy_small(dest, src, n);
+        return dest_ptr;
+    }
+    if (n <= 32) {
+        auto head = *(const v16i8_unaligned*)src;
+        auto tail = *(const v16i8_unaligned*)(src + n - 16);
+        *(v16i8_unaligned*)dest = head;
+        *(v16i8_unaligned*)(dest + n - 16) = tail;
+        return dest_ptr;
+    }
+
+    u8* end = dest + n;
+    auto head = *(const v32i8_unaligned*)src;
+    auto tail = *(const v32i8_unaligned*)(src + n - 32);
+    *(v32i8_unaligned*)dest = head;
+
+    size_t skip = 32 - ((size_t)dest & 31);
+    dest += skip;
+    src += skip;
+    n -= skip;
+    for (size_t i = n / 128; i; --i) {
+        asm volatile(
+            "vmovdqu (%0), %%ymm0\n"
+            "vmovdqu 32(%0), %%ymm1\n"
+            "vmovdqu 64(%0), %%ymm2\n"
+            "vmovdqu 96(%0), %%ymm3\n"
+            "vmovdqa %%ymm0, (%1)\n"
+            "vmovdqa %%ymm1, 32(%1)\n"
+            "vmovdqa %%ymm2, 64(%1)\n"
+            "vmovdqa %%ymm3, 96(%1)\n" ::"r"(src),
+            "r"(dest)
+            : "memory", "xmm0", "xmm1", "xmm2", "xmm3");
+        src += 128;
+        dest += 128;
+    }
+    for (size_t i = (n % 128) / 32; i; --i) {
+        asm volatile(
+            "vmovdqu (%0), %%ymm0\n"
+            "vmovdqa %%ymm0, (%1)\n" ::"r"(src),
+            "r"(dest)
+            : "memory", "xmm0");
+        src += 32;
+        dest += 32;
+    }
+    *(v32i8_unaligned*)(end - 32) = tail;
+    asm volatile("vzeroupper" ::
+                     : "memory");
+    return dest_ptr;
+}
+
+[[gnu::target("sse2")]] inline void* sse2_memset(void* dest_ptr, int c, size_t n)
+{
+    auto* dest = (u8*)dest_ptr;
+    if (n <= 16) {
+        fill_small(dest, c, n);
+        return dest_ptr;
+    }
+
+    v16i8 pattern = (v16i8) {} + (char)c;
+    *(v16i8_unaligned*)dest = pattern;
+    *(v16i8_unaligned*)(dest + n - 16) = pattern;
+
+    // Everything between the unaligned head and tail is filled with aligned stores.
+    u8* end = dest + n;
+    dest = (u8*)(((size_t)dest + 16) & ~(size_t)15);
+    size_t count = ((size_t)end & ~(size_t)15) - (size_t)dest;
+    for (size_t i = count / 64; i; --i) {
+        asm volatile(
+            "movdqa %1, %%xmm0\n"
+            "movdqa %%xmm0, (%0)\n"
+            "movdqa %%xmm0, 16(%0)\n"
+            "movdqa %%xmm0, 32(%0)\n"
+            "movdqa %%xmm0, 48(%0)\n" ::"r"(dest),
+            "m"(pattern)
+            : "memory", "xmm0");
+        dest += 64;
+    }
+    for (size_t i = (count % 64) / 16; i; --i) {
+        asm volatile(
+            "movdqa %1, %%xmm0\n"
+            "movdqa %%xmm0, (%0)\n" ::"r"(dest),
+            "m"(pattern)
+            : "memory", "xmm0");
+        dest += 16;
+    }
+    return dest_ptr;
+}
+
+[[gnu::target("avx2")]] inline void* avx2_memset(void* dest_ptr, int c, size_t n)
+{
+    auto* dest = (u8*)dest_ptr;
+    if (n <= 32)
+        return sse2_memset(dest_ptr, c, n);
+
+    v32i8 pattern = (v32i8) {} + (char)c;
+    *(v32i8_unaligned*)dest = pattern;
+    *(v32i8_unaligned*)(dest + n - 32) = pattern;
+
+    u8* end = dest + n;
+    dest = (u8*)(((size_t)dest + 32) & ~(size_t)31);
+    size_t count = ((size_t)end & ~(size_t)31) - (size_t)dest;
+    for (size_t i = count / 128; i; --i) {
+        asm volatile(
+            "vmovdqa %1, %%ymm0\n"
+            "vmovdqa %%ymm0, (%0)\n"
+            "vmovdqa %%ymm0, 32(%0)\n"
+            "vmovdqa %%ymm0, 64(%0)\n"
+            "vmovdqa %%ymm0, 96(%0)\n" ::"r"(dest),
+            "m"(pattern)
+            : "memory", "xmm0");
+        dest += 128;
+    }
+    for (size_t i = (count % 128) / 32; i; --i) {
+        asm volatile(
+            "vmovdqa %1, %%ymm0\n"
+            "vmovdqa %%ymm0, (%0)\n" ::"r"(dest),
+            "m"(pattern)
+            : "memory", "xmm0");
+        dest += 32;
+    }
+    asm volatile("vzeroupper" ::
+                     : "memory");
+    return dest_ptr;
+}
+
+inline int compare_bytes(u8 a, u8 b)
+{
+    return a < b ? -1 : 1;
+}
+
+[[gnu::target("sse2")]] inline int sse2_memcmp(const void* v1, const void* v2, size_t n)
+{
+    auto* s1 = (const u8*)v1;
+    auto* s2 = (const u8*)v2;
+    if (n < 16) {
+        for (size_t i = 0; i < n; ++i) {
+            if (s1[i] != s2[i])
+                return compare_bytes(s1[i], s2[i]);
+        }
+        return 0;
+    }
+
+    // The last vector may overlap bytes we've already compared, which is harmless.
+    for (size_t offset = 0;; offset += 16) {
+        if (offset > n - 16)
+            offset = n - 16;
+        auto a = *(const v16i8_unaligned*)(s1 + offset);
+        auto b = *(const v16i8_unaligned*)(s2 + offset);
+        u32 mask = __builtin_ia32_pmovmskb128((v16i8)(a == b));
+        if (mask != 0xffff) {
+            size_t index = offset + __builtin_ctz(~mask);
+            return compare_bytes(s1[index], s2[index]);
+        }
+        if (offset == n - 16)
+            return 0;
+    }
+}
+
+[[gnu::target("avx2")]] inline int avx2_memcmp(const void* v1, const void* v2, size_t n)
+{
+    if (n < 32)
+        return sse2_memcmp(v1, v2, n);
+
+    auto* s1 = (const u8*)v1;
+    auto* s2 = (const u8*)v2;
+    for (size_t offset = 0;; offset += 32) {
+        if (offset > n - 32)
+            offset = n - 32;
+        auto a = *(const v32i8_unaligned*)(s1 + offset);
+        auto b = *(const v32i8_unaligned*)(s2 + offset);
+        u32 mask = __builtin_ia32_pmovmskb256((v32i8)(a == b));
+        if (mask != 0xffffffff) {
+            size_t index = offset + __builtin_ctz(~mask);
+            return compare_bytes(s1[index], s2[index]);
+        }
+        if (offset == n - 32)
+            return 0;
+    }
+}
+
+[[gnu::target("sse2")]] inline size_t sse2_strlen(const char* str)
+{
+    // Start at the aligned vector containing the first byte, and ignore whatever
+    // comes before the string in it.
+    size_t misalignment = (size_t)str & 15;
+    auto* block = (const v16i8*)(str - misalignment);
+    v16i8 zero = {};
+    u32 mask = __builtin_ia32_pmovmskb128((v16i8)(*block == zero)) >> misalignment;
+    if (mask)
+        return __builtin_ctz(mask);
+    for (;;) {
+        ++block;
+        mask = __builtin_ia32_pmovmskb128((v16i8)(*block == zero));
+        if (mask)
+            return (const char*)block + __builtin_ctz(mask) - str;
+    }
+}
+
+[[gnu::target("avx2")]] inline size_t avx2_strlen(const char* str)
+{
+    size_t misalignment = (size_t)str & 31;
+    auto* block = (const v32i8*)(str - misalignment);
+    v32i8 zero = {};
+    u32 mask = (u32)__builtin_ia32_pmovmskb256((v32i8)(*block == zero)) >> misalignment;
+    if (mask)
+        return __builtin_ctz(mask);
+    for (;;) {
+        ++block;
+        mask = __builtin_ia32_pmovmskb256((v32i8)(*block == zero));
+        if (mask)
+            return (const char*)block + __builtin_ctz(mask) - str;
+    }
+}
+
+[[gnu::target("sse2")]] inline const void* sse2_memchr(const void* ptr, int c, size_t n)
+{
+    if (!n)
+        return nullptr;
+    auto* start = (const u8*)ptr;
+    auto* end = start + n;
+    size_t misalignment = (size_t)start & 15;
+    auto* block = (const v16i8*)(start - misalignment);
+    v16i8 pattern = (v16i8) {} + (char)c;
+    u32 mask = __builtin_ia32_pmovmskb128((v16i8)(*block == pattern)) >> misalignment << misalignment;
+    for (;;) {
+        if (mask) {
+            auto* found = (const u8*)block + __builtin_ctz(mask);
+            return found < end ? found : nullptr;
+        }
+        ++block;
+        if ((const u8*)block >= end)
+            return nullptr;
+        mask = __builtin_ia32_pmovmskb128((v16i8)(*block == pattern));
+    }
+}
+
+[[gnu::target("avx2")]] inline const void* avx2_memchr(const void* ptr, int c, size_t n)
+{
+    if (!n)
+        return nullptr;
+    auto* start = (const u8*)ptr;
+    auto* end = start + n;
+    size_t misalignment = (size_t)start & 31;
+    auto* block = (const v32i8*)(start - misalignment);
+    v32i8 pattern = (v32i8) {} + (char)c;
+    u32 mask = (u32)__builtin_ia32_pmovmskb256((v32i8)(*block == pattern)) >> misalignment << misalignment;
+    for (;;) {
+        if (mask) {
+            auto* found = (const u8*)block + __builtin_ctz(mask);
+            return found < end ? found : nullptr;
+        }
+        ++block;
+        if ((const u8*)block >= end)
+            return nullptr;
+        mask = __builtin_ia32_pmovmskb256((v32i8)(*block == pattern));
+    }
+}
+
+}
+}
+
+#endif
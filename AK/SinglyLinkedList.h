@@ -1,6 +1,7 @@
 #pragma once
 
 #include <AK/Assertions.h>
+#include <AK/ObjectPool.h>
 #include <AK/StdLibExtras.h>
 
 namespace AK {
@@ -31,6 +32,10 @@ private:
     typename ListType::Node* m_prev { nullptr };
 };
 
+// Nodes come from a pool owned by the list, so a list that's used as a queue (appending
+// at one end and taking from the other) stops allocating once it has reached its usual
+// size.
+
 template<typename T>
 class SinglyLinkedList {
 private:
@@ -65,7 +70,7 @@ public:
     {
         for (auto* node = m_head; node;) {
             auto* next = node->next;
-            delete node;
+            m_node_pool.destroy(node);
             node = next;
         }
         m_head = nullptr;
@@ -101,13 +106,13 @@ public:
         if (m_tail == m_head)
             m_tail = nullptr;
         m_head = m_head->next;
-        delete prev_head;
+        m_node_pool.destroy(prev_head);
         return value;
     }
 
     void append(const T& value)
     {
-        auto* node = new Node(value);
+        auto* node = m_node_pool.construct(value);
         if (!m_head) {
             m_head = node;
             m_tail = node;
@@ -119,7 +124,7 @@ public:
 
     void append(T&& value)
     {
-        auto* node = new Node(move(value));
+        auto* node = m_node_pool.construct(move(value));
         if (!m_head) {
             m_head = node;
             m_tail = node;
@@ -191,7 +196,7 @@ public:
             m_tail = iterator.m_prev;
         if (iterator.m_prev)
             iterator.m_prev->next = iterator.m_node->next;
-        delete iterator.m_node;
+        m_node_pool.destroy(iterator.m_node);
     }
 
 private:
@@ -203,6 +208,7 @@ private:
 
     Node* m_head { nullptr };
     Node* m_tail { nullptr };
+    ObjectPool<Node> m_node_pool;
 };
 
 }
@@ -11,15 +11,12 @@
 
 #include <AK/Types.h>
 
-#if defined(__serenity__) && !defined(KERNEL)
-extern "C" void* mmx_memcpy(void* to, const void* from, size_t);
-#endif
-
 [[gnu::always_inline]] inline void fast_u32_copy(u32* dest, const u32* src, size_t count)
 {
 #if defined(__serenity__) && !defined(KERNEL)
+    // Userland memcpy() picks the widest copy loop the CPU supports.
     if (count >= 256) {
-        mmx_memcpy(dest, src, count * sizeof(count));
+        memcpy(dest, src, count * sizeof(count));
         return;
     }
 #endif
@@ -7,13 +7,21 @@ namespace AK {
 
 inline void StringBuilder::will_append(int size)
 {
+    if (m_buffer.is_null()) {
+        if (m_length + size <= inline_capacity)
+            return;
+        m_buffer.grow(inline_capacity * 2 + size);
+        memcpy(m_buffer.pointer(), m_inline_buffer, m_length);
+        return;
+    }
     if ((m_length + size) > m_buffer.size())
         m_buffer.grow(max((int)16, m_buffer.size() * 2 + size));
 }
 
 StringBuilder::StringBuilder(int initial_capacity)
 {
-    m_buffer.grow(initial_capacity);
+    if (initial_capacity > inline_capacity)
+        m_buffer.grow(initial_capacity);
 }
 
 void StringBuilder::append(const StringView& str)
@@ -21,7 +29,7 @@ void StringBuilder::append(const StringView& str)
     if (str.is_empty())
         return;
     will_append(str.length());
-    memcpy(m_buffer.pointer() + m_length, str.characters_without_null_termination(), str.length());
+    memcpy(data() + m_length, str.characters_without_null_termination(), str.length());
     m_length += str.length();
 }
 
@@ -30,23 +38,21 @@ void StringBuilder::append(const char* characters, int length)
     if (!length)
         return;
     will_append(length);
-    memcpy(m_buffer.pointer() + m_length, characters, length);
+    memcpy(data() + m_length, characters, length);
     m_length += length;
 }
 
 void StringBuilder::append(char ch)
 {
     will_append(1);
-    m_buffer.pointer()[m_length] = ch;
+    data()[m_length] = ch;
     m_length += 1;
 }
 
 void StringBuilder::appendvf(const char* fmt, va_list ap)
 {
-    printf_internal([this](char*&, char ch) {
-        append(ch);
-    },
-        nullptr, fmt, ap);
+    BuilderSink<StringBuilder> sink(*this);
+    printf_to_sink(sink, fmt, ap);
 }
 
 void StringBuilder::appendf(const char* fmt, ...)
@@ -60,6 +66,11 @@ void StringBuilder::appendf(const char* fmt, ...)
 
 ByteBuffer StringBuilder::to_byte_buffer()
 {
+    if (m_buffer.is_null()) {
+        auto buffer = ByteBuffer::copy(m_inline_buffer, m_length);
+        m_length = 0;
+        return buffer;
+    }
     m_buffer.trim(m_length);
     m_length = 0;
     return move(m_buffer);
@@ -67,7 +78,7 @@ ByteBuffer StringBuilder::to_byte_buffer()
 
 String StringBuilder::to_string()
 {
-    auto string = String((const char*)m_buffer.pointer(), m_length);
+    auto string = String((const char*)data(), m_length);
     m_buffer.clear();
     m_length = 0;
     return string;
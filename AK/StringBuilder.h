@@ -6,11 +6,18 @@
 
 namespace AK {
 
+// StringBuilder starts out writing into a small buffer inside itself, and only moves to
+// the heap once that fills up. Most strings built this way are short (paths, formatted
+// numbers, serialized JSON values), so building one usually costs a single allocation,
+// for the String at the end.
+
 class StringBuilder {
 public:
     using OutputType = String;
 
-    explicit StringBuilder(int initial_capacity = 16);
+    static constexpr int inline_capacity = 128;
+
+    explicit StringBuilder(int initial_capacity = inline_capacity);
     ~StringBuilder() {}
 
     void append(const StringView&);
@@ -24,11 +31,16 @@ public:
     String to_string();
     ByteBuffer to_byte_buffer();
 
+    int length() const { return m_length; }
+
 private:
     void will_append(int);
+    u8* data() { return m_buffer.is_null() ? m_inline_buffer : m_buffer.pointer(); }
 
+    // Null until we outgrow m_inline_buffer.
     ByteBuffer m_buffer;
     int m_length { 0 };
+    u8 m_inline_buffer[inline_capacity];
 };
 
 }
@@ -1,4 +1,5 @@
 #include "StringImpl.h"
+#include "FlyString.h"
 #include "HashTable.h"
 #include "StdLibExtras.h"
 #include "kmalloc.h"
@@ -36,6 +37,18 @@ StringImpl& StringImpl::the_empty_stringimpl()
     return *s_the_empty_stringimpl;
 }
 
+StringImpl& StringImpl::the_single_character_stringimpl(char ch)
+{
+    static StringImpl* s_single_character_stringimpls[128];
+    ASSERT(ch > 0);
+    auto*& impl = s_single_character_stringimpls[(u8)ch];
+    if (!impl) {
+        void* slot = kmalloc(sizeof(StringImpl) + sizeof(char) * 2);
+        impl = new (slot) StringImpl(ConstructSingleCharacterStringImpl, ch);
+    }
+    return *impl;
+}
+
 StringImpl::StringImpl(ConstructWithInlineBufferTag, int length)
     : m_length(length)
 {
@@ -49,6 +62,8 @@ StringImpl::StringImpl(ConstructWithInlineBufferTag, int length)
 
 StringImpl::~StringImpl()
 {
+    if (m_fly)
+        FlyString::did_destroy_impl({}, *this);
 #ifdef DEBUG_STRINGIMPL
     --g_stringimpl_count;
     g_all_live_stringimpls->remove(this);
@@ -92,6 +107,9 @@ RefPtr<StringImpl> StringImpl::create(const char* cstring, int length, ShouldCho
     if (!length)
         return the_empty_stringimpl();
 
+    if (length == 1 && cstring[0] > 0)
+        return the_single_character_stringimpl(cstring[0]);
+
     char* buffer;
     auto new_stringimpl = create_uninitialized(length, buffer);
     memcpy(buffer, cstring, length * sizeof(char));
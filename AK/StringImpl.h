@@ -1,5 +1,6 @@
 #pragma once
 
+#include <AK/Badge.h>
 #include <AK/RefPtr.h>
 #include <AK/RefCounted.h>
 #include <AK/Types.h>
@@ -7,6 +8,8 @@
 
 namespace AK {
 
+class FlyString;
+
 enum ShouldChomp {
     NoChomp,
     Chomp
@@ -27,6 +30,11 @@ public:
 
     static StringImpl& the_empty_stringimpl();
 
+    // One-character strings are common enough (separators, single letters typed into
+    // text boxes, etc.) that every ASCII one gets a shared, never freed StringImpl, just
+    // like the empty string.
+    static StringImpl& the_single_character_stringimpl(char);
+
     ~StringImpl();
 
     int length() const { return m_length; }
@@ -44,6 +52,9 @@ public:
         return m_hash;
     }
 
+    bool is_fly() const { return m_fly; }
+    void set_fly(Badge<FlyString>, bool fly) const { m_fly = fly; }
+
 private:
     enum ConstructTheEmptyStringImplTag {
         ConstructTheEmptyStringImpl
@@ -53,6 +64,16 @@ private:
         m_inline_buffer[0] = '\0';
     }
 
+    enum ConstructSingleCharacterStringImplTag {
+        ConstructSingleCharacterStringImpl
+    };
+    StringImpl(ConstructSingleCharacterStringImplTag, char ch)
+        : m_length(1)
+    {
+        m_inline_buffer[0] = ch;
+        m_inline_buffer[1] = '\0';
+    }
+
     enum ConstructWithInlineBufferTag {
         ConstructWithInlineBuffer
     };
@@ -63,6 +84,7 @@ private:
     int m_length { 0 };
     mutable unsigned m_hash { 0 };
     mutable bool m_has_hash { false };
+    mutable bool m_fly { false };
     char m_inline_buffer[0];
 };
 
@@ -0,0 +1,115 @@
+#include <AK/TestSuite.h>
+
+#include <AK/AKString.h>
+#include <AK/BumpAllocator.h>
+#include <AK/Vector.h>
+
+static int s_live_objects;
+
+struct Counted {
+    explicit Counted(int v)
+        : value(v)
+    {
+        ++s_live_objects;
+    }
+    ~Counted() { --s_live_objects; }
+    int value;
+};
+
+TEST_CASE(allocations_are_aligned_and_distinct)
+{
+    BumpAllocator arena(256);
+    Vector<u8*> pointers;
+    for (int i = 0; i < 1000; ++i) {
+        size_t alignment = 1 << (i % 4);
+        auto* pointer = static_cast<u8*>(arena.allocate(i % 13 + 1, alignment));
+        EXPECT_EQ((size_t)pointer & (alignment - 1), 0u);
+        memset(pointer, i & 0xff, i % 13 + 1);
+        pointers.append(pointer);
+    }
+    for (int i = 0; i < 1000; ++i)
+        EXPECT_EQ(pointers[i][i % 13], (u8)(i & 0xff));
+    EXPECT(arena.chunk_count() > 1);
+}
+
+TEST_CASE(big_allocations_get_their_own_chunk)
+{
+    BumpAllocator arena(64);
+    auto* big = static_cast<u8*>(arena.allocate(1000));
+    memset(big, 1, 1000);
+    auto* small = static_cast<u8*>(arena.allocate(8));
+    memset(small, 2, 8);
+    EXPECT_EQ(big[999], 1);
+    EXPECT_EQ(arena.allocated_bytes(), 1008u);
+}
+
+TEST_CASE(clear_runs_destructors)
+{
+    {
+        BumpAllocator arena;
+        for (int i = 0; i < 100; ++i)
+            EXPECT_EQ(arena.make<Counted>(i)->value, i);
+        auto* string = arena.make<String>("owned by the arena");
+        EXPECT_EQ(*string, "owned by the arena");
+        EXPECT_EQ(s_live_objects, 100);
+        arena.clear_and_keep_first_chunk();
+        EXPECT_EQ(s_live_objects, 0);
+        EXPECT_EQ(arena.chunk_count(), 1);
+
+        arena.make<Counted>(1);
+        EXPECT_EQ(s_live_objects, 1);
+    }
+    EXPECT_EQ(s_live_objects, 0);
+}
+
+struct Node {
+    Node* left { nullptr };
+    Node* right { nullptr };
+    int value { 0 };
+};
+
+static const int tree_node_count = 1000000;
+
+// Builds a big tree and throws it away, which is what parsers tend to do.
+template<typename MakeNode>
+static Node* build_tree(MakeNode make_node)
+{
+    Node* root = make_node();
+    Node* current = root;
+    for (int i = 1; i < tree_node_count; ++i) {
+        auto* node = make_node();
+        node->value = i;
+        if (i & 1)
+            current->left = node;
+        else
+            current->right = node;
+        current = node;
+    }
+    return root;
+}
+
+static void delete_tree(Node* node)
+{
+    while (node) {
+        auto* next = node->left ? node->left : node->right;
+        delete node;
+        node = next;
+    }
+}
+
+BENCHMARK_CASE(tree_with_new_and_delete)
+{
+    for (int round = 0; round < 5; ++round)
+        delete_tree(build_tree([] { return new Node; }));
+}
+
+BENCHMARK_CASE(tree_with_bump_allocator)
+{
+    BumpAllocator arena;
+    for (int round = 0; round < 5; ++round) {
+        build_tree([&] { return arena.make<Node>(); });
+        arena.clear_and_keep_first_chunk();
+    }
+}
+
+TEST_MAIN(BumpAllocator)
@@ -0,0 +1,228 @@
+#include <AK/TestSuite.h>
+
+#include <AK/AKString.h>
+#include <AK/HashMap.h>
+#include <AK/HashTable.h>
+#include <AK/SinglyLinkedList.h>
+#include <AK/Vector.h>
+
+static u32 s_seed = 1;
+
+static u32 next_random()
+{
+    s_seed = s_seed * 1103515245 + 12345;
+    return s_seed >> 8;
+}
+
+TEST_CASE(set_and_find_many)
+{
+    HashTable<int> table;
+    for (int i = 0; i < 10000; ++i)
+        table.set(i * 7);
+    EXPECT_EQ(table.size(), 10000);
+    for (int i = 0; i < 10000; ++i) {
+        EXPECT(table.contains(i * 7));
+        EXPECT(!table.contains(i * 7 + 1));
+    }
+}
+
+TEST_CASE(set_replaces_equal_value)
+{
+    HashMap<int, int> map;
+    map.set(1, 10);
+    map.set(1, 20);
+    EXPECT_EQ(map.size(), 1);
+    EXPECT_EQ(map.get(1).value(), 20);
+}
+
+TEST_CASE(iteration_visits_everything_once)
+{
+    HashTable<int> table;
+    for (int i = 0; i < 1000; ++i)
+        table.set(i);
+    Vector<int> seen;
+    for (int i = 0; i < 1000; ++i)
+        seen.append(0);
+    for (auto value : table)
+        ++seen[value];
+    for (int i = 0; i < 1000; ++i)
+        EXPECT_EQ(seen[i], 1);
+}
+
+TEST_CASE(remove_keeps_probe_chains_intact)
+{
+    // Random inserts and removes, checked against a plain array of flags.
+    HashTable<int> table;
+    Vector<bool> present;
+    for (int i = 0; i < 2000; ++i)
+        present.append(false);
+    int size = 0;
+    for (int i = 0; i < 100000; ++i) {
+        int value = next_random() % 2000;
+        if (next_random() % 3) {
+            if (!present[value])
+                ++size;
+            present[value] = true;
+            table.set(value);
+        } else {
+            if (present[value])
+                --size;
+            present[value] = false;
+            table.remove(value);
+        }
+    }
+    EXPECT_EQ(table.size(), size);
+    for (int i = 0; i < 2000; ++i)
+        EXPECT_EQ(table.contains(i), (bool)present[i]);
+}
+
+TEST_CASE(remove_with_iterator)
+{
+    HashMap<String, int> map;
+    for (int i = 0; i < 100; ++i)
+        map.set(String::number(i), i);
+    while (!map.is_empty())
+        map.remove(map.begin());
+    EXPECT_EQ(map.size(), 0);
+    EXPECT(map.begin() == map.end());
+}
+
+TEST_CASE(copy_and_move)
+{
+    HashMap<int, String> map;
+    for (int i = 0; i < 100; ++i)
+        map.set(i, String::number(i));
+    auto copy = map;
+    EXPECT_EQ(copy.size(), 100);
+    EXPECT_EQ(copy.get(42).value(), "42");
+    auto moved = move(copy);
+    EXPECT_EQ(moved.size(), 100);
+    EXPECT_EQ(moved.get(99).value(), "99");
+    EXPECT(copy.is_empty());
+    EXPECT(copy.find(42) == copy.end());
+    copy.set(1, "one");
+    EXPECT_EQ(copy.get(1).value(), "one");
+}
+
+TEST_CASE(find_with_precomputed_hash)
+{
+    HashMap<String, int> map;
+    map.set("hello", 1);
+    map.set("friends", 2);
+    StringView key = "friends";
+    auto it = map.find(key.hash(), [&](auto& entry) { return entry.key == key; });
+    EXPECT(it != map.end());
+    EXPECT_EQ(it->value, 2);
+}
+
+// This is what HashTable looked like before it switched to open addressing: an array of
+// linked lists, growing to twice the number of values whenever it's full. It's only here
+// so the benchmarks below have something to compare against.
+class ChainedIntTable {
+public:
+    ~ChainedIntTable() { delete[] m_buckets; }
+
+    void set(int value)
+    {
+        if (!m_capacity)
+            rehash(1);
+        auto& bucket = m_buckets[int_hash(value) % m_capacity];
+        for (auto& e : bucket) {
+            if (e == value)
+                return;
+        }
+        if (m_size >= m_capacity) {
+            rehash(m_size + 1);
+            m_buckets[int_hash(value) % m_capacity].append(value);
+        } else {
+            bucket.append(value);
+        }
+        ++m_size;
+    }
+
+    bool contains(int value) const
+    {
+        if (!m_size)
+            return false;
+        for (auto& e : m_buckets[int_hash(value) % m_capacity]) {
+            if (e == value)
+                return true;
+        }
+        return false;
+    }
+
+    void remove(int value)
+    {
+        auto& bucket = m_buckets[int_hash(value) % m_capacity];
+        auto it = bucket.find([&](auto& e) { return e == value; });
+        if (it != bucket.end()) {
+            bucket.remove(it);
+            --m_size;
+        }
+    }
+
+private:
+    void rehash(int capacity)
+    {
+        capacity *= 2;
+        auto* old_buckets = m_buckets;
+        int old_capacity = m_capacity;
+        m_buckets = new SinglyLinkedList<int>[capacity];
+        m_capacity = capacity;
+        for (int i = 0; i < old_capacity; ++i) {
+            for (auto& value : old_buckets[i])
+                m_buckets[int_hash(value) % m_capacity].append(value);
+        }
+        delete[] old_buckets;
+    }
+
+    SinglyLinkedList<int>* m_buckets { nullptr };
+    int m_size { 0 };
+    int m_capacity { 0 };
+};
+
+static const int bench_size = 500000;
+
+template<typename Table>
+static void bench_insert_lookup_remove()
+{
+    Table table;
+    for (int i = 0; i < bench_size; ++i)
+        table.set(i * 13);
+    int found = 0;
+    for (int round = 0; round < 4; ++round) {
+        for (int i = 0; i < bench_size; ++i)
+            found += table.contains(i * 13);
+    }
+    for (int i = 0; i < bench_size; ++i)
+        table.remove(i * 13);
+    EXPECT_EQ(found, bench_size * 4);
+}
+
+BENCHMARK_CASE(open_addressing_table)
+{
+    bench_insert_lookup_remove<HashTable<int>>();
+}
+
+BENCHMARK_CASE(chained_table)
+{
+    bench_insert_lookup_remove<ChainedIntTable>();
+}
+
+BENCHMARK_CASE(string_map_lookups)
+{
+    HashMap<String, int> map;
+    Vector<String> keys;
+    for (int i = 0; i < 50000; ++i) {
+        keys.append(String::format("key-%d", i));
+        map.set(keys.last(), i);
+    }
+    int sum = 0;
+    for (int round = 0; round < 10; ++round) {
+        for (auto& key : keys)
+            sum += map.get(key).value();
+    }
+    EXPECT(sum != 0);
+}
+
+TEST_MAIN(HashTable)
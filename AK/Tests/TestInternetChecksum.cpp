@@ -0,0 +1,129 @@
+#include <AK/TestSuite.h>
+
+#include <AK/InternetChecksum.h>
+#include <AK/Vector.h>
+
+// The straightforward one-word-at-a-time version we used to have, as a reference.
+static u16 scalar_internet_checksum(const void* ptr, size_t count)
+{
+    u32 checksum = 0;
+    auto* bytes = (const u8*)ptr;
+    while (count > 1) {
+        checksum += (bytes[0] << 8) | bytes[1];
+        if (checksum & 0x80000000)
+            checksum = (checksum & 0xffff) | (checksum >> 16);
+        bytes += 2;
+        count -= 2;
+    }
+    if (count)
+        checksum += bytes[0] << 8;
+    while (checksum >> 16)
+        checksum = (checksum & 0xffff) + (checksum >> 16);
+    return ~checksum & 0xffff;
+}
+
+static Vector<u8> make_data(size_t size, u32 seed)
+{
+    Vector<u8> data;
+    data.ensure_capacity(size);
+    for (size_t i = 0; i < size; ++i) {
+        seed = seed * 1103515245 + 12345;
+        data.append(seed >> 16);
+    }
+    return data;
+}
+
+TEST_CASE(rfc1071_example)
+{
+    // RFC 1071, section 3: the sum of these bytes is 0xddf2.
+    u8 data[] = { 0x00, 0x01, 0xf2, 0x03, 0xf4, 0xf5, 0xf6, 0xf7 };
+    EXPECT_EQ(internet_checksum(data, sizeof(data)), (u16)~0xddf2);
+}
+
+TEST_CASE(empty)
+{
+    EXPECT_EQ(internet_checksum(nullptr, 0), 0xffff);
+}
+
+TEST_CASE(matches_scalar_for_all_sizes_and_alignments)
+{
+    auto data = make_data(1500 + 8, 1);
+    for (size_t offset = 0; offset < 8; ++offset) {
+        for (size_t size = 0; size <= 1500; ++size)
+            EXPECT_EQ(internet_checksum(data.data() + offset, size), scalar_internet_checksum(data.data() + offset, size));
+    }
+}
+
+TEST_CASE(all_ones_does_not_overflow)
+{
+    Vector<u8> data;
+    for (int i = 0; i < 65536; ++i)
+        data.append(0xff);
+    EXPECT_EQ(internet_checksum(data.data(), data.size()), scalar_internet_checksum(data.data(), data.size()));
+}
+
+TEST_CASE(chunks_add_up_to_the_whole)
+{
+    auto data = make_data(1001, 2);
+    for (int split = 0; split < data.size(); split += 2) {
+        InternetChecksum checksum;
+        checksum.add(data.data(), split);
+        checksum.add(data.data() + split, data.size() - split);
+        EXPECT_EQ(checksum.finish(), internet_checksum(data.data(), data.size()));
+    }
+}
+
+TEST_CASE(checksum_of_checksummed_data_is_zero)
+{
+    auto data = make_data(64, 3);
+    data[10] = 0;
+    data[11] = 0;
+    u16 checksum = internet_checksum(data.data(), data.size());
+    data[10] = checksum >> 8;
+    data[11] = checksum & 0xff;
+    EXPECT_EQ(internet_checksum(data.data(), data.size()), 0);
+}
+
+TEST_CASE(partial_sum_seeds_the_rest)
+{
+    // This is what checksum offload does: finish a sum that was started elsewhere.
+    auto header = make_data(12, 4);
+    auto payload = make_data(100, 5);
+    InternetChecksum pseudo;
+    pseudo.add(header.data(), header.size());
+    u16 seed = pseudo.partial_sum();
+    payload[16] = seed >> 8;
+    payload[17] = seed & 0xff;
+    u16 checksum = internet_checksum(payload.data(), payload.size());
+
+    payload[16] = 0;
+    payload[17] = 0;
+    InternetChecksum whole;
+    whole.add(header.data(), header.size());
+    whole.add(payload.data(), payload.size());
+    EXPECT_EQ(checksum, whole.finish());
+}
+
+BENCHMARK_CASE(scalar_checksum_1500_bytes)
+{
+    auto data = make_data(1500, 6);
+    u32 total = 0;
+    for (int i = 0; i < 200000; ++i) {
+        data[0] = i;
+        total += scalar_internet_checksum(data.data(), data.size());
+    }
+    EXPECT(total != 0);
+}
+
+BENCHMARK_CASE(wide_checksum_1500_bytes)
+{
+    auto data = make_data(1500, 6);
+    u32 total = 0;
+    for (int i = 0; i < 200000; ++i) {
+        data[0] = i;
+        total += internet_checksum(data.data(), data.size());
+    }
+    EXPECT(total != 0);
+}
+
+TEST_MAIN(InternetChecksum)
@@ -4,6 +4,8 @@
 #include <AK/HashMap.h>
 #include <AK/JsonArray.h>
 #include <AK/JsonObject.h>
+#include <AK/JsonObjectSerializer.h>
+#include <AK/JsonReader.h>
 #include <AK/JsonValue.h>
 #include <AK/StringBuilder.h>
 
@@ -74,4 +76,267 @@ TEST_CASE(json_empty_string)
     EXPECT_EQ(json.as_string().is_empty(), true);
 }
 
+static String read_4chan_catalog()
+{
+    FILE* fp = fopen("4chan_catalog.json", "r");
+    ASSERT(fp);
+
+    StringBuilder builder;
+    for (;;) {
+        char buffer[1024];
+        if (!fgets(buffer, sizeof(buffer), fp))
+            break;
+        builder.append(buffer);
+    }
+
+    fclose(fp);
+    return builder.to_string();
+}
+
+// Reads everything, and describes each token with one character, so we can compare
+// whole token streams at once.
+static String describe_tokens(const StringView& json)
+{
+    StringBuilder builder;
+    JsonReader reader(json);
+    for (;;) {
+        switch (reader.next()) {
+        case JsonReader::Token::End:
+            return builder.to_string();
+        case JsonReader::Token::Error:
+            builder.append('!');
+            return builder.to_string();
+        case JsonReader::Token::BeginObject:
+            builder.append('{');
+            break;
+        case JsonReader::Token::EndObject:
+            builder.append('}');
+            break;
+        case JsonReader::Token::BeginArray:
+            builder.append('[');
+            break;
+        case JsonReader::Token::EndArray:
+            builder.append(']');
+            break;
+        case JsonReader::Token::Key:
+            builder.appendf("k(%s)", String(reader.text()).characters());
+            break;
+        case JsonReader::Token::String:
+            builder.appendf("s(%s)", reader.string().characters());
+            break;
+        case JsonReader::Token::Number:
+            builder.appendf("n(%s)", String(reader.text()).characters());
+            break;
+        case JsonReader::Token::True:
+            builder.append('t');
+            break;
+        case JsonReader::Token::False:
+            builder.append('f');
+            break;
+        case JsonReader::Token::Null:
+            builder.append('0');
+            break;
+        }
+    }
+}
+
+TEST_CASE(reader_tokens)
+{
+    EXPECT_EQ(describe_tokens("{\"a\": [1, -2, \"x\", true, false, null], \"b\": {}}"), "{k(a)[n(1)n(-2)s(x)tf0]k(b){}}");
+    EXPECT_EQ(describe_tokens(" 42 "), "n(42)");
+    EXPECT_EQ(describe_tokens("[[],[[]]]"), "[[][[]]]");
+    EXPECT_EQ(describe_tokens("\"a\\\"b\\nc\""), "s(a\"b\nc)");
+}
+
+TEST_CASE(reader_text_points_into_input)
+{
+    const char* json = "{\"name\":\"value\"}";
+    JsonReader reader(json);
+    EXPECT(reader.next() == JsonReader::Token::BeginObject);
+    EXPECT(reader.next() == JsonReader::Token::Key);
+    EXPECT_EQ(reader.text().characters_without_null_termination(), json + 2);
+    EXPECT(reader.next() == JsonReader::Token::String);
+    EXPECT_EQ(reader.text(), "value");
+    EXPECT(!reader.text_has_escapes());
+    EXPECT(reader.next() == JsonReader::Token::EndObject);
+    EXPECT(reader.next() == JsonReader::Token::End);
+}
+
+TEST_CASE(reader_errors)
+{
+    EXPECT_EQ(describe_tokens(""), "!");
+    EXPECT_EQ(describe_tokens("[1,]"), "[n(1)!");
+    EXPECT_EQ(describe_tokens("[1 2]"), "[n(1)!");
+    EXPECT_EQ(describe_tokens("{\"a\"}"), "{!");
+    EXPECT_EQ(describe_tokens("{\"a\":}"), "{k(a)!");
+    EXPECT_EQ(describe_tokens("{1:2}"), "{!");
+    EXPECT_EQ(describe_tokens("[}"), "[!");
+    EXPECT_EQ(describe_tokens("[\"abc"), "[!");
+    EXPECT_EQ(describe_tokens("[tru]"), "[!");
+    EXPECT_EQ(describe_tokens("1 2"), "n(1)!");
+    EXPECT_EQ(describe_tokens("[1"), "[n(1)!");
+}
+
+TEST_CASE(reader_skip_value)
+{
+    JsonReader reader("{\"skip\": {\"a\": [1, {\"b\": 2}]}, \"keep\": 3}");
+    EXPECT(reader.next() == JsonReader::Token::BeginObject);
+    EXPECT(reader.next() == JsonReader::Token::Key);
+    EXPECT(reader.skip_value());
+    EXPECT(reader.next() == JsonReader::Token::Key);
+    EXPECT_EQ(reader.text(), "keep");
+    EXPECT(reader.next() == JsonReader::Token::Number);
+    EXPECT_EQ(reader.text(), "3");
+    EXPECT(reader.next() == JsonReader::Token::EndObject);
+    EXPECT(reader.next() == JsonReader::Token::End);
+}
+
+TEST_CASE(reader_reads_4chan_catalog)
+{
+    // Count the threads on each page, both ways.
+    auto json_string = read_4chan_catalog();
+    auto tree = JsonValue::from_string(json_string).as_array();
+
+    JsonReader reader(json_string);
+    EXPECT(reader.next() == JsonReader::Token::BeginArray);
+    int page_index = 0;
+    while (reader.next() == JsonReader::Token::BeginObject) {
+        int threads = -1;
+        while (reader.next() == JsonReader::Token::Key) {
+            if (reader.text() == "threads") {
+                EXPECT(reader.next() == JsonReader::Token::BeginArray);
+                threads = 0;
+                while (reader.skip_value())
+                    ++threads;
+            } else {
+                EXPECT(reader.skip_value());
+            }
+        }
+        EXPECT_EQ(threads, tree.at(page_index).as_object().get("threads").as_array().size());
+        ++page_index;
+    }
+    EXPECT_EQ(page_index, tree.size());
+    EXPECT(reader.next() == JsonReader::Token::End);
+}
+
+TEST_CASE(serializer_matches_tree)
+{
+    JsonArray array;
+    JsonObject object;
+    object.set("name", "Form1");
+    array.append(object);
+    array.append(JsonValue(42));
+    array.append(JsonValue(4000000000u));
+    array.append(JsonValue(true));
+    array.append(JsonArray());
+    array.append(JsonValue());
+
+    StringBuilder builder;
+    {
+        JsonArraySerializer serializer { builder };
+        serializer.add_object().add("name", "Form1");
+        serializer.add(42);
+        serializer.add(4000000000u);
+        serializer.add(true);
+        serializer.add_array();
+        serializer.add(JsonValue());
+    }
+    EXPECT_EQ(builder.to_string(), array.to_string());
+}
+
+TEST_CASE(serializer_nesting)
+{
+    StringBuilder builder;
+    {
+        JsonObjectSerializer object { builder };
+        object.add("pid", 1);
+        object.add("name", String("init"));
+        {
+            auto fds = object.add_array("fds");
+            fds.add(0);
+            fds.add(1);
+            auto fd = fds.add_object();
+            fd.add("path", "/dev/tty0");
+            fd.finish();
+            fds.add("last");
+        }
+        object.add("empty", JsonObject());
+    }
+    auto string = builder.to_string();
+    EXPECT_EQ(string, "{\"pid\":1,\"name\":\"init\",\"fds\":[0,1,{\"path\":\"/dev/tty0\"},\"last\"],\"empty\":{}}");
+    auto parsed = JsonValue::from_string(string).as_object();
+    EXPECT_EQ(parsed.get("fds").as_array().size(), 4);
+}
+
+TEST_CASE(serializer_long_unsigned)
+{
+    // Only 64-bit hosts have a long big enough to need more than 32 bits.
+    if (sizeof(long unsigned) < sizeof(u64))
+        return;
+    long unsigned big = (long unsigned)0xffffffffu + 1;
+    StringBuilder builder;
+    {
+        JsonObjectSerializer object { builder };
+        object.add("size", big);
+        object.add_array("sizes").add(big);
+    }
+    EXPECT_EQ(builder.to_string(), "{\"size\":4294967296,\"sizes\":[4294967296]}");
+}
+
+BENCHMARK_CASE(read_4chan_catalog_with_reader)
+{
+    auto json_string = read_4chan_catalog();
+
+    for (int i = 0; i < 10; ++i) {
+        JsonReader reader(json_string);
+        int strings = 0;
+        for (;;) {
+            auto token = reader.next();
+            if (token == JsonReader::Token::End || token == JsonReader::Token::Error)
+                break;
+            if (token == JsonReader::Token::String)
+                ++strings;
+        }
+        EXPECT(strings > 0);
+    }
+}
+
+static const int serialize_count = 2000;
+
+BENCHMARK_CASE(serialize_with_tree)
+{
+    for (int round = 0; round < 10; ++round) {
+        JsonArray array;
+        for (int i = 0; i < serialize_count; ++i) {
+            JsonObject object;
+            object.set("pid", i);
+            object.set("state", "Runnable");
+            object.set("name", "WindowServer");
+            object.set("amount_virtual", 4096u * i);
+            object.set("ticks", (unsigned)i * 7);
+            array.append(move(object));
+        }
+        EXPECT(!array.to_string().is_empty());
+    }
+}
+
+BENCHMARK_CASE(serialize_with_serializer)
+{
+    for (int round = 0; round < 10; ++round) {
+        StringBuilder builder;
+        {
+            JsonArraySerializer array { builder };
+            for (int i = 0; i < serialize_count; ++i) {
+                auto object = array.add_object();
+                object.add("pid", i);
+                object.add("state", "Runnable");
+                object.add("name", "WindowServer");
+                object.add("amount_virtual", 4096u * i);
+                object.add("ticks", (unsigned)i * 7);
+            }
+        }
+        EXPECT(!builder.to_string().is_empty());
+    }
+}
+
 TEST_MAIN(JSON)
@@ -0,0 +1,134 @@
+#include <AK/TestSuite.h>
+
+#include <AK/AKString.h>
+#include <AK/ObjectPool.h>
+#include <AK/SinglyLinkedList.h>
+#include <AK/Vector.h>
+
+static int s_live_objects;
+
+struct Counted {
+    explicit Counted(int v)
+        : value(v)
+    {
+        ++s_live_objects;
+    }
+    ~Counted() { --s_live_objects; }
+    int value;
+};
+
+TEST_CASE(pool_reuses_freed_slots)
+{
+    ObjectPool<Counted> pool;
+    auto* a = pool.construct(1);
+    auto* b = pool.construct(2);
+    EXPECT(a != b);
+    pool.destroy(a);
+    EXPECT_EQ(s_live_objects, 1);
+    auto* c = pool.construct(3);
+    EXPECT_EQ(c, a);
+    EXPECT_EQ(c->value, 3);
+    pool.destroy(b);
+    pool.destroy(c);
+    EXPECT_EQ(s_live_objects, 0);
+}
+
+TEST_CASE(pool_grows)
+{
+    ObjectPool<Counted> pool;
+    Vector<Counted*> objects;
+    for (int i = 0; i < 10000; ++i)
+        objects.append(pool.construct(i));
+    for (int i = 0; i < 10000; ++i)
+        EXPECT_EQ(objects[i]->value, i);
+    for (auto* object : objects)
+        pool.destroy(object);
+    EXPECT_EQ(s_live_objects, 0);
+}
+
+struct Pooled {
+    AK_MAKE_POOL_ALLOCATED(Pooled)
+public:
+    virtual ~Pooled() {}
+    int value { 0 };
+};
+
+struct BiggerThanPooled : public Pooled {
+    int more[16];
+};
+
+TEST_CASE(pool_allocated_class)
+{
+    auto* a = new Pooled;
+    delete a;
+    auto* b = new Pooled;
+    EXPECT_EQ(a, b);
+    delete b;
+
+    // Subclasses of a different size go to the heap, even when deleted as the base class.
+    Pooled* c = new BiggerThanPooled;
+    c->value = 42;
+    EXPECT_EQ(c->value, 42);
+    delete c;
+}
+
+TEST_CASE(linked_list_queue)
+{
+    SinglyLinkedList<String> list;
+    for (int round = 0; round < 3; ++round) {
+        for (int i = 0; i < 100; ++i)
+            list.append(String::number(i));
+        for (int i = 0; i < 100; ++i)
+            EXPECT_EQ(list.take_first(), String::number(i));
+        EXPECT(list.is_empty());
+    }
+    list.append("a");
+    list.append("b");
+    list.append("c");
+    list.remove(list.find([](auto& string) { return string == "b"; }));
+    EXPECT_EQ(list.size_slow(), 2);
+    EXPECT_EQ(list.first(), "a");
+    EXPECT_EQ(list.last(), "c");
+}
+
+static const int queue_rounds = 2000;
+
+BENCHMARK_CASE(queue_with_new_and_delete)
+{
+    // This is what SinglyLinkedList did before it pooled its nodes.
+    struct QueueNode {
+        int value;
+        QueueNode* next;
+    };
+    QueueNode* head = nullptr;
+    QueueNode* tail = nullptr;
+    for (int round = 0; round < queue_rounds; ++round) {
+        for (int i = 0; i < 500; ++i) {
+            auto* node = new QueueNode { i, nullptr };
+            if (tail)
+                tail->next = node;
+            else
+                head = node;
+            tail = node;
+        }
+        while (head) {
+            auto* next = head->next;
+            delete head;
+            head = next;
+        }
+        tail = nullptr;
+    }
+}
+
+BENCHMARK_CASE(queue_with_pooled_list)
+{
+    SinglyLinkedList<int> list;
+    for (int round = 0; round < queue_rounds; ++round) {
+        for (int i = 0; i < 500; ++i)
+            list.append(i);
+        while (!list.is_empty())
+            list.take_first();
+    }
+}
+
+TEST_MAIN(ObjectPool)
@@ -0,0 +1,120 @@
+#include <AK/TestSuite.h>
+
+#include <AK/AKString.h>
+#include <AK/PrintfImplementation.h>
+#include <stdio.h>
+
+// Collects printf_to_sink() output, and counts how many pieces it arrived in.
+class TestSink {
+public:
+    void put(char ch)
+    {
+        m_buffer[m_length++] = ch;
+        ++m_put_count;
+    }
+
+    void put(const char* characters, size_t length)
+    {
+        memcpy(m_buffer + m_length, characters, length);
+        m_length += length;
+        ++m_put_count;
+    }
+
+    void put_repeated(char ch, size_t count)
+    {
+        memset(m_buffer + m_length, ch, count);
+        m_length += count;
+        ++m_put_count;
+    }
+
+    String string() const { return String(m_buffer, m_length); }
+    int put_count() const { return m_put_count; }
+
+private:
+    char m_buffer[1024];
+    size_t m_length { 0 };
+    int m_put_count { 0 };
+};
+
+static String format_with_sink(const char* fmt, ...)
+{
+    va_list ap;
+    va_start(ap, fmt);
+    TestSink sink;
+    printf_to_sink(sink, fmt, ap);
+    va_end(ap);
+    return sink.string();
+}
+
+TEST_CASE(decimal)
+{
+    EXPECT_EQ(String::format("%d", 0), "0");
+    EXPECT_EQ(String::format("%d", 7), "7");
+    EXPECT_EQ(String::format("%d", 42), "42");
+    EXPECT_EQ(String::format("%d", 100), "100");
+    EXPECT_EQ(String::format("%d", -12345), "-12345");
+    EXPECT_EQ(String::format("%d", (int)0x80000000), "-2147483648");
+    EXPECT_EQ(String::format("%u", 4294967295u), "4294967295");
+    EXPECT_EQ(String::format("%Q", 18446744073709551615ull), "18446744073709551615");
+    EXPECT_EQ(String::format("%Q", 4294967296ull), "4294967296");
+    EXPECT_EQ(String::format("%Q", 1000000000000ull), "1000000000000");
+}
+
+TEST_CASE(decimal_matches_libc)
+{
+    u32 values[] = { 0, 1, 9, 10, 99, 100, 101, 999, 1000, 65535, 123456789, 1000000000, 4294967295u };
+    for (auto value : values) {
+        char expected[32];
+        snprintf(expected, sizeof(expected), "%u", value);
+        EXPECT_EQ(String::format("%u", value), expected);
+        snprintf(expected, sizeof(expected), "%o", value);
+        EXPECT_EQ(String::format("%o", value), expected);
+        snprintf(expected, sizeof(expected), "%x", value);
+        EXPECT_EQ(String::format("%x", value), expected);
+    }
+}
+
+TEST_CASE(padding)
+{
+    EXPECT_EQ(String::format("%5d|", 42), "   42|");
+    EXPECT_EQ(String::format("%-5d|", 42), "42   |");
+    EXPECT_EQ(String::format("%05d|", 42), "00042|");
+    EXPECT_EQ(String::format("%5s|", "ab"), "   ab|");
+    EXPECT_EQ(String::format("%-5s|", "ab"), "ab   |");
+    EXPECT_EQ(String::format("%2s|", "abcdef"), "abcdef|");
+    EXPECT_EQ(String::format("%08x", 0xbeef), "0000beef");
+    EXPECT_EQ(String::format("%X", 0xbeef), "BEEF");
+    EXPECT_EQ(String::format("%#x", 0xff), "0xff");
+}
+
+TEST_CASE(literal_runs_arrive_whole)
+{
+    TestSink sink;
+    const char* fmt = "hello, %s! you are %d years old.\n";
+    auto write = [&](const char* fmt, ...) {
+        va_list ap;
+        va_start(ap, fmt);
+        printf_to_sink(sink, fmt, ap);
+        va_end(ap);
+    };
+    write(fmt, "friend", 35);
+    EXPECT_EQ(sink.string(), "hello, friend! you are 35 years old.\n");
+    // Three literal runs and two conversions.
+    EXPECT_EQ(sink.put_count(), 5);
+}
+
+TEST_CASE(trailing_percent)
+{
+    EXPECT_EQ(format_with_sink("100%"), "100%");
+    EXPECT_EQ(format_with_sink("%%%d%%", 5), "%5%");
+}
+
+BENCHMARK_CASE(format_integers)
+{
+    for (int i = 0; i < 200000; ++i) {
+        auto string = format_with_sink("%d %u %x %s\n", i, (u32)i * 2654435761u, i, "text");
+        EXPECT(!string.is_empty());
+    }
+}
+
+TEST_MAIN(Printf)
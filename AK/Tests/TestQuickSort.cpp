@@ -0,0 +1,229 @@
+#include <AK/TestSuite.h>
+
+#include <AK/AKString.h>
+#include <AK/MergeSort.h>
+#include <AK/QuickSort.h>
+#include <AK/Vector.h>
+
+static u32 s_seed = 1;
+
+static u32 next_random()
+{
+    s_seed = s_seed * 1103515245 + 12345;
+    return s_seed >> 8;
+}
+
+static Vector<int> make_random(int size, int range)
+{
+    Vector<int> data;
+    data.ensure_capacity(size);
+    for (int i = 0; i < size; ++i)
+        data.append(next_random() % range);
+    return data;
+}
+
+static Vector<int> make_sorted(int size)
+{
+    Vector<int> data;
+    data.ensure_capacity(size);
+    for (int i = 0; i < size; ++i)
+        data.append(i);
+    return data;
+}
+
+static Vector<int> make_reversed(int size)
+{
+    Vector<int> data;
+    data.ensure_capacity(size);
+    for (int i = 0; i < size; ++i)
+        data.append(size - i);
+    return data;
+}
+
+static Vector<int> make_organ_pipe(int size)
+{
+    Vector<int> data;
+    data.ensure_capacity(size);
+    for (int i = 0; i < size; ++i)
+        data.append(i < size / 2 ? i : size - i);
+    return data;
+}
+
+static Vector<int> make_sawtooth(int size)
+{
+    Vector<int> data;
+    data.ensure_capacity(size);
+    for (int i = 0; i < size; ++i)
+        data.append(i % 37);
+    return data;
+}
+
+static bool is_sorted(const Vector<int>& data)
+{
+    for (int i = 1; i < data.size(); ++i) {
+        if (data[i] < data[i - 1])
+            return false;
+    }
+    return true;
+}
+
+static u64 checksum(const Vector<int>& data)
+{
+    u64 sum = 0;
+    for (auto value : data)
+        sum += (u64)value * value + value;
+    return sum;
+}
+
+template<typename Sort>
+static void check_all_patterns(Sort sort)
+{
+    int sizes[] = { 0, 1, 2, 3, 10, 23, 24, 25, 127, 128, 129, 1000, 10000 };
+    for (auto size : sizes) {
+        Vector<int> inputs[] = {
+            make_random(size, 1000000),
+            make_random(size, 2),
+            make_random(size, 1),
+            make_sorted(size),
+            make_reversed(size),
+            make_organ_pipe(size),
+            make_sawtooth(size),
+        };
+        for (auto& data : inputs) {
+            u64 before = checksum(data);
+            sort(data);
+            EXPECT(is_sorted(data));
+            EXPECT_EQ(checksum(data), before);
+        }
+    }
+}
+
+TEST_CASE(quick_sort_patterns)
+{
+    check_all_patterns([](Vector<int>& data) {
+        quick_sort(data.begin(), data.end(), [](int a, int b) { return a < b; });
+    });
+}
+
+TEST_CASE(merge_sort_patterns)
+{
+    check_all_patterns([](Vector<int>& data) {
+        merge_sort(data.begin(), data.end(), [](int a, int b) { return a < b; });
+    });
+}
+
+TEST_CASE(quick_sort_raw_pointers)
+{
+    int data[] = { 5, 3, 9, 1, 7 };
+    quick_sort(data, data + 5, [](int a, int b) { return a < b; });
+    for (int i = 0; i < 4; ++i)
+        EXPECT(data[i] < data[i + 1]);
+}
+
+TEST_CASE(quick_sort_strings)
+{
+    Vector<String> strings;
+    for (int i = 0; i < 500; ++i)
+        strings.append(String::format("%u", next_random() % 1000));
+    quick_sort(strings.begin(), strings.end(), [](auto& a, auto& b) { return a < b; });
+    for (int i = 1; i < strings.size(); ++i)
+        EXPECT(!(strings[i] < strings[i - 1]));
+}
+
+TEST_CASE(quick_sort_survives_median_of_3_killer)
+{
+    // This input drives a naive median-of-3 quicksort quadratic. We count comparisons
+    // to make sure we stay well within n log n.
+    int size = 1 << 14;
+    Vector<int> data;
+    data.resize(size);
+    int half = size / 2;
+    for (int i = 0; i < half; ++i) {
+        if (i % 2 == 0) {
+            data[i] = i + 1;
+            data[i + 1] = half + i + 1;
+        }
+        data[half + i] = (i + 1) * 2;
+    }
+    int comparisons = 0;
+    quick_sort(data.begin(), data.end(), [&](int a, int b) {
+        ++comparisons;
+        return a < b;
+    });
+    EXPECT(is_sorted(data));
+    EXPECT(comparisons < size * 14 * 4);
+}
+
+TEST_CASE(merge_sort_is_stable)
+{
+    struct Item {
+        int key;
+        int order;
+    };
+    Vector<Item> items;
+    for (int i = 0; i < 5000; ++i)
+        items.append({ (int)(next_random() % 50), i });
+    merge_sort(items.begin(), items.end(), [](auto& a, auto& b) { return a.key < b.key; });
+    for (int i = 1; i < items.size(); ++i) {
+        EXPECT(items[i - 1].key <= items[i].key);
+        if (items[i - 1].key == items[i].key)
+            EXPECT(items[i - 1].order < items[i].order);
+    }
+}
+
+static const int bench_size = 1000000;
+
+template<typename Sort>
+static void bench(Vector<int> (*make)(int), Sort sort)
+{
+    auto data = make(bench_size);
+    sort(data);
+    EXPECT(is_sorted(data));
+}
+
+static Vector<int> make_random_for_bench(int size)
+{
+    return make_random(size, 1 << 30);
+}
+
+static void quick_sort_ints(Vector<int>& data)
+{
+    quick_sort(data.begin(), data.end(), [](int a, int b) { return a < b; });
+}
+
+static void merge_sort_ints(Vector<int>& data)
+{
+    merge_sort(data.begin(), data.end(), [](int a, int b) { return a < b; });
+}
+
+BENCHMARK_CASE(quick_sort_random)
+{
+    bench(make_random_for_bench, quick_sort_ints);
+}
+
+BENCHMARK_CASE(quick_sort_sorted)
+{
+    bench(make_sorted, quick_sort_ints);
+}
+
+BENCHMARK_CASE(quick_sort_reversed)
+{
+    bench(make_reversed, quick_sort_ints);
+}
+
+BENCHMARK_CASE(merge_sort_random)
+{
+    bench(make_random_for_bench, merge_sort_ints);
+}
+
+BENCHMARK_CASE(merge_sort_sorted)
+{
+    bench(make_sorted, merge_sort_ints);
+}
+
+BENCHMARK_CASE(merge_sort_reversed)
+{
+    bench(make_reversed, merge_sort_ints);
+}
+
+TEST_MAIN(QuickSort)
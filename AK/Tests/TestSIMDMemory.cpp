@@ -0,0 +1,331 @@
+#include <AK/TestSuite.h>
+
+#include <AK/SIMDMemory.h>
+#include <AK/Vector.h>
+#include <string.h>
+
+using namespace AK::SIMD;
+
+static const CPUFeatures& features()
+{
+    static CPUFeatures features = detect_cpu_features();
+    return features;
+}
+
+static Vector<u8> make_data(size_t size, u32 seed)
+{
+    Vector<u8> data;
+    data.ensure_capacity(size);
+    for (size_t i = 0; i < size; ++i) {
+        seed = seed * 1103515245 + 12345;
+        // Keep zeroes out of the data so it can double as a string.
+        data.append((seed >> 16) | 1);
+    }
+    return data;
+}
+
+static int sign(int value)
+{
+    return value < 0 ? -1 : value > 0 ? 1 : 0;
+}
+
+typedef void* (*MemcpyFunction)(void*, const void*, size_t);
+typedef void* (*MemsetFunction)(void*, int, size_t);
+typedef int (*MemcmpFunction)(const void*, const void*, size_t);
+typedef size_t (*StrlenFunction)(const char*);
+typedef const void* (*MemchrFunction)(const void*, int, size_t);
+
+// Every size up to a few vectors, at (nearly) every alignment within a 64-byte line.
+static const size_t max_size = 300;
+
+static void check_memcpy(MemcpyFunction function)
+{
+    auto src = make_data(max_size + 64, 1);
+    Vector<u8> dest;
+    dest.resize(max_size + 64 + 16);
+    for (size_t dest_offset = 0; dest_offset < 64; dest_offset += 3) {
+        for (size_t src_offset = 0; src_offset < 64; src_offset += 5) {
+            for (size_t size = 0; size <= max_size; ++size) {
+                memset(dest.data(), 0, dest.size());
+                EXPECT_EQ(function(dest.data() + dest_offset, src.data() + src_offset, size), dest.data() + dest_offset);
+                EXPECT(!memcmp(dest.data() + dest_offset, src.data() + src_offset, size));
+                // Nothing around the destination may be touched.
+                for (size_t i = 0; i < dest_offset; ++i)
+                    EXPECT_EQ(dest[i], 0);
+                for (size_t i = dest_offset + size; i < (size_t)dest.size(); ++i)
+                    EXPECT_EQ(dest[i], 0);
+            }
+        }
+    }
+}
+
+static void check_memset(MemsetFunction function)
+{
+    Vector<u8> dest;
+    dest.resize(max_size + 64 + 16);
+    for (size_t offset = 0; offset < 64; ++offset) {
+        for (size_t size = 0; size <= max_size; ++size) {
+            memset(dest.data(), 0x11, dest.size());
+            EXPECT_EQ(function(dest.data() + offset, 0x1a5, size), dest.data() + offset);
+            for (size_t i = 0; i < (size_t)dest.size(); ++i)
+                EXPECT_EQ(dest[i], (i >= offset && i < offset + size) ? 0xa5 : 0x11);
+        }
+    }
+}
+
+static void check_memcmp(MemcmpFunction function)
+{
+    auto a = make_data(max_size + 64, 2);
+    auto b = a;
+    for (size_t offset = 0; offset < 64; offset += 7) {
+        for (size_t size = 0; size <= max_size; ++size) {
+            EXPECT_EQ(function(a.data() + offset, b.data() + offset, size), 0);
+            // Make each byte in turn differ, in both directions.
+            for (size_t i = 0; i < size; i += 1 + size / 16) {
+                u8 original = b[offset + i];
+                b[offset + i] = original ^ 0x80;
+                int expected = sign(memcmp(a.data() + offset, b.data() + offset, size));
+                EXPECT_EQ(sign(function(a.data() + offset, b.data() + offset, size)), expected);
+                EXPECT_EQ(sign(function(b.data() + offset, a.data() + offset, size)), -expected);
+                b[offset + i] = original;
+            }
+        }
+    }
+}
+
+static void check_strlen(StrlenFunction function)
+{
+    auto data = make_data(max_size + 64 + 1, 3);
+    for (size_t offset = 0; offset < 64; ++offset) {
+        for (size_t length = 0; length <= max_size; ++length) {
+            u8 saved = data[offset + length];
+            data[offset + length] = 0;
+            EXPECT_EQ(function((const char*)data.data() + offset), length);
+            data[offset + length] = saved;
+        }
+    }
+}
+
+static void check_memchr(MemchrFunction function)
+{
+    auto data = make_data(max_size + 64, 4);
+    // Put the byte we're looking for just past the end too, to catch overreads.
+    for (size_t offset = 0; offset < 64; offset += 3) {
+        for (size_t size = 0; size < max_size; ++size) {
+            data[offset + size] = 0;
+            for (size_t position = 0; position < size; position += 1 + size / 8) {
+                data[offset + position] = 0;
+                EXPECT_EQ(function(data.data() + offset, 0, size), data.data() + offset + position);
+                data[offset + position] = 1;
+            }
+            EXPECT_EQ(function(data.data() + offset, 0, size), nullptr);
+            data[offset + size] = 1;
+        }
+    }
+}
+
+TEST_CASE(memcpy_sse2)
+{
+    if (features().sse2)
+        check_memcpy(sse2_memcpy);
+}
+
+TEST_CASE(memcpy_avx2)
+{
+    if (features().avx2)
+        check_memcpy(avx2_memcpy);
+}
+
+TEST_CASE(memset_sse2)
+{
+    if (features().sse2)
+        check_memset(sse2_memset);
+}
+
+TEST_CASE(memset_avx2)
+{
+    if (features().avx2)
+        check_memset(avx2_memset);
+}
+
+TEST_CASE(memcmp_sse2)
+{
+    if (features().sse2)
+        check_memcmp(sse2_memcmp);
+}
+
+TEST_CASE(memcmp_avx2)
+{
+    if (features().avx2)
+        check_memcmp(avx2_memcmp);
+}
+
+TEST_CASE(strlen_sse2)
+{
+    if (features().sse2)
+        check_strlen(sse2_strlen);
+}
+
+TEST_CASE(strlen_avx2)
+{
+    if (features().avx2)
+        check_strlen(avx2_strlen);
+}
+
+TEST_CASE(memchr_sse2)
+{
+    if (features().sse2)
+        check_memchr(sse2_memchr);
+}
+
+TEST_CASE(memchr_avx2)
+{
+    if (features().avx2)
+        check_memchr(avx2_memchr);
+}
+
+// Throughput, in MB/s, of each implementation at a few sizes and alignments. The host
+// libc's versions are included as a point of reference.
+
+static void* host_memcpy(void* dest, const void* src, size_t n) { return memcpy(dest, src, n); }
+static void* host_memset(void* dest, int c, size_t n) { return memset(dest, c, n); }
+static int host_memcmp(const void* a, const void* b, size_t n) { return memcmp(a, b, n); }
+static size_t host_strlen(const char* str) { return strlen(str); }
+static const void* host_memchr(const void* ptr, int c, size_t n) { return memchr(ptr, c, n); }
+
+static const size_t bench_sizes[] = { 16, 64, 256, 4096, 65536, 1048576 };
+static const size_t bench_total = 256 * MB;
+
+template<typename Callback>
+static void report(const char* name, size_t size, size_t offset, Callback callback)
+{
+    size_t iterations = bench_total / size;
+    AK::TestElapsedTimer timer;
+    for (size_t i = 0; i < iterations; ++i)
+        callback();
+    auto elapsed = timer.elapsed();
+    u32 megabytes_per_second = elapsed ? (u32)((u64)bench_total * 1000 / MB / elapsed) : 0;
+    printf("%-12s %8zu bytes, offset %2zu: %6u MB/s\n", name, size, offset, megabytes_per_second);
+}
+
+static void bench_memcpy(const char* name, MemcpyFunction function)
+{
+    auto src = make_data(bench_sizes[5] + 64, 5);
+    auto dest = make_data(bench_sizes[5] + 64, 6);
+    for (auto size : bench_sizes) {
+        for (size_t offset : { 0, 7 }) {
+            report(name, size, offset, [&] {
+                function(dest.data() + offset, src.data(), size);
+                asm volatile("" ::: "memory");
+            });
+        }
+    }
+}
+
+static void bench_memset(const char* name, MemsetFunction function)
+{
+    auto dest = make_data(bench_sizes[5] + 64, 7);
+    for (auto size : bench_sizes) {
+        for (size_t offset : { 0, 7 }) {
+            report(name, size, offset, [&] {
+                function(dest.data() + offset, 0, size);
+                asm volatile("" ::: "memory");
+            });
+        }
+    }
+}
+
+static void bench_memcmp(const char* name, MemcmpFunction function)
+{
+    auto a = make_data(bench_sizes[5] + 64, 8);
+    auto b = a;
+    for (auto size : bench_sizes) {
+        for (size_t offset : { 0, 7 }) {
+            int result = 0;
+            report(name, size, offset, [&] {
+                result += function(a.data() + offset, b.data() + offset, size);
+                asm volatile("" ::: "memory");
+            });
+            EXPECT_EQ(result, 0);
+        }
+    }
+}
+
+static void bench_strlen(const char* name, StrlenFunction function)
+{
+    auto data = make_data(bench_sizes[5] + 64 + 1, 9);
+    for (auto size : bench_sizes) {
+        for (size_t offset : { 0, 7 }) {
+            data[offset + size] = 0;
+            size_t result = 0;
+            report(name, size, offset, [&] {
+                result += function((const char*)data.data() + offset);
+                asm volatile("" ::: "memory");
+            });
+            EXPECT_EQ(result, size * (bench_total / size));
+            data[offset + size] = 1;
+        }
+    }
+}
+
+static void bench_memchr(const char* name, MemchrFunction function)
+{
+    auto data = make_data(bench_sizes[5] + 64, 10);
+    for (auto size : bench_sizes) {
+        for (size_t offset : { 0, 7 }) {
+            const void* result = nullptr;
+            report(name, size, offset, [&] {
+                result = function(data.data() + offset, 0, size);
+                asm volatile("" ::: "memory");
+            });
+            EXPECT_EQ(result, nullptr);
+        }
+    }
+}
+
+BENCHMARK_CASE(memcpy_throughput)
+{
+    bench_memcpy("host memcpy", host_memcpy);
+    if (features().sse2)
+        bench_memcpy("sse2_memcpy", sse2_memcpy);
+    if (features().avx2)
+        bench_memcpy("avx2_memcpy", avx2_memcpy);
+}
+
+BENCHMARK_CASE(memset_throughput)
+{
+    bench_memset("host memset", host_memset);
+    if (features().sse2)
+        bench_memset("sse2_memset", sse2_memset);
+    if (features().avx2)
+        bench_memset("avx2_memset", avx2_memset);
+}
+
+BENCHMARK_CASE(memcmp_throughput)
+{
+    bench_memcmp("host memcmp", host_memcmp);
+    if (features().sse2)
+        bench_memcmp("sse2_memcmp", sse2_memcmp);
+    if (features().avx2)
+        bench_memcmp("avx2_memcmp", avx2_memcmp);
+}
+
+BENCHMARK_CASE(strlen_throughput)
+{
+    bench_strlen("host strlen", host_strlen);
+    if (features().sse2)
+        bench_strlen("sse2_strlen", sse2_strlen);
+    if (features().avx2)
+        bench_strlen("avx2_strlen", avx2_strlen);
+}
+
+BENCHMARK_CASE(memchr_throughput)
+{
+    bench_memchr("host memchr", host_memchr);
+    if (features().sse2)
+        bench_memchr("sse2_memchr", sse2_memchr);
+    if (features().avx2)
+        bench_memchr("avx2_memchr", avx2_memchr);
+}
+
+TEST_MAIN(SIMDMemory)
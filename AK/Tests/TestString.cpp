@@ -1,6 +1,32 @@
 #include <AK/TestSuite.h>
 
 #include <AK/AKString.h>
+#include <AK/FlyString.h>
+#include <AK/JsonArray.h>
+#include <AK/JsonObject.h>
+#include <AK/JsonValue.h>
+#include <AK/StringBuilder.h>
+
+#ifdef __GLIBC__
+// Count heap allocations, so we can check that the tricks below actually avoid them.
+static int s_allocation_count;
+
+extern "C" void* __libc_malloc(size_t);
+
+extern "C" void* malloc(size_t size) noexcept
+{
+    ++s_allocation_count;
+    return __libc_malloc(size);
+}
+
+template<typename Callback>
+static int count_allocations(Callback callback)
+{
+    int before = s_allocation_count;
+    callback();
+    return s_allocation_count - before;
+}
+#endif
 
 TEST_CASE(construct_empty)
 {
@@ -107,4 +133,139 @@ TEST_CASE(to_uppercase)
     EXPECT(String("AbC").to_uppercase() == "ABC");
 }
 
+TEST_CASE(single_characters_are_shared)
+{
+    EXPECT_EQ(String("x").impl(), String("x").impl());
+    EXPECT_EQ(String("xy", 1).impl(), String("x").impl());
+    EXPECT_EQ(String("x"), "x");
+    EXPECT_EQ(String("x").length(), 1);
+    EXPECT(String("x") != String("y"));
+    EXPECT_EQ(String("\n", Chomp), "");
+}
+
+TEST_CASE(fly_string_interns)
+{
+    FlyString a = "hello";
+    FlyString b = String("hello");
+    FlyString c = StringView("hello friends").substring_view(0, 5);
+    EXPECT(a == b);
+    EXPECT(a == c);
+    EXPECT_EQ(a.impl(), c.impl());
+    EXPECT(a == "hello");
+    EXPECT(a != "hell");
+    EXPECT(a != FlyString("friends"));
+    EXPECT_EQ(a.hash(), String("hello").impl()->hash());
+    EXPECT_EQ(a.to_string(), "hello");
+    EXPECT(FlyString().is_null());
+    EXPECT(FlyString("").is_empty());
+}
+
+TEST_CASE(fly_string_reuses_string_impl)
+{
+    String string = String::format("fly-%d", 1234);
+    FlyString fly = string;
+    EXPECT_EQ(fly.impl(), string.impl());
+    EXPECT_EQ(FlyString("fly-1234").impl(), string.impl());
+}
+
+TEST_CASE(fly_string_forgets_dead_strings)
+{
+    const StringImpl* first_impl;
+    {
+        FlyString fly = String::format("short-%s", "lived");
+        first_impl = fly.impl();
+        EXPECT(first_impl->is_fly());
+    }
+    // The old impl is gone, so this has to be a new one. (It may well get the same
+    // address, but it must not have been found in the table.)
+    FlyString again = String::format("short-%s", "lived");
+    EXPECT(again.impl()->is_fly());
+    EXPECT_EQ(again, "short-lived");
+}
+
+TEST_CASE(json_keys_are_interned)
+{
+    auto json = JsonValue::from_string("[{\"name\":\"a\",\"pid\":1},{\"name\":\"b\",\"pid\":2}]").as_array();
+    const StringImpl* name_impls[2] {};
+    for (int i = 0; i < 2; ++i) {
+        json.at(i).as_object().for_each_member([&](auto& key, auto&) {
+            if (key == "name")
+                name_impls[i] = key.impl();
+        });
+    }
+    EXPECT(name_impls[0] != nullptr);
+    EXPECT_EQ(name_impls[0], name_impls[1]);
+}
+
+TEST_CASE(string_builder_inline_buffer)
+{
+    StringBuilder builder;
+    for (int i = 0; i < StringBuilder::inline_capacity - 1; ++i)
+        builder.append('a' + i % 26);
+    builder.append("bcd");
+    for (int i = 0; i < 1000; ++i)
+        builder.appendf("%d,", i);
+    auto string = builder.to_string();
+    EXPECT_EQ(string.length(), StringBuilder::inline_capacity + 2 + 3890);
+    EXPECT_EQ(string[0], 'a');
+    EXPECT_EQ(string[StringBuilder::inline_capacity - 1], 'b');
+    EXPECT(string.ends_with("998,999,"));
+
+    builder.append("again");
+    EXPECT_EQ(builder.to_string(), "again");
+    builder.append("bytes");
+    auto buffer = builder.to_byte_buffer();
+    EXPECT_EQ(buffer.size(), 5);
+    EXPECT(!memcmp(buffer.pointer(), "bytes", 5));
+}
+
+#ifdef __GLIBC__
+TEST_CASE(allocation_counts)
+{
+    // A short string built with StringBuilder only allocates the String itself.
+    EXPECT_EQ(count_allocations([] {
+        StringBuilder builder;
+        builder.appendf("%s-%d", "item", 42);
+        builder.to_string();
+    }),
+        1);
+
+    // One-character strings don't allocate at all (once the shared one exists).
+    String comma = ",";
+    EXPECT_EQ(count_allocations([] { String(","); }), 0);
+
+    // Neither does looking up a string that's already interned.
+    FlyString interned = "interned";
+    EXPECT_EQ(count_allocations([] { FlyString(StringView("interned")); }), 0);
+}
+
+BENCHMARK_CASE(build_many_short_strings)
+{
+    int allocations = count_allocations([] {
+        for (int i = 0; i < 100000; ++i) {
+            StringBuilder builder;
+            builder.appendf("/proc/%d/fd/%d", i, i % 10);
+            builder.to_string();
+        }
+    });
+    // One per String, and none for the builders' buffers.
+    EXPECT_EQ(allocations, 100000);
+}
+
+BENCHMARK_CASE(intern_repeated_keys)
+{
+    static const char* keys[] = { "pid", "name", "state", "uid", "gid", "ppid", "nfds", "priority" };
+    Vector<FlyString> interned;
+    for (auto* key : keys)
+        interned.append(key);
+    int allocations = count_allocations([&] {
+        for (int i = 0; i < 1000000; ++i) {
+            FlyString key = StringView(keys[i % 8]);
+            EXPECT(key == interned[i % 8]);
+        }
+    });
+    EXPECT_EQ(allocations, 0);
+}
+#endif
+
 TEST_MAIN(String)
@@ -0,0 +1,69 @@
+#include <dlfcn.h>
+#include <stdio.h>
+#include <string.h>
+
+// Loads LinkLib.so (from /usr/lib, unless given another path) and calls into it, first
+// with lazy binding and then with everything bound up front. Exits non-zero if anything
+// didn't work.
+
+static int s_failures;
+
+static void check(bool ok, const char* what)
+{
+    printf("%s: %s\n", ok ? "PASS" : "FAIL", what);
+    if (!ok)
+        ++s_failures;
+}
+
+static void run(const char* path, int mode)
+{
+    printf("dlopen(%s, %s)\n", path, mode == RTLD_LAZY ? "RTLD_LAZY" : "RTLD_NOW");
+    void* handle = dlopen(path, mode);
+    if (!handle) {
+        check(false, dlerror());
+        return;
+    }
+
+    auto* constructor_ran = (int (*)())dlsym(handle, "constructor_ran");
+    auto* add_numbers = (int (*)(int, int))dlsym(handle, "add_numbers");
+    auto* add_and_double = (int (*)(int, int))dlsym(handle, "add_and_double");
+    auto* length_of = (int (*)(const char*))dlsym(handle, "length_of");
+    auto* global_lib_variable = (int*)dlsym(handle, "global_lib_variable");
+    check(constructor_ran && add_numbers && add_and_double && length_of && global_lib_variable, "dlsym() finds every symbol");
+    if (!constructor_ran || !add_numbers || !add_and_double || !length_of || !global_lib_variable) {
+        dlclose(handle);
+        return;
+    }
+
+    check(constructor_ran(), "the library's constructor ran");
+    check(add_numbers(2, 3) == 5, "calling a function");
+    // These two go through the library's PLT, which with RTLD_LAZY binds them right here.
+    check(add_and_double(2, 3) == 10, "calling a function in the library through its PLT");
+    check(length_of("friends") == (int)strlen("friends"), "calling a function in the program through the PLT");
+    check(add_and_double(4, 5) == 18, "calling through an already bound PLT entry");
+    check(*global_lib_variable == 1234, "reading a variable");
+
+    check(!dlsym(handle, "no_such_symbol"), "dlsym() fails for a missing symbol");
+    check(dlerror() != nullptr, "dlerror() explains why");
+    check(dlerror() == nullptr, "dlerror() is cleared once read");
+
+    void* second_handle = dlopen(path, mode);
+    check(second_handle == handle, "opening it again gives the same handle");
+    if (second_handle)
+        dlclose(second_handle);
+    dlclose(handle);
+}
+
+int main(int argc, char** argv)
+{
+    const char* path = argc > 1 ? argv[1] : "LinkLib.so";
+
+    run(path, RTLD_LAZY);
+    run(path, RTLD_NOW);
+
+    check(!dlopen("/usr/lib/NoSuchLib.so", RTLD_NOW), "dlopen() fails for a missing library");
+    check(dlerror() != nullptr, "dlerror() explains why");
+
+    printf("%s\n", s_failures ? "Some checks failed." : "All checks passed.");
+    return s_failures ? 1 : 0;
+}
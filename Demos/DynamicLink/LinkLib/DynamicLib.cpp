@@ -0,0 +1,37 @@
+#include <string.h>
+
+// A small shared library for LinkDemo to dlopen().
+
+static int s_constructor_ran;
+
+[[gnu::constructor]] static void initialize()
+{
+    s_constructor_ran = 1;
+}
+
+extern "C" {
+
+int global_lib_variable = 1234;
+
+int add_numbers(int a, int b)
+{
+    return a + b;
+}
+
+// add_numbers() could be interposed by another object, so this calls it through the PLT.
+int add_and_double(int a, int b)
+{
+    return add_numbers(a, b) * 2;
+}
+
+// strlen() isn't defined here, so this binds to the one in the program.
+int length_of(const char* string)
+{
+    return strlen(string);
+}
+
+int constructor_ran()
+{
+    return s_constructor_ran;
+}
+}
@@ -0,0 +1,433 @@
+#include <AK/Types.h>
+#include <Kernel/Arch/i386/APIC.h>
+#include <Kernel/Arch/i386/CPU.h>
+#include <Kernel/IO.h>
+#include <Kernel/SpinLock.h>
+#include <Kernel/StdLib.h>
+#include <Kernel/VM/MemoryManager.h>
+#include <Kernel/kmalloc.h>
+
+//#define APIC_DEBUG
+
+#define IA32_APIC_BASE_MSR 0x1b
+#define IA32_APIC_BASE_ENABLE (1 << 11)
+
+#define APIC_REG_ID 0x20
+#define APIC_REG_TPR 0x80
+#define APIC_REG_EOI 0xb0
+#define APIC_REG_SPURIOUS 0xf0
+#define APIC_REG_ERROR_STATUS 0x280
+#define APIC_REG_ICR_LOW 0x300
+#define APIC_REG_ICR_HIGH 0x310
+#define APIC_REG_LVT_LINT0 0x350
+#define APIC_REG_LVT_LINT1 0x360
+
+#define APIC_SOFTWARE_ENABLE 0x100
+#define APIC_SPURIOUS_VECTOR 0xff
+
+#define APIC_LVT_MASKED (1 << 16)
+#define APIC_LVT_DELIVERY_NMI (4 << 8)
+#define APIC_LVT_DELIVERY_EXTINT (7 << 8)
+
+#define APIC_ICR_DELIVERY_INIT (5 << 8)
+#define APIC_ICR_DELIVERY_STARTUP (6 << 8)
+#define APIC_ICR_DELIVERY_PENDING (1 << 12)
+#define APIC_ICR_LEVEL_ASSERT (1 << 14)
+
+// The real-mode startup code is copied here. It has to live below 1 MB on a page boundary,
+// and this page sits between the kernel's page tables and the kernel image.
+#define AP_TRAMPOLINE_ADDRESS 0x8000
+#define AP_STACK_SIZE 16384
+
+// The application processors start out in real mode at AP_TRAMPOLINE_ADDRESS. The code
+// below gets them into protected mode with paging on, using the kernel's page directory,
+// and then calls ap_entry() on the stack the bootstrap processor left for them.
+// Everything is addressed relative to the copy in low memory, not where we're linked.
+extern "C" u8 ap_trampoline_start[];
+extern "C" u8 ap_trampoline_cr3[];
+extern "C" u8 ap_trampoline_stack[];
+extern "C" u8 ap_trampoline_entry[];
+extern "C" u8 ap_trampoline_end[];
+extern "C" void ap_entry();
+
+asm(
+    ".globl ap_trampoline_start\n"
+    ".globl ap_trampoline_cr3\n"
+    ".globl ap_trampoline_stack\n"
+    ".globl ap_trampoline_entry\n"
+    ".globl ap_trampoline_end\n"
+    ".code16\n"
+    "ap_trampoline_start:\n"
+    "    cli\n"
+    "    xor %ax, %ax\n"
+    "    mov %ax, %ds\n"
+    "    lgdtl (ap_trampoline_gdtr - ap_trampoline_start + 0x8000)\n"
+    "    mov %cr0, %eax\n"
+    "    orl $1, %eax\n"
+    "    mov %eax, %cr0\n"
+    "    ljmpl $0x08, $(ap_trampoline_protected_mode - ap_trampoline_start + 0x8000)\n"
+    ".code32\n"
+    "ap_trampoline_protected_mode:\n"
+    "    mov $0x10, %ax\n"
+    "    mov %ax, %ds\n"
+    "    mov %ax, %es\n"
+    "    mov %ax, %fs\n"
+    "    mov %ax, %gs\n"
+    "    mov %ax, %ss\n"
+    "    mov (ap_trampoline_cr3 - ap_trampoline_start + 0x8000), %eax\n"
+    "    mov %eax, %cr3\n"
+    "    mov %cr0, %eax\n"
+    "    orl $0x80000000, %eax\n"
+    "    mov %eax, %cr0\n"
+    "    mov (ap_trampoline_stack - ap_trampoline_start + 0x8000), %esp\n"
+    "    mov (ap_trampoline_entry - ap_trampoline_start + 0x8000), %eax\n"
+    "    call *%eax\n"
+    "1:\n"
+    "    cli\n"
+    "    hlt\n"
+    "    jmp 1b\n"
+    ".align 8\n"
+    "ap_trampoline_gdt:\n"
+    "    .quad 0x0000000000000000\n"
+    "    .quad 0x00cf9a000000ffff\n"
+    "    .quad 0x00cf92000000ffff\n"
+    "ap_trampoline_gdtr:\n"
+    "    .word 23\n"
+    "    .long ap_trampoline_gdt - ap_trampoline_start + 0x8000\n"
+    "ap_trampoline_cr3:\n"
+    "    .long 0\n"
+    "ap_trampoline_stack:\n"
+    "    .long 0\n"
+    "ap_trampoline_entry:\n"
+    "    .long 0\n"
+    "ap_trampoline_end:\n");
+
+// Spurious interrupts don't get an EOI.
+extern "C" void apic_spurious_interrupt_entry();
+asm(
+    ".globl apic_spurious_interrupt_entry\n"
+    "apic_spurious_interrupt_entry:\n"
+    "    iret\n");
+
+// The MultiProcessor Specification, version 1.4. This is what tells us which local APIC
+// IDs belong to processors that we can start.
+struct [[gnu::packed]] MPFloatingPointer
+{
+    char signature[4];
+    u32 configuration_table;
+    u8 length;
+    u8 revision;
+    u8 checksum;
+    u8 default_configuration;
+    u8 features[4];
+};
+
+struct [[gnu::packed]] MPConfigurationTable
+{
+    char signature[4];
+    u16 length;
+    u8 revision;
+    u8 checksum;
+    char oem_id[8];
+    char product_id[12];
+    u32 oem_table;
+    u16 oem_table_size;
+    u16 entry_count;
+    u32 local_apic_address;
+    u16 extended_table_length;
+    u8 extended_table_checksum;
+    u8 reserved;
+};
+
+struct [[gnu::packed]] MPProcessorEntry
+{
+    u8 type;
+    u8 local_apic_id;
+    u8 local_apic_version;
+    u8 flags;
+    u32 signature;
+    u32 features;
+    u32 reserved[2];
+};
+
+#define MP_ENTRY_PROCESSOR 0
+#define MP_PROCESSOR_ENABLED 0x1
+#define MP_PROCESSOR_BOOTSTRAP 0x2
+
+static u32 s_apic_base;
+static bool s_enabled;
+static APIC::Processor s_processors[MAX_PROCESSORS];
+static unsigned s_processor_count;
+static unsigned s_online_processor_count;
+static SpinLock s_icr_lock;
+
+static u32 read_register(u32 offset)
+{
+    return *reinterpret_cast<volatile u32*>(s_apic_base + offset);
+}
+
+static void write_register(u32 offset, u32 value)
+{
+    *reinterpret_cast<volatile u32*>(s_apic_base + offset) = value;
+}
+
+static void delay_microseconds(u32 microseconds)
+{
+    // IO::delay() takes about 3 microseconds.
+    for (u32 i = 0; i < (microseconds + 2) / 3; ++i)
+        IO::delay();
+}
+
+static bool checksum_is_valid(const u8* data, size_t size)
+{
+    u8 sum = 0;
+    for (size_t i = 0; i < size; ++i)
+        sum += data[i];
+    return sum == 0;
+}
+
+static const MPFloatingPointer* find_floating_pointer_in(u32 start, u32 end)
+{
+    for (u32 address = start; address < end; address += 16) {
+        auto* pointer = reinterpret_cast<const MPFloatingPointer*>(address);
+        if (memcmp(pointer->signature, "_MP_", 4))
+            continue;
+        if (!checksum_is_valid(reinterpret_cast<const u8*>(pointer), pointer->length * 16))
+            continue;
+        return pointer;
+    }
+    return nullptr;
+}
+
+static const MPFloatingPointer* find_floating_pointer()
+{
+    // The spec also lists the first KB of the EBDA, but finding that means reading the
+    // BIOS data area in the null page, which we keep unmapped.
+    if (auto* pointer = find_floating_pointer_in(0x9fc00, 0xa0000))
+        return pointer;
+    return find_floating_pointer_in(0xf0000, 0x100000);
+}
+
+static void enumerate_processors()
+{
+    s_processor_count = 0;
+    auto* pointer = find_floating_pointer();
+    if (!pointer) {
+        kprintf("APIC: No MP floating pointer, assuming a single processor\n");
+        return;
+    }
+    // Everything below 5 MB is identity mapped, which is where firmware puts these tables.
+    if (pointer->default_configuration || !pointer->configuration_table || pointer->configuration_table >= 5 * MB) {
+        kprintf("APIC: No usable MP configuration table, assuming a single processor\n");
+        return;
+    }
+    auto* table = reinterpret_cast<const MPConfigurationTable*>(pointer->configuration_table);
+    if (memcmp(table->signature, "PCMP", 4) || !checksum_is_valid(reinterpret_cast<const u8*>(table), table->length)) {
+        kprintf("APIC: Invalid MP configuration table, assuming a single processor\n");
+        return;
+    }
+
+    auto* entry = reinterpret_cast<const u8*>(table + 1);
+    for (unsigned i = 0; i < table->entry_count; ++i) {
+        if (*entry != MP_ENTRY_PROCESSOR) {
+            // Everything that isn't a processor entry is 8 bytes.
+            entry += 8;
+            continue;
+        }
+        auto& processor_entry = *reinterpret_cast<const MPProcessorEntry*>(entry);
+        entry += sizeof(MPProcessorEntry);
+        if (!(processor_entry.flags & MP_PROCESSOR_ENABLED))
+            continue;
+        if (s_processor_count == MAX_PROCESSORS) {
+            kprintf("APIC: Ignoring processor with APIC ID %u, we only support %u\n", processor_entry.local_apic_id, MAX_PROCESSORS);
+            continue;
+        }
+        auto& processor = s_processors[s_processor_count++];
+        processor.apic_id = processor_entry.local_apic_id;
+        processor.is_bootstrap = processor_entry.flags & MP_PROCESSOR_BOOTSTRAP;
+#ifdef APIC_DEBUG
+        dbgprintf("APIC: MP table lists processor with APIC ID %u%s\n", processor.apic_id, processor.is_bootstrap ? " (bootstrap)" : "");
+#endif
+    }
+}
+
+static void enable_local_apic(bool is_bootstrap)
+{
+    u64 base = read_msr(IA32_APIC_BASE_MSR);
+    if (!(base & IA32_APIC_BASE_ENABLE))
+        write_msr(IA32_APIC_BASE_MSR, base | IA32_APIC_BASE_ENABLE);
+
+    write_register(APIC_REG_SPURIOUS, APIC_SOFTWARE_ENABLE | APIC_SPURIOUS_VECTOR);
+    write_register(APIC_REG_TPR, 0);
+
+    // The bootstrap processor stays in virtual wire mode, so the 8259s can keep delivering
+    // interrupts to it through LINT0. The others don't take external interrupts at all.
+    if (is_bootstrap)
+        write_register(APIC_REG_LVT_LINT0, APIC_LVT_DELIVERY_EXTINT);
+    else
+        write_register(APIC_REG_LVT_LINT0, APIC_LVT_MASKED);
+    write_register(APIC_REG_LVT_LINT1, APIC_LVT_DELIVERY_NMI);
+
+    // The error status register has to be written before it can be read.
+    write_register(APIC_REG_ERROR_STATUS, 0);
+    write_register(APIC_REG_ERROR_STATUS, 0);
+}
+
+static void wait_for_ipi_delivery()
+{
+    for (int i = 0; i < 1000; ++i) {
+        if (!(read_register(APIC_REG_ICR_LOW) & APIC_ICR_DELIVERY_PENDING))
+            return;
+        delay_microseconds(1);
+    }
+    kprintf("APIC: IPI delivery timed out\n");
+}
+
+static void send_ipi_command(u8 apic_id, u32 command)
+{
+    SpinLocker locker(s_icr_lock);
+    write_register(APIC_REG_ICR_HIGH, (u32)apic_id << 24);
+    write_register(APIC_REG_ICR_LOW, command);
+    wait_for_ipi_delivery();
+}
+
+extern "C" void ap_entry()
+{
+    flush_gdt();
+    flush_idt();
+    enable_local_apic(false);
+
+    u8 apic_id = APIC::id();
+    for (unsigned i = 0; i < s_processor_count; ++i) {
+        if (s_processors[i].apic_id == apic_id)
+            s_processors[i].is_online = true;
+    }
+    __atomic_add_fetch(&s_online_processor_count, 1, __ATOMIC_SEQ_CST);
+
+    // FIXME: Give application processors their own TSS and a scheduler to run.
+    for (;;)
+        asm volatile("cli; hlt");
+}
+
+namespace APIC {
+
+bool initialize()
+{
+    CPUID id(1);
+    if (!(id.edx() & (1 << 9))) {
+        kprintf("APIC: Not supported by this processor\n");
+        return false;
+    }
+
+    s_apic_base = read_msr(IA32_APIC_BASE_MSR) & 0xfffff000;
+    MM.map_for_kernel(VirtualAddress(s_apic_base), PhysicalAddress(s_apic_base));
+
+    enumerate_processors();
+    if (!s_processor_count) {
+        s_processors[0].apic_id = APIC::id();
+        s_processors[0].is_bootstrap = true;
+        s_processor_count = 1;
+    }
+
+    register_interrupt_handler(APIC_SPURIOUS_VECTOR, apic_spurious_interrupt_entry);
+    enable_local_apic(true);
+
+    u8 bootstrap_id = APIC::id();
+    for (unsigned i = 0; i < s_processor_count; ++i) {
+        if (s_processors[i].apic_id == bootstrap_id) {
+            s_processors[i].is_bootstrap = true;
+            s_processors[i].is_online = true;
+        } else {
+            s_processors[i].is_bootstrap = false;
+        }
+    }
+    s_online_processor_count = 1;
+    s_enabled = true;
+
+    kprintf("APIC: Local APIC @ %p, bootstrap processor has APIC ID %u, %u processor(s)\n", s_apic_base, bootstrap_id, s_processor_count);
+    return true;
+}
+
+bool is_enabled()
+{
+    return s_enabled;
+}
+
+void boot_application_processors()
+{
+    ASSERT(s_enabled);
+    ASSERT_INTERRUPTS_DISABLED();
+
+    size_t trampoline_size = ap_trampoline_end - ap_trampoline_start;
+    ASSERT(trampoline_size <= PAGE_SIZE);
+    auto* trampoline = reinterpret_cast<u8*>(AP_TRAMPOLINE_ADDRESS);
+    memcpy(trampoline, ap_trampoline_start, trampoline_size);
+
+    u32 cr3;
+    asm("movl %%cr3, %%eax"
+        : "=a"(cr3));
+    auto set_trampoline_variable = [&](u8* variable, u32 value) {
+        *reinterpret_cast<u32*>(trampoline + (variable - ap_trampoline_start)) = value;
+    };
+    set_trampoline_variable(ap_trampoline_cr3, cr3);
+    set_trampoline_variable(ap_trampoline_entry, (u32)&ap_entry);
+
+    for (unsigned i = 0; i < s_processor_count; ++i) {
+        auto& processor = s_processors[i];
+        if (processor.is_online)
+            continue;
+
+        // The processors come up one at a time, so they can't trample each other's stack.
+        u32 stack = (u32)kmalloc_eternal(AP_STACK_SIZE);
+        set_trampoline_variable(ap_trampoline_stack, (stack + AP_STACK_SIZE) & 0xfffffff0);
+
+        // INIT, then STARTUP twice, as described in the MultiProcessor Specification, B.4.
+        send_ipi_command(processor.apic_id, APIC_ICR_DELIVERY_INIT | APIC_ICR_LEVEL_ASSERT);
+        delay_microseconds(10000);
+        for (int attempt = 0; attempt < 2 && !processor.is_online; ++attempt) {
+            send_ipi_command(processor.apic_id, APIC_ICR_DELIVERY_STARTUP | (AP_TRAMPOLINE_ADDRESS >> 12));
+            delay_microseconds(200);
+        }
+        for (int i = 0; i < 1000 && !processor.is_online; ++i)
+            delay_microseconds(100);
+
+        if (processor.is_online)
+            kprintf("APIC: Processor with APIC ID %u is online\n", processor.apic_id);
+        else
+            kprintf("APIC: Processor with APIC ID %u didn't start\n", processor.apic_id);
+    }
+}
+
+u8 id()
+{
+    return read_register(APIC_REG_ID) >> 24;
+}
+
+void eoi()
+{
+    write_register(APIC_REG_EOI, 0);
+}
+
+void send_ipi(u8 apic_id, u8 vector)
+{
+    ASSERT(s_enabled);
+    send_ipi_command(apic_id, APIC_ICR_LEVEL_ASSERT | vector);
+}
+
+unsigned processor_count()
+{
+    return s_processor_count;
+}
+
+unsigned online_processor_count()
+{
+    return __atomic_load_n(&s_online_processor_count, __ATOMIC_SEQ_CST);
+}
+
+const Processor& processor(unsigned index)
+{
+    ASSERT(index < s_processor_count);
+    return s_processors[index];
+}
+
+}
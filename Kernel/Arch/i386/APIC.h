@@ -0,0 +1,32 @@
+#pragma once
+
+#include <AK/Types.h>
+
+#define MAX_PROCESSORS 16
+
+namespace APIC {
+
+struct Processor {
+    u8 apic_id { 0 };
+    bool is_bootstrap { false };
+    volatile bool is_online { false };
+};
+
+// Find the local APIC and the processors the firmware tells us about, and enable the
+// bootstrap processor's local APIC. Interrupts keep coming in through the 8259s.
+bool initialize();
+bool is_enabled();
+
+// Wake up the application processors. They switch to the kernel's page tables, turn on
+// their own local APIC and then park until there's something for them to do.
+void boot_application_processors();
+
+u8 id();
+void eoi();
+void send_ipi(u8 apic_id, u8 vector);
+
+unsigned processor_count();
+unsigned online_processor_count();
+const Processor& processor(unsigned index);
+
+}
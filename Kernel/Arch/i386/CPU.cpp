@@ -6,6 +6,7 @@
 #include <AK/Types.h>
 #include <Kernel/Arch/i386/CPU.h>
 #include <Kernel/KSyms.h>
+#include <Kernel/Trace.h>
 #include <Kernel/VM/MemoryManager.h>
 #include <LibC/mallocdefs.h>
 
@@ -261,6 +262,10 @@ void exception_14_handler(RegisterDumpWithExceptionCode& regs)
 
     auto response = MM.handle_page_fault(PageFault(regs.exception_code, VirtualAddress(fault_address)));
 
+    // Not until the fault has been handled: writing the record can itself fault
+    // (e.g. on the trace buffer), and we'd re-enter here with the first one unresolved.
+    Trace::event(TraceEventType::PageFault, fault_address, regs.exception_code, regs.eip);
+
     if (response == PageFaultResponse::ShouldCrash) {
         kprintf("\033[31;1m%s(%u:%u) Unrecoverable page fault, %s address %p\033[0m\n",
             current->process().name().characters(),
@@ -413,6 +413,27 @@ inline void read_tsc(u32& lsw, u32& msw)
                  : "=d"(msw), "=a"(lsw));
 }
 
+inline u64 read_tsc()
+{
+    u32 lsw, msw;
+    read_tsc(lsw, msw);
+    return ((u64)msw << 32) | lsw;
+}
+
+inline u64 read_msr(u32 msr)
+{
+    u32 low, high;
+    asm volatile("rdmsr"
+                 : "=a"(low), "=d"(high)
+                 : "c"(msr));
+    return ((u64)high << 32) | low;
+}
+
+inline void write_msr(u32 msr, u64 value)
+{
+    asm volatile("wrmsr" ::"a"((u32)value), "d"((u32)(value >> 32)), "c"(msr));
+}
+
 struct Stopwatch {
     union SplitQword {
         struct {
@@ -4,6 +4,7 @@
 #include <Kernel/IO.h>
 #include <Kernel/Process.h>
 #include <Kernel/StdLib.h>
+#include <Kernel/Trace.h>
 #include <Kernel/VM/MemoryManager.h>
 
 //#define DISK_DEBUG
@@ -101,9 +102,14 @@ const char* PATADiskDevice::class_name() const
 
 bool PATADiskDevice::read_blocks(unsigned index, u16 count, u8* out)
 {
+    Trace::event(TraceEventType::BlockSubmit, index, count, 0);
+    bool success;
     if (m_channel.m_bus_master_base && m_channel.m_dma_enabled.resource())
-        return read_sectors_with_dma(index, count, out);
-    return read_sectors(index, count, out);
+        success = read_sectors_with_dma(index, count, out);
+    else
+        success = read_sectors(index, count, out);
+    Trace::event(TraceEventType::BlockComplete, index, count, success);
+    return success;
 }
 
 bool PATADiskDevice::read_block(unsigned index, u8* out) const
@@ -113,13 +119,16 @@ bool PATADiskDevice::read_block(unsigned index, u8* out) const
 
 bool PATADiskDevice::write_blocks(unsigned index, u16 count, const u8* data)
 {
-    if (m_channel.m_bus_master_base && m_channel.m_dma_enabled.resource())
-        return write_sectors_with_dma(index, count, data);
-    for (unsigned i = 0; i < count; ++i) {
-        if (!write_sectors(index + i, 1, data + i * 512))
-            return false;
+    Trace::event(TraceEventType::BlockSubmit, index, count, 1);
+    bool success = true;
+    if (m_channel.m_bus_master_base && m_channel.m_dma_enabled.resource()) {
+        success = write_sectors_with_dma(index, count, data);
+    } else {
+        for (unsigned i = 0; i < count && success; ++i)
+            success = write_sectors(index + i, 1, data + i * 512);
     }
-    return true;
+    Trace::event(TraceEventType::BlockComplete, index, count, success);
+    return success;
 }
 
 bool PATADiskDevice::write_block(unsigned index, const u8* data)
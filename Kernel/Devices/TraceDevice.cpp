@@ -0,0 +1,110 @@
+#include <Kernel/Arch/i386/CPU.h>
+#include <Kernel/Devices/TraceDevice.h>
+#include <Kernel/Process.h>
+#include <Kernel/Trace.h>
+#include <Kernel/VM/MemoryManager.h>
+#include <LibC/errno_numbers.h>
+#include <LibC/sys/ioctl_numbers.h>
+
+// The records live in a ring that tracepoints append to and readers of /dev/trace consume
+// from. A tracepoint only ever moves the head and a reader only ever moves the tail, so
+// neither has to wait for the other. Tracepoints keep interrupts off while they write a
+// record so that one firing from an interrupt handler can't interleave with it. When the
+// ring is full, new records are dropped (and counted) rather than overwriting ones the
+// reader may be copying out.
+
+static const size_t trace_buffer_size = 1 * MB;
+
+bool Trace::g_enabled;
+
+static RefPtr<Region>* s_region;
+static TraceRecord* s_records;
+static u32 s_capacity;
+static u32 s_head;
+static u32 s_tail;
+static u32 s_dropped_count;
+
+void Trace::record(TraceEventType type, u32 arg0, u32 arg1, u32 arg2)
+{
+    InterruptDisabler disabler;
+    if (!s_records)
+        return;
+    u32 head = s_head;
+    if (head - __atomic_load_n(&s_tail, __ATOMIC_ACQUIRE) >= s_capacity) {
+        ++s_dropped_count;
+        return;
+    }
+    auto& record = s_records[head % s_capacity];
+    record.timestamp = read_tsc();
+    record.pid = current ? current->pid() : 0;
+    record.tid = current ? current->tid() : 0;
+    record.type = (u16)type;
+    // FIXME: Record which processor this happened on once more than one runs threads.
+    record.cpu = 0;
+    record.args[0] = arg0;
+    record.args[1] = arg1;
+    record.args[2] = arg2;
+    __atomic_store_n(&s_head, head + 1, __ATOMIC_RELEASE);
+}
+
+TraceDevice::TraceDevice()
+    : CharacterDevice(1, 20)
+{
+}
+
+TraceDevice::~TraceDevice()
+{
+}
+
+bool TraceDevice::can_read(FileDescription&) const
+{
+    return s_records && __atomic_load_n(&s_head, __ATOMIC_ACQUIRE) != s_tail;
+}
+
+ssize_t TraceDevice::read(FileDescription&, u8* buffer, ssize_t size)
+{
+    if (!s_records)
+        return 0;
+    u32 tail = s_tail;
+    u32 available = __atomic_load_n(&s_head, __ATOMIC_ACQUIRE) - tail;
+    u32 count = min(available, (u32)size / sizeof(TraceRecord));
+    for (u32 i = 0; i < count; ++i)
+        memcpy(buffer + i * sizeof(TraceRecord), &s_records[(tail + i) % s_capacity], sizeof(TraceRecord));
+    __atomic_store_n(&s_tail, tail + count, __ATOMIC_RELEASE);
+    return count * sizeof(TraceRecord);
+}
+
+ssize_t TraceDevice::write(FileDescription&, const u8*, ssize_t)
+{
+    return -EINVAL;
+}
+
+int TraceDevice::ioctl(FileDescription&, unsigned request, unsigned arg)
+{
+    switch (request) {
+    case TRACE_IOCTL_ENABLE:
+        if (!current->process().is_superuser())
+            return -EPERM;
+        if (!s_records) {
+            // Tracepoints can fire anywhere, so the buffer is committed up front.
+            s_region = new RefPtr<Region>(MM.allocate_kernel_region(trace_buffer_size, "Trace buffer"));
+            s_capacity = trace_buffer_size / sizeof(TraceRecord);
+            s_records = reinterpret_cast<TraceRecord*>((*s_region)->vaddr().as_ptr());
+        }
+        Trace::g_enabled = true;
+        return 0;
+    case TRACE_IOCTL_DISABLE:
+        if (!current->process().is_superuser())
+            return -EPERM;
+        Trace::g_enabled = false;
+        return 0;
+    case TRACE_IOCTL_GET_DROPPED_COUNT: {
+        auto* out = (u32*)arg;
+        if (!current->process().validate_write_typed(out))
+            return -EFAULT;
+        *out = s_dropped_count;
+        return 0;
+    }
+    }
+    return -EINVAL;
+}
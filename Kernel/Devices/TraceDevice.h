@@ -0,0 +1,21 @@
+#pragma once
+
+#include <Kernel/Devices/CharacterDevice.h>
+
+// /dev/trace hands out the records written by tracepoints, oldest first. Tracing is
+// switched on and off with the TRACE_IOCTL_ENABLE and TRACE_IOCTL_DISABLE ioctls.
+class TraceDevice final : public CharacterDevice {
+    AK_MAKE_ETERNAL
+public:
+    TraceDevice();
+    virtual ~TraceDevice() override;
+
+private:
+    // ^CharacterDevice
+    virtual ssize_t read(FileDescription&, u8*, ssize_t) override;
+    virtual ssize_t write(FileDescription&, const u8*, ssize_t) override;
+    virtual int ioctl(FileDescription&, unsigned request, unsigned arg) override;
+    virtual bool can_write(FileDescription&) const override { return false; }
+    virtual bool can_read(FileDescription&) const override;
+    virtual const char* class_name() const override { return "TraceDevice"; }
+};
@@ -0,0 +1,160 @@
+#include <Kernel/Arch/i386/CPU.h>
+#include <Kernel/FileSystem/EventPoll.h>
+#include <Kernel/FileSystem/FileDescription.h>
+#include <LibC/errno_numbers.h>
+
+NonnullRefPtr<EventPoll> EventPoll::create()
+{
+    return adopt(*new EventPoll);
+}
+
+EventPoll::EventPoll()
+{
+}
+
+EventPoll::~EventPoll()
+{
+}
+
+KResult EventPoll::add(int fd, FileDescription& description, const epoll_event& event)
+{
+    // Readiness of an EventPoll is computed by asking each of its interests,
+    // so nesting them (including a loop back to ourselves) would recurse without bound.
+    if (description.file().is_event_poll())
+        return KResult(-EINVAL);
+
+    InterruptDisabler disabler;
+    auto& interests = m_interests;
+    {
+        auto it = interests.find(fd);
+        if (it != interests.end()) {
+            // The old registration is only still in effect if the descriptor number
+            // refers to the same open description; otherwise it was closed and reused.
+            if (it->value.description.ptr() == &description)
+                return KResult(-EEXIST);
+            interests.remove(it);
+        }
+    }
+
+    Interest interest;
+    interest.description = description.make_weak_ptr();
+    interest.events = event.events;
+    interest.data = event.data;
+    interests.set(fd, interest);
+    return KSuccess;
+}
+
+KResult EventPoll::modify(int fd, FileDescription& description, const epoll_event& event)
+{
+    InterruptDisabler disabler;
+    auto& interests = m_interests;
+    auto it = interests.find(fd);
+    if (it == interests.end() || it->value.description.ptr() != &description)
+        return KResult(-ENOENT);
+    it->value.events = event.events;
+    it->value.data = event.data;
+    it->value.last_reported = 0;
+    return KSuccess;
+}
+
+KResult EventPoll::remove(int fd, FileDescription& description)
+{
+    InterruptDisabler disabler;
+    auto& interests = m_interests;
+    auto it = interests.find(fd);
+    if (it == interests.end() || it->value.description.ptr() != &description)
+        return KResult(-ENOENT);
+    interests.remove(it);
+    return KSuccess;
+}
+
+u32 EventPoll::ready_events_for(const Interest& interest)
+{
+    auto* description = interest.description.ptr();
+    if (!description)
+        return 0;
+    u32 ready = 0;
+    if ((interest.events & EPOLLIN) && description->can_read())
+        ready |= EPOLLIN;
+    if ((interest.events & EPOLLOUT) && description->can_write())
+        ready |= EPOLLOUT;
+    // Like on other systems, these are always reported, whether asked for or not.
+    if (description->is_hung_up())
+        ready |= EPOLLHUP;
+    if (description->has_pending_error())
+        ready |= EPOLLERR;
+    return ready;
+}
+
+bool EventPoll::should_report(const Interest& interest, u32 ready) const
+{
+    if (!ready)
+        return false;
+    if (!(interest.events & EPOLLET))
+        return true;
+    if (ready & ~interest.last_reported)
+        return true;
+    return interest.description->io_generation() != interest.reported_io_generation;
+}
+
+bool EventPoll::has_ready_events() const
+{
+    InterruptDisabler disabler;
+    for (auto& it : m_interests) {
+        if (should_report(it.value, ready_events_for(it.value)))
+            return true;
+    }
+    return false;
+}
+
+void EventPoll::collect_ready_events(Vector<epoll_event>& events, int max_events)
+{
+    InterruptDisabler disabler;
+    auto& interests = m_interests;
+    Vector<int> dead_fds;
+    for (auto& it : interests) {
+        auto& interest = it.value;
+        if (!interest.description) {
+            dead_fds.append(it.key);
+            continue;
+        }
+        if (events.size() == max_events)
+            continue;
+        u32 ready = ready_events_for(interest);
+        if (!should_report(interest, ready)) {
+            // Forget bits that went away, so that they count as new when they come back.
+            interest.last_reported &= ready;
+            continue;
+        }
+        interest.last_reported = ready;
+        interest.reported_io_generation = interest.description->io_generation();
+        events.append({ ready, interest.data });
+    }
+    for (int fd : dead_fds)
+        interests.remove(fd);
+}
+
+bool EventPoll::can_read(FileDescription&) const
+{
+    return has_ready_events();
+}
+
+bool EventPoll::can_write(FileDescription&) const
+{
+    return false;
+}
+
+ssize_t EventPoll::read(FileDescription&, u8*, ssize_t)
+{
+    return -EINVAL;
+}
+
+ssize_t EventPoll::write(FileDescription&, const u8*, ssize_t)
+{
+    return -EINVAL;
+}
+
+String EventPoll::absolute_path(const FileDescription&) const
+{
+    return "EventPoll";
+}
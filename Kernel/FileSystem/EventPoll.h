@@ -0,0 +1,58 @@
+#pragma once
+
+#include <AK/HashMap.h>
+#include <AK/Vector.h>
+#include <AK/WeakPtr.h>
+#include <Kernel/FileSystem/File.h>
+#include <Kernel/KResult.h>
+#include <Kernel/UnixTypes.h>
+
+// A persistent interest set, created by epoll_create().
+// Unlike select() and poll(), the set of watched descriptions lives in the kernel between
+// calls, so a waiter only ever looks at the descriptions it registered, and never has to
+// copy them in and out of userspace.
+class EventPoll final : public File {
+public:
+    static NonnullRefPtr<EventPoll> create();
+    virtual ~EventPoll() override;
+
+    KResult add(int fd, FileDescription&, const epoll_event&);
+    KResult modify(int fd, FileDescription&, const epoll_event&);
+    KResult remove(int fd, FileDescription&);
+
+    // Append up to `max_events` ready entries to `events`. This runs with interrupts
+    // disabled, so `events` is a kernel buffer that the caller copies out afterwards.
+    void collect_ready_events(Vector<epoll_event>& events, int max_events);
+    bool has_ready_events() const;
+
+    virtual bool is_event_poll() const override { return true; }
+    virtual bool can_read(FileDescription&) const override;
+    virtual bool can_write(FileDescription&) const override;
+    virtual ssize_t read(FileDescription&, u8*, ssize_t) override;
+    virtual ssize_t write(FileDescription&, const u8*, ssize_t) override;
+    virtual String absolute_path(const FileDescription&) const override;
+    virtual const char* class_name() const override { return "EventPoll"; };
+
+private:
+    EventPoll();
+
+    struct Interest {
+        WeakPtr<FileDescription> description;
+        u32 events { 0 };
+        epoll_data_t data;
+        // Edge-triggered bookkeeping: what we last reported, and the description's I/O
+        // generation at that time. A consumer that drained and refilled a description
+        // between two waits is told about it again even if the ready bits look the same.
+        u32 last_reported { 0 };
+        u32 reported_io_generation { 0 };
+    };
+
+    static u32 ready_events_for(const Interest&);
+    bool should_report(const Interest&, u32 ready) const;
+
+    // Keyed on the descriptor number the interest was registered with. Entries whose
+    // description has been closed everywhere are dropped lazily.
+    // This is guarded by disabling interrupts rather than by a Lock, since waiters
+    // check it from inside the scheduler.
+    HashMap<int, Interest> m_interests;
+};
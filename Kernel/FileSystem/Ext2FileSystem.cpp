@@ -480,18 +480,31 @@ RefPtr<Inode> Ext2FS::get_inode(InodeIdentifier inode) const
     return new_inode;
 }
 
-ssize_t Ext2FSInode::read_bytes(off_t offset, ssize_t count, u8* buffer, FileDescription*) const
+ssize_t Ext2FSInode::read_bytes(off_t offset, ssize_t count, u8* buffer, FileDescription* description) const
+{
+    iovec iov { buffer, (size_t)count };
+    return read_bytes_vectored(offset, &iov, 1, description);
+}
+
+ssize_t Ext2FSInode::read_bytes_vectored(off_t offset, const iovec* iov, int iov_count, FileDescription* description) const
 {
     Locker inode_locker(m_lock);
     ASSERT(offset >= 0);
-    if (m_raw_inode.i_size == 0)
+    if (m_raw_inode.i_size == 0 || offset >= (off_t)size())
         return 0;
 
+    size_t count = 0;
+    for (int i = 0; i < iov_count; ++i)
+        count += iov[i].iov_len;
+
     // Symbolic links shorter than 60 characters are store inline inside the i_block array.
     // This avoids wasting an entire block on short links. (Most links are short.)
     if (is_symlink() && size() < max_inline_symlink_length) {
+        // Nobody reads a link with more than one buffer, so don't bother scattering here.
+        if (iov_count != 1)
+            return Inode::read_bytes_vectored(offset, iov, iov_count, description);
         ssize_t nread = min((off_t)size() - offset, static_cast<off_t>(count));
-        memcpy(buffer, ((const u8*)m_raw_inode.i_block) + offset, (size_t)nread);
+        memcpy(iov[0].iov_base, ((const u8*)m_raw_inode.i_block) + offset, (size_t)nread);
         return nread;
     }
 
@@ -519,13 +532,15 @@ ssize_t Ext2FSInode::read_bytes(off_t offset, ssize_t count, u8* buffer, FileDes
 
     ssize_t nread = 0;
     int remaining_count = min((off_t)count, (off_t)size() - offset);
-    u8* out = buffer;
+    int iov_index = 0;
+    size_t offset_into_iov = 0;
 
 #ifdef EXT2_DEBUG
-    kprintf("Ext2FS: Reading up to %u bytes %d bytes into inode %u:%u to %p\n", count, offset, identifier().fsid(), identifier().index(), buffer);
-    //kprintf("ok let's do it, read(%u, %u) -> blocks %u thru %u, oifb: %u\n", offset, count, first_block_logical_index, last_block_logical_index, offset_into_first_block);
+    kprintf("Ext2FS: Reading up to %u bytes %d bytes into inode %u:%u to %d buffer(s)\n", count, offset, identifier().fsid(), identifier().index(), iov_count);
 #endif
 
+    // Walk the block list once, and scatter each block across however many of the
+    // caller's buffers it happens to span.
     for (int bi = first_block_logical_index; remaining_count && bi <= last_block_logical_index; ++bi) {
         auto block = fs().read_block(m_block_list[bi]);
         if (!block) {
@@ -535,10 +550,20 @@ ssize_t Ext2FSInode::read_bytes(off_t offset, ssize_t count, u8* buffer, FileDes
 
         int offset_into_block = (bi == first_block_logical_index) ? offset_into_first_block : 0;
         int num_bytes_to_copy = min(block_size - offset_into_block, remaining_count);
-        memcpy(out, block.pointer() + offset_into_block, num_bytes_to_copy);
+        const u8* in = block.pointer() + offset_into_block;
         remaining_count -= num_bytes_to_copy;
         nread += num_bytes_to_copy;
-        out += num_bytes_to_copy;
+        while (num_bytes_to_copy) {
+            while (offset_into_iov == iov[iov_index].iov_len) {
+                ++iov_index;
+                offset_into_iov = 0;
+            }
+            int chunk_size = min((size_t)num_bytes_to_copy, iov[iov_index].iov_len - offset_into_iov);
+            memcpy((u8*)iov[iov_index].iov_base + offset_into_iov, in, chunk_size);
+            offset_into_iov += chunk_size;
+            in += chunk_size;
+            num_bytes_to_copy -= chunk_size;
+        }
     }
 
     return nread;
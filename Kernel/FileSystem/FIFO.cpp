@@ -90,7 +90,18 @@ bool FIFO::can_read(FileDescription&) const
 
 bool FIFO::can_write(FileDescription&) const
 {
-    return m_buffer.bytes_in_write_buffer() < 4096 || !m_readers;
+    return m_buffer.space_available() > 0 || !m_readers;
+}
+
+bool FIFO::is_hung_up(FileDescription& description) const
+{
+    return description.fifo_direction() == Direction::Reader && !m_writers;
+}
+
+bool FIFO::has_pending_error(FileDescription& description) const
+{
+    // Writing now would raise SIGPIPE.
+    return description.fifo_direction() == Direction::Writer && !m_readers;
 }
 
 ssize_t FIFO::read(FileDescription&, u8* buffer, ssize_t size)
@@ -1,7 +1,7 @@
 #pragma once
 
-#include <Kernel/DoubleBuffer.h>
 #include <Kernel/FileSystem/File.h>
+#include <Kernel/RingBuffer.h>
 #include <Kernel/UnixTypes.h>
 
 class FileDescription;
@@ -32,6 +32,8 @@ private:
     virtual ssize_t read(FileDescription&, u8*, ssize_t) override;
     virtual bool can_read(FileDescription&) const override;
     virtual bool can_write(FileDescription&) const override;
+    virtual bool is_hung_up(FileDescription&) const override;
+    virtual bool has_pending_error(FileDescription&) const override;
     virtual String absolute_path(const FileDescription&) const override;
     virtual const char* class_name() const override { return "FIFO"; }
     virtual bool is_fifo() const override { return true; }
@@ -40,7 +42,7 @@ private:
 
     unsigned m_writers { 0 };
     unsigned m_readers { 0 };
-    DoubleBuffer m_buffer;
+    RingBuffer m_buffer { 16 * KB };
 
     uid_t m_uid { 0 };
 };
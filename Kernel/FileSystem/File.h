@@ -27,6 +27,12 @@ class Region;
 //   - Note that can_read() should return true in EOF conditions,
 //     and a subsequent call to read() should return 0.
 //
+// is_hung_up() and has_pending_error()
+//
+//   - Optional. Used by epoll to report EPOLLHUP and EPOLLERR.
+//   - is_hung_up() should return true once the other end (a peer socket, the other
+//     side of a FIFO) has gone away for good.
+//
 // ioctl()
 //
 //   - Optional. If unimplemented, ioctl() on this File will fail with -ENOTTY.
@@ -48,6 +54,8 @@ public:
 
     virtual bool can_read(FileDescription&) const = 0;
     virtual bool can_write(FileDescription&) const = 0;
+    virtual bool is_hung_up(FileDescription&) const { return false; }
+    virtual bool has_pending_error(FileDescription&) const { return false; }
 
     virtual ssize_t read(FileDescription&, u8*, ssize_t) = 0;
     virtual ssize_t write(FileDescription&, const u8*, ssize_t) = 0;
@@ -71,6 +79,7 @@ public:
     virtual bool is_block_device() const { return false; }
     virtual bool is_character_device() const { return false; }
     virtual bool is_socket() const { return false; }
+    virtual bool is_event_poll() const { return false; }
 
 protected:
     File();
@@ -100,6 +100,7 @@ off_t FileDescription::seek(off_t offset, int whence)
 ssize_t FileDescription::read(u8* buffer, ssize_t count)
 {
     int nread = m_file->read(*this, buffer, count);
+    ++m_io_generation;
     if (m_file->is_seekable())
         m_current_offset += nread;
     return nread;
@@ -108,11 +109,69 @@ ssize_t FileDescription::read(u8* buffer, ssize_t count)
 ssize_t FileDescription::write(const u8* data, ssize_t size)
 {
     int nwritten = m_file->write(*this, data, size);
+    ++m_io_generation;
     if (m_file->is_seekable())
         m_current_offset += nwritten;
     return nwritten;
 }
 
+ssize_t FileDescription::readv(const iovec* iov, int iov_count)
+{
+    if (m_file->is_inode()) {
+        ssize_t nread = m_inode->read_bytes_vectored(m_current_offset, iov, iov_count, this);
+        ++m_io_generation;
+        if (nread > 0)
+            m_current_offset += nread;
+        return nread;
+    }
+
+    ssize_t total_read = 0;
+    for (int i = 0; i < iov_count; ++i) {
+        ssize_t nread = read((u8*)iov[i].iov_base, iov[i].iov_len);
+        if (nread < 0) {
+            if (total_read == 0)
+                return nread;
+            break;
+        }
+        total_read += nread;
+        if ((size_t)nread < iov[i].iov_len)
+            break;
+    }
+    return total_read;
+}
+
+ssize_t FileDescription::preadv(off_t offset, const iovec* iov, int iov_count)
+{
+    if (!m_file->is_inode())
+        return -ESPIPE;
+    if (offset < 0)
+        return -EINVAL;
+    ++m_io_generation;
+    return m_inode->read_bytes_vectored(offset, iov, iov_count, this);
+}
+
+ssize_t FileDescription::pwritev(off_t offset, const iovec* iov, int iov_count)
+{
+    if (!m_file->is_inode())
+        return -ESPIPE;
+    if (offset < 0)
+        return -EINVAL;
+    ++m_io_generation;
+    ssize_t total_written = 0;
+    for (int i = 0; i < iov_count; ++i) {
+        ssize_t nwritten = m_inode->write_bytes(offset + total_written, iov[i].iov_len, (const u8*)iov[i].iov_base, this);
+        if (nwritten < 0) {
+            if (total_written == 0)
+                return nwritten;
+            break;
+        }
+        total_written += nwritten;
+        if ((size_t)nwritten < iov[i].iov_len)
+            break;
+    }
+    return total_written;
+}
+
 bool FileDescription::can_write() const
 {
     // FIXME: Remove this const_cast.
@@ -125,6 +184,18 @@ bool FileDescription::can_read() const
     return m_file->can_read(const_cast<FileDescription&>(*this));
 }
 
+bool FileDescription::is_hung_up() const
+{
+    // FIXME: Remove this const_cast.
+    return m_file->is_hung_up(const_cast<FileDescription&>(*this));
+}
+
+bool FileDescription::has_pending_error() const
+{
+    // FIXME: Remove this const_cast.
+    return m_file->has_pending_error(const_cast<FileDescription&>(*this));
+}
+
 ByteBuffer FileDescription::read_entire_file()
 {
     // HACK ALERT: (This entire function)
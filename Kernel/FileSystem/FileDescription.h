@@ -4,6 +4,7 @@
 #include <AK/ByteBuffer.h>
 #include <AK/CircularQueue.h>
 #include <AK/RefCounted.h>
+#include <AK/Weakable.h>
 #include <Kernel/FileSystem/FIFO.h>
 #include <Kernel/FileSystem/Inode.h>
 #include <Kernel/FileSystem/InodeMetadata.h>
@@ -20,7 +21,8 @@ class Region;
 class CharacterDevice;
 class SharedMemory;
 
-class FileDescription : public RefCounted<FileDescription> {
+class FileDescription : public RefCounted<FileDescription>
+    , public Weakable<FileDescription> {
 public:
     static NonnullRefPtr<FileDescription> create(Custody&);
     static NonnullRefPtr<FileDescription> create(File&);
@@ -31,12 +33,25 @@ public:
     off_t seek(off_t, int whence);
     ssize_t read(u8*, ssize_t);
     ssize_t write(const u8* data, ssize_t);
+    ssize_t readv(const iovec*, int iov_count);
+
+    // Positional I/O, for descriptions of inodes only. These neither use nor move the
+    // current offset, so threads sharing a description don't have to take turns seeking.
+    ssize_t preadv(off_t, const iovec*, int iov_count);
+    ssize_t pwritev(off_t, const iovec*, int iov_count);
+
     KResult fstat(stat&);
 
     KResult fchmod(mode_t);
 
     bool can_read() const;
     bool can_write() const;
+    bool is_hung_up() const;
+    bool has_pending_error() const;
+
+    // Bumped by every read() and write(), so that edge-triggered waiters can tell that
+    // the description was used even when its readiness looks unchanged.
+    u32 io_generation() const { return m_io_generation; }
 
     ssize_t get_dir_entries(u8* buffer, ssize_t);
 
@@ -113,6 +128,7 @@ private:
     Optional<KBuffer> m_generator_cache;
 
     u32 m_file_flags { 0 };
+    u32 m_io_generation { 0 };
 
     bool m_is_blocking { true };
     bool m_should_append { false };
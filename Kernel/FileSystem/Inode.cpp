@@ -3,6 +3,7 @@
 #include <Kernel/FileSystem/Inode.h>
 #include <Kernel/FileSystem/InodeWatcher.h>
 #include <Kernel/Net/LocalSocket.h>
+#include <Kernel/UnixTypes.h>
 #include <Kernel/VM/InodeVMObject.h>
 
 InlineLinkedList<Inode>& all_inodes()
@@ -54,6 +55,23 @@ ByteBuffer Inode::read_entire(FileDescription* descriptor) const
     return builder.to_byte_buffer();
 }
 
+ssize_t Inode::read_bytes_vectored(off_t offset, const iovec* iov, int iov_count, FileDescription* description) const
+{
+    ssize_t total_read = 0;
+    for (int i = 0; i < iov_count; ++i) {
+        ssize_t nread = read_bytes(offset + total_read, iov[i].iov_len, (u8*)iov[i].iov_base, description);
+        if (nread < 0) {
+            if (total_read == 0)
+                return nread;
+            break;
+        }
+        total_read += nread;
+        if ((size_t)nread < iov[i].iov_len)
+            break;
+    }
+    return total_read;
+}
+
 unsigned Inode::fsid() const
 {
     return m_fs.fsid();
@@ -13,6 +13,7 @@
 
 class FileDescription;
 class InodeVMObject;
+struct iovec;
 class InodeWatcher;
 class LocalSocket;
 
@@ -44,6 +45,9 @@ public:
     ByteBuffer read_entire(FileDescription* = nullptr) const;
 
     virtual ssize_t read_bytes(off_t, ssize_t, u8* buffer, FileDescription*) const = 0;
+    // Scatter a read starting at the given offset across several buffers. The default
+    // just calls read_bytes() once per buffer, until one of them comes up short.
+    virtual ssize_t read_bytes_vectored(off_t, const iovec*, int iov_count, FileDescription*) const;
     virtual bool traverse_as_directory(Function<bool(const FS::DirectoryEntry&)>) const = 0;
     virtual InodeIdentifier lookup(StringView name) = 0;
     virtual ssize_t write_bytes(off_t, ssize_t, const u8* data, FileDescription*) = 0;
@@ -3,6 +3,7 @@
 #include <Kernel/FileSystem/InodeFile.h>
 #include <Kernel/FileSystem/VirtualFileSystem.h>
 #include <Kernel/Process.h>
+#include <Kernel/VM/InodeVMObject.h>
 
 InodeFile::InodeFile(NonnullRefPtr<Inode>&& inode)
     : m_inode(move(inode))
@@ -25,10 +26,18 @@ ssize_t InodeFile::write(FileDescription& description, const u8* data, ssize_t c
 
 KResultOr<Region*> InodeFile::mmap(Process& process, FileDescription& description, VirtualAddress preferred_vaddr, size_t offset, size_t size, int prot)
 {
-    ASSERT(offset == 0);
     // FIXME: If PROT_EXEC, check that the underlying file system isn't mounted noexec.
     InterruptDisabler disabler;
-    auto* region = process.allocate_file_backed_region(preferred_vaddr, size, inode(), description.absolute_path(), prot);
+    // Mappings at an offset share the inode's VMObject too, so the dynamic loader can map
+    // each segment of a library separately and still share its pages with everyone else.
+    auto vmo = InodeVMObject::create_with_inode(inode());
+    if (offset) {
+        // Written so that neither side can overflow.
+        size_t vmo_size = PAGE_ROUND_UP(vmo->size());
+        if (offset > vmo_size || size > vmo_size - offset || PAGE_ROUND_UP(size) > vmo_size - offset)
+            return KResult(-EINVAL);
+    }
+    auto* region = process.allocate_region_with_vmo(preferred_vaddr, size, move(vmo), offset, description.absolute_path(), prot);
     if (!region)
         return KResult(-ENOMEM);
     return region;
@@ -2,10 +2,12 @@
 #include "Console.h"
 #include "KSyms.h"
 #include "Process.h"
+#include "ProfileBuffer.h"
 #include "Scheduler.h"
 #include "StdLib.h"
 #include <AK/JsonArray.h>
 #include <AK/JsonObject.h>
+#include <AK/JsonObjectSerializer.h>
 #include <AK/JsonValue.h>
 #include <Kernel/Arch/i386/CPU.h>
 #include <Kernel/FileSystem/Custody.h>
@@ -16,6 +18,7 @@
 #include <Kernel/KParams.h>
 #include <Kernel/Net/LocalSocket.h>
 #include <Kernel/Net/NetworkAdapter.h>
+#include <Kernel/Net/Routing.h>
 #include <Kernel/Net/TCPSocket.h>
 #include <Kernel/Net/UDPSocket.h>
 #include <Kernel/PCI.h>
@@ -61,6 +64,8 @@ enum ProcFileType {
     FI_Root_net_tcp,
     FI_Root_net_udp,
     FI_Root_net_local,
+    FI_Root_net_route,
+    FI_Root_net_arp,
 
     FI_PID,
 
@@ -69,6 +74,8 @@ enum ProcFileType {
     FI_PID_vmo,
     FI_PID_stack,
     FI_PID_regs,
+    FI_PID_profile,
+    FI_PID_syscalls,
     FI_PID_fds,
     FI_PID_exe, // symlink
     FI_PID_cwd, // symlink
@@ -318,12 +325,42 @@ Optional<KBuffer> procfs$net_adapters(InodeIdentifier)
         obj.set("bytes_in", adapter.bytes_in());
         obj.set("packets_out", adapter.packets_out());
         obj.set("bytes_out", adapter.bytes_out());
+        obj.set("packets_dropped", adapter.packets_dropped());
         obj.set("link_up", adapter.link_up());
         json.append(obj);
     });
     return json.serialized<KBufferBuilder>();
 }
 
+Optional<KBuffer> procfs$net_route(InodeIdentifier)
+{
+    JsonArray json;
+    for_each_route([&json](auto& route) {
+        JsonObject obj;
+        obj.set("destination", route.destination.to_string());
+        obj.set("prefix_length", route.prefix_length);
+        obj.set("gateway", route.gateway.to_string());
+        obj.set("adapter", route.adapter->name());
+        json.append(obj);
+    });
+    return json.serialized<KBufferBuilder>();
+}
+
+Optional<KBuffer> procfs$net_arp(InodeIdentifier)
+{
+    JsonArray json;
+    for_each_arp_entry([&json](auto& ipv4_address, auto& entry) {
+        JsonObject obj;
+        obj.set("ipv4_address", ipv4_address.to_string());
+        obj.set("mac_address", entry.mac_address.to_string());
+        obj.set("state", entry.state == ARPTableEntry::State::Reachable ? "reachable" : "incomplete");
+        obj.set("adapter", entry.adapter ? entry.adapter->name() : String());
+        obj.set("pending_frames", entry.pending_frames.size());
+        json.append(obj);
+    });
+    return json.serialized<KBufferBuilder>();
+}
+
 Optional<KBuffer> procfs$net_tcp(InodeIdentifier)
 {
     JsonArray json;
@@ -437,6 +474,65 @@ Optional<KBuffer> procfs$pid_regs(InodeIdentifier identifier)
     return builder.build();
 }
 
+Optional<KBuffer> procfs$pid_profile(InodeIdentifier identifier)
+{
+    auto handle = ProcessInspectionHandle::from_pid(to_pid(identifier));
+    if (!handle)
+        return {};
+    auto& process = handle->process();
+    auto* profile = process.profile_buffer();
+    if (!profile)
+        return {};
+
+    // This is almost entirely numbers, so write it out directly instead of building
+    // thousands of JsonObjects in the kmalloc heap.
+    KBufferBuilder builder(2 * MB);
+    profile->set_paused(true);
+    builder.appendf("{\"pid\":%d,\"profiling\":%s,\"lost_samples\":%u,\"samples\":[",
+        process.pid(), process.is_profiling() ? "true" : "false", profile->lost_sample_count());
+    bool first = true;
+    profile->for_each_sample([&](auto& sample) {
+        if (!first)
+            builder.append(',');
+        first = false;
+        builder.appendf("{\"tid\":%d,\"timestamp\":%u,\"frames\":[", sample.tid, sample.timestamp);
+        for (u32 i = 0; i < sample.frame_count; ++i)
+            builder.appendf(i ? ",%u" : "%u", sample.frames[i]);
+        builder.append("]}");
+    });
+    builder.append("]}");
+    profile->set_paused(false);
+    return builder.build();
+}
+
+Optional<KBuffer> procfs$pid_syscalls(InodeIdentifier identifier)
+{
+    auto handle = ProcessInspectionHandle::from_pid(to_pid(identifier));
+    if (!handle)
+        return {};
+    auto& process = handle->process();
+
+    // The cycle counts don't fit in a JsonValue, so this is written out by hand too.
+    KBufferBuilder builder(64 * KB);
+    builder.append('[');
+    bool first = true;
+    for (int function = 0; function < Syscall::function_count; ++function) {
+        auto* statistics = process.syscall_statistics(function);
+        if (!statistics)
+            continue;
+        if (!first)
+            builder.append(',');
+        first = false;
+        builder.appendf("{\"name\":\"%s\",\"calls\":%u,\"total_cycles\":%Q,\"max_cycles\":%Q,\"histogram_first_bucket_log2\":%d,\"histogram\":[",
+            Syscall::to_string((Syscall::Function)function), statistics->call_count, statistics->total_cycles, statistics->max_cycles, SyscallStatistics::histogram_first_bucket_log2);
+        for (int i = 0; i < SyscallStatistics::histogram_bucket_count; ++i)
+            builder.appendf(i ? ",%u" : "%u", statistics->histogram[i]);
+        builder.append("]}");
+    }
+    builder.append(']');
+    return builder.build();
+}
+
 Optional<KBuffer> procfs$pid_exe(InodeIdentifier identifier)
 {
     auto handle = ProcessInspectionHandle::from_pid(to_pid(identifier));
@@ -621,36 +717,37 @@ Optional<KBuffer> procfs$all(InodeIdentifier)
 {
     InterruptDisabler disabler;
     auto processes = Process::all_processes();
-    JsonArray array;
+    KBufferBuilder builder;
+    JsonArraySerializer array { builder };
 
     // Keep this in sync with CProcessStatistics.
     auto build_process = [&](const Process& process) {
-        JsonObject process_object;
-        process_object.set("pid", process.pid());
-        process_object.set("times_scheduled", process.main_thread().times_scheduled());
-        process_object.set("pgid", process.tty() ? process.tty()->pgid() : 0);
-        process_object.set("pgp", process.pgid());
-        process_object.set("sid", process.sid());
-        process_object.set("uid", process.uid());
-        process_object.set("gid", process.gid());
-        process_object.set("state", process.main_thread().state_string());
-        process_object.set("ppid", process.ppid());
-        process_object.set("nfds", process.number_of_open_file_descriptors());
-        process_object.set("name", process.name());
-        process_object.set("tty", process.tty() ? process.tty()->tty_name() : "notty");
-        process_object.set("amount_virtual", process.amount_virtual());
-        process_object.set("amount_resident", process.amount_resident());
-        process_object.set("amount_shared", process.amount_shared());
-        process_object.set("ticks", process.main_thread().ticks());
-        process_object.set("priority", to_string(process.priority()));
-        process_object.set("syscall_count", process.syscall_count());
-        process_object.set("icon_id", process.icon_id());
-        array.append(process_object);
+        auto process_object = array.add_object();
+        process_object.add("pid", process.pid());
+        process_object.add("times_scheduled", process.main_thread().times_scheduled());
+        process_object.add("pgid", process.tty() ? process.tty()->pgid() : 0);
+        process_object.add("pgp", process.pgid());
+        process_object.add("sid", process.sid());
+        process_object.add("uid", process.uid());
+        process_object.add("gid", process.gid());
+        process_object.add("state", process.main_thread().state_string());
+        process_object.add("ppid", process.ppid());
+        process_object.add("nfds", process.number_of_open_file_descriptors());
+        process_object.add("name", process.name());
+        process_object.add("tty", process.tty() ? process.tty()->tty_name() : "notty");
+        process_object.add("amount_virtual", process.amount_virtual());
+        process_object.add("amount_resident", process.amount_resident());
+        process_object.add("amount_shared", process.amount_shared());
+        process_object.add("ticks", process.main_thread().ticks());
+        process_object.add("priority", to_string(process.priority()));
+        process_object.add("syscall_count", process.syscall_count());
+        process_object.add("icon_id", process.icon_id());
     };
     build_process(*Scheduler::colonel());
     for (auto* process : processes)
         build_process(*process);
-    return array.serialized<KBufferBuilder>();
+    array.finish();
+    return builder.build();
 }
 
 Optional<KBuffer> procfs$inodes(InodeIdentifier)
@@ -1009,6 +1106,8 @@ bool ProcFSInode::traverse_as_directory(Function<bool(const FS::DirectoryEntry&)
         callback({ "tcp", 3, to_identifier(fsid(), PDI_Root_net, 0, FI_Root_net_tcp), 0 });
         callback({ "udp", 3, to_identifier(fsid(), PDI_Root_net, 0, FI_Root_net_udp), 0 });
         callback({ "local", 5, to_identifier(fsid(), PDI_Root_net, 0, FI_Root_net_local), 0 });
+        callback({ "route", 5, to_identifier(fsid(), PDI_Root_net, 0, FI_Root_net_route), 0 });
+        callback({ "arp", 3, to_identifier(fsid(), PDI_Root_net, 0, FI_Root_net_arp), 0 });
         break;
 
     case FI_PID: {
@@ -1099,6 +1198,10 @@ InodeIdentifier ProcFSInode::lookup(StringView name)
             return to_identifier(fsid(), PDI_Root, 0, FI_Root_net_udp);
         if (name == "local")
             return to_identifier(fsid(), PDI_Root, 0, FI_Root_net_local);
+        if (name == "route")
+            return to_identifier(fsid(), PDI_Root, 0, FI_Root_net_route);
+        if (name == "arp")
+            return to_identifier(fsid(), PDI_Root, 0, FI_Root_net_arp);
         return {};
     }
 
@@ -1231,11 +1334,15 @@ ProcFS::ProcFS()
     m_entries[FI_Root_net_tcp] = { "tcp", FI_Root_net_tcp, procfs$net_tcp };
     m_entries[FI_Root_net_udp] = { "udp", FI_Root_net_udp, procfs$net_udp };
     m_entries[FI_Root_net_local] = { "local", FI_Root_net_local, procfs$net_local };
+    m_entries[FI_Root_net_route] = { "route", FI_Root_net_route, procfs$net_route };
+    m_entries[FI_Root_net_arp] = { "arp", FI_Root_net_arp, procfs$net_arp };
 
     m_entries[FI_PID_vm] = { "vm", FI_PID_vm, procfs$pid_vm };
     m_entries[FI_PID_vmo] = { "vmo", FI_PID_vmo, procfs$pid_vmo };
     m_entries[FI_PID_stack] = { "stack", FI_PID_stack, procfs$pid_stack };
     m_entries[FI_PID_regs] = { "regs", FI_PID_regs, procfs$pid_regs };
+    m_entries[FI_PID_profile] = { "profile", FI_PID_profile, procfs$pid_profile };
+    m_entries[FI_PID_syscalls] = { "syscalls", FI_PID_syscalls, procfs$pid_syscalls };
     m_entries[FI_PID_fds] = { "fds", FI_PID_fds, procfs$pid_fds };
     m_entries[FI_PID_exe] = { "exe", FI_PID_exe, procfs$pid_exe };
     m_entries[FI_PID_cwd] = { "cwd", FI_PID_cwd, procfs$pid_cwd };
@@ -0,0 +1,92 @@
+#include <Kernel/Arch/i386/CPU.h>
+#include <Kernel/FutexTable.h>
+#include <Kernel/Process.h>
+
+typedef IntrusiveList<Thread::FutexBlocker, &Thread::FutexBlocker::m_futex_list_node> FutexQueue;
+
+static const int futex_bucket_count = 64;
+
+static FutexQueue* s_buckets;
+
+static FutexQueue& bucket_for(const Process& process, VirtualAddress address)
+{
+    if (!s_buckets)
+        s_buckets = new FutexQueue[futex_bucket_count];
+    u32 hash = (address.get() >> 2) ^ ((u32)&process >> 4);
+    hash ^= hash >> 16;
+    return s_buckets[hash % futex_bucket_count];
+}
+
+static bool is_waiting_on(Thread::FutexBlocker& blocker, const Process& process, VirtualAddress address)
+{
+    return &blocker.thread().process() == &process && blocker.address() == address;
+}
+
+void FutexTable::enqueue(Thread::FutexBlocker& blocker)
+{
+    InterruptDisabler disabler;
+    bucket_for(blocker.thread().process(), blocker.address()).append(blocker);
+}
+
+void FutexTable::dequeue(Thread::FutexBlocker& blocker)
+{
+    InterruptDisabler disabler;
+    if (blocker.m_futex_list_node.is_in_list())
+        blocker.m_futex_list_node.remove();
+}
+
+int FutexTable::wake(Process& process, VirtualAddress address, int count)
+{
+    InterruptDisabler disabler;
+    auto& queue = bucket_for(process, address);
+    int woken = 0;
+    for (auto it = queue.begin(); it != queue.end() && woken < count;) {
+        auto& blocker = *it;
+        if (!is_waiting_on(blocker, process, address)) {
+            ++it;
+            continue;
+        }
+        it.erase();
+        blocker.wake();
+        ++woken;
+    }
+    return woken;
+}
+
+int FutexTable::requeue(Process& process, VirtualAddress address, int wake_count, VirtualAddress new_address, int requeue_count)
+{
+    InterruptDisabler disabler;
+    int woken = wake(process, address, wake_count);
+    if (address == new_address)
+        return woken;
+    auto& queue = bucket_for(process, address);
+    auto& new_queue = bucket_for(process, new_address);
+    int requeued = 0;
+    for (auto it = queue.begin(); it != queue.end() && requeued < requeue_count;) {
+        auto& blocker = *it;
+        if (!is_waiting_on(blocker, process, address)) {
+            ++it;
+            continue;
+        }
+        it.erase();
+        blocker.set_address(new_address);
+        new_queue.append(blocker);
+        ++requeued;
+    }
+    return woken;
+}
+
+void FutexTable::forget_thread(Thread& thread)
+{
+    InterruptDisabler disabler;
+    if (!s_buckets)
+        return;
+    for (int i = 0; i < futex_bucket_count; ++i) {
+        for (auto it = s_buckets[i].begin(); it != s_buckets[i].end();) {
+            if (&it->thread() == &thread)
+                it.erase();
+            else
+                ++it;
+        }
+    }
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <Kernel/Thread.h>
+#include <Kernel/VM/VirtualAddress.h>
+
+class Process;
+
+// Threads parked in futex(FUTEX_WAIT), hashed on the (process, address) they wait on.
+// A waiter's FutexBlocker lives on its own kernel stack and is linked in here for as long
+// as it is blocked. The table is guarded by disabling interrupts rather than by a Lock,
+// since the finalizer has to unlink threads that died while waiting.
+class FutexTable {
+public:
+    static void enqueue(Thread::FutexBlocker&);
+    static void dequeue(Thread::FutexBlocker&);
+
+    // Wake up to `count` threads waiting on `address`, and return how many were woken.
+    static int wake(Process&, VirtualAddress address, int count);
+
+    // Wake up to `wake_count` threads waiting on `address`, then move up to `requeue_count`
+    // of the remaining waiters over to `new_address` without waking them.
+    static int requeue(Process&, VirtualAddress address, int wake_count, VirtualAddress new_address, int requeue_count);
+
+    static void forget_thread(Thread&);
+};
@@ -16,8 +16,8 @@ KBuffer KBufferBuilder::build()
     return m_buffer;
 }
 
-KBufferBuilder::KBufferBuilder()
-    : m_buffer(KBuffer::create_with_size(1048576))
+KBufferBuilder::KBufferBuilder(size_t capacity)
+    : m_buffer(KBuffer::create_with_size(capacity))
 {
 }
 
@@ -37,7 +37,7 @@ void KBufferBuilder::append(const char* characters, int length)
         return;
     if (!can_append(length))
         return;
-    memcpy(insertion_ptr() + m_size, characters, length);
+    memcpy(insertion_ptr(), characters, length);
     m_size += length;
 }
 
@@ -51,10 +51,8 @@ void KBufferBuilder::append(char ch)
 
 void KBufferBuilder::appendvf(const char* fmt, va_list ap)
 {
-    printf_internal([this](char*&, char ch) {
-        append(ch);
-    },
-        nullptr, fmt, ap);
+    BuilderSink<KBufferBuilder> sink(*this);
+    printf_to_sink(sink, fmt, ap);
 }
 
 void KBufferBuilder::appendf(const char* fmt, ...)
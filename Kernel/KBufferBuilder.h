@@ -8,7 +8,7 @@ class KBufferBuilder {
 public:
     using OutputType = KBuffer;
 
-    explicit KBufferBuilder();
+    explicit KBufferBuilder(size_t capacity = 1048576);
     ~KBufferBuilder() {}
 
     void append(const StringView&);
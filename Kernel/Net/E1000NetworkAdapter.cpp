@@ -1,5 +1,7 @@
 #include <Kernel/IO.h>
 #include <Kernel/Net/E1000NetworkAdapter.h>
+#include <Kernel/Net/EtherType.h>
+#include <Kernel/Net/EthernetFrameHeader.h>
 #include <Kernel/PCI.h>
 
 #define REG_CTRL 0x0000
@@ -24,6 +26,7 @@
 #define REG_RADV 0x282C             // RX Int. Absolute Delay Timer
 #define REG_RSRPD 0x2C00            // RX Small Packet Detect Interrupt
 #define REG_TIPG 0x0410             // Transmit Inter Packet Gap
+#define REG_RXCSUM 0x5000           // RX Checksum Control
 #define ECTRL_SLU 0x40              //set link up
 #define RCTL_EN (1 << 1)            // Receiver Enable
 #define RCTL_SBP (1 << 2)           // Store Bad Packets
@@ -47,6 +50,18 @@
 #define RCTL_PMCF (1 << 23)         // Pass MAC Control Frames
 #define RCTL_SECRC (1 << 26)        // Strip Ethernet CRC
 
+// RXCSUM Register
+
+#define RXCSUM_IPOFLD (1 << 8) // IP Checksum Offload Enable
+#define RXCSUM_TUOFLD (1 << 9) // TCP/UDP Checksum Offload Enable
+
+// Receive Status and Errors
+
+#define RSTA_DD (1 << 0)   // Descriptor Done
+#define RSTA_IXSM (1 << 2) // Ignore Checksum Indication
+#define RERR_TCPE (1 << 5) // TCP/UDP Checksum Error
+#define RERR_IPE (1 << 6)  // IP Checksum Error
+
 // Buffer Sizes
 #define RCTL_BSIZE_256 (3 << 16)
 #define RCTL_BSIZE_512 (2 << 16)
@@ -64,8 +79,18 @@
 #define CMD_RS (1 << 3)   // Report Status
 #define CMD_RPS (1 << 4)  // Report Packet Sent
 #define CMD_VLE (1 << 6)  // VLAN Packet Enable
+#define CMD_DEXT (1 << 5) // Descriptor Extension
 #define CMD_IDE (1 << 7)  // Interrupt Delay Enable
 
+// Extended Transmit Descriptors
+
+#define DTYP_CONTEXT (0 << 4)
+#define DTYP_DATA (1 << 4)
+#define TUCMD_TCP (1 << 0) // TCP (as opposed to UDP) checksum
+#define TUCMD_IP (1 << 1)  // IPv4 (as opposed to IPv6)
+#define POPTS_IXSM (1 << 0) // Insert IP Checksum
+#define POPTS_TXSM (1 << 1) // Insert TCP/UDP Checksum
+
 // TCTL Register
 
 #define TCTL_EN (1 << 1)      // Transmit Enable
@@ -149,6 +174,9 @@ E1000NetworkAdapter::E1000NetworkAdapter(PCI::Address pci_address, u8 irq)
     initialize_rx_descriptors();
     initialize_tx_descriptors();
 
+    out32(REG_RXCSUM, in32(REG_RXCSUM) | RXCSUM_IPOFLD | RXCSUM_TUOFLD);
+    set_checksum_offload(IPv4ChecksumOffload | TCPChecksumOffload | UDPChecksumOffload);
+
     out32(REG_IMASK, 0x1f6dc);
     out32(REG_IMASK, 0xff & ~4);
     in32(0xc0);
@@ -262,7 +290,8 @@ void E1000NetworkAdapter::initialize_tx_descriptors()
     m_tx_descriptors = (e1000_tx_desc*)ptr;
     for (int i = 0; i < number_of_tx_descriptors; ++i) {
         auto& descriptor = m_tx_descriptors[i];
-        descriptor.addr = (u64)kmalloc_eternal(8192 + 16);
+        m_tx_buffers[i] = (u8*)kmalloc_eternal(8192 + 16);
+        descriptor.addr = (u64)m_tx_buffers[i];
         descriptor.cmd = 0;
     }
 
@@ -327,18 +356,70 @@ u32 E1000NetworkAdapter::in32(u16 address)
     return IO::in32(m_io_base + address);
 }
 
+u8 E1000NetworkAdapter::prepare_checksum_offload(const u8* data, int length, u32& tx_current)
+{
+    if (length < (int)(sizeof(EthernetFrameHeader) + sizeof(IPv4Packet)))
+        return 0;
+    auto& eth = *(const EthernetFrameHeader*)data;
+    if (eth.ether_type() != EtherType::IPv4)
+        return 0;
+    auto& ipv4 = *(const IPv4Packet*)eth.payload();
+    u8 ip_header_length = ipv4.internet_header_length() * 4;
+    u8 protocol = ipv4.protocol();
+
+    u8 popts = POPTS_IXSM;
+    if (protocol == (u8)IPv4Protocol::TCP || protocol == (u8)IPv4Protocol::UDP)
+        popts |= POPTS_TXSM;
+
+    // The context sticks until it's replaced, so we only need a new one when the
+    // layout of the packets changes, which is almost never.
+    if (ip_header_length == m_tx_context_ip_header_length && ((popts & POPTS_TXSM) == 0 || protocol == m_tx_context_protocol))
+        return popts;
+
+    u8 ip_start = sizeof(EthernetFrameHeader);
+    u8 transport_start = ip_start + ip_header_length;
+    auto& context = *(e1000_tx_context_desc*)&m_tx_descriptors[tx_current];
+    context.ipcss = ip_start;
+    context.ipcso = ip_start + 10;
+    context.ipcse = transport_start - 1;
+    context.tucss = transport_start;
+    context.tucso = transport_start + (protocol == (u8)IPv4Protocol::TCP ? 16 : 6);
+    context.tucse = 0;
+    context.paylen = 0;
+    context.paylen_high_and_dtyp = DTYP_CONTEXT;
+    context.tucmd = CMD_DEXT | TUCMD_IP | (protocol == (u8)IPv4Protocol::TCP ? TUCMD_TCP : 0);
+    context.status = 0;
+    context.hdrlen = 0;
+    context.mss = 0;
+    tx_current = (tx_current + 1) % number_of_tx_descriptors;
+
+    m_tx_context_ip_header_length = ip_header_length;
+    m_tx_context_protocol = protocol;
+    return popts;
+}
+
 void E1000NetworkAdapter::send_raw(const u8* data, int length)
 {
     u32 tx_current = in32(REG_TXDESCTAIL);
 #ifdef E1000_DEBUG
     kprintf("E1000: Sending packet (%d bytes)\n", length);
 #endif
+    u8 popts = prepare_checksum_offload(data, length, tx_current);
     auto& descriptor = m_tx_descriptors[tx_current];
     ASSERT(length <= 8192);
-    memcpy((void*)descriptor.addr, data, length);
+    descriptor.addr = (u64)m_tx_buffers[tx_current];
+    memcpy(m_tx_buffers[tx_current], data, length);
     descriptor.length = length;
     descriptor.status = 0;
-    descriptor.cmd = CMD_EOP | CMD_IFCS | CMD_RS;
+    if (popts) {
+        descriptor.cso = DTYP_DATA;
+        descriptor.cmd = CMD_EOP | CMD_IFCS | CMD_RS | CMD_DEXT;
+        descriptor.css = popts;
+    } else {
+        descriptor.cso = 0;
+        descriptor.cmd = CMD_EOP | CMD_IFCS | CMD_RS;
+        descriptor.css = 0;
+    }
 #ifdef E1000_DEBUG
     kprintf("E1000: Using tx descriptor %d (head is at %d)\n", tx_current, in32(REG_TXDESCHEAD));
 #endif
@@ -363,10 +444,18 @@ void E1000NetworkAdapter::receive()
             break;
         auto* buffer = (u8*)m_rx_descriptors[rx_current].addr;
         u16 length = m_rx_descriptors[rx_current].length;
+        u8 status = m_rx_descriptors[rx_current].status;
+        u8 errors = m_rx_descriptors[rx_current].errors;
 #ifdef E1000_DEBUG
         kprintf("E1000: Received 1 packet @ %p (%u) bytes!\n", buffer, length);
 #endif
-        did_receive(buffer, length);
+        if (!(status & RSTA_IXSM) && (errors & (RERR_IPE | RERR_TCPE))) {
+#ifdef E1000_DEBUG
+            kprintf("E1000: Dropping packet with bad checksum (errors=%b)\n", errors);
+#endif
+        } else {
+            did_receive(buffer, length);
+        }
         m_rx_descriptors[rx_current].status = 0;
         out32(REG_RXDESCTAIL, rx_current);
     }
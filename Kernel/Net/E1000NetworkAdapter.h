@@ -44,6 +44,24 @@ private:
         volatile uint16_t special { 0 };
     };
 
+    // Occupies a transmit descriptor slot and tells the hardware where the IP and
+    // TCP/UDP checksums live in the data descriptors that follow it.
+    struct [[gnu::packed]] e1000_tx_context_desc
+    {
+        volatile uint8_t ipcss { 0 };
+        volatile uint8_t ipcso { 0 };
+        volatile uint16_t ipcse { 0 };
+        volatile uint8_t tucss { 0 };
+        volatile uint8_t tucso { 0 };
+        volatile uint16_t tucse { 0 };
+        volatile uint16_t paylen { 0 };
+        volatile uint8_t paylen_high_and_dtyp { 0 };
+        volatile uint8_t tucmd { 0 };
+        volatile uint8_t status { 0 };
+        volatile uint8_t hdrlen { 0 };
+        volatile uint16_t mss { 0 };
+    };
+
     void detect_eeprom();
     u32 read_eeprom(u8 address);
     void read_mac_address();
@@ -53,6 +71,7 @@ private:
 
     void initialize_rx_descriptors();
     void initialize_tx_descriptors();
+    u8 prepare_checksum_offload(const u8*, int, u32& tx_current);
 
     void out8(u16 address, u8);
     void out16(u16 address, u16);
@@ -75,4 +94,10 @@ private:
 
     e1000_rx_desc* m_rx_descriptors;
     e1000_tx_desc* m_tx_descriptors;
+    // Context descriptors take up ring slots too, so the buffers can't live in the descriptors.
+    u8* m_tx_buffers[number_of_tx_descriptors];
+
+    // The offsets the hardware's checksum context was last loaded with.
+    u8 m_tx_context_ip_header_length { 0 };
+    u8 m_tx_context_protocol { 0 };
 };
@@ -3,6 +3,7 @@
 #include <AK/AKString.h>
 #include <AK/Assertions.h>
 #include <AK/IPv4Address.h>
+#include <AK/InternetChecksum.h>
 #include <AK/NetworkOrdered.h>
 #include <AK/Types.h>
 
@@ -12,8 +13,6 @@ enum class IPv4Protocol : u16 {
     UDP = 17,
 };
 
-NetworkOrdered<u16> internet_checksum(const void*, size_t);
-
 class [[gnu::packed]] IPv4Packet
 {
 public:
@@ -70,17 +69,20 @@ private:
 
 static_assert(sizeof(IPv4Packet) == 20);
 
-inline NetworkOrdered<u16> internet_checksum(const void* ptr, size_t count)
+// Start a checksum with the pseudo-header that TCP and UDP cover along with their own data.
+inline InternetChecksum checksum_with_ipv4_pseudo_header(const IPv4Address& source, const IPv4Address& destination, IPv4Protocol protocol, u16 length)
 {
-    u32 checksum = 0;
-    auto* w = (const u16*)ptr;
-    while (count > 1) {
-        checksum += convert_between_host_and_network(*w++);
-        if (checksum & 0x80000000)
-            checksum = (checksum & 0xffff) | (checksum >> 16);
-        count -= 2;
-    }
-    while (checksum >> 16)
-        checksum = (checksum & 0xffff) + (checksum >> 16);
-    return ~checksum & 0xffff;
+    struct [[gnu::packed]] PseudoHeader
+    {
+        IPv4Address source;
+        IPv4Address destination;
+        u8 zero;
+        u8 protocol;
+        NetworkOrdered<u16> length;
+    };
+
+    PseudoHeader pseudo_header { source, destination, 0, (u8)protocol, length };
+    InternetChecksum checksum;
+    checksum.add(&pseudo_header, sizeof(pseudo_header));
+    return checksum;
 }
@@ -13,6 +13,7 @@
 #include <Kernel/Process.h>
 #include <Kernel/UnixTypes.h>
 #include <LibC/errno_numbers.h>
+#include <LibC/sys/ioctl_numbers.h>
 
 //#define IPV4_SOCKET_DEBUG
 
@@ -141,6 +142,11 @@ bool IPv4Socket::can_write(FileDescription&) const
     return is_connected();
 }
 
+bool IPv4Socket::is_hung_up(FileDescription&) const
+{
+    return m_role != Role::Listener && protocol_is_disconnected();
+}
+
 int IPv4Socket::allocate_local_port_if_needed()
 {
     if (m_local_port)
@@ -169,9 +175,10 @@ ssize_t IPv4Socket::sendto(FileDescription&, const void* data, size_t data_lengt
         m_peer_port = ntohs(ia.sin_port);
     }
 
-    auto adapter = adapter_for_route_to(m_peer_address);
-    if (!adapter)
+    auto routing_decision = route_to(m_peer_address);
+    if (!routing_decision.is_valid())
         return -EHOSTUNREACH;
+    auto& adapter = routing_decision.adapter;
 
     if (m_local_address.to_u32() == 0)
         m_local_address = adapter->ipv4_address();
@@ -183,7 +190,7 @@ ssize_t IPv4Socket::sendto(FileDescription&, const void* data, size_t data_lengt
     kprintf("sendto: destination=%s:%u\n", m_peer_address.to_string().characters(), m_peer_port);
 
     if (type() == SOCK_RAW) {
-        adapter->send_ipv4(MACAddress(), m_peer_address, (IPv4Protocol)protocol(), (const u8*)data, data_length);
+        adapter->send_ipv4_via(routing_decision.next_hop, m_peer_address, (IPv4Protocol)protocol(), (const u8*)data, data_length);
         return data_length;
     }
 
@@ -301,3 +308,65 @@ String IPv4Socket::absolute_path(const FileDescription&) const
 
     return builder.to_string();
 }
+
+static Optional<u8> netmask_to_prefix_length(const IPv4Address& netmask)
+{
+    u8 prefix_length = 0;
+    bool seen_zero = false;
+    for (int i = 0; i < 32; ++i) {
+        bool bit = (netmask[i / 8] >> (7 - (i % 8))) & 1;
+        if (bit && seen_zero)
+            return {};
+        if (bit)
+            ++prefix_length;
+        else
+            seen_zero = true;
+    }
+    return prefix_length;
+}
+
+int IPv4Socket::ioctl(FileDescription&, unsigned request, unsigned arg)
+{
+    auto& process = current->process();
+    switch (request) {
+    case SIOCADDRT:
+    case SIOCDELRT: {
+        if (!process.is_superuser())
+            return -EPERM;
+        auto* route = reinterpret_cast<const rtentry*>(arg);
+        if (!process.validate_read_typed(route))
+            return -EFAULT;
+        if (route->rt_dst.sin_family != AF_INET || route->rt_genmask.sin_family != AF_INET)
+            return -EAFNOSUPPORT;
+
+        IPv4Address destination((const u8*)&route->rt_dst.sin_addr.s_addr);
+        auto prefix_length = netmask_to_prefix_length(IPv4Address((const u8*)&route->rt_genmask.sin_addr.s_addr));
+        if (!prefix_length.has_value())
+            return -EINVAL;
+
+        if (request == SIOCDELRT)
+            return remove_route(destination, prefix_length.value());
+
+        IPv4Address gateway;
+        if (route->rt_flags & RTF_GATEWAY) {
+            if (route->rt_gateway.sin_family != AF_INET)
+                return -EAFNOSUPPORT;
+            gateway = IPv4Address((const u8*)&route->rt_gateway.sin_addr.s_addr);
+        }
+
+        WeakPtr<NetworkAdapter> adapter;
+        if (route->rt_dev) {
+            if (!process.validate_read_str(route->rt_dev))
+                return -EFAULT;
+            adapter = NetworkAdapter::lookup_by_name(route->rt_dev);
+        } else if (route->rt_flags & RTF_GATEWAY) {
+            // Send through whichever adapter already reaches the gateway.
+            adapter = adapter_for_route_to(gateway);
+        }
+        if (!adapter)
+            return -ENODEV;
+        return add_route(destination, prefix_length.value(), gateway, *adapter);
+    }
+    }
+    return -ENOTTY;
+}
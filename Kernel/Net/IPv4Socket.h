@@ -29,8 +29,10 @@ public:
     virtual void detach(FileDescription&) override;
     virtual bool can_read(FileDescription&) const override;
     virtual bool can_write(FileDescription&) const override;
+    virtual bool is_hung_up(FileDescription&) const override;
     virtual ssize_t sendto(FileDescription&, const void*, size_t, int, const sockaddr*, socklen_t) override;
     virtual ssize_t recvfrom(FileDescription&, void*, size_t, int flags, sockaddr*, socklen_t*) override;
+    virtual int ioctl(FileDescription&, unsigned request, unsigned arg) override;
 
     void did_receive(const IPv4Address& peer_address, u16 peer_port, KBuffer&&);
 
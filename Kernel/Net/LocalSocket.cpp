@@ -211,50 +211,101 @@ bool LocalSocket::can_write(FileDescription& description) const
 {
     auto role = this->role(description);
     if (role == Role::Accepted)
-        return !has_attached_peer(description) || m_for_client.bytes_in_write_buffer() < 16384;
+        return !has_attached_peer(description) || m_for_client.space_available() > 0;
     if (role == Role::Connected)
-        return !has_attached_peer(description) || m_for_server.bytes_in_write_buffer() < 16384;
+        return !has_attached_peer(description) || m_for_server.space_available() > 0;
     ASSERT_NOT_REACHED();
 }
 
-ssize_t LocalSocket::sendto(FileDescription& description, const void* data, size_t data_size, int, const sockaddr*, socklen_t)
+bool LocalSocket::is_hung_up(FileDescription& description) const
+{
+    auto role = this->role(description);
+    if (role != Role::Accepted && role != Role::Connected)
+        return false;
+    return !has_attached_peer(description);
+}
+
+RingBuffer& LocalSocket::send_buffer_for(FileDescription& description)
 {
-    if (!has_attached_peer(description))
-        return -EPIPE;
     auto role = this->role(description);
     if (role == Role::Accepted)
-        return m_for_client.write((const u8*)data, data_size);
+        return m_for_client;
     if (role == Role::Connected)
-        return m_for_server.write((const u8*)data, data_size);
+        return m_for_server;
     ASSERT_NOT_REACHED();
 }
 
-ssize_t LocalSocket::recvfrom(FileDescription& description, void* buffer, size_t buffer_size, int, sockaddr*, socklen_t*)
+RingBuffer& LocalSocket::receive_buffer_for(FileDescription& description)
 {
     auto role = this->role(description);
-    if (role == Role::Accepted) {
-        if (!description.is_blocking()) {
-            if (m_for_server.is_empty()) {
-                if (!has_attached_peer(description))
-                    return 0;
-                return -EAGAIN;
-            }
+    if (role == Role::Accepted)
+        return m_for_server;
+    if (role == Role::Connected)
+        return m_for_client;
+    ASSERT_NOT_REACHED();
+}
+
+ssize_t LocalSocket::sendto(FileDescription& description, const void* data, size_t data_size, int, const sockaddr*, socklen_t)
+{
+    iovec iov { const_cast<void*>(data), data_size };
+    return writev(description, &iov, 1);
+}
+
+ssize_t LocalSocket::writev(FileDescription& description, const iovec* iov, int iov_count)
+{
+    if (!has_attached_peer(description))
+        return -EPIPE;
+    auto& buffer = send_buffer_for(description);
+
+    size_t total_size = 0;
+    for (int i = 0; i < iov_count; ++i)
+        total_size += iov[i].iov_len;
+
+    // Wait until everything fits, unless it never will; then we stream it through
+    // piece by piece instead.
+    size_t needed_space = min(total_size, buffer.capacity());
+    while (buffer.space_available() < needed_space) {
+        if (!description.is_blocking())
+            return -EAGAIN;
+        if (current->block<Thread::WriteBlocker>(description) == Thread::BlockResult::InterruptedBySignal)
+            return -EINTR;
+        if (!has_attached_peer(description))
+            return -EPIPE;
+    }
+
+    size_t nwritten = 0;
+    for (int i = 0; i < iov_count; ++i) {
+        auto* data = (const u8*)iov[i].iov_base;
+        size_t offset = 0;
+        while (offset < iov[i].iov_len) {
+            ssize_t rc = buffer.write(data + offset, iov[i].iov_len - offset);
+            offset += rc;
+            nwritten += rc;
+            if (offset == iov[i].iov_len)
+                break;
+            if (!description.is_blocking())
+                return nwritten;
+            if (current->block<Thread::WriteBlocker>(description) == Thread::BlockResult::InterruptedBySignal)
+                return nwritten;
+            if (!has_attached_peer(description))
+                return nwritten;
         }
-        ASSERT(!m_for_server.is_empty());
-        return m_for_server.read((u8*)buffer, buffer_size);
     }
-    if (role == Role::Connected) {
-        if (!description.is_blocking()) {
-            if (m_for_client.is_empty()) {
-                if (!has_attached_peer(description))
-                    return 0;
-                return -EAGAIN;
-            }
+    return nwritten;
+}
+
+ssize_t LocalSocket::recvfrom(FileDescription& description, void* buffer, size_t buffer_size, int, sockaddr*, socklen_t*)
+{
+    auto& receive_buffer = receive_buffer_for(description);
+    if (!description.is_blocking()) {
+        if (receive_buffer.is_empty()) {
+            if (!has_attached_peer(description))
+                return 0;
+            return -EAGAIN;
         }
-        ASSERT(!m_for_client.is_empty());
-        return m_for_client.read((u8*)buffer, buffer_size);
     }
-    ASSERT_NOT_REACHED();
+    ASSERT(!receive_buffer.is_empty() || !has_attached_peer(description));
+    return receive_buffer.read((u8*)buffer, buffer_size);
 }
 
 StringView LocalSocket::socket_path() const
@@ -1,14 +1,16 @@
 #pragma once
 
 #include <AK/InlineLinkedList.h>
-#include <Kernel/DoubleBuffer.h>
 #include <Kernel/Net/Socket.h>
+#include <Kernel/RingBuffer.h>
 
 class FileDescription;
 
 class LocalSocket final : public Socket, public InlineLinkedListNode<LocalSocket> {
     friend class InlineLinkedListNode<LocalSocket>;
 public:
+    static const size_t buffer_size = 64 * KB;
+
     static NonnullRefPtr<LocalSocket> create(int type);
     virtual ~LocalSocket() override;
 
@@ -27,14 +29,21 @@ public:
     virtual void detach(FileDescription&) override;
     virtual bool can_read(FileDescription&) const override;
     virtual bool can_write(FileDescription&) const override;
+    virtual bool is_hung_up(FileDescription&) const override;
     virtual ssize_t sendto(FileDescription&, const void*, size_t, int, const sockaddr*, socklen_t) override;
     virtual ssize_t recvfrom(FileDescription&, void*, size_t, int flags, sockaddr*, socklen_t*) override;
 
+    // Queue all of the given data for the peer. Writes that fit in the buffer are never
+    // split, so a message spread over several iovecs arrives in one piece or not at all.
+    ssize_t writev(FileDescription&, const iovec*, int iov_count);
+
 private:
     explicit LocalSocket(int type);
     virtual const char* class_name() const override { return "LocalSocket"; }
     virtual bool is_local() const override { return true; }
     bool has_attached_peer(const FileDescription&) const;
+    RingBuffer& send_buffer_for(FileDescription&);
+    RingBuffer& receive_buffer_for(FileDescription&);
     static Lockable<InlineLinkedList<LocalSocket>>& all_sockets();
 
     // An open socket file on the filesystem.
@@ -58,8 +67,8 @@ private:
     bool m_accept_side_fd_open { false };
     sockaddr_un m_address;
 
-    DoubleBuffer m_for_client;
-    DoubleBuffer m_for_server;
+    RingBuffer m_for_client { buffer_size };
+    RingBuffer m_for_server { buffer_size };
 
     // for InlineLinkedList
     LocalSocket* m_prev { nullptr };
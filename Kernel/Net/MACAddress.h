@@ -15,6 +15,12 @@ public:
     }
     ~MACAddress() {}
 
+    static MACAddress broadcast()
+    {
+        const u8 data[6] = { 0xff, 0xff, 0xff, 0xff, 0xff, 0xff };
+        return MACAddress(data);
+    }
+
     u8 operator[](int i) const
     {
         ASSERT(i >= 0 && i < 6);
@@ -32,7 +38,7 @@ public:
     }
 
 private:
-    u8 m_data[6];
+    u8 m_data[6] { 0 };
 };
 
 static_assert(sizeof(MACAddress) == 6);
@@ -4,7 +4,9 @@
 #include <Kernel/Net/EtherType.h>
 #include <Kernel/Net/EthernetFrameHeader.h>
 #include <Kernel/Net/NetworkAdapter.h>
+#include <Kernel/Net/Routing.h>
 #include <Kernel/StdLib.h>
+#include <Kernel/Trace.h>
 #include <Kernel/kmalloc.h>
 
 static Lockable<HashTable<NetworkAdapter*>>& all_adapters()
@@ -32,6 +34,16 @@ WeakPtr<NetworkAdapter> NetworkAdapter::from_ipv4_address(const IPv4Address& add
     return nullptr;
 }
 
+WeakPtr<NetworkAdapter> NetworkAdapter::lookup_by_name(const StringView& name)
+{
+    LOCKER(all_adapters().lock());
+    for (auto* adapter : all_adapters().resource()) {
+        if (adapter->name() == name)
+            return adapter->make_weak_ptr();
+    }
+    return nullptr;
+}
+
 NetworkAdapter::NetworkAdapter()
 {
     // FIXME: I wanna lock :(
@@ -55,16 +67,16 @@ void NetworkAdapter::send(const MACAddress& destination, const ARPPacket& packet
     m_packets_out++;
     m_bytes_out += size_in_bytes;
     memcpy(eth->payload(), &packet, sizeof(ARPPacket));
+    Trace::event(TraceEventType::PacketTransmit, size_in_bytes);
     send_raw((u8*)eth, size_in_bytes);
 }
 
-void NetworkAdapter::send_ipv4(const MACAddress& destination_mac, const IPv4Address& destination_ipv4, IPv4Protocol protocol, const u8* payload, size_t payload_size)
+ByteBuffer NetworkAdapter::build_ipv4_frame(const IPv4Address& destination_ipv4, IPv4Protocol protocol, const u8* payload, size_t payload_size)
 {
     size_t size_in_bytes = sizeof(EthernetFrameHeader) + sizeof(IPv4Packet) + payload_size;
     auto buffer = ByteBuffer::create_zeroed(size_in_bytes);
     auto& eth = *(EthernetFrameHeader*)buffer.pointer();
     eth.set_source(mac_address());
-    eth.set_destination(destination_mac);
     eth.set_ether_type(EtherType::IPv4);
     auto& ipv4 = *(IPv4Packet*)eth.payload();
     ipv4.set_version(4);
@@ -75,11 +87,31 @@ void NetworkAdapter::send_ipv4(const MACAddress& destination_mac, const IPv4Addr
     ipv4.set_length(sizeof(IPv4Packet) + payload_size);
     ipv4.set_ident(1);
     ipv4.set_ttl(64);
-    ipv4.set_checksum(ipv4.compute_checksum());
-    m_packets_out++;
-    m_bytes_out += size_in_bytes;
+    if (!(m_checksum_offload & IPv4ChecksumOffload))
+        ipv4.set_checksum(ipv4.compute_checksum());
     memcpy(ipv4.payload(), payload, payload_size);
-    send_raw((const u8*)&eth, size_in_bytes);
+    return buffer;
+}
+
+void NetworkAdapter::send_ipv4(const MACAddress& destination_mac, const IPv4Address& destination_ipv4, IPv4Protocol protocol, const u8* payload, size_t payload_size)
+{
+    auto frame = build_ipv4_frame(destination_ipv4, protocol, payload, payload_size);
+    send_frame(destination_mac, frame);
+}
+
+void NetworkAdapter::send_ipv4_via(const IPv4Address& next_hop, const IPv4Address& destination_ipv4, IPv4Protocol protocol, const u8* payload, size_t payload_size)
+{
+    send_frame_to_neighbour(*this, next_hop, build_ipv4_frame(destination_ipv4, protocol, payload, payload_size));
+}
+
+void NetworkAdapter::send_frame(const MACAddress& destination, ByteBuffer& frame)
+{
+    auto& eth = *(EthernetFrameHeader*)frame.pointer();
+    eth.set_destination(destination);
+    m_packets_out++;
+    m_bytes_out += frame.size();
+    Trace::event(TraceEventType::PacketTransmit, frame.size());
+    send_raw(frame.data(), frame.size());
 }
 
 void NetworkAdapter::did_receive(const u8* data, int length)
@@ -87,6 +119,7 @@ void NetworkAdapter::did_receive(const u8* data, int length)
     InterruptDisabler disabler;
     m_packets_in++;
     m_bytes_in += length;
+    Trace::event(TraceEventType::PacketReceive, length);
     m_packet_queue.append(KBuffer::copy(data, length));
 }
 
@@ -18,6 +18,7 @@ class NetworkAdapter : public Weakable<NetworkAdapter> {
 public:
     static void for_each(Function<void(NetworkAdapter&)>);
     static WeakPtr<NetworkAdapter> from_ipv4_address(const IPv4Address&);
+    static WeakPtr<NetworkAdapter> lookup_by_name(const StringView&);
     virtual ~NetworkAdapter();
 
     virtual const char* class_name() const = 0;
@@ -27,10 +28,21 @@ public:
     IPv4Address ipv4_address() const { return m_ipv4_address; }
     virtual bool link_up() { return false; }
 
+    // Checksums the hardware inserts into outgoing packets, and verifies on incoming ones.
+    // Incoming packets that fail verification are dropped by the driver.
+    enum ChecksumOffload : u8 {
+        IPv4ChecksumOffload = 1 << 0,
+        TCPChecksumOffload = 1 << 1,
+        UDPChecksumOffload = 1 << 2,
+    };
+    u8 checksum_offload() const { return m_checksum_offload; }
+
     void set_ipv4_address(const IPv4Address&);
 
     void send(const MACAddress&, const ARPPacket&);
     void send_ipv4(const MACAddress&, const IPv4Address&, IPv4Protocol, const u8* payload, size_t payload_size);
+    void send_ipv4_via(const IPv4Address& next_hop, const IPv4Address&, IPv4Protocol, const u8* payload, size_t payload_size);
+    void send_frame(const MACAddress&, ByteBuffer& frame);
 
     Optional<KBuffer> dequeue_packet();
 
@@ -40,21 +52,30 @@ public:
     u32 bytes_in() const { return m_bytes_in; }
     u32 packets_out() const { return m_packets_out; }
     u32 bytes_out() const { return m_bytes_out; }
+    u32 packets_dropped() const { return m_packets_dropped; }
+
+    // For outgoing packets we gave up on before they reached the driver.
+    void did_drop_packets(u32 count) { m_packets_dropped += count; }
 
 protected:
     NetworkAdapter();
     void set_interface_name(const StringView& basename);
     void set_mac_address(const MACAddress& mac_address) { m_mac_address = mac_address; }
+    void set_checksum_offload(u8 checksum_offload) { m_checksum_offload = checksum_offload; }
     virtual void send_raw(const u8*, int) = 0;
     void did_receive(const u8*, int);
 
 private:
+    ByteBuffer build_ipv4_frame(const IPv4Address&, IPv4Protocol, const u8* payload, size_t payload_size);
+
     MACAddress m_mac_address;
     IPv4Address m_ipv4_address;
     SinglyLinkedList<KBuffer> m_packet_queue;
     String m_name;
+    u8 m_checksum_offload { 0 };
     u32 m_packets_in { 0 };
     u32 m_bytes_in { 0 };
     u32 m_packets_out { 0 };
     u32 m_bytes_out { 0 };
+    u32 m_packets_dropped { 0 };
 };
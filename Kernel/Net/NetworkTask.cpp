@@ -8,11 +8,13 @@
 #include <Kernel/Net/IPv4Socket.h>
 #include <Kernel/Net/LoopbackAdapter.h>
 #include <Kernel/Net/RTL8139NetworkAdapter.h>
+#include <Kernel/Net/Routing.h>
 #include <Kernel/Net/TCP.h>
 #include <Kernel/Net/TCPSocket.h>
 #include <Kernel/Net/UDP.h>
 #include <Kernel/Net/UDPSocket.h>
 #include <Kernel/Process.h>
+#include <Kernel/Scheduler.h>
 
 //#define ETHERNET_DEBUG
 //#define ETHERNET_VERY_DEBUG
@@ -27,29 +29,31 @@ static void handle_icmp(const EthernetFrameHeader&, const IPv4Packet&);
 static void handle_udp(const IPv4Packet&);
 static void handle_tcp(const IPv4Packet&);
 
-Lockable<HashMap<IPv4Address, MACAddress>>& arp_table()
-{
-    static Lockable<HashMap<IPv4Address, MACAddress>>* the;
-    if (!the)
-        the = new Lockable<HashMap<IPv4Address, MACAddress>>;
-    return *the;
-}
+static const u64 arp_housekeeping_interval = 1000;
 
 void NetworkTask_main()
 {
-    LoopbackAdapter::the();
+    auto& loopback = LoopbackAdapter::the();
+    add_route({ 127, 0, 0, 0 }, 8, {}, loopback);
 
     auto e1000 = E1000NetworkAdapter::the();
     if (!e1000)
         dbgprintf("E1000 network card not found!\n");
-    if (e1000)
-        e1000->set_ipv4_address(IPv4Address(192, 168, 5, 2));
+    if (e1000) {
+        // These are the addresses QEMU's user mode networking (slirp) hands out by default,
+        // see Kernel/run. Other setups can change the routes with the 'route' utility.
+        e1000->set_ipv4_address(IPv4Address(10, 0, 2, 15));
+        add_route({ 10, 0, 2, 0 }, 24, {}, *e1000);
+        add_route({ 0, 0, 0, 0 }, 0, { 10, 0, 2, 2 }, *e1000);
+    }
 
     auto rtl8139 = RTL8139NetworkAdapter::the();
     if (!rtl8139)
         dbgprintf("RTL8139 network card not found!\n");
-    if (rtl8139)
+    if (rtl8139) {
         rtl8139->set_ipv4_address(IPv4Address(192, 168, 13, 201));
+        add_route({ 192, 168, 13, 0 }, 24, {}, *rtl8139);
+    }
 
     auto dequeue_packet = [&]() -> Optional<KBuffer> {
         auto packet = LoopbackAdapter::the().dequeue_packet();
@@ -64,11 +68,19 @@ void NetworkTask_main()
         return {};
     };
 
+    u64 next_arp_housekeeping = g_uptime + arp_housekeeping_interval;
+
     kprintf("NetworkTask: Enter main loop.\n");
     for (;;) {
+        if (g_uptime >= next_arp_housekeeping) {
+            arp_table_tick();
+            next_arp_housekeeping = g_uptime + arp_housekeeping_interval;
+        }
         auto packet_maybe_null = dequeue_packet();
         if (!packet_maybe_null.has_value()) {
-            (void)current->block_until("Networking", [] {
+            (void)current->block_until("Networking", [next_arp_housekeeping] {
+                if (g_uptime >= next_arp_housekeeping)
+                    return true;
                 if (LoopbackAdapter::the().has_queued_packets())
                     return true;
                 if (auto* e1000 = E1000NetworkAdapter::the()) {
@@ -163,7 +175,8 @@ void handle_arp(const EthernetFrameHeader& eth, size_t frame_size)
     if (packet.operation() == ARPOperation::Request) {
         // Who has this IP address?
         if (auto adapter = NetworkAdapter::from_ipv4_address(packet.target_protocol_address())) {
-            // We do!
+            // We do! The asker is clearly about to talk to us, so remember them too.
+            update_arp_table(*adapter, packet.sender_protocol_address(), packet.sender_hardware_address(), true);
             kprintf("handle_arp: Responding to ARP request for my IPv4 address (%s)\n",
                 adapter->ipv4_address().to_string().characters());
             ARPPacket response;
@@ -179,16 +192,13 @@ void handle_arp(const EthernetFrameHeader& eth, size_t frame_size)
     }
 
     if (packet.operation() == ARPOperation::Response) {
-        // Someone has this IPv4 address. I guess we can try to remember that.
-        // FIXME: Protect against ARP spamming.
+        // Someone has this IPv4 address. Unsolicited responses are ignored, so we only
+        // learn about neighbours we have actually asked about.
         // FIXME: Support static ARP table entries.
-        LOCKER(arp_table().lock());
-        arp_table().resource().set(packet.sender_protocol_address(), packet.sender_hardware_address());
-
-        kprintf("ARP table (%d entries):\n", arp_table().resource().size());
-        for (auto& it : arp_table().resource()) {
-            kprintf("%s :: %s\n", it.value.to_string().characters(), it.key.to_string().characters());
-        }
+        auto adapter = NetworkAdapter::from_ipv4_address(packet.target_protocol_address());
+        if (!adapter)
+            return;
+        update_arp_table(*adapter, packet.sender_protocol_address(), packet.sender_hardware_address(), false);
     }
 }
 
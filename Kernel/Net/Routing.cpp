@@ -1,10 +1,294 @@
+#include <AK/HashMap.h>
+#include <AK/OwnPtr.h>
+#include <Kernel/Lock.h>
+#include <Kernel/Net/EthernetFrameHeader.h>
 #include <Kernel/Net/LoopbackAdapter.h>
 #include <Kernel/Net/Routing.h>
+#include <Kernel/Scheduler.h>
+
+//#define ROUTING_DEBUG
+//#define ARP_DEBUG
+
+// Reachable neighbours are forgotten after this many milliseconds.
+static const u64 arp_entry_lifetime = 5 * 60 * 1000;
+// Outstanding requests are retransmitted at this interval, until we give up.
+static const u64 arp_request_interval = 1000;
+static const int arp_max_requests = 3;
+static const int arp_max_pending_frames = 8;
+static const int arp_max_entries = 256;
+
+// The routing table is a binary trie keyed on the destination prefix, one address bit
+// per level. A lookup walks at most 32 levels and remembers the deepest route it
+// passed, which is the longest matching prefix.
+struct RouteTrieNode {
+    OwnPtr<RouteTrieNode> children[2];
+    Optional<Route> route;
+
+    bool is_empty() const { return !route.has_value() && !children[0] && !children[1]; }
+};
+
+static Lockable<RouteTrieNode>& routing_table()
+{
+    static Lockable<RouteTrieNode>* the;
+    if (!the)
+        the = new Lockable<RouteTrieNode>;
+    return *the;
+}
+
+static Lockable<HashMap<IPv4Address, ARPTableEntry>>& arp_table()
+{
+    static Lockable<HashMap<IPv4Address, ARPTableEntry>>* the;
+    if (!the)
+        the = new Lockable<HashMap<IPv4Address, ARPTableEntry>>;
+    return *the;
+}
+
+static inline int bit_at(const IPv4Address& address, int index)
+{
+    return (address[index / 8] >> (7 - (index % 8))) & 1;
+}
+
+static IPv4Address mask_address(const IPv4Address& address, u8 prefix_length)
+{
+    u8 octets[4];
+    for (int i = 0; i < 4; ++i) {
+        int bits = min(max((int)prefix_length - i * 8, 0), 8);
+        octets[i] = address[i] & (u8)(0xff00 >> bits);
+    }
+    return IPv4Address(octets);
+}
+
+KResult add_route(const IPv4Address& destination, u8 prefix_length, const IPv4Address& gateway, NetworkAdapter& adapter)
+{
+    if (prefix_length > 32)
+        return KResult(-EINVAL);
+
+    auto masked_destination = mask_address(destination, prefix_length);
+
+    LOCKER(routing_table().lock());
+    auto* node = &routing_table().resource();
+    for (int i = 0; i < prefix_length; ++i) {
+        auto& child = node->children[bit_at(masked_destination, i)];
+        if (!child)
+            child = make<RouteTrieNode>();
+        node = child.ptr();
+    }
+    if (node->route.has_value() && node->route.value().adapter)
+        return KResult(-EEXIST);
+    node->route = Route { masked_destination, prefix_length, gateway, adapter.make_weak_ptr() };
+#ifdef ROUTING_DEBUG
+    kprintf("add_route: %s/%u via %s on %s\n",
+        masked_destination.to_string().characters(),
+        prefix_length,
+        gateway.to_string().characters(),
+        adapter.name().characters());
+#endif
+    return KSuccess;
+}
+
+static bool remove_route_impl(RouteTrieNode& node, const IPv4Address& destination, u8 prefix_length, int depth, bool& found)
+{
+    if (depth == prefix_length) {
+        found = node.route.has_value();
+        node.route.clear();
+    } else {
+        auto& child = node.children[bit_at(destination, depth)];
+        if (!child)
+            return false;
+        if (remove_route_impl(*child, destination, prefix_length, depth + 1, found))
+            child = nullptr;
+    }
+    return node.is_empty();
+}
+
+KResult remove_route(const IPv4Address& destination, u8 prefix_length)
+{
+    if (prefix_length > 32)
+        return KResult(-EINVAL);
+
+    LOCKER(routing_table().lock());
+    bool found = false;
+    remove_route_impl(routing_table().resource(), mask_address(destination, prefix_length), prefix_length, 0, found);
+    if (!found)
+        return KResult(-ESRCH);
+    return KSuccess;
+}
+
+static void for_each_route_impl(const RouteTrieNode& node, Function<void(const Route&)>& callback)
+{
+    if (node.route.has_value() && node.route.value().adapter)
+        callback(node.route.value());
+    for (auto& child : node.children) {
+        if (child)
+            for_each_route_impl(*child, callback);
+    }
+}
+
+void for_each_route(Function<void(const Route&)> callback)
+{
+    LOCKER(routing_table().lock());
+    for_each_route_impl(routing_table().resource(), callback);
+}
+
+RoutingDecision route_to(const IPv4Address& target)
+{
+    LOCKER(routing_table().lock());
+    const Route* best_match = nullptr;
+    auto* node = &routing_table().resource();
+    for (int i = 0;; ++i) {
+        // Routes whose adapter has gone away are skipped rather than matched.
+        if (node->route.has_value() && node->route.value().adapter)
+            best_match = &node->route.value();
+        if (i == 32)
+            break;
+        node = node->children[bit_at(target, i)].ptr();
+        if (!node)
+            break;
+    }
+
+    if (!best_match) {
+#ifdef ROUTING_DEBUG
+        kprintf("route_to: No route to %s\n", target.to_string().characters());
+#endif
+        return {};
+    }
+
+    auto next_hop = best_match->gateway.to_u32() ? best_match->gateway : target;
+    return { best_match->adapter, next_hop };
+}
 
 WeakPtr<NetworkAdapter> adapter_for_route_to(const IPv4Address& ipv4_address)
 {
-    // FIXME: Have an actual routing table.
-    if (ipv4_address == IPv4Address(127, 0, 0, 1))
-        return LoopbackAdapter::the().make_weak_ptr();
-    return NetworkAdapter::from_ipv4_address(IPv4Address(192, 168, 5, 2));
+    return route_to(ipv4_address).adapter;
+}
+
+static void send_arp_request(NetworkAdapter& adapter, const IPv4Address& target)
+{
+#ifdef ARP_DEBUG
+    kprintf("send_arp_request: Who has %s? Tell %s\n",
+        target.to_string().characters(),
+        adapter.ipv4_address().to_string().characters());
+#endif
+    ARPPacket request;
+    request.set_operation(ARPOperation::Request);
+    request.set_target_hardware_address(MACAddress());
+    request.set_target_protocol_address(target);
+    request.set_sender_hardware_address(adapter.mac_address());
+    request.set_sender_protocol_address(adapter.ipv4_address());
+    adapter.send(MACAddress::broadcast(), request);
+}
+
+void send_frame_to_neighbour(NetworkAdapter& adapter, const IPv4Address& next_hop, ByteBuffer&& frame)
+{
+    // Frames to ourselves never hit the wire, so there is nobody to ask.
+    if (&adapter == &LoopbackAdapter::the() || next_hop == adapter.ipv4_address()) {
+        adapter.send_frame(adapter.mac_address(), frame);
+        return;
+    }
+
+    LOCKER(arp_table().lock());
+    auto& table = arp_table().resource();
+    {
+        auto it = table.find(next_hop);
+        if (it != table.end()) {
+            auto& entry = it->value;
+            if (entry.state == ARPTableEntry::State::Incomplete) {
+                // A request is already in flight; just wait in line with the others.
+                if (entry.pending_frames.size() >= arp_max_pending_frames)
+                    entry.pending_frames.remove(0);
+                entry.pending_frames.append(move(frame));
+                return;
+            }
+            if (entry.expiration_time > g_uptime && entry.adapter.ptr() == &adapter) {
+                adapter.send_frame(entry.mac_address, frame);
+                return;
+            }
+            table.remove(it);
+        }
+    }
+
+    if (table.size() >= arp_max_entries)
+        table.remove_one_randomly();
+    ARPTableEntry entry;
+    entry.adapter = adapter.make_weak_ptr();
+    entry.requests_sent = 1;
+    entry.next_request_time = g_uptime + arp_request_interval;
+    entry.pending_frames.append(move(frame));
+    table.set(next_hop, move(entry));
+    send_arp_request(adapter, next_hop);
+}
+
+void update_arp_table(NetworkAdapter& adapter, const IPv4Address& ipv4_address, const MACAddress& mac_address, bool create)
+{
+    LOCKER(arp_table().lock());
+    auto& table = arp_table().resource();
+    if (!table.contains(ipv4_address)) {
+        if (!create)
+            return;
+        if (table.size() >= arp_max_entries)
+            table.remove_one_randomly();
+        table.set(ipv4_address, ARPTableEntry());
+    }
+
+    auto it = table.find(ipv4_address);
+    auto& entry = it->value;
+    entry.state = ARPTableEntry::State::Reachable;
+    entry.mac_address = mac_address;
+    entry.adapter = adapter.make_weak_ptr();
+    entry.expiration_time = g_uptime + arp_entry_lifetime;
+    entry.requests_sent = 0;
+
+#ifdef ARP_DEBUG
+    kprintf("update_arp_table: %s is at %s, sending %d pending frame(s)\n",
+        ipv4_address.to_string().characters(),
+        mac_address.to_string().characters(),
+        entry.pending_frames.size());
+#endif
+
+    auto pending_frames = move(entry.pending_frames);
+    for (auto& frame : pending_frames)
+        adapter.send_frame(mac_address, frame);
+}
+
+void arp_table_tick()
+{
+    LOCKER(arp_table().lock());
+    auto& table = arp_table().resource();
+    Vector<IPv4Address> expired;
+    for (auto& it : table) {
+        auto& entry = it.value;
+        if (!entry.adapter) {
+            expired.append(it.key);
+            continue;
+        }
+        if (entry.state == ARPTableEntry::State::Reachable) {
+            if (entry.expiration_time <= g_uptime)
+                expired.append(it.key);
+            continue;
+        }
+        if (entry.next_request_time > g_uptime)
+            continue;
+        if (entry.requests_sent >= arp_max_requests) {
+#ifdef ARP_DEBUG
+            kprintf("arp_table_tick: %s did not answer, dropping %d pending frame(s)\n",
+                it.key.to_string().characters(),
+                entry.pending_frames.size());
+#endif
+            entry.adapter->did_drop_packets(entry.pending_frames.size());
+            expired.append(it.key);
+            continue;
+        }
+        ++entry.requests_sent;
+        entry.next_request_time = g_uptime + arp_request_interval;
+        send_arp_request(*entry.adapter, it.key);
+    }
+    for (auto& ipv4_address : expired)
+        table.remove(ipv4_address);
+}
+
+void for_each_arp_entry(Function<void(const IPv4Address&, const ARPTableEntry&)> callback)
+{
+    LOCKER(arp_table().lock());
+    for (auto& it : arp_table().resource())
+        callback(it.key, it.value);
 }
@@ -1,5 +1,59 @@
 #pragma once
 
+#include <AK/Function.h>
+#include <AK/Vector.h>
+#include <Kernel/KResult.h>
 #include <Kernel/Net/NetworkAdapter.h>
 
+struct Route {
+    IPv4Address destination;
+    u8 prefix_length { 0 };
+    // A zero gateway means the destination network is directly attached to the adapter.
+    IPv4Address gateway;
+    WeakPtr<NetworkAdapter> adapter;
+};
+
+struct RoutingDecision {
+    WeakPtr<NetworkAdapter> adapter;
+    IPv4Address next_hop;
+
+    bool is_valid() const { return !!adapter; }
+};
+
+KResult add_route(const IPv4Address& destination, u8 prefix_length, const IPv4Address& gateway, NetworkAdapter&);
+KResult remove_route(const IPv4Address& destination, u8 prefix_length);
+void for_each_route(Function<void(const Route&)>);
+
+RoutingDecision route_to(const IPv4Address&);
 WeakPtr<NetworkAdapter> adapter_for_route_to(const IPv4Address&);
+
+struct ARPTableEntry {
+    enum class State {
+        Incomplete,
+        Reachable,
+    };
+
+    State state { State::Incomplete };
+    MACAddress mac_address;
+    WeakPtr<NetworkAdapter> adapter;
+    u64 expiration_time { 0 };
+    u64 next_request_time { 0 };
+    int requests_sent { 0 };
+    // Frames waiting for this neighbour's hardware address to be resolved.
+    Vector<ByteBuffer> pending_frames;
+};
+
+// Transmit an Ethernet frame to the given on-link neighbour, resolving its hardware
+// address first if needed. The frame is held until the ARP response arrives.
+void send_frame_to_neighbour(NetworkAdapter&, const IPv4Address& next_hop, ByteBuffer&& frame);
+
+// Record the hardware address of a neighbour reachable through the given adapter.
+// Unless `create` is set, only addresses we already have an entry for (e.g. because
+// of an outstanding request) are learned.
+void update_arp_table(NetworkAdapter&, const IPv4Address&, const MACAddress&, bool create);
+
+// Expire stale entries, retransmit outstanding requests and give up on neighbours
+// that never answered. Called periodically by the NetworkTask.
+void arp_table_tick();
+
+void for_each_arp_entry(Function<void(const IPv4Address&, const ARPTableEntry&)>);
@@ -156,7 +156,13 @@ void TCPSocket::send_tcp_packet(u16 flags, const void* payload, int payload_size
     }
 
     memcpy(tcp_packet.payload(), payload, payload_size);
-    tcp_packet.set_checksum(compute_tcp_checksum(local_address(), peer_address(), tcp_packet, payload_size));
+    if (m_adapter->checksum_offload() & NetworkAdapter::TCPChecksumOffload) {
+        // The adapter sums up the segment itself, but leaves the pseudo-header to us.
+        auto checksum = checksum_with_ipv4_pseudo_header(local_address(), peer_address(), IPv4Protocol::TCP, sizeof(TCPPacket) + payload_size);
+        tcp_packet.set_checksum(checksum.partial_sum());
+    } else {
+        tcp_packet.set_checksum(compute_tcp_checksum(local_address(), peer_address(), tcp_packet, payload_size));
+    }
 #ifdef TCP_SOCKET_DEBUG
     kprintf("sending tcp packet from %s:%u to %s:%u with (%s%s%s%s) seq_no=%u, ack_no=%u\n",
         local_address().to_string().characters(),
@@ -170,7 +176,9 @@ void TCPSocket::send_tcp_packet(u16 flags, const void* payload, int payload_size
         tcp_packet.sequence_number(),
         tcp_packet.ack_number());
 #endif
-    m_adapter->send_ipv4(MACAddress(), peer_address(), IPv4Protocol::TCP, buffer.data(), buffer.size());
+    auto routing_decision = route_to(peer_address());
+    auto next_hop = routing_decision.adapter.ptr() == m_adapter.ptr() ? routing_decision.next_hop : peer_address();
+    m_adapter->send_ipv4_via(next_hop, peer_address(), IPv4Protocol::TCP, buffer.data(), buffer.size());
 
     m_packets_out++;
     m_bytes_out += buffer.size();
@@ -184,44 +192,10 @@ void TCPSocket::record_incoming_data(int size)
 
 NetworkOrdered<u16> TCPSocket::compute_tcp_checksum(const IPv4Address& source, const IPv4Address& destination, const TCPPacket& packet, u16 payload_size)
 {
-    struct [[gnu::packed]] PseudoHeader
-    {
-        IPv4Address source;
-        IPv4Address destination;
-        u8 zero;
-        u8 protocol;
-        NetworkOrdered<u16> payload_size;
-    };
-
-    PseudoHeader pseudo_header { source, destination, 0, (u8)IPv4Protocol::TCP, sizeof(TCPPacket) + payload_size };
-
-    u32 checksum = 0;
-    auto* w = (const NetworkOrdered<u16>*)&pseudo_header;
-    for (size_t i = 0; i < sizeof(pseudo_header) / sizeof(u16); ++i) {
-        checksum += w[i];
-        if (checksum > 0xffff)
-            checksum = (checksum >> 16) + (checksum & 0xffff);
-    }
-    w = (const NetworkOrdered<u16>*)&packet;
-    for (size_t i = 0; i < sizeof(packet) / sizeof(u16); ++i) {
-        checksum += w[i];
-        if (checksum > 0xffff)
-            checksum = (checksum >> 16) + (checksum & 0xffff);
-    }
     ASSERT(packet.data_offset() * 4 == sizeof(TCPPacket));
-    w = (const NetworkOrdered<u16>*)packet.payload();
-    for (size_t i = 0; i < payload_size / sizeof(u16); ++i) {
-        checksum += w[i];
-        if (checksum > 0xffff)
-            checksum = (checksum >> 16) + (checksum & 0xffff);
-    }
-    if (payload_size & 1) {
-        u16 expanded_byte = ((const u8*)packet.payload())[payload_size - 1] << 8;
-        checksum += expanded_byte;
-        if (checksum > 0xffff)
-            checksum = (checksum >> 16) + (checksum & 0xffff);
-    }
-    return ~(checksum & 0xffff);
+    auto checksum = checksum_with_ipv4_pseudo_header(source, destination, IPv4Protocol::TCP, sizeof(TCPPacket) + payload_size);
+    checksum.add(&packet, sizeof(TCPPacket) + payload_size);
+    return checksum.finish();
 }
 
 KResult TCPSocket::protocol_bind()
@@ -106,6 +106,7 @@ public:
     Direction direction() const { return m_direction; }
 
     bool has_error() const { return m_error != Error::None; }
+    virtual bool has_pending_error(FileDescription&) const override { return has_error(); }
     Error error() const { return m_error; }
     void set_error(Error error) { m_error = error; }
 
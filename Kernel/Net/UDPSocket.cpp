@@ -63,21 +63,27 @@ int UDPSocket::protocol_receive(const KBuffer& packet_buffer, void* buffer, size
 
 int UDPSocket::protocol_send(const void* data, int data_length)
 {
-    auto adapter = adapter_for_route_to(peer_address());
-    if (!adapter)
+    auto routing_decision = route_to(peer_address());
+    if (!routing_decision.is_valid())
         return -EHOSTUNREACH;
+    auto& adapter = routing_decision.adapter;
     auto buffer = ByteBuffer::create_zeroed(sizeof(UDPPacket) + data_length);
     auto& udp_packet = *(UDPPacket*)(buffer.pointer());
     udp_packet.set_source_port(local_port());
     udp_packet.set_destination_port(peer_port());
     udp_packet.set_length(sizeof(UDPPacket) + data_length);
     memcpy(udp_packet.payload(), data, data_length);
+    // Without offload, we leave the checksum at zero, which tells the receiver not to check.
+    if (adapter->checksum_offload() & NetworkAdapter::UDPChecksumOffload) {
+        auto checksum = checksum_with_ipv4_pseudo_header(adapter->ipv4_address(), peer_address(), IPv4Protocol::UDP, sizeof(UDPPacket) + data_length);
+        udp_packet.set_checksum(checksum.partial_sum());
+    }
     kprintf("sending as udp packet from %s:%u to %s:%u!\n",
         adapter->ipv4_address().to_string().characters(),
         local_port(),
         peer_address().to_string().characters(),
         peer_port());
-    adapter->send_ipv4(MACAddress(), peer_address(), IPv4Protocol::UDP, buffer.data(), buffer.size());
+    adapter->send_ipv4_via(routing_decision.next_hop, peer_address(), IPv4Protocol::UDP, buffer.data(), buffer.size());
     return data_length;
 }
 
@@ -9,6 +9,7 @@
 #include <Kernel/Arch/i386/PIT.h>
 #include <Kernel/Devices/NullDevice.h>
 #include <Kernel/FileSystem/Custody.h>
+#include <Kernel/FileSystem/EventPoll.h>
 #include <Kernel/FileSystem/Ext2FileSystem.h>
 #include <Kernel/FileSystem/ProcFS.h>
 #include <Kernel/FileSystem/DevPtsFS.h>
@@ -18,16 +19,21 @@
 #include <Kernel/FileSystem/InodeWatcher.h>
 #include <Kernel/FileSystem/SharedMemory.h>
 #include <Kernel/FileSystem/VirtualFileSystem.h>
+#include <Kernel/FutexTable.h>
 #include <Kernel/IO.h>
+#include <Kernel/KBuffer.h>
 #include <Kernel/KBufferBuilder.h>
 #include <Kernel/KSyms.h>
 #include <Kernel/Multiboot.h>
+#include <Kernel/Net/LocalSocket.h>
 #include <Kernel/Net/Socket.h>
 #include <Kernel/Process.h>
 #include <Kernel/ProcessTracer.h>
+#include <Kernel/ProfileBuffer.h>
 #include <Kernel/RTC.h>
 #include <Kernel/Scheduler.h>
 #include <Kernel/SharedBuffer.h>
+#include <Kernel/SharedTimePage.h>
 #include <Kernel/StdLib.h>
 #include <Kernel/Syscall.h>
 #include <Kernel/TTY/MasterPTY.h>
@@ -44,6 +50,7 @@
 //#define SHARED_BUFFER_DEBUG
 
 static void create_signal_trampolines();
+static pid_t get_sid_from_pgid(pid_t pgid);
 
 static pid_t next_pid;
 InlineLinkedList<Process>* g_processes;
@@ -120,16 +127,6 @@ Region* Process::allocate_region(VirtualAddress vaddr, size_t size, const String
     return &m_regions.last();
 }
 
-Region* Process::allocate_file_backed_region(VirtualAddress vaddr, size_t size, NonnullRefPtr<Inode> inode, const String& name, int prot)
-{
-    auto range = allocate_range(vaddr, size);
-    if (!range.is_valid())
-        return nullptr;
-    m_regions.append(Region::create_user_accessible(range, inode, name, prot_to_region_access_flags(prot)));
-    MM.map_region(*this, m_regions.last());
-    return &m_regions.last();
-}
-
 Region* Process::allocate_region_with_vmo(VirtualAddress vaddr, size_t size, NonnullRefPtr<VMObject> vmo, size_t offset_in_vmo, const String& name, int prot)
 {
     auto range = allocate_range(vaddr, size);
@@ -202,7 +199,7 @@ void* Process::sys$mmap(const Syscall::SC_mmap_params* params)
             region->set_name(name);
         return region->vaddr().as_ptr();
     }
-    if (offset & ~PAGE_MASK)
+    if (offset < 0 || (offset & ~PAGE_MASK))
         return (void*)-EINVAL;
     auto* description = file_description(fd);
     if (!description)
@@ -238,6 +235,41 @@ int Process::sys$mprotect(void* addr, size_t size, int prot)
     return 0;
 }
 
+int Process::sys$madvise(void* address, size_t size, int advice)
+{
+    VirtualAddress vaddr((u32)address);
+    if (vaddr.get() % PAGE_SIZE)
+        return -EINVAL;
+    // Sizes in the last page of the address space would round up to 0.
+    if (size > 0xffffffff - PAGE_SIZE + 1)
+        return -EINVAL;
+    size = PAGE_ROUND_UP(size);
+    Region* region = nullptr;
+    for (auto& it : m_regions) {
+        if (it.contains(vaddr)) {
+            region = &it;
+            break;
+        }
+    }
+    if (!region || size > region->size() - (vaddr - region->vaddr()).get())
+        return -EINVAL;
+
+    switch (advice) {
+    case MADV_NORMAL:
+        return 0;
+    case MADV_DONTNEED:
+        // The pages are only ours to throw away if no other region maps this VMObject.
+        // Checking the region's flags isn't enough: shared memory mapped MAP_PRIVATE gets a
+        // private, writable region over a VMObject that other processes map too.
+        if (!region->is_writable() || !region->vmo().is_anonymous() || region->vmo().ref_count() != 1)
+            return -EINVAL;
+        MM.decommit_region_pages(*region, region->page_index_from_address(vaddr), size / PAGE_SIZE);
+        return 0;
+    default:
+        return -EINVAL;
+    }
+}
+
 int Process::sys$gethostname(char* buffer, ssize_t size)
 {
     if (size < 0)
@@ -251,7 +283,7 @@ int Process::sys$gethostname(char* buffer, ssize_t size)
     return 0;
 }
 
-Process* Process::fork(RegisterDump& regs)
+Process* Process::fork(RegisterDump& regs, ShouldShareAddressSpace should_share_address_space)
 {
     auto* child = new Process(String(m_name), m_uid, m_gid, m_pid, m_ring, m_cwd, m_executable, m_tty, this);
 
@@ -259,13 +291,23 @@ Process* Process::fork(RegisterDump& regs)
     dbgprintf("fork: child=%p\n", child);
 #endif
 
-    for (auto& region : m_regions) {
+    if (should_share_address_space == ShouldShareAddressSpace::Yes) {
+        // The child borrows our page directory and the very same regions, so nothing
+        // gets copied or marked copy-on-write. It gives them back in exec() or finalize().
+        child->m_page_directory = m_page_directory;
+        for (auto& region : m_regions)
+            child->m_regions.append(region);
+        child->main_thread().m_tss.cr3 = page_directory().cr3();
+        child->m_is_sharing_address_space_with_parent = true;
+    } else {
+        for (auto& region : m_regions) {
 #ifdef FORK_DEBUG
-        dbgprintf("fork: cloning Region{%p} \"%s\" V%08x\n", region.ptr(), region->name().characters(), region->vaddr().get());
+            dbgprintf("fork: cloning Region{%p} \"%s\" V%08x\n", region.ptr(), region->name().characters(), region->vaddr().get());
 #endif
-        auto cloned_region = region.clone();
-        child->m_regions.append(move(cloned_region));
-        MM.map_region(*child, child->m_regions.last());
+            auto cloned_region = region.clone();
+            child->m_regions.append(move(cloned_region));
+            MM.map_region(*child, child->m_regions.last());
+        }
     }
 
     for (auto gid : m_gids)
@@ -288,6 +330,7 @@ Process* Process::fork(RegisterDump& regs)
     child_tss.fs = regs.fs;
     child_tss.gs = regs.gs;
     child_tss.ss = regs.ss_if_crossRing;
+    child->main_thread().m_thread_pointer = current->m_thread_pointer;
 
 #ifdef FORK_DEBUG
     dbgprintf("fork: child will begin executing at %w:%x with stack %w:%x, kstack %w:%x\n", child_tss.cs, child_tss.eip, child_tss.ss, child_tss.esp, child_tss.ss0, child_tss.esp0);
@@ -313,7 +356,33 @@ pid_t Process::sys$fork(RegisterDump& regs)
     return child->pid();
 }
 
-int Process::do_exec(String path, Vector<String> arguments, Vector<String> environment)
+pid_t Process::sys$vfork(RegisterDump& regs)
+{
+    auto* child = fork(regs, ShouldShareAddressSpace::Yes);
+    ASSERT(child);
+    pid_t child_pid = child->pid();
+
+    // The child is running on our stack until it execs or dies, so we can't go back to
+    // userspace before then, not even to run a signal handler. Signals that don't need one
+    // still get through: SIGKILL and SIGSTOP always, and SIGCONT unless it's caught, so
+    // that a stop can be undone.
+    auto old_signal_mask = current->m_signal_mask;
+    u32 unmasked_signals = (1 << (SIGKILL - 1)) | (1 << (SIGSTOP - 1));
+    if (current->m_signal_action_data[SIGCONT].handler_or_sigaction.is_null())
+        unmasked_signals |= 1 << (SIGCONT - 1);
+    current->m_signal_mask = ~unmasked_signals;
+    auto child_is_done = [child_pid] {
+        auto* child = Process::from_pid(child_pid);
+        return !child || !child->m_is_sharing_address_space_with_parent;
+    };
+    // Being stopped and continued wakes us up early, so keep waiting until the child is done.
+    while (!child_is_done())
+        (void)current->block_until("Vfork", [&] { return child_is_done(); });
+    current->m_signal_mask = old_signal_mask;
+    return child_pid;
+}
+
+int Process::do_exec(String path, Vector<String> arguments, Vector<String> environment, u32 signal_mask)
 {
     ASSERT(is_ring3());
 
@@ -393,8 +462,8 @@ int Process::do_exec(String path, Vector<String> arguments, Vector<String> envir
         if (!success || !loader->entry().get()) {
             m_page_directory = move(old_page_directory);
             // FIXME: RAII this somehow instead.
-            ASSERT(&current->process() == this);
-            MM.enter_process_paging_scope(*this);
+            if (&current->process() == this)
+                MM.enter_process_paging_scope(*this);
             m_regions = move(old_regions);
             kprintf("do_exec: Failure loading %s\n", path.characters());
             return -ENOEXEC;
@@ -407,16 +476,21 @@ int Process::do_exec(String path, Vector<String> arguments, Vector<String> envir
     m_elf_loader = move(loader);
     m_executable = description->custody();
 
+    // A vfork() parent can have its address space back now.
+    m_is_sharing_address_space_with_parent = false;
+
     if (metadata.is_setuid())
         m_euid = metadata.uid;
     if (metadata.is_setgid())
         m_egid = metadata.gid;
 
-    current->m_kernel_stack_for_signal_handler_region = nullptr;
-    current->m_signal_stack_user_region = nullptr;
-    current->set_default_signal_dispositions();
-    current->m_signal_mask = 0;
-    current->m_pending_signals = 0;
+    // posix_spawn() execs on behalf of a process that isn't running yet.
+    auto& thread = &current->process() == this ? *current : main_thread();
+    thread.m_kernel_stack_for_signal_handler_region = nullptr;
+    thread.m_signal_stack_user_region = nullptr;
+    thread.set_default_signal_dispositions();
+    thread.m_signal_mask = signal_mask;
+    thread.m_pending_signals = 0;
 
     for (int i = 0; i < m_fds.size(); ++i) {
         auto& daf = m_fds[i];
@@ -447,6 +521,7 @@ int Process::do_exec(String path, Vector<String> arguments, Vector<String> envir
     main_thread().m_tss.es = 0x23;
     main_thread().m_tss.fs = 0x23;
     main_thread().m_tss.gs = 0x23;
+    main_thread().m_thread_pointer = 0;
     main_thread().m_tss.ss = 0x23;
     main_thread().m_tss.cr3 = page_directory().cr3();
     main_thread().make_userspace_stack_for_main_thread(move(arguments), move(environment));
@@ -463,11 +538,11 @@ int Process::do_exec(String path, Vector<String> arguments, Vector<String> envir
     return 0;
 }
 
-int Process::exec(String path, Vector<String> arguments, Vector<String> environment)
+int Process::exec(String path, Vector<String> arguments, Vector<String> environment, u32 signal_mask)
 {
     // The bulk of exec() is done by do_exec(), which ensures that all locals
     // are cleaned up by the time we yield-teleport below.
-    int rc = do_exec(move(path), move(arguments), move(environment));
+    int rc = do_exec(move(path), move(arguments), move(environment), signal_mask);
     if (rc < 0)
         return rc;
 
@@ -478,6 +553,21 @@ int Process::exec(String path, Vector<String> arguments, Vector<String> environm
     return 0;
 }
 
+bool Process::copy_string_list_from_user(const char** list, Vector<String>& strings)
+{
+    if (!list)
+        return true;
+    for (size_t i = 0;; ++i) {
+        if (!validate_read_typed(&list[i]))
+            return false;
+        if (!list[i])
+            return true;
+        if (!validate_read_str(list[i]))
+            return false;
+        strings.append(list[i]);
+    }
+}
+
 int Process::sys$execve(const char* filename, const char** argv, const char** envp)
 {
     // NOTE: Be extremely careful with allocating any kernel memory in exec().
@@ -486,45 +576,146 @@ int Process::sys$execve(const char* filename, const char** argv, const char** en
         return -EFAULT;
     if (!*filename)
         return -ENOENT;
-    if (argv) {
-        if (!validate_read_typed(argv))
+
+    String path(filename);
+    Vector<String> arguments;
+    Vector<String> environment;
+    if (!copy_string_list_from_user(argv, arguments) || !copy_string_list_from_user(envp, environment))
+        return -EFAULT;
+    if (!argv)
+        arguments.append(path.split('/').last());
+
+    int rc = exec(move(path), move(arguments), move(environment));
+    ASSERT(rc < 0); // We should never continue after a successful exec!
+    return rc;
+}
+
+KResult Process::apply_spawn_file_action(const posix_spawn_file_action& action)
+{
+    // This runs in the parent, on behalf of a child that hasn't started yet.
+    switch (action.type) {
+    case POSIX_SPAWN_FILE_ACTION_OPEN: {
+        if (action.fd < 0 || action.fd >= m_max_open_file_descriptors)
+            return KResult(-EBADF);
+        auto result = VFS::the().open(action.path, action.flags, action.mode & ~umask(), current_directory());
+        if (result.is_error())
+            return result.error();
+        if (m_fds[action.fd])
+            sys$close(action.fd);
+        auto description = result.value();
+        description->set_file_flags(action.flags);
+        m_fds[action.fd].set(move(description), (action.flags & O_CLOEXEC) ? FD_CLOEXEC : 0);
+        return KSuccess;
+    }
+    case POSIX_SPAWN_FILE_ACTION_CLOSE: {
+        // Closing a descriptor that isn't open is harmless here.
+        if (!file_description(action.fd))
+            return KSuccess;
+        int rc = sys$close(action.fd);
+        return rc < 0 ? KResult(rc) : KSuccess;
+    }
+    case POSIX_SPAWN_FILE_ACTION_DUP2: {
+        int rc = sys$dup2(action.fd, action.new_fd);
+        return rc < 0 ? KResult(rc) : KSuccess;
+    }
+    default:
+        return KResult(-EINVAL);
+    }
+}
+
+pid_t Process::sys$posix_spawn(const Syscall::SC_posix_spawn_params* params)
+{
+    if (!validate_read_typed(params))
+        return -EFAULT;
+    if (!validate_read_str(params->path))
+        return -EFAULT;
+    if (!*params->path)
+        return -ENOENT;
+
+    String path(params->path);
+    Vector<String> arguments;
+    Vector<String> environment;
+    if (!copy_string_list_from_user(params->argv, arguments) || !copy_string_list_from_user(params->envp, environment))
+        return -EFAULT;
+    if (arguments.is_empty())
+        arguments.append(path.split('/').last());
+
+    posix_spawnattr_t attr;
+    memset(&attr, 0, sizeof(attr));
+    if (params->attr) {
+        if (!validate_read_typed(params->attr))
             return -EFAULT;
-        for (size_t i = 0; argv[i]; ++i) {
-            if (!validate_read_str(argv[i]))
-                return -EFAULT;
-        }
+        attr = *params->attr;
+        if (attr.pgroup < 0)
+            return -EINVAL;
     }
-    if (envp) {
-        if (!validate_read_typed(envp))
+
+    const posix_spawn_file_action* file_actions = nullptr;
+    int file_action_count = 0;
+    if (params->file_actions) {
+        if (!validate_read_typed(params->file_actions))
+            return -EFAULT;
+        file_actions = params->file_actions->actions;
+        file_action_count = params->file_actions->count;
+        if (file_action_count < 0)
+            return -EINVAL;
+        if (file_action_count && !validate_read(file_actions, file_action_count * sizeof(posix_spawn_file_action)))
             return -EFAULT;
-        for (size_t i = 0; envp[i]; ++i) {
-            if (!validate_read_str(envp[i]))
+        for (int i = 0; i < file_action_count; ++i) {
+            if (file_actions[i].type == POSIX_SPAWN_FILE_ACTION_OPEN && !validate_read_str(file_actions[i].path))
                 return -EFAULT;
         }
     }
 
-    String path(filename);
-    Vector<String> arguments;
-    Vector<String> environment;
-    {
-        auto parts = path.split('/');
-        if (argv) {
-            for (size_t i = 0; argv[i]; ++i) {
-                arguments.append(argv[i]);
-            }
-        } else {
-            arguments.append(parts.last());
+    // Unlike fork() + exec(), none of our address space is cloned only to be thrown away:
+    // the child starts out with our descriptors and credentials and an empty page directory,
+    // and exec() loads the new program straight into it.
+    auto* child = new Process(String(m_name), m_uid, m_gid, m_pid, Ring3, m_cwd, nullptr, m_tty, this);
+    for (auto gid : m_gids)
+        child->m_gids.set(gid);
+    if (!(attr.flags & POSIX_SPAWN_RESETIDS)) {
+        child->m_euid = m_euid;
+        child->m_egid = m_egid;
+    }
+
+    if (attr.flags & POSIX_SPAWN_SETPGROUP) {
+        InterruptDisabler disabler;
+        pid_t new_pgid = attr.pgroup ? attr.pgroup : child->m_pid;
+        if (get_sid_from_pgid(new_pgid) != get_sid_from_pgid(child->m_pgid) && new_pgid != child->m_pid) {
+            // Can't move a process between sessions.
+            delete child;
+            return -EPERM;
         }
+        child->m_pgid = new_pgid;
+    }
 
-        if (envp) {
-            for (size_t i = 0; envp[i]; ++i)
-                environment.append(envp[i]);
+    for (int i = 0; i < file_action_count; ++i) {
+        auto result = child->apply_spawn_file_action(file_actions[i]);
+        if (result.is_error()) {
+            delete child;
+            return result;
         }
     }
 
-    int rc = exec(move(path), move(arguments), move(environment));
-    ASSERT(rc < 0); // We should never continue after a successful exec!
-    return rc;
+    // NOTE: exec() already resets every signal disposition to the default, which takes
+    //       care of POSIX_SPAWN_SETSIGDEF. The signal mask has to be passed in, since the
+    //       child's thread is runnable by the time exec() returns.
+    u32 signal_mask = (attr.flags & POSIX_SPAWN_SETSIGMASK) ? attr.sigmask : 0;
+    int rc = child->exec(move(path), move(arguments), move(environment), signal_mask);
+    if (rc < 0) {
+        delete child;
+        return rc;
+    }
+
+    pid_t child_pid = child->pid();
+    {
+        InterruptDisabler disabler;
+        g_processes->prepend(child);
+    }
+#ifdef TASK_DEBUG
+    kprintf("Process %u (%s) spawned by %u @ %p\n", child_pid, child->name().characters(), m_pid, child->main_thread().tss().eip);
+#endif
+    return child_pid;
 }
 
 Process* Process::create_user_process(const String& path, uid_t uid, gid_t gid, pid_t parent_pid, int& error, Vector<String>&& arguments, Vector<String>&& environment, TTY* tty)
@@ -864,20 +1055,39 @@ int Process::sys$ptsname_r(int fd, char* buffer, ssize_t size)
     return 0;
 }
 
-ssize_t Process::sys$writev(int fd, const struct iovec* iov, int iov_count)
+KResult Process::validate_iovecs(const iovec* iov, int iov_count, IOVecAccess access)
 {
     if (iov_count < 0)
-        return -EINVAL;
-
+        return KResult(-EINVAL);
     if (!validate_read_typed(iov, iov_count))
-        return -EFAULT;
+        return KResult(-EFAULT);
+    u64 total_length = 0;
+    for (int i = 0; i < iov_count; ++i) {
+        total_length += iov[i].iov_len;
+        if (total_length > 0x7fffffff)
+            return KResult(-EINVAL);
+        bool valid = access == IOVecAccess::Read ? validate_read(iov[i].iov_base, iov[i].iov_len) : validate_write(iov[i].iov_base, iov[i].iov_len);
+        if (!valid)
+            return KResult(-EFAULT);
+    }
+    return KSuccess;
+}
 
-    // FIXME: Return EINVAL if sum of iovecs is greater than INT_MAX
+ssize_t Process::sys$writev(int fd, const struct iovec* iov, int iov_count)
+{
+    auto result = validate_iovecs(iov, iov_count, IOVecAccess::Read);
+    if (result.is_error())
+        return result;
 
     auto* description = file_description(fd);
     if (!description)
         return -EBADF;
 
+    // Local sockets take the whole vector at once, so that IPC messages made up of a
+    // header and a payload are never torn apart by a full buffer.
+    if (description->is_socket() && description->socket()->is_local())
+        return static_cast<LocalSocket*>(description->socket())->writev(*description, iov, iov_count);
+
     int nwritten = 0;
     for (int i = 0; i < iov_count; ++i) {
         int rc = do_write(*description, (const u8*)iov[i].iov_base, iov[i].iov_len);
@@ -899,6 +1109,68 @@ ssize_t Process::sys$writev(int fd, const struct iovec* iov, int iov_count)
     return nwritten;
 }
 
+ssize_t Process::sys$sendfile(const Syscall::SC_sendfile_params* params)
+{
+    if (!validate_read_typed(params))
+        return -EFAULT;
+    int out_fd = params->out_fd;
+    int in_fd = params->in_fd;
+    off_t* user_offset = params->offset;
+    size_t count = params->count;
+
+    if (user_offset && (!validate_read_typed(user_offset) || !validate_write_typed(user_offset)))
+        return -EFAULT;
+
+    auto* in_description = file_description(in_fd);
+    auto* out_description = file_description(out_fd);
+    if (!in_description || !out_description)
+        return -EBADF;
+
+    // The source has to be a regular file so we can read straight from its inode
+    // (and thereby the block cache) without going through the description's offset.
+    auto* inode = in_description->inode();
+    if (!inode || !inode->metadata().is_regular_file())
+        return -EINVAL;
+
+    off_t offset = user_offset ? *user_offset : in_description->offset();
+    if (offset < 0)
+        return -EINVAL;
+
+    // Data is shuttled through a single kernel page, one page at a time. This keeps each
+    // write small enough for a socket to send in one go, and never touches userspace.
+    auto buffer = KBuffer::create_with_size(PAGE_SIZE);
+    ssize_t total_written = 0;
+    while ((size_t)total_written < count) {
+        ssize_t chunk_size = min((size_t)PAGE_SIZE, count - total_written);
+        ssize_t nread = inode->read_bytes(offset + total_written, chunk_size, buffer.data(), in_description);
+        if (nread < 0) {
+            if (total_written == 0)
+                return nread;
+            break;
+        }
+        if (nread == 0)
+            break;
+        ssize_t nwritten = do_write(*out_description, buffer.data(), nread);
+        if (nwritten < 0) {
+            if (total_written == 0)
+                return nwritten;
+            break;
+        }
+        total_written += nwritten;
+        if (nwritten < nread)
+            break;
+        if (current->has_unmasked_pending_signals())
+            break;
+    }
+
+    if (user_offset)
+        *user_offset = offset + total_written;
+    else
+        in_description->seek(offset + total_written, SEEK_SET);
+
+    return total_written;
+}
+
 ssize_t Process::do_write(FileDescription& description, const u8* data, int data_size)
 {
     ssize_t nwritten = 0;
@@ -919,6 +1191,8 @@ ssize_t Process::do_write(FileDescription& description, const u8* data, int data
         dbgprintf("while %u < %u\n", nwritten, size);
 #endif
         if (!description.can_write()) {
+            if (!description.is_blocking())
+                break;
 #ifdef IO_DEBUG
             dbgprintf("block write on %d\n", fd);
 #endif
@@ -996,6 +1270,79 @@ ssize_t Process::sys$read(int fd, u8* buffer, ssize_t size)
     return description->read(buffer, size);
 }
 
+ssize_t Process::sys$readv(int fd, const struct iovec* iov, int iov_count)
+{
+    auto result = validate_iovecs(iov, iov_count, IOVecAccess::Write);
+    if (result.is_error())
+        return result;
+    auto* description = file_description(fd);
+    if (!description)
+        return -EBADF;
+    if (description->is_blocking()) {
+        if (!description->can_read()) {
+            if (current->block<Thread::ReadBlocker>(*description) == Thread::BlockResult::InterruptedBySignal)
+                return -EINTR;
+        }
+    }
+    return description->readv(iov, iov_count);
+}
+
+ssize_t Process::sys$pread(const Syscall::SC_pread_params* params)
+{
+    if (!validate_read_typed(params))
+        return -EFAULT;
+    if (params->count < 0)
+        return -EINVAL;
+    if (!validate_write(params->buffer, params->count))
+        return -EFAULT;
+    auto* description = file_description(params->fd);
+    if (!description)
+        return -EBADF;
+    iovec iov { params->buffer, (size_t)params->count };
+    return description->preadv(params->offset, &iov, 1);
+}
+
+ssize_t Process::sys$pwrite(const Syscall::SC_pwrite_params* params)
+{
+    if (!validate_read_typed(params))
+        return -EFAULT;
+    if (params->count < 0)
+        return -EINVAL;
+    if (!validate_read(params->data, params->count))
+        return -EFAULT;
+    auto* description = file_description(params->fd);
+    if (!description)
+        return -EBADF;
+    iovec iov { const_cast<void*>(params->data), (size_t)params->count };
+    return description->pwritev(params->offset, &iov, 1);
+}
+
+ssize_t Process::sys$preadv(const Syscall::SC_preadv_params* params)
+{
+    if (!validate_read_typed(params))
+        return -EFAULT;
+    auto result = validate_iovecs(params->iov, params->iov_count, IOVecAccess::Write);
+    if (result.is_error())
+        return result;
+    auto* description = file_description(params->fd);
+    if (!description)
+        return -EBADF;
+    return description->preadv(params->offset, params->iov, params->iov_count);
+}
+
+ssize_t Process::sys$pwritev(const Syscall::SC_pwritev_params* params)
+{
+    if (!validate_read_typed(params))
+        return -EFAULT;
+    auto result = validate_iovecs(params->iov, params->iov_count, IOVecAccess::Read);
+    if (result.is_error())
+        return result;
+    auto* description = file_description(params->fd);
+    if (!description)
+        return -EBADF;
+    return description->pwritev(params->offset, params->iov, params->iov_count);
+}
+
 int Process::sys$close(int fd)
 {
     auto* description = file_description(fd);
@@ -1371,6 +1718,21 @@ int Process::sys$gettimeofday(timeval* tv)
     return 0;
 }
 
+u32 Process::sys$get_time_page()
+{
+    return SharedTimePage::user_address().get();
+}
+
+int Process::sys$set_thread_pointer(RegisterDump& regs, void* thread_pointer)
+{
+    if (!thread_pointer || !validate_read(thread_pointer, sizeof(void*)))
+        return -EFAULT;
+    current->set_thread_pointer((u32)thread_pointer);
+    // Point %gs at it when we return to userspace.
+    regs.gs = Thread::thread_pointer_selector();
+    return Thread::thread_pointer_selector();
+}
+
 uid_t Process::sys$getuid()
 {
     return m_uid;
@@ -2067,6 +2429,12 @@ void Process::finalize()
     m_cwd = nullptr;
     m_elf_loader = nullptr;
 
+    if (m_is_sharing_address_space_with_parent) {
+        // A vfork() child that died without exec'ing; the regions were never ours.
+        m_regions.clear();
+        m_is_sharing_address_space_with_parent = false;
+    }
+
     disown_all_shared_buffers();
     {
         InterruptDisabler disabler;
@@ -2719,6 +3087,84 @@ int Process::sys$watch_file(const char* path, int path_length)
     return fd;
 }
 
+int Process::sys$epoll_create(int flags)
+{
+    if ((flags & EPOLL_CLOEXEC) != flags)
+        return -EINVAL;
+
+    int fd = alloc_fd();
+    if (fd < 0)
+        return fd;
+
+    u32 fd_flags = (flags & EPOLL_CLOEXEC) ? FD_CLOEXEC : 0;
+    m_fds[fd].set(FileDescription::create(*EventPoll::create()), fd_flags);
+    return fd;
+}
+
+int Process::sys$epoll_ctl(const Syscall::SC_epoll_ctl_params* params)
+{
+    if (!validate_read_typed(params))
+        return -EFAULT;
+    auto* epoll_description = file_description(params->epfd);
+    auto* description = file_description(params->fd);
+    if (!epoll_description || !description)
+        return -EBADF;
+    if (!epoll_description->file().is_event_poll())
+        return -EINVAL;
+    auto& event_poll = static_cast<EventPoll&>(epoll_description->file());
+
+    if (params->op == EPOLL_CTL_DEL)
+        return event_poll.remove(params->fd, *description);
+
+    if (!validate_read_typed(params->event))
+        return -EFAULT;
+    switch (params->op) {
+    case EPOLL_CTL_ADD:
+        return event_poll.add(params->fd, *description, *params->event);
+    case EPOLL_CTL_MOD:
+        return event_poll.modify(params->fd, *description, *params->event);
+    default:
+        return -EINVAL;
+    }
+}
+
+int Process::sys$epoll_wait(const Syscall::SC_epoll_wait_params* params)
+{
+    if (!validate_read_typed(params))
+        return -EFAULT;
+    if (params->max_events <= 0)
+        return -EINVAL;
+    if ((size_t)params->max_events > 0x7fffffff / sizeof(epoll_event))
+        return -EINVAL;
+    if (!validate_write(params->events, params->max_events * sizeof(epoll_event)))
+        return -EFAULT;
+    auto* epoll_description = file_description(params->epfd);
+    if (!epoll_description)
+        return -EBADF;
+    if (!epoll_description->file().is_event_poll())
+        return -EINVAL;
+    // Keep the interest set alive even if another thread closes the descriptor while we sleep.
+    NonnullRefPtr<EventPoll> event_poll = static_cast<EventPoll&>(epoll_description->file());
+
+    if (params->timeout != 0 && !event_poll->has_ready_events()) {
+        bool has_deadline = params->timeout > 0;
+        u64 deadline = g_uptime + (u64)max(params->timeout, 0) * TICKS_PER_SECOND / 1000;
+        // FIXME: Files have no way to tell us when their readiness changes, so this still
+        //        re-checks the registered descriptions on every tick. It is, however, only
+        //        the ones the caller registered, without rebuilding anything per call.
+        auto result = current->block_until("Polling", [&] {
+            return event_poll->has_ready_events() || (has_deadline && g_uptime >= deadline);
+        });
+        if (result == Thread::BlockResult::InterruptedBySignal)
+            return -EINTR;
+    }
+
+    Vector<epoll_event> events;
+    event_poll->collect_ready_events(events, params->max_events);
+    memcpy(params->events, events.data(), events.size() * sizeof(epoll_event));
+    return events.size();
+}
+
 int Process::sys$systrace(pid_t pid)
 {
     InterruptDisabler disabler;
@@ -2735,6 +3181,70 @@ int Process::sys$systrace(pid_t pid)
     return fd;
 }
 
+int Process::sys$profiling_enable(pid_t pid)
+{
+    InterruptDisabler disabler;
+    auto* peer = Process::from_pid(pid);
+    if (!peer)
+        return -ESRCH;
+    if (!is_superuser() && peer->uid() != m_euid)
+        return -EPERM;
+    if (!peer->m_profile_buffer)
+        peer->m_profile_buffer = make<ProfileBuffer>();
+    else
+        peer->m_profile_buffer->clear();
+    peer->m_profiling = true;
+    return 0;
+}
+
+int Process::sys$profiling_disable(pid_t pid)
+{
+    InterruptDisabler disabler;
+    auto* peer = Process::from_pid(pid);
+    if (!peer)
+        return -ESRCH;
+    if (!is_superuser() && peer->uid() != m_euid)
+        return -EPERM;
+    if (!peer->m_profiling)
+        return -EINVAL;
+    // The samples stay around until the process goes away, so they can still be read.
+    peer->m_profiling = false;
+    return 0;
+}
+
+void SyscallStatistics::add(u64 cycles)
+{
+    ++call_count;
+    total_cycles += cycles;
+    if (cycles > max_cycles)
+        max_cycles = cycles;
+
+    u32 high = cycles >> 32;
+    u32 low = cycles;
+    int log2 = 0;
+    if (high)
+        log2 = 63 - __builtin_clz(high);
+    else if (low)
+        log2 = 31 - __builtin_clz(low);
+    int bucket = log2 - histogram_first_bucket_log2;
+    if (bucket < 0)
+        bucket = 0;
+    if (bucket >= histogram_bucket_count)
+        bucket = histogram_bucket_count - 1;
+    ++histogram[bucket];
+}
+
+void Process::did_syscall(u32 function, u64 cycles)
+{
+    ++m_syscall_count;
+    if (function >= (u32)Syscall::function_count)
+        return;
+    auto& statistics = m_syscall_statistics[function];
+    if (!statistics)
+        statistics = make<SyscallStatistics>();
+    statistics->add(cycles);
+}
+
 int Process::sys$halt()
 {
     if (!is_superuser())
@@ -2931,3 +3441,52 @@ int Process::sys$get_process_name(char* buffer, int buffer_size)
     return 0;
 }
 
+
+int Process::sys$futex(const Syscall::SC_futex_params* params)
+{
+    if (!validate_read_typed(params))
+        return -EFAULT;
+    if ((u32)params->userspace_address & 3)
+        return -EINVAL;
+    if (!validate_read_typed(params->userspace_address))
+        return -EFAULT;
+    VirtualAddress address((u32)params->userspace_address);
+
+    switch (params->futex_op) {
+    case FUTEX_WAIT: {
+        u64 deadline = 0;
+        if (params->timeout) {
+            if (!validate_read_typed(params->timeout))
+                return -EFAULT;
+            auto& timeout = *params->timeout;
+            if (timeout.tv_nsec < 0 || timeout.tv_nsec >= 1000000000)
+                return -EINVAL;
+            // Round up to the next tick, so that we never wake up early.
+            u64 ticks = (u64)timeout.tv_sec * TICKS_PER_SECOND + ((u64)timeout.tv_nsec * TICKS_PER_SECOND + 999999999) / 1000000000;
+            deadline = g_uptime + max(ticks, (u64)1);
+        }
+        // Both this check and the enqueueing below happen under the big lock, so a
+        // FUTEX_WAKE from another thread can't slip in between them and get lost.
+        if (*params->userspace_address != params->val)
+            return -EAGAIN;
+        bool woken = false;
+        auto result = current->block<Thread::FutexBlocker>(address, deadline, woken);
+        if (woken)
+            return 0;
+        if (result == Thread::BlockResult::InterruptedBySignal)
+            return -EINTR;
+        return -ETIMEDOUT;
+    }
+    case FUTEX_WAKE:
+        return FutexTable::wake(*this, address, params->val);
+    case FUTEX_REQUEUE: {
+        if ((u32)params->userspace_address2 & 3)
+            return -EINVAL;
+        if (!validate_read_typed(params->userspace_address2))
+            return -EFAULT;
+        VirtualAddress address2((u32)params->userspace_address2);
+        return FutexTable::requeue(*this, address, params->val, address2, params->val2);
+    }
+    }
+    return -ENOSYS;
+}
@@ -23,6 +23,7 @@ class PageDirectory;
 class Region;
 class VMObject;
 class ProcessTracer;
+class ProfileBuffer;
 class SharedBuffer;
 
 timeval kgettimeofday();
@@ -31,6 +32,22 @@ void kgettimeofday(timeval&);
 extern VirtualAddress g_return_to_ring3_from_signal_trampoline;
 extern VirtualAddress g_return_to_ring0_from_signal_trampoline;
 
+// How many times a process made one particular syscall, and how long those calls took
+// (in TSC cycles, from entering the kernel to leaving it, including any time spent blocked.)
+// Bucket N of the histogram counts the calls that took [2^(N + 8), 2^(N + 9)) cycles, except
+// that the first and last buckets also catch everything below and above them.
+struct SyscallStatistics {
+    static const int histogram_bucket_count = 20;
+    static const int histogram_first_bucket_log2 = 8;
+
+    void add(u64 cycles);
+
+    u32 call_count { 0 };
+    u64 total_cycles { 0 };
+    u64 max_cycles { 0 };
+    u32 histogram[histogram_bucket_count] {};
+};
+
 class Process : public InlineLinkedListNode<Process>
     , public Weakable<Process> {
     friend class InlineLinkedListNode<Process>;
@@ -135,6 +152,15 @@ public:
     ssize_t sys$read(int fd, u8*, ssize_t);
     ssize_t sys$write(int fd, const u8*, ssize_t);
     ssize_t sys$writev(int fd, const struct iovec* iov, int iov_count);
+    ssize_t sys$readv(int fd, const struct iovec* iov, int iov_count);
+    ssize_t sys$pread(const Syscall::SC_pread_params*);
+    ssize_t sys$pwrite(const Syscall::SC_pwrite_params*);
+    ssize_t sys$preadv(const Syscall::SC_preadv_params*);
+    ssize_t sys$pwritev(const Syscall::SC_pwritev_params*);
+    ssize_t sys$sendfile(const Syscall::SC_sendfile_params*);
+    int sys$epoll_create(int flags);
+    int sys$epoll_ctl(const Syscall::SC_epoll_ctl_params*);
+    int sys$epoll_wait(const Syscall::SC_epoll_wait_params*);
     int sys$fstat(int fd, stat*);
     int sys$lstat(const char*, stat*);
     int sys$stat(const char*, stat*);
@@ -147,6 +173,7 @@ public:
     int sys$munmap(void*, size_t size);
     int sys$set_mmap_name(void*, size_t, const char*);
     int sys$mprotect(void*, size_t, int prot);
+    int sys$madvise(void*, size_t, int advice);
     int sys$select(const Syscall::SC_select_params*);
     int sys$poll(pollfd*, int nfds, int timeout);
     ssize_t sys$get_dir_entries(int fd, void*, ssize_t);
@@ -161,6 +188,9 @@ public:
     int sys$ttyname_r(int fd, char*, ssize_t);
     int sys$ptsname_r(int fd, char*, ssize_t);
     pid_t sys$fork(RegisterDump&);
+    pid_t sys$vfork(RegisterDump&);
+    pid_t sys$posix_spawn(const Syscall::SC_posix_spawn_params*);
+    int sys$futex(const Syscall::SC_futex_params*);
     int sys$execve(const char* filename, const char** argv, const char** envp);
     int sys$isatty(int fd);
     int sys$getdtablesize();
@@ -211,6 +241,10 @@ public:
     void sys$exit_thread(int code);
     int sys$rename(const char* oldpath, const char* newpath);
     int sys$systrace(pid_t);
+    int sys$profiling_enable(pid_t);
+    int sys$profiling_disable(pid_t);
+    u32 sys$get_time_page();
+    int sys$set_thread_pointer(RegisterDump&, void*);
     int sys$mknod(const char* pathname, mode_t, dev_t);
     int sys$create_shared_buffer(int, void** buffer);
     int sys$share_buffer_with(int, pid_t peer_pid);
@@ -239,6 +273,9 @@ public:
     ProcessTracer* tracer() { return m_tracer.ptr(); }
     ProcessTracer& ensure_tracer();
 
+    bool is_profiling() const { return m_profiling; }
+    ProfileBuffer* profile_buffer() { return m_profile_buffer.ptr(); }
+
     u32 m_ticks_in_user { 0 };
     u32 m_ticks_in_kernel { 0 };
 
@@ -265,13 +302,16 @@ public:
     size_t amount_resident() const;
     size_t amount_shared() const;
 
-    Process* fork(RegisterDump&);
-    int exec(String path, Vector<String> arguments, Vector<String> environment);
+    enum class ShouldShareAddressSpace {
+        No,
+        Yes,
+    };
+    Process* fork(RegisterDump&, ShouldShareAddressSpace = ShouldShareAddressSpace::No);
+    int exec(String path, Vector<String> arguments, Vector<String> environment, u32 signal_mask = 0);
 
     bool is_superuser() const { return m_euid == 0; }
 
     Region* allocate_region_with_vmo(VirtualAddress, size_t, NonnullRefPtr<VMObject>, size_t offset_in_vmo, const String& name, int prot);
-    Region* allocate_file_backed_region(VirtualAddress, size_t, NonnullRefPtr<Inode>, const String& name, int prot);
     Region* allocate_region(VirtualAddress, size_t, const String& name, int prot = PROT_READ | PROT_WRITE, bool commit = true);
     bool deallocate_region(Region& region);
 
@@ -286,7 +326,8 @@ public:
     Lock& big_lock() { return m_big_lock; }
 
     unsigned syscall_count() const { return m_syscall_count; }
-    void did_syscall() { ++m_syscall_count; }
+    void did_syscall(u32 function, u64 cycles);
+    const SyscallStatistics* syscall_statistics(int function) const { return m_syscall_statistics[function].ptr(); }
 
     const ELFLoader* elf_loader() const { return m_elf_loader.ptr(); }
 
@@ -301,10 +342,17 @@ private:
 
     Range allocate_range(VirtualAddress, size_t);
 
-    int do_exec(String path, Vector<String> arguments, Vector<String> environment);
+    int do_exec(String path, Vector<String> arguments, Vector<String> environment, u32 signal_mask);
     ssize_t do_write(FileDescription&, const u8*, int data_size);
 
     int alloc_fd(int first_candidate_fd = 0);
+    bool copy_string_list_from_user(const char** list, Vector<String>&);
+    KResult apply_spawn_file_action(const posix_spawn_file_action&);
+    enum class IOVecAccess {
+        Read,
+        Write,
+    };
+    KResult validate_iovecs(const iovec*, int iov_count, IOVecAccess);
     void disown_all_shared_buffers();
 
     Thread* m_main_thread { nullptr };
@@ -342,6 +390,9 @@ private:
 
     bool m_being_inspected { false };
     bool m_dead { false };
+    // Set for a vfork() child that is still running on its parent's page directory
+    // and regions. The parent stays blocked until this is cleared by exec() or death.
+    bool m_is_sharing_address_space_with_parent { false };
 
     RefPtr<Custody> m_executable;
     RefPtr<Custody> m_cwd;
@@ -362,10 +413,14 @@ private:
     int m_next_tid { 0 };
 
     unsigned m_syscall_count { 0 };
+    OwnPtr<SyscallStatistics> m_syscall_statistics[Syscall::function_count];
 
     RefPtr<ProcessTracer> m_tracer;
     OwnPtr<ELFLoader> m_elf_loader;
 
+    bool m_profiling { false };
+    OwnPtr<ProfileBuffer> m_profile_buffer;
+
     Lock m_big_lock { "Process" };
 
     u64 m_alarm_deadline { 0 };
@@ -0,0 +1,71 @@
+#include <Kernel/Arch/i386/CPU.h>
+#include <Kernel/ProfileBuffer.h>
+#include <Kernel/Process.h>
+#include <Kernel/Scheduler.h>
+#include <Kernel/VM/MemoryManager.h>
+
+static const size_t profile_buffer_size = 512 * KB;
+
+ProfileBuffer::ProfileBuffer()
+{
+    m_region = MM.allocate_kernel_region(profile_buffer_size, "Profile buffer");
+    m_capacity = profile_buffer_size / sizeof(Sample);
+}
+
+ProfileBuffer::~ProfileBuffer()
+{
+}
+
+ProfileBuffer::Sample& ProfileBuffer::sample_at(size_t index)
+{
+    return reinterpret_cast<Sample*>(m_region->vaddr().as_ptr())[index];
+}
+
+const ProfileBuffer::Sample& ProfileBuffer::sample_at(size_t index) const
+{
+    return reinterpret_cast<const Sample*>(m_region->vaddr().as_ptr())[index];
+}
+
+void ProfileBuffer::clear()
+{
+    InterruptDisabler disabler;
+    m_head = 0;
+    m_count = 0;
+    m_lost_count = 0;
+}
+
+void ProfileBuffer::record(Thread& thread, const RegisterDump& regs)
+{
+    ASSERT_INTERRUPTS_DISABLED();
+    if (m_paused)
+        return;
+
+    auto& sample = sample_at(m_head);
+    sample.timestamp = (u32)g_uptime;
+    sample.tid = thread.tid();
+    sample.frames[0] = regs.eip;
+    sample.frame_count = 1;
+
+    // User code controls its own frame pointer, so don't let it point us at kernel memory
+    // that would then show up in the profile.
+    bool is_user_mode = regs.cs & 3;
+    u32 frame_pointer = regs.ebp;
+    while (sample.frame_count < max_frame_count) {
+        if (!MM.can_read_without_faulting(thread.process(), VirtualAddress(frame_pointer), 2 * sizeof(u32), is_user_mode))
+            break;
+        auto* frame = reinterpret_cast<const u32*>(frame_pointer);
+        if (!frame[1])
+            break;
+        sample.frames[sample.frame_count++] = frame[1];
+        // Callers' frames are further up the stack. Anything else is garbage, or a loop.
+        if (frame[0] <= frame_pointer)
+            break;
+        frame_pointer = frame[0];
+    }
+
+    m_head = (m_head + 1) % m_capacity;
+    if (m_count < m_capacity)
+        ++m_count;
+    else
+        ++m_lost_count;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <AK/RefPtr.h>
+#include <AK/Types.h>
+
+class Region;
+class Thread;
+struct RegisterDump;
+
+// The samples taken by the timer interrupt while a process is being profiled. Each one is
+// the interrupted EIP plus whatever return addresses we can find by following the frame
+// pointer chain. The buffer is a fixed-size ring, so a long profile keeps its most
+// recent samples. It's allocated up front since samples are recorded from the timer
+// interrupt, where we can't take page faults.
+class ProfileBuffer {
+public:
+    static const size_t max_frame_count = 29;
+
+    struct Sample {
+        u32 timestamp;
+        int tid;
+        u32 frame_count;
+        u32 frames[max_frame_count];
+    };
+
+    ProfileBuffer();
+    ~ProfileBuffer();
+
+    void record(Thread&, const RegisterDump&);
+    void clear();
+
+    size_t sample_count() const { return m_count; }
+    size_t lost_sample_count() const { return m_lost_count; }
+
+    // Keeps the timer interrupt from recording into the buffer while it's being read.
+    void set_paused(bool paused) { m_paused = paused; }
+
+    template<typename Callback>
+    void for_each_sample(Callback callback) const
+    {
+        size_t first = (m_head + m_capacity - m_count) % m_capacity;
+        for (size_t i = 0; i < m_count; ++i)
+            callback(sample_at((first + i) % m_capacity));
+    }
+
+private:
+    Sample& sample_at(size_t index);
+    const Sample& sample_at(size_t index) const;
+
+    RefPtr<Region> m_region;
+    size_t m_capacity { 0 };
+    size_t m_head { 0 };
+    size_t m_count { 0 };
+    size_t m_lost_count { 0 };
+    bool m_paused { false };
+};
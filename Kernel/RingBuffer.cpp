@@ -0,0 +1,43 @@
+#include <AK/StdLibExtras.h>
+#include <Kernel/RingBuffer.h>
+
+RingBuffer::RingBuffer(size_t capacity)
+    : m_capacity(capacity)
+{
+    ASSERT(capacity && !(capacity & (capacity - 1)));
+}
+
+ssize_t RingBuffer::write(const u8* data, ssize_t size)
+{
+    if (!size)
+        return 0;
+    LOCKER(m_write_lock);
+    if (!m_storage.has_value())
+        m_storage = KBuffer::create_with_size(m_capacity);
+
+    u32 tail = m_tail;
+    ssize_t nwritten = min((ssize_t)space_available(), size);
+    size_t offset = tail & (m_capacity - 1);
+    size_t first_chunk = min((size_t)nwritten, m_capacity - offset);
+    memcpy(m_storage.value().data() + offset, data, first_chunk);
+    memcpy(m_storage.value().data(), data + first_chunk, nwritten - first_chunk);
+    m_tail = tail + nwritten;
+    return nwritten;
+}
+
+ssize_t RingBuffer::read(u8* data, ssize_t size)
+{
+    if (!size)
+        return 0;
+    LOCKER(m_read_lock);
+    u32 head = m_head;
+    ssize_t nread = min((ssize_t)(m_tail - head), size);
+    if (!nread)
+        return 0;
+    size_t offset = head & (m_capacity - 1);
+    size_t first_chunk = min((size_t)nread, m_capacity - offset);
+    memcpy(data, m_storage.value().data() + offset, first_chunk);
+    memcpy(data + first_chunk, m_storage.value().data(), nread - first_chunk);
+    m_head = head + nread;
+    return nread;
+}
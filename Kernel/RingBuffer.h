@@ -0,0 +1,41 @@
+#pragma once
+
+#include <AK/Optional.h>
+#include <AK/Types.h>
+#include <Kernel/KBuffer.h>
+#include <Kernel/Lock.h>
+
+// A fixed-capacity byte queue between one producer and one consumer.
+// The producer only ever advances the tail and the consumer only ever advances the head,
+// so the two ends never wait for each other. Each byte is copied exactly once on the way
+// in and once on the way out, and the storage never moves or grows.
+// If several threads share an end (e.g. through a shared descriptor), they take turns
+// through a per-end lock.
+class RingBuffer {
+public:
+    // The capacity must be a power of two. Storage is allocated on the first write,
+    // since plenty of sockets never carry any data in one direction.
+    explicit RingBuffer(size_t capacity);
+
+    // Both of these transfer as much as they can without blocking and return the count.
+    ssize_t write(const u8*, ssize_t);
+    ssize_t read(u8*, ssize_t);
+
+    bool is_empty() const { return m_head == m_tail; }
+    size_t capacity() const { return m_capacity; }
+    size_t used_bytes() const { return m_tail - m_head; }
+    size_t space_available() const { return m_capacity - used_bytes(); }
+
+private:
+    size_t m_capacity { 0 };
+    Optional<KBuffer> m_storage;
+
+    // Free-running positions; the difference is the number of queued bytes.
+    // FIXME: volatile is enough to order these against the buffer accesses on a single
+    //        x86 CPU. This will need proper barriers once we run on more than one.
+    volatile u32 m_head { 0 };
+    volatile u32 m_tail { 0 };
+
+    Lock m_write_lock { "RingBuffer:write" };
+    Lock m_read_lock { "RingBuffer:read" };
+};
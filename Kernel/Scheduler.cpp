@@ -2,9 +2,13 @@
 #include <Kernel/Arch/i386/PIT.h>
 #include <Kernel/Devices/PCSpeaker.h>
 #include <Kernel/FileSystem/FileDescription.h>
+#include <Kernel/FutexTable.h>
 #include <Kernel/Process.h>
+#include <Kernel/ProfileBuffer.h>
 #include <Kernel/RTC.h>
 #include <Kernel/Scheduler.h>
+#include <Kernel/SharedTimePage.h>
+#include <Kernel/Trace.h>
 
 SchedulerData* g_scheduler_data;
 
@@ -215,6 +219,25 @@ bool Thread::WaitBlocker::should_unblock(Thread& thread, time_t, long)
     return should_unblock;
 }
 
+Thread::FutexBlocker::FutexBlocker(VirtualAddress address, u64 deadline, bool& woken)
+    : m_thread(*current)
+    , m_address(address)
+    , m_deadline(deadline)
+    , m_woken(woken)
+{
+    FutexTable::enqueue(*this);
+}
+
+Thread::FutexBlocker::~FutexBlocker()
+{
+    FutexTable::dequeue(*this);
+}
+
+bool Thread::FutexBlocker::should_unblock(Thread&, time_t, long)
+{
+    return m_woken || (m_deadline && g_uptime >= m_deadline);
+}
+
 Thread::SemiPermanentBlocker::SemiPermanentBlocker(Reason reason)
     : m_reason(reason)
 {}
@@ -427,9 +450,15 @@ bool Scheduler::context_switch(Thread& thread)
     thread.set_ticks_left(time_slice_for(thread.process().priority()));
     thread.did_schedule();
 
+    // Our esp0 can change while we're running (see Thread::dispatch_signal()), so update
+    // the sysenter stack even if we're not switching.
+    Syscall::set_sysenter_stack(thread.tss().esp0);
+
     if (current == &thread)
         return false;
 
+    Trace::event(TraceEventType::ContextSwitch, current ? current->tid() : 0, thread.tid());
+
     if (current) {
         // If the last process hasn't blocked (still marked as running),
         // mark it as runnable for the next round.
@@ -462,6 +491,9 @@ bool Scheduler::context_switch(Thread& thread)
 
     auto& descriptor = get_gdt_entry(thread.selector());
     descriptor.type = 11; // Busy TSS
+
+    // The task switch reloads %gs, so this has to be in place before we make it.
+    get_gdt_entry(Thread::thread_pointer_selector()).set_base((void*)thread.thread_pointer());
     flush_gdt();
     return true;
 }
@@ -520,12 +552,16 @@ void Scheduler::timer_tick(RegisterDump& regs)
         return;
 
     ++g_uptime;
+    SharedTimePage::update();
 
     if (s_beep_timeout && g_uptime > s_beep_timeout) {
         PCSpeaker::tone_off();
         s_beep_timeout = 0;
     }
 
+    if (current->process().is_profiling())
+        current->process().profile_buffer()->record(*current, regs);
+
     if (current->tick())
         return;
 
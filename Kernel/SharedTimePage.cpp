@@ -0,0 +1,80 @@
+#include <Kernel/Arch/i386/CPU.h>
+#include <Kernel/Arch/i386/PIT.h>
+#include <Kernel/RTC.h>
+#include <Kernel/SharedTimePage.h>
+#include <Kernel/TimePage.h>
+#include <Kernel/VM/MemoryManager.h>
+
+// How many ticks to count TSC cycles over before we trust the TSC for interpolation.
+#define CALIBRATION_TICKS 250
+
+static Region* s_kernel_region;
+static Region* s_user_region;
+static volatile TimePage* s_page;
+
+static u64 s_calibration_start_tsc;
+static u32 s_calibration_ticks;
+
+namespace SharedTimePage {
+
+void initialize()
+{
+    InterruptDisabler disabler;
+
+    // We write the page through a kernel-only mapping, and userspace reads it through
+    // a second, read-only mapping of the same physical page.
+    // NOTE: We leak these regions.
+    s_kernel_region = MM.allocate_kernel_region(PAGE_SIZE, "Time page").leak_ref();
+    s_user_region = MM.allocate_user_accessible_kernel_region_with_vmobject(s_kernel_region->vmo(), "Time page (user)", PROT_READ).leak_ref();
+
+    s_page = reinterpret_cast<volatile TimePage*>(s_kernel_region->vaddr().as_ptr());
+    s_page->sequence = 0;
+    s_page->boot_time = RTC::boot_time();
+    s_page->seconds_since_boot = PIT::seconds_since_boot();
+    s_page->ticks_this_second = PIT::ticks_this_second();
+    s_page->ticks_per_second = TICKS_PER_SECOND;
+    s_page->tsc_cycles_per_tick = 0;
+    s_page->tsc_to_microseconds = 0;
+    s_page->tsc_at_last_tick = read_tsc();
+}
+
+static void calibrate(u64 tsc)
+{
+    if (!s_calibration_ticks++) {
+        s_calibration_start_tsc = tsc;
+        return;
+    }
+    if (s_calibration_ticks <= CALIBRATION_TICKS)
+        return;
+
+    u32 microseconds_per_tick = 1000000 / TICKS_PER_SECOND;
+    u64 cycles_per_tick = (tsc - s_calibration_start_tsc) / CALIBRATION_TICKS;
+    // A TSC this slow (or this broken) isn't worth interpolating with.
+    if (cycles_per_tick <= microseconds_per_tick || cycles_per_tick > 0xffffffff)
+        return;
+    s_page->tsc_cycles_per_tick = cycles_per_tick;
+    s_page->tsc_to_microseconds = ((u64)microseconds_per_tick << 32) / cycles_per_tick;
+}
+
+void update()
+{
+    if (!s_page)
+        return;
+    u64 tsc = read_tsc();
+    ++s_page->sequence;
+    asm volatile("" ::: "memory");
+    s_page->seconds_since_boot = PIT::seconds_since_boot();
+    s_page->ticks_this_second = PIT::ticks_this_second();
+    s_page->tsc_at_last_tick = tsc;
+    if (s_calibration_ticks <= CALIBRATION_TICKS)
+        calibrate(tsc);
+    asm volatile("" ::: "memory");
+    ++s_page->sequence;
+}
+
+VirtualAddress user_address()
+{
+    return s_user_region->vaddr();
+}
+
+}
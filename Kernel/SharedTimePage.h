@@ -0,0 +1,15 @@
+#pragma once
+
+#include <Kernel/VM/VirtualAddress.h>
+
+namespace SharedTimePage {
+
+void initialize();
+
+// Called from the timer interrupt after the PIT has counted the tick.
+void update();
+
+// Where userspace can find the TimePage. It's the same in every process.
+VirtualAddress user_address();
+
+}
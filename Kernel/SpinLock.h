@@ -0,0 +1,41 @@
+#pragma once
+
+#include <AK/Types.h>
+
+// A lock that busy-waits instead of blocking. Unlike InterruptDisabler, this also keeps
+// out the other processors, so it's what code that can run on an AP has to use.
+// It doesn't disable interrupts by itself; take it with interrupts off if an interrupt
+// handler on the same processor might want it too.
+class SpinLock {
+public:
+    void lock()
+    {
+        while (__atomic_exchange_n(&m_lock, 1, __ATOMIC_ACQUIRE)) {
+            while (__atomic_load_n(&m_lock, __ATOMIC_RELAXED))
+                asm volatile("pause");
+        }
+    }
+
+    void unlock()
+    {
+        __atomic_store_n(&m_lock, 0, __ATOMIC_RELEASE);
+    }
+
+    bool is_locked() const { return __atomic_load_n(&m_lock, __ATOMIC_RELAXED); }
+
+private:
+    u32 m_lock { 0 };
+};
+
+class SpinLocker {
+public:
+    explicit SpinLocker(SpinLock& lock)
+        : m_lock(lock)
+    {
+        m_lock.lock();
+    }
+    ~SpinLocker() { m_lock.unlock(); }
+
+private:
+    SpinLock& m_lock;
+};
@@ -4,24 +4,36 @@
 
 extern "C" {
 
+// NOTE: The kernel doesn't save the SSE state of the thread it interrupted, so we can't
+//       use anything wider than general purpose registers in here. Instead we get the
+//       destination aligned and let rep movsl/stosl do the rest.
+
 void* memcpy(void* dest_ptr, const void* src_ptr, size_t n)
 {
     size_t dest = (size_t)dest_ptr;
     size_t src = (size_t)src_ptr;
-    // FIXME: Support starting at an unaligned address.
-    if (!(dest & 0x3) && !(src & 0x3) && n >= 12) {
+    if (n >= 12) {
+        size_t prologue = -dest & 0x3;
+        n -= prologue;
+        asm volatile(
+            "rep movsb\n"
+            : "=S"(src), "=D"(dest), "=c"(prologue)
+            : "0"(src), "1"(dest), "2"(prologue)
+            : "memory");
         size_t size_ts = n / sizeof(size_t);
         asm volatile(
             "rep movsl\n"
-            : "=S"(src), "=D"(dest)
-            : "S"(src), "D"(dest), "c"(size_ts)
+            : "=S"(src), "=D"(dest), "=c"(size_ts)
+            : "0"(src), "1"(dest), "2"(size_ts)
             : "memory");
-        n -= size_ts * sizeof(size_t);
+        n %= sizeof(size_t);
         if (n == 0)
             return dest_ptr;
     }
     asm volatile(
-        "rep movsb\n" ::"S"(src), "D"(dest), "c"(n)
+        "rep movsb\n"
+        : "=S"(src), "=D"(dest), "=c"(n)
+        : "0"(src), "1"(dest), "2"(n)
         : "memory");
     return dest_ptr;
 }
@@ -60,18 +72,24 @@ char* strncpy(char* dest, const char* src, size_t n)
 void* memset(void* dest_ptr, int c, size_t n)
 {
     size_t dest = (size_t)dest_ptr;
-    // FIXME: Support starting at an unaligned address.
-    if (!(dest & 0x3) && n >= 12) {
+    if (n >= 12) {
+        size_t prologue = -dest & 0x3;
+        n -= prologue;
+        asm volatile(
+            "rep stosb\n"
+            : "=D"(dest), "=c"(prologue)
+            : "0"(dest), "1"(prologue), "a"(c)
+            : "memory");
         size_t size_ts = n / sizeof(size_t);
         size_t expanded_c = (u8)c;
         expanded_c |= expanded_c << 8;
         expanded_c |= expanded_c << 16;
         asm volatile(
             "rep stosl\n"
-            : "=D"(dest)
-            : "D"(dest), "c"(size_ts), "a"(expanded_c)
+            : "=D"(dest), "=c"(size_ts)
+            : "0"(dest), "1"(size_ts), "a"(expanded_c)
             : "memory");
-        n -= size_ts * sizeof(size_t);
+        n %= sizeof(size_t);
         if (n == 0)
             return dest_ptr;
     }
@@ -94,12 +112,30 @@ char* strrchr(const char* str, int ch)
     return last;
 }
 
+// Nonzero if any byte in the word is zero.
+static inline u32 has_zero_byte(u32 word)
+{
+    return (word - 0x01010101) & ~word & 0x80808080;
+}
+
 size_t strlen(const char* str)
 {
-    size_t len = 0;
-    while (*(str++))
-        ++len;
-    return len;
+    // Look at a whole aligned word at a time once we get there. An aligned word never
+    // straddles a page boundary, so we can't fault by reading past the terminator.
+    const char* ptr = str;
+    for (; (size_t)ptr & 0x3; ++ptr) {
+        if (!*ptr)
+            return ptr - str;
+    }
+    for (;; ptr += sizeof(u32)) {
+        u32 word;
+        __builtin_memcpy(&word, ptr, sizeof(word));
+        if (has_zero_byte(word))
+            break;
+    }
+    while (*ptr)
+        ++ptr;
+    return ptr - str;
 }
 
 size_t strnlen(const char* str, size_t maxlen)
@@ -131,6 +167,16 @@ int memcmp(const void* v1, const void* v2, size_t n)
 {
     auto* s1 = (const u8*)v1;
     auto* s2 = (const u8*)v2;
+    // Skip over equal words, and let the byte loop below find where they differ.
+    for (; n >= sizeof(u32); n -= sizeof(u32)) {
+        u32 a, b;
+        __builtin_memcpy(&a, s1, sizeof(a));
+        __builtin_memcpy(&b, s2, sizeof(b));
+        if (a != b)
+            break;
+        s1 += sizeof(u32);
+        s2 += sizeof(u32);
+    }
     while (n-- > 0) {
         if (*s1++ != *s2++)
             return s1[-1] < s2[-1] ? -1 : 1;
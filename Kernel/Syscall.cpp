@@ -5,9 +5,11 @@
 #include <Kernel/ProcessTracer.h>
 #include <Kernel/Scheduler.h>
 #include <Kernel/Syscall.h>
+#include <Kernel/Trace.h>
 
 extern "C" void syscall_trap_entry(RegisterDump&);
 extern "C" void syscall_trap_handler();
+extern "C" void syscall_sysenter_handler();
 extern volatile RegisterDump* syscallRegDump;
 
 asm(
@@ -37,12 +39,86 @@ asm(
     "    popa\n"
     "    iret\n");
 
+// sysenter lands here on the current thread's kernel stack (see Scheduler::context_switch)
+// with interrupts off, and with nothing saved: userspace passes its return address in edx
+// and its stack pointer in ecx. We build the same frame that int 0x82 would have pushed,
+// and move the arguments from esi/edi to where syscall_trap_entry() expects them, so the
+// rest of the kernel can't tell the difference. On the way out, we leave through sysexit
+// with whatever return address and stack pointer are in the frame by then.
+asm(
+    ".globl syscall_sysenter_handler\n"
+    "syscall_sysenter_handler:\n"
+    "    pushl $0x23\n"
+    "    pushl %ecx\n"
+    "    pushfl\n"
+    "    orl $0x200, (%esp)\n"
+    "    pushl $0x1b\n"
+    "    pushl %edx\n"
+    "    movl %esi, %edx\n"
+    "    movl %edi, %ecx\n"
+    "    sti\n"
+    "    pusha\n"
+    "    pushw %ds\n"
+    "    pushw %es\n"
+    "    pushw %fs\n"
+    "    pushw %gs\n"
+    "    pushw %ss\n"
+    "    pushw %ss\n"
+    "    pushw %ss\n"
+    "    pushw %ss\n"
+    "    pushw %ss\n"
+    "    popw %ds\n"
+    "    popw %es\n"
+    "    popw %fs\n"
+    "    popw %gs\n"
+    "    mov %esp, %eax\n"
+    "    call syscall_trap_entry\n"
+    "    popw %gs\n"
+    "    popw %gs\n"
+    "    popw %fs\n"
+    "    popw %es\n"
+    "    popw %ds\n"
+    "    popa\n"
+    "    cli\n"
+    "    movl 0(%esp), %edx\n"
+    "    movl 12(%esp), %ecx\n"
+    "    andl $~0x200, 8(%esp)\n"
+    "    addl $8, %esp\n"
+    "    popfl\n"
+    "    sti\n"
+    "    sysexit\n");
+
+#define MSR_IA32_SYSENTER_CS 0x174
+#define MSR_IA32_SYSENTER_ESP 0x175
+#define MSR_IA32_SYSENTER_EIP 0x176
+
+static bool s_sysenter_supported;
+
 namespace Syscall {
 
 void initialize()
 {
     register_user_callable_interrupt_handler(0x82, syscall_trap_handler);
     kprintf("Syscall: int 0x82 handler installed\n");
+
+    // Family 6 processors before model 3 claim SEP but don't actually have it.
+    CPUID cpuid(1);
+    u32 family = (cpuid.eax() >> 8) & 0xf;
+    u32 model = (cpuid.eax() >> 4) & 0xf;
+    s_sysenter_supported = (cpuid.edx() & (1 << 11)) && !(family == 6 && model < 3 && (cpuid.eax() & 0xf) < 3);
+    if (!s_sysenter_supported)
+        return;
+    // sysenter loads cs/ss from this and the next GDT entry, and sysexit uses the two after
+    // those, which is exactly how our kernel and user segments are laid out.
+    write_msr(MSR_IA32_SYSENTER_CS, 0x08);
+    write_msr(MSR_IA32_SYSENTER_EIP, (u32)syscall_sysenter_handler);
+    kprintf("Syscall: sysenter handler installed\n");
+}
+
+void set_sysenter_stack(u32 esp)
+{
+    if (s_sysenter_supported)
+        write_msr(MSR_IA32_SYSENTER_ESP, esp);
 }
 
 int sync()
@@ -53,8 +129,6 @@ int sync()
 
 static u32 handle(RegisterDump& regs, u32 function, u32 arg1, u32 arg2, u32 arg3)
 {
-    current->process().did_syscall();
-
     ASSERT_INTERRUPTS_ENABLED();
     switch (function) {
     case Syscall::SC_yield:
@@ -307,12 +381,46 @@ static u32 handle(RegisterDump& regs, u32 function, u32 arg1, u32 arg2, u32 arg3
         return current->process().sys$share_buffer_globally((int)arg1);
     case Syscall::SC_set_process_icon:
         return current->process().sys$set_process_icon((int)arg1);
+    case Syscall::SC_madvise:
+        return current->process().sys$madvise((void*)arg1, (size_t)arg2, (int)arg3);
     case Syscall::SC_mprotect:
         return current->process().sys$mprotect((void*)arg1, (size_t)arg2, (int)arg3);
     case Syscall::SC_get_process_name:
         return current->process().sys$get_process_name((char*)arg1, (int)arg2);
     case Syscall::SC_realpath:
         return current->process().sys$realpath((const char*)arg1, (char*)arg2, (size_t)arg3);
+    case Syscall::SC_sendfile:
+        return current->process().sys$sendfile((const SC_sendfile_params*)arg1);
+    case Syscall::SC_epoll_create:
+        return current->process().sys$epoll_create((int)arg1);
+    case Syscall::SC_epoll_ctl:
+        return current->process().sys$epoll_ctl((const SC_epoll_ctl_params*)arg1);
+    case Syscall::SC_epoll_wait:
+        return current->process().sys$epoll_wait((const SC_epoll_wait_params*)arg1);
+    case Syscall::SC_vfork:
+        return current->process().sys$vfork(regs);
+    case Syscall::SC_posix_spawn:
+        return current->process().sys$posix_spawn((const SC_posix_spawn_params*)arg1);
+    case Syscall::SC_futex:
+        return current->process().sys$futex((const SC_futex_params*)arg1);
+    case Syscall::SC_readv:
+        return current->process().sys$readv((int)arg1, (const struct iovec*)arg2, (int)arg3);
+    case Syscall::SC_pread:
+        return current->process().sys$pread((const SC_pread_params*)arg1);
+    case Syscall::SC_pwrite:
+        return current->process().sys$pwrite((const SC_pwrite_params*)arg1);
+    case Syscall::SC_preadv:
+        return current->process().sys$preadv((const SC_preadv_params*)arg1);
+    case Syscall::SC_pwritev:
+        return current->process().sys$pwritev((const SC_pwritev_params*)arg1);
+    case Syscall::SC_profiling_enable:
+        return current->process().sys$profiling_enable((pid_t)arg1);
+    case Syscall::SC_profiling_disable:
+        return current->process().sys$profiling_disable((pid_t)arg1);
+    case Syscall::SC_get_time_page:
+        return current->process().sys$get_time_page();
+    case Syscall::SC_set_thread_pointer:
+        return current->process().sys$set_thread_pointer(regs, (void*)arg1);
     default:
         kprintf("<%u> int0x82: Unknown function %u requested {%x, %x, %x}\n", current->process().pid(), function, arg1, arg2, arg3);
         return -ENOSYS;
@@ -325,11 +433,15 @@ static u32 handle(RegisterDump& regs, u32 function, u32 arg1, u32 arg2, u32 arg3
 void syscall_trap_entry(RegisterDump& regs)
 {
     current->process().big_lock().lock();
+    u64 start_cycles = read_tsc();
     u32 function = regs.eax;
     u32 arg1 = regs.edx;
     u32 arg2 = regs.ecx;
     u32 arg3 = regs.ebx;
+    Trace::event(TraceEventType::SyscallEntry, function, arg1, arg2);
     regs.eax = Syscall::handle(regs, function, arg1, arg2, arg3);
+    Trace::event(TraceEventType::SyscallExit, function, regs.eax);
+    current->process().did_syscall(function, read_tsc() - start_cycles);
     if (auto* tracer = current->process().tracer())
         tracer->did_syscall(function, arg1, arg2, arg3, regs.eax);
     current->process().big_lock().unlock();
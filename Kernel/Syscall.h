@@ -5,6 +5,11 @@
 
 extern "C" {
 struct timeval;
+struct epoll_event;
+struct posix_spawn_file_actions;
+struct posix_spawnattr;
+struct timespec;
+struct iovec;
 }
 
 #define ENUMERATE_SYSCALLS                      \
@@ -126,7 +131,24 @@ struct timeval;
     __ENUMERATE_SYSCALL(set_process_icon)       \
     __ENUMERATE_SYSCALL(mprotect)               \
     __ENUMERATE_SYSCALL(realpath)               \
-    __ENUMERATE_SYSCALL(get_process_name)
+    __ENUMERATE_SYSCALL(get_process_name)       \
+    __ENUMERATE_SYSCALL(sendfile)               \
+    __ENUMERATE_SYSCALL(epoll_create)           \
+    __ENUMERATE_SYSCALL(epoll_ctl)              \
+    __ENUMERATE_SYSCALL(epoll_wait)             \
+    __ENUMERATE_SYSCALL(vfork)                  \
+    __ENUMERATE_SYSCALL(posix_spawn)            \
+    __ENUMERATE_SYSCALL(futex)                  \
+    __ENUMERATE_SYSCALL(readv)                  \
+    __ENUMERATE_SYSCALL(pread)                  \
+    __ENUMERATE_SYSCALL(pwrite)                 \
+    __ENUMERATE_SYSCALL(preadv)                 \
+    __ENUMERATE_SYSCALL(pwritev)                \
+    __ENUMERATE_SYSCALL(profiling_enable)       \
+    __ENUMERATE_SYSCALL(profiling_disable)      \
+    __ENUMERATE_SYSCALL(get_time_page)          \
+    __ENUMERATE_SYSCALL(set_thread_pointer)     \
+    __ENUMERATE_SYSCALL(madvise)
 
 namespace Syscall {
 
@@ -150,6 +172,13 @@ inline constexpr const char* to_string(Function function)
     return "Unknown";
 }
 
+constexpr int function_count = 0
+#undef __ENUMERATE_SYSCALL
+#define __ENUMERATE_SYSCALL(x) +1
+    ENUMERATE_SYSCALLS
+#undef __ENUMERATE_SYSCALL
+    ;
+
 #ifdef __serenity__
 struct SC_mmap_params {
     uint32_t addr;
@@ -210,7 +239,74 @@ struct SC_setsockopt_params {
     size_t value_size; // socklen_t
 };
 
+struct SC_sendfile_params {
+    int out_fd;
+    int in_fd;
+    i32* offset; // off_t*
+    size_t count;
+};
+
+struct SC_epoll_ctl_params {
+    int epfd;
+    int op;
+    int fd;
+    struct epoll_event* event;
+};
+
+struct SC_epoll_wait_params {
+    int epfd;
+    struct epoll_event* events;
+    int max_events;
+    int timeout;
+};
+
+struct SC_posix_spawn_params {
+    const char* path;
+    const char** argv;
+    const char** envp;
+    const struct posix_spawn_file_actions* file_actions;
+    const struct posix_spawnattr* attr;
+};
+
+struct SC_futex_params {
+    u32* userspace_address;
+    int futex_op;
+    u32 val;
+    const struct timespec* timeout;
+    u32* userspace_address2;
+    u32 val2;
+};
+
+struct SC_pread_params {
+    int fd;
+    void* buffer;
+    ssize_t count;
+    i32 offset; // off_t
+};
+
+struct SC_pwrite_params {
+    int fd;
+    const void* data;
+    ssize_t count;
+    i32 offset; // off_t
+};
+
+struct SC_preadv_params {
+    int fd;
+    const struct iovec* iov;
+    int iov_count;
+    i32 offset; // off_t
+};
+
+struct SC_pwritev_params {
+    int fd;
+    const struct iovec* iov;
+    int iov_count;
+    i32 offset; // off_t
+};
+
 void initialize();
+void set_sysenter_stack(u32);
 int sync();
 
 inline u32 invoke(Function function)
@@ -255,6 +351,62 @@ inline u32 invoke(Function function, T1 arg1, T2 arg2, T3 arg3)
                  : "memory");
     return result;
 }
+
+// The same thing through sysenter, which skips the IDT and the privilege checks of a
+// software interrupt. sysenter doesn't save a return address or stack pointer, so we pass
+// them in edx and ecx (which the kernel clobbers on the way back with sysexit) and the
+// arguments move to esi and edi. Only use this if CPUID says the processor has SEP.
+#define __SYSENTER                 \
+    "movl %%esp, %%ecx\n"          \
+    "call 0f\n"                    \
+    "0: popl %%edx\n"              \
+    "addl $(1f - 0b), %%edx\n"     \
+    "sysenter\n"                   \
+    "1:\n"
+
+inline u32 invoke_fast(Function function)
+{
+    u32 result;
+    asm volatile(__SYSENTER
+                 : "=a"(result)
+                 : "a"(function)
+                 : "ecx", "edx", "memory");
+    return result;
+}
+
+template<typename T1>
+inline u32 invoke_fast(Function function, T1 arg1)
+{
+    u32 result;
+    asm volatile(__SYSENTER
+                 : "=a"(result)
+                 : "a"(function), "S"((u32)arg1)
+                 : "ecx", "edx", "memory");
+    return result;
+}
+
+template<typename T1, typename T2>
+inline u32 invoke_fast(Function function, T1 arg1, T2 arg2)
+{
+    u32 result;
+    asm volatile(__SYSENTER
+                 : "=a"(result)
+                 : "a"(function), "S"((u32)arg1), "D"((u32)arg2)
+                 : "ecx", "edx", "memory");
+    return result;
+}
+
+template<typename T1, typename T2, typename T3>
+inline u32 invoke_fast(Function function, T1 arg1, T2 arg2, T3 arg3)
+{
+    u32 result;
+    asm volatile(__SYSENTER
+                 : "=a"(result)
+                 : "a"(function), "S"((u32)arg1), "D"((u32)arg2), "b"((u32)arg3)
+                 : "ecx", "edx", "memory");
+    return result;
+}
+#undef __SYSENTER
 #endif
 
 }
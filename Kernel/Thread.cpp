@@ -1,6 +1,7 @@
 #include <AK/ELF/ELFLoader.h>
 #include <AK/StringBuilder.h>
 #include <Kernel/FileSystem/FileDescription.h>
+#include <Kernel/FutexTable.h>
 #include <Kernel/Process.h>
 #include <Kernel/Scheduler.h>
 #include <Kernel/Thread.h>
@@ -171,6 +172,9 @@ void Thread::finalize()
     dbgprintf("Finalizing Thread %u in %s(%u)\n", tid(), m_process.name().characters(), pid());
     set_state(Thread::State::Dead);
 
+    // A thread killed while parked on a futex never gets to unlink its blocker.
+    FutexTable::forget_thread(*this);
+
     if (m_dump_backtrace_on_finalization)
         dbg() << backtrace_impl();
 
@@ -430,7 +434,7 @@ ShouldUnblockThread Thread::dispatch_signal(u8 signal)
     m_tss.ds = 0x23;
     m_tss.es = 0x23;
     m_tss.fs = 0x23;
-    m_tss.gs = 0x23;
+    m_tss.gs = user_gs();
     m_tss.eip = handler_vaddr.get();
 
     // FIXME: Should we worry about the stack being 16 byte aligned when entering a signal handler?
@@ -535,9 +539,36 @@ Thread* Thread::clone(Process& process)
     return clone;
 }
 
+static u16 s_thread_pointer_selector;
+
 void Thread::initialize()
 {
     Scheduler::initialize();
+
+    s_thread_pointer_selector = gdt_alloc_entry() | 3;
+    auto& descriptor = get_gdt_entry(s_thread_pointer_selector);
+    descriptor.set_base(nullptr);
+    descriptor.set_limit(0xfffff);
+    descriptor.type = 2; // Read/write data
+    descriptor.descriptor_type = 1;
+    descriptor.dpl = 3;
+    descriptor.segment_present = 1;
+    descriptor.zero = 0;
+    descriptor.operation_size = 1;
+    descriptor.granularity = 1;
+    flush_gdt();
+}
+
+u16 Thread::thread_pointer_selector()
+{
+    return s_thread_pointer_selector;
+}
+
+void Thread::set_thread_pointer(u32 thread_pointer)
+{
+    m_thread_pointer = thread_pointer;
+    if (current == this)
+        get_gdt_entry(s_thread_pointer_selector).set_base((void*)thread_pointer);
 }
 
 Vector<Thread*> Thread::all_threads()
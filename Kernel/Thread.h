@@ -172,6 +172,27 @@ public:
         pid_t& m_waitee_pid;
     };
 
+    class FutexBlocker final : public Blocker {
+    public:
+        FutexBlocker(VirtualAddress, u64 deadline, bool& woken);
+        virtual ~FutexBlocker() override;
+        virtual bool should_unblock(Thread&, time_t, long) override;
+        virtual const char* state_string() const override { return "Futex"; }
+
+        Thread& thread() { return m_thread; }
+        VirtualAddress address() const { return m_address; }
+        void set_address(VirtualAddress address) { m_address = address; }
+        void wake() { m_woken = true; }
+
+        IntrusiveListNode m_futex_list_node;
+
+    private:
+        Thread& m_thread;
+        VirtualAddress m_address;
+        u64 m_deadline { 0 };
+        bool& m_woken;
+    };
+
     class SemiPermanentBlocker final : public Blocker {
     public:
         enum class Reason {
@@ -209,6 +230,13 @@ public:
     u16 selector() const { return m_far_ptr.selector; }
     TSS32& tss() { return m_tss; }
     const TSS32& tss() const { return m_tss; }
+
+    // A per-thread pointer that userspace can reach through %gs once it's been set.
+    // All threads share one GDT entry, which the scheduler rebases on every switch.
+    static u16 thread_pointer_selector();
+    u32 thread_pointer() const { return m_thread_pointer; }
+    void set_thread_pointer(u32);
+    u16 user_gs() const { return m_thread_pointer ? thread_pointer_selector() : 0x23; }
     State state() const { return m_state; }
     const char* state_string() const;
     u32 ticks() const { return m_ticks; }
@@ -322,6 +350,7 @@ private:
     int m_tid { -1 };
     TSS32 m_tss;
     OwnPtr<TSS32> m_tss_to_resume_kernel;
+    u32 m_thread_pointer { 0 };
     FarPtr m_far_ptr;
     u32 m_ticks { 0 };
     u32 m_ticks_left { 0 };
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <AK/Types.h>
+
+// The layout of the read-only page that the kernel maps into every process so that
+// userspace can tell the time without a syscall. This is shared with userspace.
+//
+// The kernel updates it on every timer tick. `sequence` is odd while an update is in
+// progress, so readers copy what they need and start over if `sequence` was odd or
+// changed in the meantime.
+struct TimePage {
+    u32 sequence;
+    u32 boot_time; // Seconds since the epoch, from the RTC.
+    u32 seconds_since_boot;
+    u32 ticks_this_second;
+    u32 ticks_per_second;
+
+    // For interpolating between ticks. tsc_cycles_per_tick is 0 until the TSC has been
+    // calibrated against the timer, and microseconds are ((cycles * tsc_to_microseconds) >> 32).
+    u32 tsc_cycles_per_tick;
+    u32 tsc_to_microseconds;
+    u64 tsc_at_last_tick;
+};
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <AK/Types.h>
+#include <Kernel/TraceRecord.h>
+
+// Static tracepoints. While tracing is off, a tracepoint costs a load and a not-taken
+// branch. While it's on, each one appends a TraceRecord to the buffer behind /dev/trace.
+namespace Trace {
+
+extern bool g_enabled;
+
+void record(TraceEventType, u32 arg0, u32 arg1, u32 arg2);
+
+[[gnu::always_inline]] inline void event(TraceEventType type, u32 arg0 = 0, u32 arg1 = 0, u32 arg2 = 0)
+{
+    if (__builtin_expect(g_enabled, false))
+        record(type, arg0, arg1, arg2);
+}
+
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <AK/Types.h>
+
+// The binary format of /dev/trace. This is shared with userspace.
+enum class TraceEventType : u16 {
+    Invalid = 0,
+    ContextSwitch,  // tid switched from, tid switched to
+    PageFault,      // faulting address, fault code, eip
+    SyscallEntry,   // function, arg1, arg2
+    SyscallExit,    // function, return value
+    BlockSubmit,    // first block, block count, 1 if it's a write
+    BlockComplete,  // first block, block count, 1 if it succeeded
+    PacketReceive,  // frame length
+    PacketTransmit, // frame length
+    __Count
+};
+
+struct TraceRecord {
+    u64 timestamp; // rdtsc
+    u32 pid;
+    u32 tid;
+    u16 type;
+    u16 cpu;
+    u32 args[3];
+};
+
+static_assert(sizeof(TraceRecord) == 32);
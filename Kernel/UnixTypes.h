@@ -27,6 +27,9 @@
 #define MAP_ANONYMOUS 0x20
 #define MAP_ANON MAP_ANONYMOUS
 
+#define MADV_NORMAL 0
+#define MADV_DONTNEED 4
+
 #define PROT_READ 0x1
 #define PROT_WRITE 0x2
 #define PROT_EXEC 0x4
@@ -314,6 +317,65 @@ struct pollfd {
     short revents;
 };
 
+#define EPOLLIN (1u << 0)
+#define EPOLLOUT (1u << 2)
+#define EPOLLERR (1u << 3)
+#define EPOLLHUP (1u << 4)
+#define EPOLLET (1u << 31)
+
+#define EPOLL_CTL_ADD 1
+#define EPOLL_CTL_DEL 2
+#define EPOLL_CTL_MOD 3
+
+#define EPOLL_CLOEXEC 02000000
+
+typedef union epoll_data {
+    void* ptr;
+    int fd;
+    uint32_t u32;
+    uint64_t u64;
+} epoll_data_t;
+
+struct epoll_event {
+    uint32_t events;
+    epoll_data_t data;
+};
+
+#define POSIX_SPAWN_RESETIDS 0x01
+#define POSIX_SPAWN_SETPGROUP 0x02
+#define POSIX_SPAWN_SETSIGDEF 0x04
+#define POSIX_SPAWN_SETSIGMASK 0x08
+
+#define POSIX_SPAWN_FILE_ACTION_OPEN 1
+#define POSIX_SPAWN_FILE_ACTION_CLOSE 2
+#define POSIX_SPAWN_FILE_ACTION_DUP2 3
+
+struct posix_spawn_file_action {
+    int type;
+    int fd;
+    int new_fd;
+    int flags;
+    mode_t mode;
+    const char* path;
+};
+
+typedef struct posix_spawn_file_actions {
+    int count;
+    int capacity;
+    struct posix_spawn_file_action* actions;
+} posix_spawn_file_actions_t;
+
+typedef struct posix_spawnattr {
+    short flags;
+    pid_t pgroup;
+    sigset_t sigdefault;
+    sigset_t sigmask;
+} posix_spawnattr_t;
+
+#define FUTEX_WAIT 0
+#define FUTEX_WAKE 1
+#define FUTEX_REQUEUE 3
+
 #define AF_MASK 0xff
 #define AF_UNSPEC 0
 #define AF_LOCAL 1
@@ -365,6 +427,17 @@ struct sockaddr_in {
     char sin_zero[8];
 };
 
+#define RTF_UP 0x1
+#define RTF_GATEWAY 0x2
+
+struct rtentry {
+    struct sockaddr_in rt_dst;
+    struct sockaddr_in rt_gateway;
+    struct sockaddr_in rt_genmask;
+    unsigned short rt_flags;
+    char* rt_dev;
+};
+
 typedef u32 __u32;
 typedef u16 __u16;
 typedef u8 __u8;
@@ -379,6 +452,11 @@ struct timeval {
     suseconds_t tv_usec;
 };
 
+struct timespec {
+    time_t tv_sec;
+    long tv_nsec;
+};
+
 #define UTSNAME_ENTRY_LEN 65
 
 struct utsname {
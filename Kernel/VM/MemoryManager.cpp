@@ -207,6 +207,38 @@ PageTableEntry& MemoryManager::ensure_pte(PageDirectory& page_directory, Virtual
     return pde.page_table_base()[page_table_index];
 }
 
+PageTableEntry* MemoryManager::existing_pte(PageDirectory& page_directory, VirtualAddress vaddr)
+{
+    ASSERT_INTERRUPTS_DISABLED();
+    u32 page_directory_index = (vaddr.get() >> 22) & 0x3ff;
+    u32 page_table_index = (vaddr.get() >> 12) & 0x3ff;
+
+    PageDirectoryEntry& pde = page_directory.entries()[page_directory_index];
+    if (!pde.is_present())
+        return nullptr;
+    return &pde.page_table_base()[page_table_index];
+}
+
+// Calls callback(page_index_in_region, pte) for each page of the region that has a page
+// table, without allocating any. Missing page tables are skipped 4 MB at a time.
+template<typename Callback>
+void MemoryManager::for_each_existing_pte(PageDirectory& page_directory, Region& region, Callback callback)
+{
+    ASSERT_INTERRUPTS_DISABLED();
+    const size_t pages_per_page_table = 1024;
+    size_t i = 0;
+    while (i < region.page_count()) {
+        auto page_vaddr = region.vaddr().offset(i * PAGE_SIZE);
+        auto* pte = existing_pte(page_directory, page_vaddr);
+        if (!pte) {
+            i += pages_per_page_table - ((page_vaddr.get() >> 12) & 0x3ff);
+            continue;
+        }
+        callback(i, *pte);
+        ++i;
+    }
+}
+
 void MemoryManager::map_protected(VirtualAddress vaddr, size_t length)
 {
     InterruptDisabler disabler;
@@ -298,8 +330,8 @@ bool MemoryManager::zero_page(Region& region, unsigned page_index_in_region)
 #ifdef PAGE_FAULT_DEBUG
     dbgprintf("      >> ZERO P%x\n", physical_page->paddr().get());
 #endif
-    region.set_should_cow(page_index_in_region, false);
-    vmo.physical_pages()[page_index_in_region] = move(physical_page);
+    region.set_should_cow(region.first_page_index() + page_index_in_region, false);
+    vmo_page = move(physical_page);
     remap_region_page(region, page_index_in_region);
     return true;
 }
@@ -308,11 +340,12 @@ bool MemoryManager::copy_on_write(Region& region, unsigned page_index_in_region)
 {
     ASSERT_INTERRUPTS_DISABLED();
     auto& vmo = region.vmo();
-    if (vmo.physical_pages()[page_index_in_region]->ref_count() == 1) {
+    auto page_index_in_vmo = region.first_page_index() + page_index_in_region;
+    if (vmo.physical_pages()[page_index_in_vmo]->ref_count() == 1) {
 #ifdef PAGE_FAULT_DEBUG
         dbgprintf("    >> It's a COW page but nobody is sharing it anymore. Remap r/w\n");
 #endif
-        region.set_should_cow(page_index_in_region, false);
+        region.set_should_cow(page_index_in_vmo, false);
         remap_region_page(region, page_index_in_region);
         return true;
     }
@@ -320,7 +353,7 @@ bool MemoryManager::copy_on_write(Region& region, unsigned page_index_in_region)
 #ifdef PAGE_FAULT_DEBUG
     dbgprintf("    >> It's a COW page and it's time to COW!\n");
 #endif
-    auto physical_page_to_copy = move(vmo.physical_pages()[page_index_in_region]);
+    auto physical_page_to_copy = move(vmo.physical_pages()[page_index_in_vmo]);
     auto physical_page = allocate_user_physical_page(ShouldZeroFill::No);
     u8* dest_ptr = quickmap_page(*physical_page);
     const u8* src_ptr = region.vaddr().offset(page_index_in_region * PAGE_SIZE).as_ptr();
@@ -328,9 +361,9 @@ bool MemoryManager::copy_on_write(Region& region, unsigned page_index_in_region)
     dbgprintf("      >> COW P%x <- P%x\n", physical_page->paddr().get(), physical_page_to_copy->paddr().get());
 #endif
     memcpy(dest_ptr, src_ptr, PAGE_SIZE);
-    vmo.physical_pages()[page_index_in_region] = move(physical_page);
+    vmo.physical_pages()[page_index_in_vmo] = move(physical_page);
     unquickmap_page();
-    region.set_should_cow(page_index_in_region, false);
+    region.set_should_cow(page_index_in_vmo, false);
     remap_region_page(region, page_index_in_region);
     return true;
 }
@@ -425,6 +458,15 @@ PageFaultResponse MemoryManager::handle_page_fault(const PageFault& fault)
     }
     auto page_index_in_region = region->page_index_from_address(fault.vaddr());
     if (fault.type() == PageFault::Type::PageNotPresent) {
+        if (region->vmo().physical_pages()[region->first_page_index() + page_index_in_region]) {
+            // User mappings are populated lazily, so most of these are for pages that exist
+            // and just haven't been touched through this page directory yet.
+#ifdef PAGE_FAULT_DEBUG
+            dbgprintf("NP(map) fault in Region{%p}[%u]\n", region, page_index_in_region);
+#endif
+            remap_region_page(*region, page_index_in_region);
+            return PageFaultResponse::Continue;
+        }
         if (region->vmo().is_inode()) {
 #ifdef PAGE_FAULT_DEBUG
             dbgprintf("NP(inode) fault in Region{%p}[%u]\n", region, page_index_in_region);
@@ -439,7 +481,7 @@ PageFaultResponse MemoryManager::handle_page_fault(const PageFault& fault)
         return PageFaultResponse::Continue;
     }
     ASSERT(fault.type() == PageFault::Type::ProtectionViolation);
-    if (fault.access() == PageFault::Access::Write && region->should_cow(page_index_in_region)) {
+    if (fault.access() == PageFault::Access::Write && region->should_cow(region->first_page_index() + page_index_in_region)) {
 #ifdef PAGE_FAULT_DEBUG
         dbgprintf("PV(cow) fault in Region{%p}[%u]\n", region, page_index_in_region);
 #endif
@@ -474,6 +516,16 @@ RefPtr<Region> MemoryManager::allocate_user_accessible_kernel_region(size_t size
     return allocate_kernel_region(size, name, true);
 }
 
+RefPtr<Region> MemoryManager::allocate_user_accessible_kernel_region_with_vmobject(VMObject& vmobject, const StringView& name, u8 access)
+{
+    InterruptDisabler disabler;
+    auto range = kernel_page_directory().range_allocator().allocate_anywhere(vmobject.size());
+    ASSERT(range.is_valid());
+    auto region = Region::create_user_accessible(range, vmobject, 0, name, access);
+    MM.map_region_at_address(*m_kernel_page_directory, *region, range.base());
+    return region;
+}
+
 void MemoryManager::deallocate_user_physical_page(PhysicalPage&& page)
 {
     for (auto& region : m_user_physical_regions) {
@@ -603,6 +655,28 @@ void MemoryManager::flush_tlb(VirtualAddress vaddr)
                  : "memory");
 }
 
+bool MemoryManager::can_read_without_faulting(Process& process, VirtualAddress vaddr, size_t size, bool user_accessible_only)
+{
+    ASSERT_INTERRUPTS_DISABLED();
+    ASSERT(size);
+    VirtualAddress last_vaddr = vaddr.offset(size - 1);
+    if (last_vaddr < vaddr)
+        return false;
+    if (user_accessible_only && last_vaddr.get() >= 0xc0000000)
+        return false;
+    // Processes pick up new kernel page tables lazily, so go straight to the source for those.
+    auto& page_directory = vaddr.get() >= 0xc0000000 ? kernel_page_directory() : process.page_directory();
+    size_t page_count = ((last_vaddr.page_base().get() - vaddr.page_base().get()) / PAGE_SIZE) + 1;
+    for (size_t i = 0; i < page_count; ++i) {
+        auto* pte = existing_pte(page_directory, vaddr.page_base().offset(i * PAGE_SIZE));
+        if (!pte || !pte->is_present())
+            return false;
+        if (user_accessible_only && !pte->is_user_allowed())
+            return false;
+    }
+    return true;
+}
+
 void MemoryManager::map_for_kernel(VirtualAddress vaddr, PhysicalAddress paddr)
 {
     auto& pte = ensure_pte(kernel_page_directory(), vaddr);
@@ -657,11 +731,12 @@ void MemoryManager::remap_region_page(Region& region, unsigned page_index_in_reg
     InterruptDisabler disabler;
     auto page_vaddr = region.vaddr().offset(page_index_in_region * PAGE_SIZE);
     auto& pte = ensure_pte(*region.page_directory(), page_vaddr);
-    auto& physical_page = region.vmo().physical_pages()[page_index_in_region];
+    auto page_index_in_vmo = region.first_page_index() + page_index_in_region;
+    auto& physical_page = region.vmo().physical_pages()[page_index_in_vmo];
     ASSERT(physical_page);
     pte.set_physical_page_base(physical_page->paddr().get());
     pte.set_present(true); // FIXME: Maybe we should use the is_readable flag here?
-    if (region.should_cow(page_index_in_region))
+    if (region.should_cow(page_index_in_vmo))
         pte.set_writable(false);
     else
         pte.set_writable(region.is_writable());
@@ -672,17 +747,71 @@ void MemoryManager::remap_region_page(Region& region, unsigned page_index_in_reg
 #endif
 }
 
+void MemoryManager::decommit_region_pages(Region& region, size_t page_index_in_region, size_t page_count)
+{
+    InterruptDisabler disabler;
+    ASSERT(page_index_in_region + page_count <= region.page_count());
+    auto& physical_pages = region.vmo().physical_pages();
+    for (size_t i = page_index_in_region; i < page_index_in_region + page_count; ++i) {
+        auto page_index_in_vmo = region.first_page_index() + i;
+        if (!physical_pages[page_index_in_vmo])
+            continue;
+        // Dropping our reference frees the page, unless a copy-on-write sibling still has it.
+        physical_pages[page_index_in_vmo] = nullptr;
+        region.set_should_cow(page_index_in_vmo, false);
+        if (!region.page_directory())
+            continue;
+        auto page_vaddr = region.vaddr().offset(i * PAGE_SIZE);
+        if (auto* pte = existing_pte(*region.page_directory(), page_vaddr)) {
+            pte->set_physical_page_base(0);
+            pte->set_present(false);
+            region.page_directory()->flush(page_vaddr);
+        }
+    }
+}
+
 void MemoryManager::remap_region(PageDirectory& page_directory, Region& region)
 {
     InterruptDisabler disabler;
     ASSERT(region.page_directory() == &page_directory);
-    map_region_at_address(page_directory, region, region.vaddr());
+    if (&page_directory == m_kernel_page_directory) {
+        map_region_at_address(page_directory, region, region.vaddr());
+        return;
+    }
+    // Only pages that have been faulted in have a PTE worth updating. The rest pick up
+    // the region's current state (COW, protection, contents) when first touched.
+    for_each_existing_pte(page_directory, region, [&](size_t page_index_in_region, PageTableEntry& pte) {
+        if (!pte.is_present())
+            return;
+        auto page_vaddr = region.vaddr().offset(page_index_in_region * PAGE_SIZE);
+        auto page_index_in_vmo = region.first_page_index() + page_index_in_region;
+        auto& physical_page = region.vmo().physical_pages()[page_index_in_vmo];
+        if (physical_page) {
+            pte.set_physical_page_base(physical_page->paddr().get());
+            if (region.should_cow(page_index_in_vmo))
+                pte.set_writable(false);
+            else
+                pte.set_writable(region.is_writable());
+        } else {
+            pte.set_physical_page_base(0);
+            pte.set_present(false);
+            pte.set_writable(false);
+        }
+        page_directory.flush(page_vaddr);
+    });
 }
 
 void MemoryManager::map_region_at_address(PageDirectory& page_directory, Region& region, VirtualAddress vaddr)
 {
     InterruptDisabler disabler;
     region.set_page_directory(page_directory);
+
+    // User regions are mapped lazily: their PTEs are filled in by handle_page_fault() as
+    // pages are touched, so mapping (and forking) costs nothing for pages never used.
+    // Kernel regions have to be there up front, since we can't take faults on e.g. stacks.
+    if (&page_directory != m_kernel_page_directory)
+        return;
+
     auto& vmo = region.vmo();
 #ifdef MM_DEBUG
     dbgprintf("MM: map_region_at_address will map VMO pages %u - %u (VMO page count: %u)\n", region.first_page_index(), region.last_page_index(), vmo.page_count());
@@ -694,7 +823,6 @@ void MemoryManager::map_region_at_address(PageDirectory& page_directory, Region&
         if (physical_page) {
             pte.set_physical_page_base(physical_page->paddr().get());
             pte.set_present(true); // FIXME: Maybe we should use the is_readable flag here?
-            // FIXME: It seems wrong that the *region* cow map is essentially using *VMO* relative indices.
             if (region.should_cow(region.first_page_index() + i))
                 pte.set_writable(false);
             else
@@ -716,20 +844,22 @@ bool MemoryManager::unmap_region(Region& region)
 {
     ASSERT(region.page_directory());
     InterruptDisabler disabler;
-    for (size_t i = 0; i < region.page_count(); ++i) {
-        auto vaddr = region.vaddr().offset(i * PAGE_SIZE);
-        auto& pte = ensure_pte(*region.page_directory(), vaddr);
+    auto& page_directory = *region.page_directory();
+    for_each_existing_pte(page_directory, region, [&](size_t page_index_in_region, PageTableEntry& pte) {
+        auto vaddr = region.vaddr().offset(page_index_in_region * PAGE_SIZE);
+        bool was_present = pte.is_present();
         pte.set_physical_page_base(0);
         pte.set_present(false);
         pte.set_writable(false);
         pte.set_user_allowed(false);
-        region.page_directory()->flush(vaddr);
+        if (was_present)
+            page_directory.flush(vaddr);
 #ifdef MM_DEBUG
-        auto& physical_page = region.vmo().physical_pages()[region.first_page_index() + i];
+        auto& physical_page = region.vmo().physical_pages()[region.first_page_index() + page_index_in_region];
         dbgprintf("MM: >> Unmapped V%p => P%x <<\n", vaddr, physical_page ? physical_page->paddr().get() : 0);
 #endif
-    }
-    region.page_directory()->range_allocator().deallocate({ region.vaddr(), region.size() });
+    });
+    page_directory.range_allocator().deallocate({ region.vaddr(), region.size() });
     region.release_page_directory();
     return true;
 }
@@ -68,11 +68,17 @@ public:
     void deallocate_supervisor_physical_page(PhysicalPage&&);
 
     void remap_region(PageDirectory&, Region&);
+    void decommit_region_pages(Region&, size_t page_index_in_region, size_t page_count);
 
     void map_for_kernel(VirtualAddress, PhysicalAddress);
 
+    // Whether the range is currently mapped in, so reading it can't page fault. This is for
+    // peeking at memory from contexts that can't take a fault, like interrupt handlers.
+    bool can_read_without_faulting(Process&, VirtualAddress, size_t, bool user_accessible_only);
+
     RefPtr<Region> allocate_kernel_region(size_t, const StringView& name, bool user_accessible = false, bool should_commit = true);
     RefPtr<Region> allocate_user_accessible_kernel_region(size_t, const StringView& name);
+    RefPtr<Region> allocate_user_accessible_kernel_region_with_vmobject(VMObject&, const StringView& name, u8 access);
     void map_region_at_address(PageDirectory&, Region&, VirtualAddress);
 
     unsigned user_physical_pages() const { return m_user_physical_pages; }
@@ -128,6 +134,10 @@ private:
     PageDirectory& kernel_page_directory() { return *m_kernel_page_directory; }
 
     PageTableEntry& ensure_pte(PageDirectory&, VirtualAddress);
+    PageTableEntry* existing_pte(PageDirectory&, VirtualAddress);
+
+    template<typename Callback>
+    void for_each_existing_pte(PageDirectory&, Region&, Callback);
 
     RefPtr<PageDirectory> m_kernel_page_directory;
     PageTableEntry* m_page_table_zero { nullptr };
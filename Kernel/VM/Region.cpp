@@ -93,7 +93,9 @@ int Region::commit()
             return -ENOMEM;
         }
         vmo().physical_pages()[i] = move(physical_page);
-        MM.remap_region_page(*this, i);
+        // User mappings are populated on first touch, see MemoryManager::map_region_at_address().
+        if (m_page_directory == MM.m_kernel_page_directory)
+            MM.remap_region_page(*this, i - first_page_index());
     }
     return 0;
 }
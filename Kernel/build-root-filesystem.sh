@@ -36,6 +36,7 @@ mknod -m 666 mnt/dev/null c 1 3
 mknod -m 666 mnt/dev/zero c 1 5
 mknod -m 666 mnt/dev/full c 1 7
 mknod -m 666 mnt/dev/debuglog c 1 18
+mknod -m 600 mnt/dev/trace c 1 20
 mknod mnt/dev/keyboard c 85 1
 mknod mnt/dev/psaux c 10 1
 mknod -m 666 mnt/dev/audio c 42 42
@@ -90,6 +91,8 @@ cp ../Demos/HelloWorld2/HelloWorld2 mnt/bin/HelloWorld2
 cp ../Demos/RetroFetch/RetroFetch mnt/bin/RetroFetch
 cp ../Demos/WidgetGallery/WidgetGallery mnt/bin/WidgetGallery
 cp ../Demos/Fire/Fire mnt/bin/Fire
+cp ../Demos/DynamicLink/LinkDemo/LinkDemo mnt/bin/LinkDemo
+cp ../Demos/DynamicLink/LinkLib/LinkLib.so mnt/usr/lib/LinkLib.so
 cp ../DevTools/VisualBuilder/VisualBuilder mnt/bin/VisualBuilder
 cp ../DevTools/Inspector/Inspector mnt/bin/Inspector
 cp ../Games/Minesweeper/Minesweeper mnt/bin/Minesweeper
@@ -6,6 +6,7 @@
 #include "kmalloc.h"
 #include "kstdio.h"
 #include <AK/Types.h>
+#include <Kernel/Arch/i386/APIC.h>
 #include <Kernel/Arch/i386/CPU.h>
 #include <Kernel/Arch/i386/PIC.h>
 #include <Kernel/Arch/i386/PIT.h>
@@ -24,6 +25,7 @@
 #include <Kernel/Devices/RandomDevice.h>
 #include <Kernel/Devices/SB16.h>
 #include <Kernel/Devices/SerialDevice.h>
+#include <Kernel/Devices/TraceDevice.h>
 #include <Kernel/Devices/ZeroDevice.h>
 #include <Kernel/FileSystem/DevPtsFS.h>
 #include <Kernel/FileSystem/Ext2FileSystem.h>
@@ -36,6 +38,7 @@
 #include <Kernel/Net/NetworkTask.h>
 #include <Kernel/Net/RTL8139NetworkAdapter.h>
 #include <Kernel/PCI.h>
+#include <Kernel/SharedTimePage.h>
 #include <Kernel/TTY/PTYMultiplexer.h>
 #include <Kernel/TTY/VirtualConsole.h>
 #include <Kernel/VM/MemoryManager.h>
@@ -62,6 +65,7 @@ VFS* vfs;
     auto dev_zero = make<ZeroDevice>();
     auto dev_full = make<FullDevice>();
     auto dev_random = make<RandomDevice>();
+    auto dev_trace = make<TraceDevice>();
     auto dev_ptmx = make<PTYMultiplexer>();
 
     auto root = KParams::the().get("root");
@@ -221,6 +225,9 @@ extern "C" [[noreturn]] void init()
     MemoryManager::initialize();
     PIT::initialize();
 
+    if (APIC::initialize())
+        APIC::boot_application_processors();
+
     PCI::enumerate_all([](const PCI::Address& address, PCI::ID id) {
         kprintf("PCI device: bus=%d slot=%d function=%d id=%w:%w\n",
             address.bus(),
@@ -253,6 +260,7 @@ extern "C" [[noreturn]] void init()
 
     Process::initialize();
     Thread::initialize();
+    SharedTimePage::initialize();
     Process::create_kernel_process("init_stage2", init_stage2);
     Process::create_kernel_process("syncd", [] {
         for (;;) {
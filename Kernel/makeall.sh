@@ -56,6 +56,8 @@ build_targets="$build_targets ../Applications/Taskbar"
 build_targets="$build_targets ../Applications/Terminal"
 build_targets="$build_targets ../Applications/TextEditor"
 
+build_targets="$build_targets ../Demos/DynamicLink/LinkDemo"
+build_targets="$build_targets ../Demos/DynamicLink/LinkLib"
 build_targets="$build_targets ../Demos/Fire"
 build_targets="$build_targets ../Demos/HelloWorld"
 build_targets="$build_targets ../Demos/HelloWorld2"
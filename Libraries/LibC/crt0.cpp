@@ -12,6 +12,9 @@ bool __environ_is_malloced;
 
 void __libc_init()
 {
+    void __string_init();
+    __string_init();
+
     void __malloc_init();
     __malloc_init();
 
@@ -1,25 +1,208 @@
+#include <AK/AKString.h>
+#include <AK/ELF/ELFDynamicObject.h>
+#include <AK/ELF/ELFImage.h>
+#include <AK/HashMap.h>
+#include <AK/Vector.h>
+#include <LibThread/Lock.h>
 #include <assert.h>
 #include <dlfcn.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Libraries are looked for here when dlopen() isn't given a path.
+static const char* library_directory = "/usr/lib";
+
+static LibThread::Lock s_lock;
+
+// Every object we've loaded, by path. The map doesn't hold a reference; objects are kept
+// alive by their dlopen() count, and libraries that were only pulled in as dependencies
+// stay around for the life of the process.
+static HashMap<String, ELFDynamicObject*>* s_loaded_objects;
+// Objects opened with RTLD_GLOBAL, and their dependencies, in the order they came in.
+static Vector<ELFDynamicObject*>* s_global_objects;
+// Our programs are linked statically, so the only symbols they can offer are the ones in
+// their regular symbol table. We read that once, the first time anyone asks.
+static HashMap<String, u32>* s_executable_symbols;
+
+// dlopen(nullptr) hands this out to mean "the program itself".
+static int s_main_program_handle;
+
+static char s_error_buffer[256];
+static bool s_has_error;
+
+static void set_error(const String& error)
+{
+    strncpy(s_error_buffer, error.characters(), sizeof(s_error_buffer) - 1);
+    s_error_buffer[sizeof(s_error_buffer) - 1] = '\0';
+    s_has_error = true;
+}
+
+static void load_executable_symbols()
+{
+    s_executable_symbols = new HashMap<String, u32>;
+    int fd = open("/proc/self/exe", O_RDONLY);
+    if (fd < 0)
+        return;
+    struct stat st;
+    if (fstat(fd, &st) < 0 || st.st_size == 0) {
+        close(fd);
+        return;
+    }
+    auto* data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+        return;
+    ELFImage image((const u8*)data);
+    if (image.is_valid()) {
+        image.for_each_symbol([](const ELFImage::Symbol& symbol) {
+            if (symbol.section_index() == SHN_UNDEF || symbol.bind() == STB_LOCAL)
+                return IterationDecision::Continue;
+            if (symbol.type() != STT_FUNC && symbol.type() != STT_OBJECT)
+                return IterationDecision::Continue;
+            s_executable_symbols->set(symbol.name(), symbol.value());
+            return IterationDecision::Continue;
+        });
+    }
+    munmap(data, st.st_size);
+}
+
+// The global scope: the program first, then every RTLD_GLOBAL object in load order.
+static void* resolve_global_symbol(const char* name)
+{
+    LOCKER(s_lock);
+    if (!s_executable_symbols)
+        load_executable_symbols();
+    auto it = s_executable_symbols->find(name);
+    if (it != s_executable_symbols->end())
+        return (void*)it->value;
+    if (s_global_objects) {
+        for (auto* object : *s_global_objects) {
+            if (auto* address = object->symbol_for_name(name))
+                return address;
+        }
+    }
+    return nullptr;
+}
+
+static String path_for_library(const char* name)
+{
+    if (strchr(name, '/'))
+        return name;
+    return String::format("%s/%s", library_directory, name);
+}
+
+static void make_global(ELFDynamicObject& object)
+{
+    if (!s_global_objects)
+        s_global_objects = new Vector<ELFDynamicObject*>;
+    if (!s_global_objects->contains_slow(&object))
+        s_global_objects->append(&object);
+}
+
+// Returns the object with one more reference, for the caller to own.
+static ELFDynamicObject* open_object(const String& path, int flags)
+{
+    if (!s_loaded_objects)
+        s_loaded_objects = new HashMap<String, ELFDynamicObject*>;
+
+    auto it = s_loaded_objects->find(path);
+    if (it != s_loaded_objects->end()) {
+        it->value->ref();
+        if (flags & RTLD_GLOBAL)
+            make_global(*it->value);
+        return it->value;
+    }
+
+    String error;
+    auto object = ELFDynamicObject::load(path.characters(), error);
+    if (!object) {
+        set_error(error);
+        return nullptr;
+    }
+
+    // Register the object before loading its dependencies, so that a dependency that
+    // needs it back (directly or further down) finds it instead of loading it again.
+    s_loaded_objects->set(path, object.ptr());
+    auto forget_object = [&] {
+        s_loaded_objects->remove(path);
+        if (s_global_objects)
+            s_global_objects->remove_first_matching([&](auto* entry) { return entry == object.ptr(); });
+    };
+
+    // Dependencies go into the global scope, so that the object can link against them.
+    bool failed = false;
+    object->for_each_needed_library([&](const char* name) {
+        if (failed)
+            return;
+        if (!open_object(path_for_library(name), RTLD_GLOBAL | (flags & RTLD_NOW)))
+            failed = true;
+    });
+    if (failed) {
+        forget_object();
+        return nullptr;
+    }
+
+    if (!object->link(resolve_global_symbol, flags & RTLD_NOW, error)) {
+        set_error(error);
+        forget_object();
+        return nullptr;
+    }
+
+    if (flags & RTLD_GLOBAL)
+        make_global(*object);
+    return object.leak_ref();
+}
 
 extern "C" {
 
-int dlclose(void*)
+void* dlopen(const char* filename, int flags)
 {
-    ASSERT_NOT_REACHED();
+    if (!filename)
+        return &s_main_program_handle;
+    LOCKER(s_lock);
+    return open_object(path_for_library(filename), flags);
 }
 
-char* dlerror()
+void* dlsym(void* handle, const char* name)
 {
-    ASSERT_NOT_REACHED();
+    void* address;
+    if (handle == RTLD_DEFAULT || handle == &s_main_program_handle) {
+        address = resolve_global_symbol(name);
+    } else {
+        LOCKER(s_lock);
+        address = static_cast<ELFDynamicObject*>(handle)->symbol_for_name(name);
+    }
+    if (!address) {
+        LOCKER(s_lock);
+        set_error(String::format("Symbol not found: %s", name));
+    }
+    return address;
 }
 
-void* dlopen(const char*, int)
+int dlclose(void* handle)
 {
-    ASSERT_NOT_REACHED();
+    if (handle == &s_main_program_handle)
+        return 0;
+    LOCKER(s_lock);
+    auto* object = static_cast<ELFDynamicObject*>(handle);
+    if (object->ref_count() == 1) {
+        s_loaded_objects->remove(object->path());
+        if (s_global_objects)
+            s_global_objects->remove_first_matching([&](auto* entry) { return entry == object; });
+    }
+    object->deref();
+    return 0;
 }
 
-void* dlsym(void*, const char*)
+char* dlerror()
 {
-    ASSERT_NOT_REACHED();
+    LOCKER(s_lock);
+    if (!s_has_error)
+        return nullptr;
+    s_has_error = false;
+    return s_error_buffer;
 }
 }
@@ -6,8 +6,10 @@ __BEGIN_DECLS
 
 #define RTLD_LAZY 1
 #define RTLD_NOW 2
-#define RTLD_GLOBAL 3
-#define RTLD_LOCAL 4
+#define RTLD_GLOBAL 0x100
+#define RTLD_LOCAL 0
+
+#define RTLD_DEFAULT ((void*)0)
 
 int dlclose(void*);
 char* dlerror();
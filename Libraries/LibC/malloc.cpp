@@ -2,21 +2,22 @@
 #include <AK/InlineLinkedList.h>
 #include <AK/ScopedValueRollback.h>
 #include <AK/Vector.h>
+#include <Kernel/Syscall.h>
 #include <LibThread/Lock.h>
 #include <assert.h>
+#include <errno.h>
 #include <mallocdefs.h>
 #include <serenity.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <sys/mman.h>
 
-// FIXME: Thread safety.
-
 //#define MALLOC_DEBUG
-#define RECYCLE_BIG_ALLOCATIONS
 
 #define MAGIC_PAGE_HEADER 0x42657274
 #define MAGIC_BIGALLOC_HEADER 0x42697267
+#define MAGIC_MEDIUM_HEADER 0x4d656469
 #define PAGE_ROUND_UP(x) ((((size_t)(x)) + PAGE_SIZE - 1) & (~(PAGE_SIZE - 1)))
 
 static LibThread::Lock& malloc_lock()
@@ -26,11 +27,17 @@ static LibThread::Lock& malloc_lock()
 }
 
 static const int number_of_chunked_blocks_to_keep_around_per_size_class = 32;
-static const int number_of_big_blocks_to_keep_around_per_size_class = 8;
+static const size_t max_chunks_per_thread_cache_batch = 32;
+
+// Allocations too big for a ChunkedBlock but no bigger than this are runs of pages in a
+// MediumArena. Anything bigger gets its own mmap.
+static const size_t max_medium_allocation_pages = 64;
+static const size_t medium_arena_page_count = 256;
+// Once an arena has this many free pages that haven't been given back to the kernel, we do.
+static const size_t max_dirty_pages_per_medium_arena = 64;
 
 static bool s_log_malloc = false;
-static bool s_scrub_malloc = true;
-static bool s_scrub_free = true;
+static bool s_scrub = false;
 static unsigned short size_classes[] = { 8, 16, 32, 64, 128, 252, 508, 1016, 2036, 0 };
 static constexpr size_t num_size_classes = sizeof(size_classes) / sizeof(unsigned short);
 
@@ -48,6 +55,138 @@ struct BigAllocationBlock : public CommonHeader {
     unsigned char* m_slot[0];
 };
 
+struct MediumArena;
+
+struct MediumAllocationHeader : public CommonHeader {
+    MediumArena* m_arena;
+    size_t m_reserved;
+    unsigned char m_slot[0];
+};
+
+// Sizes this close to SIZE_MAX would wrap around when we add a header and round up to
+// whole pages. (The medium header is the biggest one.)
+static bool is_too_big_to_allocate(size_t size)
+{
+    return size > SIZE_MAX - sizeof(MediumAllocationHeader) - PAGE_SIZE;
+}
+
+// A MediumArena is a single mmap. Its first page is this header, and the rest are carved
+// into runs of whole pages. The first and last page of every run have an entry in
+// page_info with the length of the run, and whether it's free. Free neighbours are
+// coalesced as soon as a run is freed, so two free runs are never adjacent.
+struct MediumArena : public InlineLinkedListNode<MediumArena> {
+    static const u16 run_is_free = 0x8000;
+    // Free pages that may still have physical memory behind them.
+    static const u16 run_is_dirty = 0x4000;
+    static const u16 run_length_mask = 0x3fff;
+
+    MediumArena()
+    {
+        set_run(1, usable_page_count(), run_is_free);
+        m_free_pages = usable_page_count();
+    }
+
+    static size_t usable_page_count() { return medium_arena_page_count - 1; }
+
+    u8* page(size_t index) { return (u8*)this + index * PAGE_SIZE; }
+    size_t page_index(const void* ptr) const { return ((uintptr_t)ptr - (uintptr_t)this) / PAGE_SIZE; }
+    size_t run_length(size_t first_page) const { return m_page_info[first_page] & run_length_mask; }
+    bool is_free(size_t first_page) const { return m_page_info[first_page] & run_is_free; }
+    bool is_completely_free() const { return m_free_pages == usable_page_count(); }
+
+    void set_run(size_t first_page, size_t length, u16 flags)
+    {
+        m_page_info[first_page] = length | flags;
+        m_page_info[first_page + length - 1] = length | flags;
+    }
+
+    // Split `length` pages off the front of the free run at `first_page`.
+    void take_from_free_run(size_t first_page, size_t length)
+    {
+        u16 flags = m_page_info[first_page];
+        size_t free_length = flags & run_length_mask;
+        if (free_length > length)
+            set_run(first_page + length, free_length - length, flags & (run_is_free | run_is_dirty));
+        m_free_pages -= length;
+        if (flags & run_is_dirty)
+            m_dirty_free_pages -= min(length, m_dirty_free_pages);
+    }
+
+    u8* allocate_run(size_t length)
+    {
+        if (m_free_pages < length)
+            return nullptr;
+        for (size_t i = 1; i < medium_arena_page_count; i += run_length(i)) {
+            if (is_free(i) && run_length(i) >= length) {
+                take_from_free_run(i, length);
+                set_run(i, length, 0);
+                return page(i);
+            }
+        }
+        return nullptr;
+    }
+
+    void free_run(size_t first_page)
+    {
+        size_t length = run_length(first_page);
+        m_free_pages += length;
+        m_dirty_free_pages += length;
+
+        size_t next = first_page + length;
+        if (next < medium_arena_page_count && is_free(next)) {
+            if (!(m_page_info[next] & run_is_dirty))
+                m_dirty_free_pages += run_length(next);
+            length += run_length(next);
+        }
+        if (first_page > 1 && is_free(first_page - 1)) {
+            size_t previous_length = run_length(first_page - 1);
+            if (!(m_page_info[first_page - 1] & run_is_dirty))
+                m_dirty_free_pages += previous_length;
+            first_page -= previous_length;
+            length += previous_length;
+        }
+        set_run(first_page, length, run_is_free | run_is_dirty);
+    }
+
+    // Make the run at `first_page` `new_length` pages long by taking pages from the free
+    // run right after it, if there is one and it's big enough.
+    bool try_grow_run(size_t first_page, size_t new_length)
+    {
+        size_t length = run_length(first_page);
+        size_t next = first_page + length;
+        if (next >= medium_arena_page_count || !is_free(next) || length + run_length(next) < new_length)
+            return false;
+        take_from_free_run(next, new_length - length);
+        set_run(first_page, new_length, 0);
+        return true;
+    }
+
+    // Tell the kernel it can have the memory behind our free pages back. They'll come
+    // back zeroed if we touch them again.
+    void purge()
+    {
+        for (size_t i = 1; i < medium_arena_page_count; i += run_length(i)) {
+            if (!(m_page_info[i] & run_is_dirty))
+                continue;
+            madvise(page(i), run_length(i) * PAGE_SIZE, MADV_DONTNEED);
+            set_run(i, run_length(i), run_is_free);
+        }
+        m_dirty_free_pages = 0;
+    }
+
+    size_t dirty_free_pages() const { return m_dirty_free_pages; }
+
+    MediumArena* m_prev { nullptr };
+    MediumArena* m_next { nullptr };
+
+private:
+    size_t m_free_pages { 0 };
+    size_t m_dirty_free_pages { 0 };
+    u16 m_page_info[medium_arena_page_count] {};
+};
+
+static_assert(sizeof(MediumArena) <= PAGE_SIZE);
+
 struct FreelistEntry {
     FreelistEntry* next;
 };
@@ -89,16 +228,30 @@ struct ChunkedBlock : public CommonHeader
 struct Allocator {
     size_t size { 0 };
     size_t block_count { 0 };
+    // How many chunks move between a thread cache and this allocator at a time.
+    size_t batch_size { 0 };
+    // Every block in usable_blocks has at least one free chunk, so the head is always a good pick.
     InlineLinkedList<ChunkedBlock> usable_blocks;
     InlineLinkedList<ChunkedBlock> full_blocks;
 };
 
-struct BigAllocator {
-    Vector<BigAllocationBlock*, number_of_big_blocks_to_keep_around_per_size_class> blocks;
+// Each thread keeps a small stack ("magazine") of free chunks for every size class, so
+// most calls to malloc() and free() never touch the lock. Magazines are refilled from
+// and flushed to the allocators above in batches. The kernel points %gs at each thread's
+// cache (see set_thread_pointer()), and the first word of the cache points to itself.
+struct ThreadCache {
+    ThreadCache* self;
+    struct Magazine {
+        FreelistEntry* chunks;
+        size_t count;
+    } magazines[num_size_classes - 1];
 };
 
 static Allocator g_allocators[num_size_classes];
-static BigAllocator g_big_allocators[1];
+static InlineLinkedList<MediumArena> g_medium_arenas;
+
+static u16 s_thread_cache_selector;
+static bool s_thread_caches_unavailable;
 
 static Allocator* allocator_for_size(size_t size, size_t& good_size)
 {
@@ -112,11 +265,9 @@ static Allocator* allocator_for_size(size_t size, size_t& good_size)
     return nullptr;
 }
 
-static BigAllocator* big_allocator_for_size(size_t size)
+static ChunkedBlock* block_for_chunk(void* ptr)
 {
-    if (size == 4096)
-        return &g_big_allocators[0];
-    return nullptr;
+    return (ChunkedBlock*)((uintptr_t)ptr & (uintptr_t)~0xfff);
 }
 
 extern "C" {
@@ -141,48 +292,48 @@ static void os_free(void* ptr, size_t size)
     assert(rc == 0);
 }
 
-void* malloc(size_t size)
+static ThreadCache* thread_cache()
 {
-    LOCKER(malloc_lock());
-
-    if (s_log_malloc)
-        dbgprintf("LibC: malloc(%u)\n", size);
-
-    if (!size)
-        return nullptr;
-
-    size_t good_size;
-    auto* allocator = allocator_for_size(size, good_size);
-
-    if (!allocator) {
-        size_t real_size = PAGE_ROUND_UP(sizeof(BigAllocationBlock) + size);
-#ifdef RECYCLE_BIG_ALLOCATIONS
-        if (auto* allocator = big_allocator_for_size(real_size)) {
-            if (!allocator->blocks.is_empty()) {
-                auto* block = allocator->blocks.take_last();
-                return &block->m_slot[0];
-            }
-        }
-#endif
-        auto* block = (BigAllocationBlock*)os_alloc(real_size, "malloc: BigAllocationBlock");
-        new (block) BigAllocationBlock(real_size);
-        return &block->m_slot[0];
+    u16 gs;
+    asm volatile("movw %%gs, %0"
+                 : "=r"(gs));
+    if (s_thread_cache_selector && gs == s_thread_cache_selector) {
+        ThreadCache* cache;
+        asm volatile("movl %%gs:0, %0"
+                     : "=r"(cache));
+        return cache;
     }
+    if (s_thread_caches_unavailable)
+        return nullptr;
 
-    ChunkedBlock* block = nullptr;
-
-    for (block = allocator->usable_blocks.head(); block; block = block->next()) {
-        if (block->free_chunks())
-            break;
+    // This is the first time this thread has called malloc().
+    auto* cache = (ThreadCache*)os_alloc(PAGE_ROUND_UP(sizeof(ThreadCache)), "malloc: ThreadCache");
+    if (cache == MAP_FAILED)
+        return nullptr;
+    cache->self = cache;
+    int rc = syscall(SC_set_thread_pointer, cache);
+    if (rc < 0) {
+        os_free(cache, PAGE_ROUND_UP(sizeof(ThreadCache)));
+        s_thread_caches_unavailable = true;
+        return nullptr;
     }
+    s_thread_cache_selector = rc;
+    return cache;
+}
 
+// Take a chunk from the allocator's first usable block. The caller must hold the lock.
+static void* allocate_chunk(Allocator& allocator, size_t good_size)
+{
+    auto* block = allocator.usable_blocks.head();
     if (!block) {
         char buffer[64];
         snprintf(buffer, sizeof(buffer), "malloc: ChunkedBlock(%zu)", good_size);
         block = (ChunkedBlock*)os_alloc(PAGE_SIZE, buffer);
+        if (block == MAP_FAILED)
+            return nullptr;
         new (block) ChunkedBlock(good_size);
-        allocator->usable_blocks.append(block);
-        ++allocator->block_count;
+        allocator.usable_blocks.append(block);
+        ++allocator.block_count;
     }
 
     --block->m_free_chunks;
@@ -192,53 +343,25 @@ void* malloc(size_t size)
 #ifdef MALLOC_DEBUG
         dbgprintf("Block %p is now full in size class %u\n", block, good_size);
 #endif
-        allocator->usable_blocks.remove(block);
-        allocator->full_blocks.append(block);
+        allocator.usable_blocks.remove(block);
+        allocator.full_blocks.append(block);
     }
 #ifdef MALLOC_DEBUG
     dbgprintf("LibC: allocated %p (chunk in block %p, size %u)\n", ptr, block, block->bytes_per_chunk());
 #endif
-    if (s_scrub_malloc)
-        memset(ptr, MALLOC_SCRUB_BYTE, block->m_size);
     return ptr;
 }
 
-void free(void* ptr)
+// Give a chunk back to its block. The caller must hold the lock.
+static void free_chunk(void* ptr)
 {
-    ScopedValueRollback rollback(errno);
-
-    if (!ptr)
-        return;
-
-    LOCKER(malloc_lock());
-
-    void* page_base = (void*)((uintptr_t)ptr & (uintptr_t)~0xfff);
-    size_t magic = *(size_t*)page_base;
-
-    if (magic == MAGIC_BIGALLOC_HEADER) {
-        auto* block = (BigAllocationBlock*)page_base;
-#ifdef RECYCLE_BIG_ALLOCATIONS
-        if (auto* allocator = big_allocator_for_size(block->m_size)) {
-            if (allocator->blocks.size() < number_of_big_blocks_to_keep_around_per_size_class) {
-                allocator->blocks.append(block);
-                return;
-            }
-        }
-#endif
-        os_free(block, block->m_size);
-        return;
-    }
-
-    assert(magic == MAGIC_PAGE_HEADER);
-    auto* block = (ChunkedBlock*)page_base;
+    auto* block = block_for_chunk(ptr);
+    assert(block->m_magic == MAGIC_PAGE_HEADER);
 
 #ifdef MALLOC_DEBUG
     dbgprintf("LibC: freeing %p in allocator %p (size=%u, used=%u)\n", ptr, block, block->bytes_per_chunk(), block->used_chunks());
 #endif
 
-    if (s_scrub_free)
-        memset(ptr, FREE_SCRUB_BYTE, block->bytes_per_chunk());
-
     auto* entry = (FreelistEntry*)ptr;
     entry->next = block->m_freelist;
     block->m_freelist = entry;
@@ -280,6 +403,189 @@ void free(void* ptr)
     }
 }
 
+// Carve a run of pages out of the first arena with room for it. The caller must hold the lock.
+static void* allocate_medium(size_t page_count)
+{
+    u8* run = nullptr;
+    MediumArena* arena = g_medium_arenas.head();
+    for (; arena; arena = arena->next()) {
+        if ((run = arena->allocate_run(page_count)))
+            break;
+    }
+    if (!run) {
+        arena = (MediumArena*)os_alloc(medium_arena_page_count * PAGE_SIZE, "malloc: MediumArena");
+        if (arena == MAP_FAILED)
+            return nullptr;
+        new (arena) MediumArena;
+        g_medium_arenas.prepend(arena);
+        run = arena->allocate_run(page_count);
+        assert(run);
+    }
+    auto* header = (MediumAllocationHeader*)run;
+    header->m_magic = MAGIC_MEDIUM_HEADER;
+    header->m_size = page_count * PAGE_SIZE;
+    header->m_arena = arena;
+#ifdef MALLOC_DEBUG
+    dbgprintf("LibC: allocated %p (%u pages in arena %p)\n", &header->m_slot[0], page_count, arena);
+#endif
+    return &header->m_slot[0];
+}
+
+// The caller must hold the lock.
+static void free_medium(MediumAllocationHeader* header)
+{
+    auto* arena = header->m_arena;
+    arena->free_run(arena->page_index(header));
+    if (arena->is_completely_free() && g_medium_arenas.head() != g_medium_arenas.tail()) {
+        g_medium_arenas.remove(arena);
+        os_free(arena, medium_arena_page_count * PAGE_SIZE);
+        return;
+    }
+    if (arena->dirty_free_pages() > max_dirty_pages_per_medium_arena)
+        arena->purge();
+}
+
+static void refill_magazine(ThreadCache::Magazine& magazine, Allocator& allocator, size_t good_size)
+{
+    LOCKER(malloc_lock());
+    for (size_t i = 0; i < allocator.batch_size; ++i) {
+        auto* entry = (FreelistEntry*)allocate_chunk(allocator, good_size);
+        if (!entry)
+            break;
+        entry->next = magazine.chunks;
+        magazine.chunks = entry;
+        ++magazine.count;
+    }
+}
+
+static void flush_magazine(ThreadCache::Magazine& magazine, size_t count)
+{
+    LOCKER(malloc_lock());
+    for (size_t i = 0; i < count && magazine.chunks; ++i) {
+        auto* entry = magazine.chunks;
+        magazine.chunks = entry->next;
+        --magazine.count;
+        free_chunk(entry);
+    }
+}
+
+void* malloc(size_t size)
+{
+    if (s_log_malloc)
+        dbgprintf("LibC: malloc(%u)\n", size);
+
+    if (!size)
+        return nullptr;
+
+    size_t good_size;
+    auto* allocator = allocator_for_size(size, good_size);
+
+    if (!allocator) {
+        if (is_too_big_to_allocate(size)) {
+            errno = ENOMEM;
+            return nullptr;
+        }
+        size_t medium_size = PAGE_ROUND_UP(sizeof(MediumAllocationHeader) + size);
+        if (medium_size <= max_medium_allocation_pages * PAGE_SIZE) {
+            LOCKER(malloc_lock());
+            void* ptr = allocate_medium(medium_size / PAGE_SIZE);
+            if (ptr && s_scrub)
+                memset(ptr, MALLOC_SCRUB_BYTE, size);
+            return ptr;
+        }
+        size_t real_size = PAGE_ROUND_UP(sizeof(BigAllocationBlock) + size);
+        auto* block = (BigAllocationBlock*)os_alloc(real_size, "malloc: BigAllocationBlock");
+        if (block == MAP_FAILED)
+            return nullptr;
+        new (block) BigAllocationBlock(real_size);
+        return &block->m_slot[0];
+    }
+
+    // Batch sizes are set in __malloc_init(), and anything before that goes straight to the allocator.
+    void* ptr = nullptr;
+    auto* cache = allocator->batch_size ? thread_cache() : nullptr;
+    if (cache) {
+        auto& magazine = cache->magazines[allocator - g_allocators];
+        if (!magazine.count)
+            refill_magazine(magazine, *allocator, good_size);
+        if (magazine.count) {
+            ptr = magazine.chunks;
+            magazine.chunks = magazine.chunks->next;
+            --magazine.count;
+        }
+    } else {
+        LOCKER(malloc_lock());
+        ptr = allocate_chunk(*allocator, good_size);
+    }
+
+    if (ptr && s_scrub)
+        memset(ptr, MALLOC_SCRUB_BYTE, good_size);
+    return ptr;
+}
+
+void free(void* ptr)
+{
+    ScopedValueRollback rollback(errno);
+
+    if (!ptr)
+        return;
+
+    void* page_base = (void*)((uintptr_t)ptr & (uintptr_t)~0xfff);
+    size_t magic = *(size_t*)page_base;
+
+    if (magic == MAGIC_BIGALLOC_HEADER) {
+        auto* block = (BigAllocationBlock*)page_base;
+        os_free(block, block->m_size);
+        return;
+    }
+
+    if (magic == MAGIC_MEDIUM_HEADER) {
+        auto* header = (MediumAllocationHeader*)page_base;
+        if (s_scrub)
+            memset(ptr, FREE_SCRUB_BYTE, header->m_size - sizeof(MediumAllocationHeader));
+        LOCKER(malloc_lock());
+        free_medium(header);
+        return;
+    }
+
+    assert(magic == MAGIC_PAGE_HEADER);
+    auto* block = (ChunkedBlock*)page_base;
+
+    if (s_scrub)
+        memset(ptr, FREE_SCRUB_BYTE, block->bytes_per_chunk());
+
+    size_t good_size;
+    auto* allocator = allocator_for_size(block->m_size, good_size);
+    auto* cache = allocator->batch_size ? thread_cache() : nullptr;
+    if (!cache) {
+        LOCKER(malloc_lock());
+        free_chunk(ptr);
+        return;
+    }
+
+    auto& magazine = cache->magazines[allocator - g_allocators];
+    auto* entry = (FreelistEntry*)ptr;
+    entry->next = magazine.chunks;
+    magazine.chunks = entry;
+    ++magazine.count;
+    if (magazine.count > 2 * allocator->batch_size)
+        flush_magazine(magazine, allocator->batch_size);
+}
+
+void __malloc_thread_exit()
+{
+    u16 gs;
+    asm volatile("movw %%gs, %0"
+                 : "=r"(gs));
+    if (!s_thread_cache_selector || gs != s_thread_cache_selector)
+        return;
+    auto* cache = thread_cache();
+    for (auto& magazine : cache->magazines)
+        flush_magazine(magazine, magazine.count);
+    // Nothing touches %gs after this, since the thread is on its way out.
+    os_free(cache, PAGE_ROUND_UP(sizeof(ThreadCache)));
+}
+
 void* calloc(size_t count, size_t size)
 {
     size_t new_size = count * size;
@@ -292,12 +598,13 @@ size_t malloc_size(void* ptr)
 {
     if (!ptr)
         return 0;
-    LOCKER(malloc_lock());
     void* page_base = (void*)((uintptr_t)ptr & (uintptr_t)~0xfff);
     auto* header = (const CommonHeader*)page_base;
     auto size = header->m_size;
     if (header->m_magic == MAGIC_BIGALLOC_HEADER)
         size -= sizeof(CommonHeader);
+    else if (header->m_magic == MAGIC_MEDIUM_HEADER)
+        size -= sizeof(MediumAllocationHeader);
     return size;
 }
 
@@ -305,11 +612,29 @@ void* realloc(void* ptr, size_t size)
 {
     if (!ptr)
         return malloc(size);
-    LOCKER(malloc_lock());
     auto existing_allocation_size = malloc_size(ptr);
     if (size <= existing_allocation_size)
         return ptr;
+    if (is_too_big_to_allocate(size)) {
+        errno = ENOMEM;
+        return nullptr;
+    }
+
+    void* page_base = (void*)((uintptr_t)ptr & (uintptr_t)~0xfff);
+    auto* header = (MediumAllocationHeader*)page_base;
+    size_t medium_size = PAGE_ROUND_UP(sizeof(MediumAllocationHeader) + size);
+    if (header->m_magic == MAGIC_MEDIUM_HEADER && medium_size <= max_medium_allocation_pages * PAGE_SIZE) {
+        LOCKER(malloc_lock());
+        auto* arena = header->m_arena;
+        if (arena->try_grow_run(arena->page_index(header), medium_size / PAGE_SIZE)) {
+            header->m_size = medium_size;
+            return ptr;
+        }
+    }
+
     auto* new_ptr = malloc(size);
+    if (!new_ptr)
+        return nullptr;
     memcpy(new_ptr, ptr, min(existing_allocation_size, size));
     free(ptr);
     return new_ptr;
@@ -318,10 +643,14 @@ void* realloc(void* ptr, size_t size)
 void __malloc_init()
 {
     new (&malloc_lock()) LibThread::Lock();
-    if (getenv("LIBC_NOSCRUB_MALLOC"))
-        s_scrub_malloc = false;
-    if (getenv("LIBC_NOSCRUB_FREE"))
-        s_scrub_free = false;
+    for (size_t i = 0; size_classes[i]; ++i) {
+        size_t chunk_capacity = (PAGE_SIZE - sizeof(ChunkedBlock)) / size_classes[i];
+        g_allocators[i].batch_size = max((size_t)1, min(max_chunks_per_thread_cache_batch, chunk_capacity / 2));
+    }
+    // Filling new allocations and freed memory with a pattern makes use of uninitialized
+    // and freed memory easier to spot, but it's too slow to do all the time.
+    if (getenv("LIBC_SCRUB_MALLOC"))
+        s_scrub = true;
     if (getenv("LIBC_LOG_MALLOC"))
         s_log_malloc = true;
 }
@@ -39,6 +39,12 @@ int mprotect(void* addr, size_t size, int prot)
     __RETURN_WITH_ERRNO(rc, rc, -1);
 }
 
+int madvise(void* address, size_t size, int advice)
+{
+    int rc = syscall(SC_madvise, address, size, advice);
+    __RETURN_WITH_ERRNO(rc, rc, -1);
+}
+
 int set_mmap_name(void* addr, size_t size, const char* name)
 {
     int rc = syscall(SC_set_mmap_name, addr, size, name);
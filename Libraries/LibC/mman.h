@@ -16,12 +16,16 @@
 
 #define MAP_FAILED ((void*)-1)
 
+#define MADV_NORMAL 0
+#define MADV_DONTNEED 4
+
 __BEGIN_DECLS
 
 void* mmap(void* addr, size_t, int prot, int flags, int fd, off_t);
 void* mmap_with_name(void* addr, size_t, int prot, int flags, int fd, off_t, const char* name);
 int munmap(void*, size_t);
 int mprotect(void*, size_t, int prot);
+int madvise(void*, size_t, int advice);
 int set_mmap_name(void*, size_t, const char*);
 int shm_open(const char* name, int flags, mode_t);
 int shm_unlink(const char* name);
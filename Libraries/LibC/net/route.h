@@ -0,0 +1,19 @@
+#pragma once
+
+#include <sys/cdefs.h>
+#include <sys/socket.h>
+
+__BEGIN_DECLS
+
+#define RTF_UP 0x1
+#define RTF_GATEWAY 0x2
+
+struct rtentry {
+    struct sockaddr_in rt_dst;
+    struct sockaddr_in rt_gateway;
+    struct sockaddr_in rt_genmask;
+    unsigned short rt_flags;
+    char* rt_dev;
+};
+
+__END_DECLS
@@ -0,0 +1,304 @@
+#include <AK/Types.h>
+#include <errno.h>
+#include <limits.h>
+#include <pthread.h>
+#include <sys/futex.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+extern "C" {
+
+// The mutex is the three-state lock from Ulrich Drepper's "Futexes Are Tricky":
+// 0 is unlocked, 1 is locked, and 2 is locked with possible waiters. Only a thread that
+// saw the lock word at 2 when unlocking has to go into the kernel to wake somebody up.
+
+static void mutex_lock_contended(pthread_mutex_t* mutex, u32 state)
+{
+    if (state != 2)
+        state = __atomic_exchange_n(&mutex->lock, 2, __ATOMIC_ACQUIRE);
+    while (state != 0) {
+        futex(&mutex->lock, FUTEX_WAIT, 2, nullptr, nullptr, 0);
+        state = __atomic_exchange_n(&mutex->lock, 2, __ATOMIC_ACQUIRE);
+    }
+}
+
+static void mutex_unlock(pthread_mutex_t* mutex)
+{
+    if (__atomic_fetch_sub(&mutex->lock, 1, __ATOMIC_RELEASE) != 1) {
+        __atomic_store_n(&mutex->lock, 0, __ATOMIC_RELEASE);
+        futex(&mutex->lock, FUTEX_WAKE, 1, nullptr, nullptr, 0);
+    }
+}
+
+int pthread_mutex_init(pthread_mutex_t* mutex, const pthread_mutexattr_t* attributes)
+{
+    mutex->lock = 0;
+    mutex->owner = 0;
+    mutex->level = 0;
+    mutex->type = attributes ? attributes->type : PTHREAD_MUTEX_DEFAULT;
+    return 0;
+}
+
+int pthread_mutex_destroy(pthread_mutex_t* mutex)
+{
+    if (mutex->lock)
+        return EBUSY;
+    return 0;
+}
+
+int pthread_mutex_lock(pthread_mutex_t* mutex)
+{
+    pid_t tid = 0;
+    if (mutex->type == PTHREAD_MUTEX_RECURSIVE) {
+        tid = gettid();
+        if (mutex->owner == tid) {
+            ++mutex->level;
+            return 0;
+        }
+    }
+    u32 expected = 0;
+    if (!__atomic_compare_exchange_n(&mutex->lock, &expected, 1, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+        mutex_lock_contended(mutex, expected);
+    mutex->owner = tid;
+    mutex->level = 1;
+    return 0;
+}
+
+int pthread_mutex_trylock(pthread_mutex_t* mutex)
+{
+    pid_t tid = 0;
+    if (mutex->type == PTHREAD_MUTEX_RECURSIVE) {
+        tid = gettid();
+        if (mutex->owner == tid) {
+            ++mutex->level;
+            return 0;
+        }
+    }
+    u32 expected = 0;
+    if (!__atomic_compare_exchange_n(&mutex->lock, &expected, 1, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+        return EBUSY;
+    mutex->owner = tid;
+    mutex->level = 1;
+    return 0;
+}
+
+int pthread_mutex_unlock(pthread_mutex_t* mutex)
+{
+    if (mutex->type == PTHREAD_MUTEX_RECURSIVE) {
+        if (mutex->owner != gettid())
+            return EPERM;
+        if (--mutex->level)
+            return 0;
+        mutex->owner = 0;
+    }
+    mutex_unlock(mutex);
+    return 0;
+}
+
+int pthread_mutexattr_init(pthread_mutexattr_t* attributes)
+{
+    attributes->type = PTHREAD_MUTEX_DEFAULT;
+    return 0;
+}
+
+int pthread_mutexattr_destroy(pthread_mutexattr_t*)
+{
+    return 0;
+}
+
+int pthread_mutexattr_settype(pthread_mutexattr_t* attributes, int type)
+{
+    if (type != PTHREAD_MUTEX_NORMAL && type != PTHREAD_MUTEX_RECURSIVE)
+        return EINVAL;
+    attributes->type = type;
+    return 0;
+}
+
+int pthread_mutexattr_gettype(const pthread_mutexattr_t* attributes, int* type)
+{
+    *type = attributes->type;
+    return 0;
+}
+
+// A condition variable is a sequence number that every signal bumps. A waiter samples it
+// before dropping the mutex, and futex() refuses to put it to sleep if it has moved on
+// since, so a signal can't get lost in between. The waiter count lets signal() and
+// broadcast() skip the system call when nobody is waiting.
+
+int pthread_cond_init(pthread_cond_t* cond, const pthread_condattr_t*)
+{
+    cond->sequence = 0;
+    cond->waiters = 0;
+    cond->mutex = nullptr;
+    return 0;
+}
+
+int pthread_cond_destroy(pthread_cond_t* cond)
+{
+    if (__atomic_load_n(&cond->waiters, __ATOMIC_SEQ_CST))
+        return EBUSY;
+    return 0;
+}
+
+static int cond_wait(pthread_cond_t* cond, pthread_mutex_t* mutex, const struct timespec* timeout)
+{
+    // broadcast() uses the mutex as soon as it sees a waiter, so publish it first.
+    __atomic_store_n(&cond->mutex, mutex, __ATOMIC_SEQ_CST);
+    __atomic_fetch_add(&cond->waiters, 1, __ATOMIC_SEQ_CST);
+    u32 sequence = __atomic_load_n(&cond->sequence, __ATOMIC_SEQ_CST);
+
+    // A recursive mutex is released all the way, and restored to the same depth afterwards.
+    pid_t owner = mutex->owner;
+    int level = mutex->level;
+    mutex->owner = 0;
+    mutex->level = 0;
+    mutex_unlock(mutex);
+
+    int saved_errno = errno;
+    int rc = futex(&cond->sequence, FUTEX_WAIT, sequence, timeout, nullptr, 0);
+    bool timed_out = rc < 0 && errno == ETIMEDOUT;
+    errno = saved_errno;
+
+    // broadcast() may have moved us over to the mutex's wait queue, so we have to take
+    // the mutex as contended. That way our unlock passes the wakeup on to the next one.
+    mutex_lock_contended(mutex, 1);
+    mutex->owner = owner;
+    mutex->level = level;
+
+    __atomic_fetch_sub(&cond->waiters, 1, __ATOMIC_SEQ_CST);
+    return timed_out ? ETIMEDOUT : 0;
+}
+
+int pthread_cond_wait(pthread_cond_t* cond, pthread_mutex_t* mutex)
+{
+    return cond_wait(cond, mutex, nullptr);
+}
+
+int pthread_cond_timedwait(pthread_cond_t* cond, pthread_mutex_t* mutex, const struct timespec* abstime)
+{
+    // futex() wants a relative timeout, while we're given a CLOCK_REALTIME deadline.
+    struct timeval now;
+    gettimeofday(&now, nullptr);
+    // time_t is unsigned, so do the subtraction in signed arithmetic.
+    i64 seconds = (i64)abstime->tv_sec - (i64)now.tv_sec;
+    long nanoseconds = abstime->tv_nsec - now.tv_usec * 1000;
+    if (nanoseconds < 0) {
+        --seconds;
+        nanoseconds += 1000000000;
+    }
+    if (seconds < 0)
+        return ETIMEDOUT;
+    struct timespec relative;
+    relative.tv_sec = seconds;
+    relative.tv_nsec = nanoseconds;
+    return cond_wait(cond, mutex, &relative);
+}
+
+int pthread_cond_signal(pthread_cond_t* cond)
+{
+    __atomic_fetch_add(&cond->sequence, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&cond->waiters, __ATOMIC_SEQ_CST))
+        futex(&cond->sequence, FUTEX_WAKE, 1, nullptr, nullptr, 0);
+    return 0;
+}
+
+int pthread_cond_broadcast(pthread_cond_t* cond)
+{
+    __atomic_fetch_add(&cond->sequence, 1, __ATOMIC_SEQ_CST);
+    if (!__atomic_load_n(&cond->waiters, __ATOMIC_SEQ_CST))
+        return 0;
+    // Only one waiter can get the mutex anyway, so wake that one and move the rest straight
+    // over to the mutex, instead of waking them all up just to have them go back to sleep.
+    auto* mutex = __atomic_load_n(&cond->mutex, __ATOMIC_SEQ_CST);
+    futex(&cond->sequence, FUTEX_REQUEUE, 1, nullptr, &mutex->lock, INT_MAX);
+    return 0;
+}
+
+int pthread_condattr_init(pthread_condattr_t*)
+{
+    return 0;
+}
+
+int pthread_condattr_destroy(pthread_condattr_t*)
+{
+    return 0;
+}
+
+// The read/write lock word holds the number of readers, or PTHREAD_RWLOCK_WRITE_LOCKED.
+// Waiters sleep on the word itself, so any change to it lets them re-check.
+
+int pthread_rwlock_init(pthread_rwlock_t* rwlock, const pthread_rwlockattr_t*)
+{
+    rwlock->state = 0;
+    rwlock->waiters = 0;
+    return 0;
+}
+
+int pthread_rwlock_destroy(pthread_rwlock_t* rwlock)
+{
+    if (rwlock->state)
+        return EBUSY;
+    return 0;
+}
+
+static void rwlock_wait(pthread_rwlock_t* rwlock, u32 state)
+{
+    int saved_errno = errno;
+    __atomic_fetch_add(&rwlock->waiters, 1, __ATOMIC_SEQ_CST);
+    futex(&rwlock->state, FUTEX_WAIT, state, nullptr, nullptr, 0);
+    __atomic_fetch_sub(&rwlock->waiters, 1, __ATOMIC_SEQ_CST);
+    errno = saved_errno;
+}
+
+int pthread_rwlock_tryrdlock(pthread_rwlock_t* rwlock)
+{
+    u32 state = __atomic_load_n(&rwlock->state, __ATOMIC_RELAXED);
+    while (state < PTHREAD_RWLOCK_WRITE_LOCKED - 1) {
+        if (__atomic_compare_exchange_n(&rwlock->state, &state, state + 1, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+            return 0;
+    }
+    return state == PTHREAD_RWLOCK_WRITE_LOCKED ? EBUSY : EAGAIN;
+}
+
+int pthread_rwlock_rdlock(pthread_rwlock_t* rwlock)
+{
+    for (;;) {
+        int rc = pthread_rwlock_tryrdlock(rwlock);
+        if (rc != EBUSY)
+            return rc;
+        rwlock_wait(rwlock, PTHREAD_RWLOCK_WRITE_LOCKED);
+    }
+}
+
+int pthread_rwlock_trywrlock(pthread_rwlock_t* rwlock)
+{
+    u32 expected = 0;
+    if (__atomic_compare_exchange_n(&rwlock->state, &expected, PTHREAD_RWLOCK_WRITE_LOCKED, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+        return 0;
+    return EBUSY;
+}
+
+int pthread_rwlock_wrlock(pthread_rwlock_t* rwlock)
+{
+    for (;;) {
+        u32 expected = 0;
+        if (__atomic_compare_exchange_n(&rwlock->state, &expected, PTHREAD_RWLOCK_WRITE_LOCKED, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+            return 0;
+        rwlock_wait(rwlock, expected);
+    }
+}
+
+int pthread_rwlock_unlock(pthread_rwlock_t* rwlock)
+{
+    u32 state = __atomic_load_n(&rwlock->state, __ATOMIC_RELAXED);
+    if (!state)
+        return EPERM;
+    if (state == PTHREAD_RWLOCK_WRITE_LOCKED)
+        __atomic_store_n(&rwlock->state, 0, __ATOMIC_SEQ_CST);
+    else if (__atomic_sub_fetch(&rwlock->state, 1, __ATOMIC_SEQ_CST) != 0)
+        return 0;
+    if (__atomic_load_n(&rwlock->waiters, __ATOMIC_SEQ_CST))
+        futex(&rwlock->state, FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+    return 0;
+}
+}
@@ -1,19 +1,50 @@
 #pragma once
 
 #include <sched.h>
+#include <stdint.h>
 #include <sys/cdefs.h>
+#include <sys/types.h>
+#include <time.h>
 
 __BEGIN_DECLS
 
 typedef void* pthread_t;
 typedef void* pthread_key_t;
 typedef void* pthread_once_t;
-typedef void* pthread_mutex_t;
 typedef void* pthread_attr_t;
-typedef void* pthread_mutexattr_t;
-typedef void* pthread_cond_t;
 typedef void* pthread_spinlock_t;
-typedef void* pthread_condattr_t;
+
+// All of these are built on futex(). The lock words below are the futex words, and an
+// uncontended lock or unlock never leaves userspace.
+typedef struct __pthread_mutex_t {
+    uint32_t lock; // 0: unlocked, 1: locked, 2: locked and somebody may be waiting.
+    pid_t owner;
+    int level;
+    int type;
+} pthread_mutex_t;
+
+typedef struct __pthread_mutexattr_t {
+    int type;
+} pthread_mutexattr_t;
+
+typedef struct __pthread_cond_t {
+    uint32_t sequence;
+    uint32_t waiters;
+    pthread_mutex_t* mutex;
+} pthread_cond_t;
+
+typedef struct __pthread_condattr_t {
+    int unused;
+} pthread_condattr_t;
+
+typedef struct __pthread_rwlock_t {
+    uint32_t state; // Reader count, or PTHREAD_RWLOCK_WRITE_LOCKED.
+    uint32_t waiters;
+} pthread_rwlock_t;
+
+typedef struct __pthread_rwlockattr_t {
+    int unused;
+} pthread_rwlockattr_t;
 
 int pthread_create(pthread_t, pthread_attr_t*, void* (*)(void*), void*);
 void pthread_exit(void*);
@@ -31,14 +62,16 @@ int pthread_attr_destroy(pthread_attr_t*);
 
 int pthread_once(pthread_once_t*, void (*)(void));
 #define PTHREAD_ONCE_INIT 0
-pthread_once_t once_control = PTHREAD_ONCE_INIT;
 void* pthread_getspecific(pthread_key_t key);
 int pthread_setspecific(pthread_key_t key, const void* value);
 
 #define PTHREAD_MUTEX_NORMAL 0
 #define PTHREAD_MUTEX_RECURSIVE 1
-#define PTHREAD_MUTEX_INITIALIZER 0
-#define PTHREAD_COND_INITIALIZER 0
+#define PTHREAD_MUTEX_DEFAULT PTHREAD_MUTEX_NORMAL
+#define PTHREAD_MUTEX_INITIALIZER { 0, 0, 0, PTHREAD_MUTEX_DEFAULT }
+#define PTHREAD_COND_INITIALIZER { 0, 0, 0 }
+#define PTHREAD_RWLOCK_INITIALIZER { 0, 0 }
+#define PTHREAD_RWLOCK_WRITE_LOCKED 0xffffffffu
 
 int pthread_key_create(pthread_key_t* key, void (*destructor)(void*));
 int pthread_key_delete(pthread_key_t key);
@@ -71,5 +104,15 @@ void pthread_exit(void*);
 int pthread_mutexattr_init(pthread_mutexattr_t*);
 int pthread_mutexattr_settype(pthread_mutexattr_t*, int);
 int pthread_mutexattr_destroy(pthread_mutexattr_t*);
+int pthread_mutexattr_gettype(const pthread_mutexattr_t*, int*);
+int pthread_condattr_init(pthread_condattr_t*);
+
+int pthread_rwlock_init(pthread_rwlock_t*, const pthread_rwlockattr_t*);
+int pthread_rwlock_destroy(pthread_rwlock_t*);
+int pthread_rwlock_rdlock(pthread_rwlock_t*);
+int pthread_rwlock_tryrdlock(pthread_rwlock_t*);
+int pthread_rwlock_wrlock(pthread_rwlock_t*);
+int pthread_rwlock_trywrlock(pthread_rwlock_t*);
+int pthread_rwlock_unlock(pthread_rwlock_t*);
 
 __END_DECLS
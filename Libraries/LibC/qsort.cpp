@@ -1,100 +1,273 @@
-/*-
- * Copyright (c) 1980, 1983, 1990 The Regents of the University of California.
- * All rights reserved.
- *
- * Redistribution and use in source and binary forms, with or without
- * modification, are permitted provided that the following conditions
- * are met:
- * 1. Redistributions of source code must retain the above copyright
- *    notice, this list of conditions and the following disclaimer.
- * 2. Redistributions in binary form must reproduce the above copyright
- *    notice, this list of conditions and the following disclaimer in the
- *    documentation and/or other materials provided with the distribution.
- * 3. All advertising materials mentioning features or use of this software
- *    must display the following acknowledgement:
- *	This product includes software developed by the University of
- *	California, Berkeley and its contributors.
- * 4. Neither the name of the University nor the names of its contributors
- *    may be used to endorse or promote products derived from this software
- *    without specific prior written permission.
- *
- * THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS ``AS IS'' AND
- * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
- * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
- * ARE DISCLAIMED.  IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE
- * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
- * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
- * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
- * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
- * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
- * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
- * SUCH DAMAGE.
- */
-
-#if defined(LIBC_SCCS) && !defined(lint)
-static char sccsid[] = "@(#)qsort.c	5.9 (Berkeley) 2/23/91";
-#endif /* LIBC_SCCS and not lint */
-
+#include <AK/Types.h>
 #include <stdlib.h>
 #include <sys/types.h>
 
-static void insertion_sort(void* bot, size_t nmemb, size_t size, int (*compar)(const void*, const void*));
-static void insertion_sort_r(void* bot, size_t nmemb, size_t size, int (*compar)(const void*, const void*, void*), void* arg);
+// This is the same pattern-defeating quicksort as AK::quick_sort() (see AK/QuickSort.h),
+// adapted to elements whose size we only know at runtime. Without a type to hold a
+// temporary, the pivot stays at the start of the range while we partition, and insertion
+// sort moves elements with swaps.
+//
+// Unlike the AK version, every scan here is bounded by the other end of the range instead
+// of relying on a sentinel element to stop it. The comparator comes from the caller, and one
+// that isn't a strict weak ordering must only leave the array in an unspecified order, not
+// send us walking off either end of it.
 
-void qsort(void* bot, size_t nmemb, size_t size, int (*compar)(const void*, const void*))
-{
-    if (nmemb <= 1)
-        return;
+namespace {
+
+const size_t insertion_sort_threshold = 24;
+const size_t ninther_threshold = 128;
+const size_t partial_insertion_sort_limit = 8;
+
+template<typename Compare>
+class Sorter {
+public:
+    Sorter(size_t element_size, Compare compare)
+        : m_element_size(element_size)
+        , m_compare(compare)
+    {
+    }
+
+    void sort(char* begin, char* end, int bad_partitions_allowed, bool leftmost) const;
+
+private:
+    bool less(const char* a, const char* b) const { return m_compare(a, b) < 0; }
+    size_t count(const char* begin, const char* end) const { return (end - begin) / m_element_size; }
+    char* at(char* base, ssize_t index) const { return base + index * (ssize_t)m_element_size; }
+
+    void swap(char* a, char* b) const
+    {
+        if (a == b)
+            return;
+        if (!(((size_t)a | (size_t)b | m_element_size) & 3)) {
+            auto* wa = (u32*)a;
+            auto* wb = (u32*)b;
+            for (size_t i = m_element_size / 4; i; --i) {
+                u32 tmp = *wa;
+                *wa++ = *wb;
+                *wb++ = tmp;
+            }
+            return;
+        }
+        for (size_t i = m_element_size; i; --i) {
+            char tmp = *a;
+            *a++ = *b;
+            *b++ = tmp;
+        }
+    }
+
+    void sort2(char* a, char* b) const
+    {
+        if (less(b, a))
+            swap(a, b);
+    }
+
+    void sort3(char* a, char* b, char* c) const
+    {
+        sort2(a, b);
+        sort2(b, c);
+        sort2(a, b);
+    }
 
-    insertion_sort(bot, nmemb, size, compar);
+    // Returns false if it gave up after more than `limit` moves.
+    bool insertion_sort(char* begin, char* end, size_t limit) const;
+    void heap_sort(char* begin, char* end) const;
+    void sift_down(char* heap, size_t size, size_t index) const;
+    char* partition_right(char* begin, char* end, bool& already_partitioned) const;
+    char* partition_left(char* begin, char* end) const;
+    void break_patterns(char* begin, char* end) const;
+
+    size_t m_element_size;
+    Compare m_compare;
+};
+
+template<typename Compare>
+bool Sorter<Compare>::insertion_sort(char* begin, char* end, size_t limit) const
+{
+    size_t moves = 0;
+    for (char* current = begin + m_element_size; current < end; current += m_element_size) {
+        for (char* sift = current; sift > begin && less(sift, sift - m_element_size); sift -= m_element_size) {
+            swap(sift, sift - m_element_size);
+            ++moves;
+        }
+        if (moves > limit)
+            return false;
+    }
+    return true;
 }
 
-void qsort_r(void* bot, size_t nmemb, size_t size, int (*compar)(const void*, const void*, void*), void* arg)
+template<typename Compare>
+void Sorter<Compare>::sift_down(char* heap, size_t size, size_t index) const
 {
-    if (nmemb <= 1)
-        return;
+    for (;;) {
+        size_t child = index * 2 + 1;
+        if (child >= size)
+            return;
+        if (child + 1 < size && less(at(heap, child), at(heap, child + 1)))
+            ++child;
+        if (!less(at(heap, index), at(heap, child)))
+            return;
+        swap(at(heap, index), at(heap, child));
+        index = child;
+    }
+}
 
-    insertion_sort_r(bot, nmemb, size, compar, arg);
+template<typename Compare>
+void Sorter<Compare>::heap_sort(char* begin, char* end) const
+{
+    size_t size = count(begin, end);
+    for (size_t i = size / 2; i--;)
+        sift_down(begin, size, i);
+    for (size_t i = size - 1; i > 0; --i) {
+        swap(begin, at(begin, i));
+        sift_down(begin, i, 0);
+    }
 }
 
-void insertion_sort(void* bot, size_t nmemb, size_t size, int (*compar)(const void*, const void*))
+// Partitions around the pivot at begin, putting elements equal to it on the right.
+template<typename Compare>
+char* Sorter<Compare>::partition_right(char* begin, char* end, bool& already_partitioned) const
 {
-    int cnt;
-    unsigned char ch;
-    char *s1, *s2, *t1, *t2, *top;
-    top = (char*)bot + nmemb * size;
-    for (t1 = (char*)bot + size; t1 < top;) {
-        for (t2 = t1; (t2 -= size) >= bot && compar(t1, t2) < 0;)
+    size_t n = m_element_size;
+    char* first = begin;
+    char* last = end;
+
+    while ((first += n) < last && less(first, begin))
+        ;
+    while (first < last && !less(last -= n, begin))
+        ;
+
+    already_partitioned = first >= last;
+    while (first < last) {
+        swap(first, last);
+        while ((first += n) < last && less(first, begin))
+            ;
+        while ((last -= n) > first && !less(last, begin))
             ;
-        if (t1 != (t2 += size)) {
-            for (cnt = size; cnt--; ++t1) {
-                ch = *t1;
-                for (s1 = s2 = t1; (s2 -= size) >= t2; s1 = s2)
-                    *s1 = *s2;
-                *s1 = ch;
-            }
-        } else
-            t1 += size;
     }
+
+    char* pivot_position = first - n;
+    swap(begin, pivot_position);
+    return pivot_position;
 }
 
-void insertion_sort_r(void* bot, size_t nmemb, size_t size, int (*compar)(const void*, const void*, void*), void* arg)
+// Partitions around the pivot at begin, putting elements equal to it on the left.
+template<typename Compare>
+char* Sorter<Compare>::partition_left(char* begin, char* end) const
 {
-    int cnt;
-    unsigned char ch;
-    char *s1, *s2, *t1, *t2, *top;
-    top = (char*)bot + nmemb * size;
-    for (t1 = (char*)bot + size; t1 < top;) {
-        for (t2 = t1; (t2 -= size) >= bot && compar(t1, t2, arg) < 0;)
+    size_t n = m_element_size;
+    char* first = begin;
+    char* last = end;
+
+    while ((last -= n) > first && less(begin, last))
+        ;
+    while (first < last && !less(begin, first += n))
+        ;
+
+    while (first < last) {
+        swap(first, last);
+        while ((last -= n) > first && less(begin, last))
+            ;
+        while ((first += n) < last && !less(begin, first))
             ;
-        if (t1 != (t2 += size)) {
-            for (cnt = size; cnt--; ++t1) {
-                ch = *t1;
-                for (s1 = s2 = t1; (s2 -= size) >= t2; s1 = s2)
-                    *s1 = *s2;
-                *s1 = ch;
+    }
+
+    swap(begin, last);
+    return last;
+}
+
+template<typename Compare>
+void Sorter<Compare>::break_patterns(char* begin, char* end) const
+{
+    size_t size = count(begin, end);
+    if (size < insertion_sort_threshold)
+        return;
+    ssize_t quarter = size / 4;
+    swap(begin, at(begin, quarter));
+    swap(at(end, -1), at(end, -quarter));
+    if (size > ninther_threshold) {
+        swap(at(begin, 1), at(begin, quarter + 1));
+        swap(at(begin, 2), at(begin, quarter + 2));
+        swap(at(end, -2), at(end, -quarter - 1));
+        swap(at(end, -3), at(end, -quarter - 2));
+    }
+}
+
+template<typename Compare>
+void Sorter<Compare>::sort(char* begin, char* end, int bad_partitions_allowed, bool leftmost) const
+{
+    for (;;) {
+        size_t size = count(begin, end);
+        if (size < insertion_sort_threshold) {
+            insertion_sort(begin, end, (size_t)-1);
+            return;
+        }
+
+        ssize_t middle = size / 2;
+        if (size > ninther_threshold) {
+            sort3(begin, at(begin, middle), at(end, -1));
+            sort3(at(begin, 1), at(begin, middle - 1), at(end, -2));
+            sort3(at(begin, 2), at(begin, middle + 1), at(end, -3));
+            sort3(at(begin, middle - 1), at(begin, middle), at(begin, middle + 1));
+            swap(begin, at(begin, middle));
+        } else {
+            sort3(at(begin, middle), begin, at(end, -1));
+        }
+
+        if (!leftmost && !less(begin - m_element_size, begin)) {
+            begin = partition_left(begin, end) + m_element_size;
+            continue;
+        }
+
+        bool already_partitioned = false;
+        char* pivot = partition_right(begin, end, already_partitioned);
+        char* after_pivot = pivot + m_element_size;
+        size_t left_size = count(begin, pivot);
+        size_t right_size = count(after_pivot, end);
+
+        if (left_size < size / 8 || right_size < size / 8) {
+            if (--bad_partitions_allowed == 0) {
+                heap_sort(begin, end);
+                return;
             }
-        } else
-            t1 += size;
+            break_patterns(begin, pivot);
+            break_patterns(after_pivot, end);
+        } else if (already_partitioned
+            && insertion_sort(begin, pivot, partial_insertion_sort_limit)
+            && insertion_sort(after_pivot, end, partial_insertion_sort_limit)) {
+            return;
+        }
+
+        if (left_size < right_size) {
+            sort(begin, pivot, bad_partitions_allowed, leftmost);
+            begin = after_pivot;
+            leftmost = false;
+        } else {
+            sort(after_pivot, end, bad_partitions_allowed, false);
+            end = pivot;
+        }
     }
 }
+
+template<typename Compare>
+void sort(void* bot, size_t nmemb, size_t size, Compare compare)
+{
+    if (nmemb <= 1 || !size)
+        return;
+    int log2 = 0;
+    for (size_t n = nmemb; n >>= 1;)
+        ++log2;
+    auto* begin = (char*)bot;
+    Sorter<Compare>(size, compare).sort(begin, begin + nmemb * size, log2, true);
+}
+
+}
+
+void qsort(void* bot, size_t nmemb, size_t size, int (*compar)(const void*, const void*))
+{
+    sort(bot, nmemb, size, [compar](const void* a, const void* b) { return compar(a, b); });
+}
+
+void qsort_r(void* bot, size_t nmemb, size_t size, int (*compar)(const void*, const void*, void*), void* arg)
+{
+    sort(bot, nmemb, size, [compar, arg](const void* a, const void* b) { return compar(a, b, arg); });
+}
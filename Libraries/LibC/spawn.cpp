@@ -0,0 +1,173 @@
+#include <AK/AKString.h>
+#include <Kernel/Syscall.h>
+#include <errno.h>
+#include <spawn.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+extern "C" {
+
+int posix_spawn(pid_t* pid, const char* path, const posix_spawn_file_actions_t* file_actions, const posix_spawnattr_t* attr, char* const argv[], char* const envp[])
+{
+    Syscall::SC_posix_spawn_params params { path, (const char**)argv, (const char**)envp, file_actions, attr };
+    int rc = syscall(SC_posix_spawn, &params);
+    // Unlike most of the API, posix_spawn() returns the error number instead of setting errno.
+    if (rc < 0)
+        return -rc;
+    if (pid)
+        *pid = rc;
+    return 0;
+}
+
+int posix_spawnp(pid_t* pid, const char* file, const posix_spawn_file_actions_t* file_actions, const posix_spawnattr_t* attr, char* const argv[], char* const envp[])
+{
+    if (strchr(file, '/'))
+        return posix_spawn(pid, file, file_actions, attr, argv, envp);
+
+    String path = getenv("PATH");
+    if (path.is_empty())
+        path = "/bin:/usr/bin";
+    auto parts = path.split(':');
+    for (auto& part : parts) {
+        auto candidate = String::format("%s/%s", part.characters(), file);
+        int rc = posix_spawn(pid, candidate.characters(), file_actions, attr, argv, envp);
+        if (rc != ENOENT)
+            return rc;
+    }
+    return ENOENT;
+}
+
+int posix_spawn_file_actions_init(posix_spawn_file_actions_t* file_actions)
+{
+    file_actions->count = 0;
+    file_actions->capacity = 0;
+    file_actions->actions = nullptr;
+    return 0;
+}
+
+int posix_spawn_file_actions_destroy(posix_spawn_file_actions_t* file_actions)
+{
+    for (int i = 0; i < file_actions->count; ++i)
+        free(const_cast<char*>(file_actions->actions[i].path));
+    free(file_actions->actions);
+    return posix_spawn_file_actions_init(file_actions);
+}
+
+static posix_spawn_file_action* append_file_action(posix_spawn_file_actions_t* file_actions, int type, int fd)
+{
+    if (file_actions->count == file_actions->capacity) {
+        int new_capacity = file_actions->capacity ? file_actions->capacity * 2 : 4;
+        auto* new_actions = (posix_spawn_file_action*)realloc(file_actions->actions, new_capacity * sizeof(posix_spawn_file_action));
+        if (!new_actions)
+            return nullptr;
+        file_actions->actions = new_actions;
+        file_actions->capacity = new_capacity;
+    }
+    auto& action = file_actions->actions[file_actions->count++];
+    memset(&action, 0, sizeof(action));
+    action.type = type;
+    action.fd = fd;
+    return &action;
+}
+
+int posix_spawn_file_actions_addopen(posix_spawn_file_actions_t* file_actions, int fd, const char* path, int flags, mode_t mode)
+{
+    if (fd < 0)
+        return EBADF;
+    // The path has to outlive the caller's copy, so we keep our own.
+    char* path_copy = strdup(path);
+    if (!path_copy)
+        return ENOMEM;
+    auto* action = append_file_action(file_actions, POSIX_SPAWN_FILE_ACTION_OPEN, fd);
+    if (!action) {
+        free(path_copy);
+        return ENOMEM;
+    }
+    action->path = path_copy;
+    action->flags = flags;
+    action->mode = mode;
+    return 0;
+}
+
+int posix_spawn_file_actions_addclose(posix_spawn_file_actions_t* file_actions, int fd)
+{
+    if (fd < 0)
+        return EBADF;
+    if (!append_file_action(file_actions, POSIX_SPAWN_FILE_ACTION_CLOSE, fd))
+        return ENOMEM;
+    return 0;
+}
+
+int posix_spawn_file_actions_adddup2(posix_spawn_file_actions_t* file_actions, int old_fd, int new_fd)
+{
+    if (old_fd < 0 || new_fd < 0)
+        return EBADF;
+    auto* action = append_file_action(file_actions, POSIX_SPAWN_FILE_ACTION_DUP2, old_fd);
+    if (!action)
+        return ENOMEM;
+    action->new_fd = new_fd;
+    return 0;
+}
+
+int posix_spawnattr_init(posix_spawnattr_t* attr)
+{
+    memset(attr, 0, sizeof(*attr));
+    return 0;
+}
+
+int posix_spawnattr_destroy(posix_spawnattr_t*)
+{
+    return 0;
+}
+
+int posix_spawnattr_getflags(const posix_spawnattr_t* attr, short* flags)
+{
+    *flags = attr->flags;
+    return 0;
+}
+
+int posix_spawnattr_setflags(posix_spawnattr_t* attr, short flags)
+{
+    if (flags & ~(POSIX_SPAWN_RESETIDS | POSIX_SPAWN_SETPGROUP | POSIX_SPAWN_SETSIGDEF | POSIX_SPAWN_SETSIGMASK))
+        return EINVAL;
+    attr->flags = flags;
+    return 0;
+}
+
+int posix_spawnattr_getpgroup(const posix_spawnattr_t* attr, pid_t* pgroup)
+{
+    *pgroup = attr->pgroup;
+    return 0;
+}
+
+int posix_spawnattr_setpgroup(posix_spawnattr_t* attr, pid_t pgroup)
+{
+    attr->pgroup = pgroup;
+    return 0;
+}
+
+int posix_spawnattr_getsigdefault(const posix_spawnattr_t* attr, sigset_t* sigdefault)
+{
+    *sigdefault = attr->sigdefault;
+    return 0;
+}
+
+int posix_spawnattr_setsigdefault(posix_spawnattr_t* attr, const sigset_t* sigdefault)
+{
+    attr->sigdefault = *sigdefault;
+    return 0;
+}
+
+int posix_spawnattr_getsigmask(const posix_spawnattr_t* attr, sigset_t* sigmask)
+{
+    *sigmask = attr->sigmask;
+    return 0;
+}
+
+int posix_spawnattr_setsigmask(posix_spawnattr_t* attr, const sigset_t* sigmask)
+{
+    attr->sigmask = *sigmask;
+    return 0;
+}
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <signal.h>
+#include <sys/cdefs.h>
+#include <sys/types.h>
+
+__BEGIN_DECLS
+
+#define POSIX_SPAWN_RESETIDS 0x01
+#define POSIX_SPAWN_SETPGROUP 0x02
+#define POSIX_SPAWN_SETSIGDEF 0x04
+#define POSIX_SPAWN_SETSIGMASK 0x08
+
+#define POSIX_SPAWN_FILE_ACTION_OPEN 1
+#define POSIX_SPAWN_FILE_ACTION_CLOSE 2
+#define POSIX_SPAWN_FILE_ACTION_DUP2 3
+
+struct posix_spawn_file_action {
+    int type;
+    int fd;
+    int new_fd;
+    int flags;
+    mode_t mode;
+    const char* path;
+};
+
+typedef struct posix_spawn_file_actions {
+    int count;
+    int capacity;
+    struct posix_spawn_file_action* actions;
+} posix_spawn_file_actions_t;
+
+typedef struct posix_spawnattr {
+    short flags;
+    pid_t pgroup;
+    sigset_t sigdefault;
+    sigset_t sigmask;
+} posix_spawnattr_t;
+
+int posix_spawn(pid_t*, const char* path, const posix_spawn_file_actions_t*, const posix_spawnattr_t*, char* const argv[], char* const envp[]);
+int posix_spawnp(pid_t*, const char* file, const posix_spawn_file_actions_t*, const posix_spawnattr_t*, char* const argv[], char* const envp[]);
+
+int posix_spawn_file_actions_init(posix_spawn_file_actions_t*);
+int posix_spawn_file_actions_destroy(posix_spawn_file_actions_t*);
+int posix_spawn_file_actions_addopen(posix_spawn_file_actions_t*, int fd, const char* path, int flags, mode_t);
+int posix_spawn_file_actions_addclose(posix_spawn_file_actions_t*, int fd);
+int posix_spawn_file_actions_adddup2(posix_spawn_file_actions_t*, int old_fd, int new_fd);
+
+int posix_spawnattr_init(posix_spawnattr_t*);
+int posix_spawnattr_destroy(posix_spawnattr_t*);
+int posix_spawnattr_getflags(const posix_spawnattr_t*, short* flags);
+int posix_spawnattr_setflags(posix_spawnattr_t*, short flags);
+int posix_spawnattr_getpgroup(const posix_spawnattr_t*, pid_t* pgroup);
+int posix_spawnattr_setpgroup(posix_spawnattr_t*, pid_t pgroup);
+int posix_spawnattr_getsigdefault(const posix_spawnattr_t*, sigset_t*);
+int posix_spawnattr_setsigdefault(posix_spawnattr_t*, const sigset_t*);
+int posix_spawnattr_getsigmask(const posix_spawnattr_t*, sigset_t*);
+int posix_spawnattr_setsigmask(posix_spawnattr_t*, const sigset_t*);
+
+__END_DECLS
@@ -1,11 +1,6 @@
 #pragma once
 
-#ifdef KERNEL
-#    define __BEGIN_DECLS
-#    define __END_DECLS
-#else
-#    include <sys/cdefs.h>
-#endif
+#include <sys/cdefs.h>
 
 __BEGIN_DECLS
 
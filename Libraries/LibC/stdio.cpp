@@ -8,8 +8,10 @@
 #include <fcntl.h>
 #include <stdarg.h>
 #include <stdio.h>
+#include <spawn.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
 
@@ -20,19 +22,36 @@ FILE* stdin;
 FILE* stdout;
 FILE* stderr;
 
+// Every open stream, so that fflush(nullptr) (and exit()) can get to all of them.
+static FILE* s_open_streams;
+
+// Output buffers are allocated on the first write, so streams that are only ever read
+// from (or are unbuffered, like stderr) never get one.
+static const size_t regular_file_buffer_size = 32 * KB;
+static const size_t max_buffer_size = 64 * KB;
+
+static bool is_default_stream(FILE* stream)
+{
+    return stream >= &__default_streams[0] && stream <= &__default_streams[3];
+}
+
 void init_FILE(FILE& fp, int fd, int mode)
 {
     fp.fd = fd;
-    fp.buffer = fp.default_buffer;
-    fp.buffer_size = BUFSIZ;
+    fp.buffer = nullptr;
+    fp.buffer_size = 0;
+    fp.buffer_index = 0;
+    fp.buffer_is_owned = false;
     fp.mode = mode;
+    fp.next_open_stream = s_open_streams;
+    s_open_streams = &fp;
 }
 
 static FILE* make_FILE(int fd)
 {
     auto* fp = (FILE*)malloc(sizeof(FILE));
     memset(fp, 0, sizeof(FILE));
-    init_FILE(*fp, fd, isatty(fd));
+    init_FILE(*fp, fd, isatty(fd) ? _IOLBF : _IOFBF);
     return fp;
 }
 
@@ -46,21 +65,99 @@ void __stdio_init()
     init_FILE(*stderr, 2, _IONBF);
 }
 
+static size_t preferred_buffer_size(int fd)
+{
+    // Terminals and pipes get BUFSIZ. Regular files get more, since every write() there
+    // goes through the filesystem, and at least one of the filesystem's own blocks.
+    struct stat st;
+    if (fstat(fd, &st) < 0)
+        return BUFSIZ;
+    size_t size = S_ISREG(st.st_mode) ? regular_file_buffer_size : BUFSIZ;
+    if (st.st_blksize > 0 && (size_t)st.st_blksize > size)
+        size = st.st_blksize;
+    return min(size, max_buffer_size);
+}
+
+static bool allocate_buffer(FILE* stream)
+{
+    size_t size = preferred_buffer_size(stream->fd);
+    auto* buffer = (char*)malloc(size);
+    if (!buffer)
+        return false;
+    stream->buffer = buffer;
+    stream->buffer_size = size;
+    stream->buffer_index = 0;
+    stream->buffer_is_owned = true;
+    return true;
+}
+
+static void release_buffer(FILE* stream)
+{
+    if (stream->buffer_is_owned)
+        free(stream->buffer);
+    stream->buffer = nullptr;
+    stream->buffer_size = 0;
+    stream->buffer_index = 0;
+    stream->buffer_is_owned = false;
+}
+
+// Keeps going through short writes and interruptions until everything is out.
+static bool write_all(FILE* stream, const char* data, size_t size)
+{
+    while (size) {
+        ssize_t rc = write(stream->fd, data, size);
+        if (rc < 0) {
+            if (errno == EINTR)
+                continue;
+            stream->error = errno;
+            return false;
+        }
+        data += rc;
+        size -= rc;
+    }
+    return true;
+}
+
+// Appends a run of characters to the stream's buffer, or hands it straight to write()
+// when buffering wouldn't save us anything.
+static bool write_to_stream(FILE* stream, const char* data, size_t size)
+{
+    if (stream->mode == _IONBF) {
+        if (stream->buffer_index && fflush(stream) == EOF)
+            return false;
+        return write_all(stream, data, size);
+    }
+
+    if (!stream->buffer && !allocate_buffer(stream))
+        return write_all(stream, data, size);
+
+    if (size > stream->buffer_size - stream->buffer_index) {
+        if (fflush(stream) == EOF)
+            return false;
+        if (size >= stream->buffer_size)
+            return write_all(stream, data, size);
+    }
+
+    memcpy(stream->buffer + stream->buffer_index, data, size);
+    stream->buffer_index += size;
+    if (stream->mode == _IOLBF && memchr(data, '\n', size))
+        return fflush(stream) == 0;
+    return true;
+}
+
 int setvbuf(FILE* stream, char* buf, int mode, size_t size)
 {
     if (mode != _IONBF && mode != _IOLBF && mode != _IOFBF) {
         errno = EINVAL;
         return -1;
     }
+    fflush(stream);
+    release_buffer(stream);
     stream->mode = mode;
-    if (buf) {
+    if (buf && size) {
         stream->buffer = buf;
         stream->buffer_size = size;
-    } else {
-        stream->buffer = stream->default_buffer;
-        stream->buffer_size = BUFSIZ;
     }
-    stream->buffer_index = 0;
     return 0;
 }
 
@@ -88,18 +185,22 @@ int feof(FILE* stream)
 
 int fflush(FILE* stream)
 {
-    // FIXME: fflush(NULL) should flush all open output streams.
-    ASSERT(stream);
+    if (!stream) {
+        int rc = 0;
+        for (auto* open_stream = s_open_streams; open_stream; open_stream = open_stream->next_open_stream) {
+            if (fflush(open_stream) == EOF)
+                rc = EOF;
+        }
+        return rc;
+    }
     if (!stream->buffer_index)
         return 0;
-    int rc = write(stream->fd, stream->buffer, stream->buffer_index);
+    size_t size = stream->buffer_index;
     stream->buffer_index = 0;
     stream->error = 0;
     stream->eof = 0;
-    if (rc < 0) {
-        stream->error = errno;
+    if (!write_all(stream, stream->buffer, size))
         return EOF;
-    }
     return 0;
 }
 
@@ -203,13 +304,12 @@ int ungetc(int c, FILE* stream)
 int fputc(int ch, FILE* stream)
 {
     assert(stream);
-    assert(stream->buffer_index < stream->buffer_size);
-    stream->buffer[stream->buffer_index++] = ch;
-    if (stream->buffer_index >= stream->buffer_size)
-        fflush(stream);
-    else if (stream->mode == _IONBF || (stream->mode == _IOLBF && ch == '\n'))
-        fflush(stream);
-    if (stream->eof || stream->error)
+    if (stream->mode == _IOFBF && stream->buffer_index < stream->buffer_size) {
+        stream->buffer[stream->buffer_index++] = ch;
+        return (u8)ch;
+    }
+    char c = ch;
+    if (!write_to_stream(stream, &c, 1))
         return EOF;
     return (u8)ch;
 }
@@ -226,11 +326,9 @@ int putchar(int ch)
 
 int fputs(const char* s, FILE* stream)
 {
-    for (; *s; ++s) {
-        int rc = putc(*s, stream);
-        if (rc == EOF)
-            return EOF;
-    }
+    assert(stream);
+    if (!write_to_stream(stream, s, strlen(s)))
+        return EOF;
     return 1;
 }
 
@@ -288,15 +386,11 @@ size_t fread(void* ptr, size_t size, size_t nmemb, FILE* stream)
 size_t fwrite(const void* ptr, size_t size, size_t nmemb, FILE* stream)
 {
     assert(stream);
-    auto* bytes = (const u8*)ptr;
-    ssize_t nwritten = 0;
-    for (size_t i = 0; i < (size * nmemb); ++i) {
-        int rc = fputc(bytes[i], stream);
-        if (rc == EOF)
-            break;
-        ++nwritten;
-    }
-    return nwritten / size;
+    if (!size || !nmemb)
+        return 0;
+    if (!write_to_stream(stream, (const char*)ptr, size * nmemb))
+        return 0;
+    return nmemb;
 }
 
 int fseek(FILE* stream, long offset, int whence)
@@ -325,30 +419,97 @@ void rewind(FILE* stream)
     fseek(stream, 0, SEEK_SET);
 }
 
+// These are the sinks that printf_to_sink() (see AK/PrintfImplementation.h) writes to.
+
+class DebugSink {
+public:
+    void put(char ch) { dbgputch(ch); }
+    void put(const char* characters, size_t length) { dbgputstr(characters, length); }
+    void put_repeated(char ch, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+            dbgputch(ch);
+    }
+};
+
+class StreamSink {
+public:
+    explicit StreamSink(FILE* stream)
+        : m_stream(stream)
+    {
+    }
+
+    void put(char ch) { fputc(ch, m_stream); }
+    void put(const char* characters, size_t length) { write_to_stream(m_stream, characters, length); }
+    void put_repeated(char ch, size_t count)
+    {
+        char chunk[32];
+        memset(chunk, ch, min(count, sizeof(chunk)));
+        while (count) {
+            size_t length = min(count, sizeof(chunk));
+            write_to_stream(m_stream, chunk, length);
+            count -= length;
+        }
+    }
+
+private:
+    FILE* m_stream;
+};
+
+// Writes up to `size` characters to the buffer, and quietly drops the rest.
+class BufferSink {
+public:
+    BufferSink(char* buffer, size_t size)
+        : m_buffer(buffer)
+        , m_space_remaining(size)
+    {
+    }
+
+    void put(char ch)
+    {
+        if (m_space_remaining) {
+            *m_buffer++ = ch;
+            --m_space_remaining;
+        }
+    }
+
+    void put(const char* characters, size_t length)
+    {
+        length = min(length, m_space_remaining);
+        memcpy(m_buffer, characters, length);
+        m_buffer += length;
+        m_space_remaining -= length;
+    }
+
+    void put_repeated(char ch, size_t count)
+    {
+        count = min(count, m_space_remaining);
+        memset(m_buffer, ch, count);
+        m_buffer += count;
+        m_space_remaining -= count;
+    }
+
+    void terminate() { *m_buffer = '\0'; }
+
+private:
+    char* m_buffer;
+    size_t m_space_remaining;
+};
+
 int dbgprintf(const char* fmt, ...)
 {
     va_list ap;
     va_start(ap, fmt);
-    int ret = printf_internal([](char*&, char ch) { dbgputch(ch); }, nullptr, fmt, ap);
+    DebugSink sink;
+    int ret = printf_to_sink(sink, fmt, ap);
     va_end(ap);
     return ret;
 }
 
-static void stdout_putch(char*&, char ch)
-{
-    putchar(ch);
-}
-
-static FILE* __current_stream = nullptr;
-static void stream_putch(char*&, char ch)
-{
-    fputc(ch, __current_stream);
-}
-
 int vfprintf(FILE* stream, const char* fmt, va_list ap)
 {
-    __current_stream = stream;
-    return printf_internal(stream_putch, nullptr, fmt, ap);
+    StreamSink sink(stream);
+    return printf_to_sink(sink, fmt, ap);
 }
 
 int fprintf(FILE* stream, const char* fmt, ...)
@@ -362,7 +523,7 @@ int fprintf(FILE* stream, const char* fmt, ...)
 
 int vprintf(const char* fmt, va_list ap)
 {
-    return printf_internal(stdout_putch, nullptr, fmt, ap);
+    return vfprintf(stdout, fmt, ap);
 }
 
 int printf(const char* fmt, ...)
@@ -374,15 +535,11 @@ int printf(const char* fmt, ...)
     return ret;
 }
 
-static void buffer_putch(char*& bufptr, char ch)
-{
-    *bufptr++ = ch;
-}
-
 int vsprintf(char* buffer, const char* fmt, va_list ap)
 {
-    int ret = printf_internal(buffer_putch, buffer, fmt, ap);
-    buffer[ret] = '\0';
+    BufferSink sink(buffer, SIZE_MAX);
+    int ret = printf_to_sink(sink, fmt, ap);
+    sink.terminate();
     return ret;
 }
 
@@ -391,25 +548,17 @@ int sprintf(char* buffer, const char* fmt, ...)
     va_list ap;
     va_start(ap, fmt);
     int ret = vsprintf(buffer, fmt, ap);
-    buffer[ret] = '\0';
     va_end(ap);
     return ret;
 }
 
-static size_t __vsnprintf_space_remaining;
-static void sized_buffer_putch(char*& bufptr, char ch)
-{
-    if (__vsnprintf_space_remaining) {
-        *bufptr++ = ch;
-        --__vsnprintf_space_remaining;
-    }
-}
-
 int vsnprintf(char* buffer, size_t size, const char* fmt, va_list ap)
 {
-    __vsnprintf_space_remaining = size;
-    int ret = printf_internal(sized_buffer_putch, buffer, fmt, ap);
-    buffer[ret] = '\0';
+    // Leave room for the null terminator, if there's room for anything at all.
+    BufferSink sink(buffer, size ? size - 1 : 0);
+    int ret = printf_to_sink(sink, fmt, ap);
+    if (size)
+        sink.terminate();
     return ret;
 }
 
@@ -418,7 +567,6 @@ int snprintf(char* buffer, size_t size, const char* fmt, ...)
     va_list ap;
     va_start(ap, fmt);
     int ret = vsnprintf(buffer, size, fmt, ap);
-    buffer[ret] = '\0';
     va_end(ap);
     return ret;
 }
@@ -471,7 +619,14 @@ int fclose(FILE* stream)
 {
     fflush(stream);
     int rc = close(stream->fd);
-    if (stream != &__default_streams[0] && stream != &__default_streams[1] && stream != &__default_streams[2] && stream != &__default_streams[3])
+    for (auto** link = &s_open_streams; *link; link = &(*link)->next_open_stream) {
+        if (*link == stream) {
+            *link = stream->next_open_stream;
+            break;
+        }
+    }
+    release_buffer(stream);
+    if (!is_default_stream(stream))
         free(stream);
     return rc;
 }
@@ -514,30 +669,25 @@ FILE* popen(const char* command, const char* type)
         return nullptr;
     }
 
-    pid_t child_pid = fork();
-    if (!child_pid) {
-        if (*type == 'r') {
-            int rc = dup2(pipe_fds[1], STDOUT_FILENO);
-            if (rc < 0) {
-                perror("dup2");
-                exit(1);
-            }
-            close(pipe_fds[0]);
-            close(pipe_fds[1]);
-        } else if (*type == 'w') {
-            int rc = dup2(pipe_fds[0], STDIN_FILENO);
-            if (rc < 0) {
-                perror("dup2");
-                exit(1);
-            }
-            close(pipe_fds[0]);
-            close(pipe_fds[1]);
-        }
-
-        int rc = execl("/bin/sh", "sh", "-c", command, nullptr);
-        if (rc < 0)
-            perror("execl");
-        exit(1);
+    // The child gets one end of the pipe as its stdin or stdout, and neither of the originals.
+    posix_spawn_file_actions_t file_actions;
+    posix_spawn_file_actions_init(&file_actions);
+    if (*type == 'r')
+        posix_spawn_file_actions_adddup2(&file_actions, pipe_fds[1], STDOUT_FILENO);
+    else
+        posix_spawn_file_actions_adddup2(&file_actions, pipe_fds[0], STDIN_FILENO);
+    posix_spawn_file_actions_addclose(&file_actions, pipe_fds[0]);
+    posix_spawn_file_actions_addclose(&file_actions, pipe_fds[1]);
+
+    const char* argv[] = { "sh", "-c", command, nullptr };
+    pid_t child_pid;
+    rc = posix_spawn(&child_pid, "/bin/sh", &file_actions, nullptr, const_cast<char**>(argv), environ);
+    posix_spawn_file_actions_destroy(&file_actions);
+    if (rc) {
+        close(pipe_fds[0]);
+        close(pipe_fds[1]);
+        errno = rc;
+        return nullptr;
     }
 
     FILE* fp = nullptr;
@@ -7,7 +7,7 @@
 #include <sys/cdefs.h>
 #include <sys/types.h>
 
-#define BUFSIZ 1024
+#define BUFSIZ 8192
 
 __BEGIN_DECLS
 #ifndef EOF
@@ -33,9 +33,10 @@ struct __STDIO_FILE {
     char* buffer;
     size_t buffer_size;
     size_t buffer_index;
+    int buffer_is_owned;
     int have_ungotten;
     char ungotten;
-    char default_buffer[BUFSIZ];
+    struct __STDIO_FILE* next_open_stream;
 };
 
 typedef struct __STDIO_FILE FILE;
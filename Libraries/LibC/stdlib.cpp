@@ -9,6 +9,7 @@
 #include <ctype.h>
 #include <errno.h>
 #include <signal.h>
+#include <spawn.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -28,8 +29,7 @@ void exit(int status)
         __atexit_handlers[i]();
     extern void _fini();
     _fini();
-    fflush(stdout);
-    fflush(stderr);
+    fflush(nullptr);
     _exit(status);
     ASSERT_NOT_REACHED();
 }
@@ -262,12 +262,13 @@ void srandom(unsigned seed)
 
 int system(const char* command)
 {
-    auto child = fork();
-    if (!child) {
-        int rc = execl("/bin/sh", "sh", "-c", command, nullptr);
-        if (rc < 0)
-            perror("execl");
-        exit(0);
+    const char* argv[] = { "sh", "-c", command, nullptr };
+    pid_t child;
+    int rc = posix_spawn(&child, "/bin/sh", nullptr, nullptr, const_cast<char**>(argv), environ);
+    if (rc) {
+        errno = rc;
+        perror("posix_spawn");
+        return -1;
     }
     int wstatus;
     waitpid(child, &wstatus, 0);
@@ -1,4 +1,5 @@
 #include <AK/Platform.h>
+#include <AK/SIMDMemory.h>
 #include <AK/StdLibExtras.h>
 #include <AK/Types.h>
 #include <assert.h>
@@ -47,13 +48,6 @@ size_t strcspn(const char* s, const char* reject)
     }
 }
 
-size_t strlen(const char* str)
-{
-    size_t len = 0;
-    while (*(str++))
-        ++len;
-    return len;
-}
 
 char* strdup(const char* str)
 {
@@ -122,16 +116,6 @@ int strncasecmp(const char* s1, const char* s2, size_t n)
     return tolower(*s1) - tolower(*s2);
 }
 
-int memcmp(const void* v1, const void* v2, size_t n)
-{
-    auto* s1 = (const uint8_t*)v1;
-    auto* s2 = (const uint8_t*)v2;
-    while (n-- > 0) {
-        if (*s1++ != *s2++)
-            return s1[-1] < s2[-1] ? -1 : 1;
-    }
-    return 0;
-}
 
 #if ARCH(I386)
 void* mmx_memcpy(void* dest, const void* src, size_t len)
@@ -182,46 +166,62 @@ void* mmx_memcpy(void* dest, const void* src, size_t len)
     return dest;
 }
 
-void* memcpy(void* dest_ptr, const void* src_ptr, size_t n)
+static void* scalar_memcpy(void* dest_ptr, const void* src_ptr, size_t n)
 {
     if (n >= 1024)
         return mmx_memcpy(dest_ptr, src_ptr, n);
 
     u32 dest = (u32)dest_ptr;
     u32 src = (u32)src_ptr;
-    // FIXME: Support starting at an unaligned address.
-    if (!(dest & 0x3) && !(src & 0x3) && n >= 12) {
+    if (n >= 12) {
+        // Copy bytes until the destination is aligned, and then whole words from there.
+        size_t prologue = -dest & 0x3;
+        n -= prologue;
+        asm volatile(
+            "rep movsb\n"
+            : "=S"(src), "=D"(dest), "=c"(prologue)
+            : "0"(src), "1"(dest), "2"(prologue)
+            : "memory");
         size_t u32s = n / sizeof(u32);
         asm volatile(
             "rep movsl\n"
-            : "=S"(src), "=D"(dest)
-            : "S"(src), "D"(dest), "c"(u32s)
+            : "=S"(src), "=D"(dest), "=c"(u32s)
+            : "0"(src), "1"(dest), "2"(u32s)
             : "memory");
-        n -= u32s * sizeof(u32);
+        n %= sizeof(u32);
         if (n == 0)
             return dest_ptr;
     }
     asm volatile(
-        "rep movsb\n" ::"S"(src), "D"(dest), "c"(n)
+        "rep movsb\n"
+        : "=S"(src), "=D"(dest), "=c"(n)
+        : "0"(src), "1"(dest), "2"(n)
         : "memory");
     return dest_ptr;
 }
 
-void* memset(void* dest_ptr, int c, size_t n)
+static void* scalar_memset(void* dest_ptr, int c, size_t n)
 {
     u32 dest = (u32)dest_ptr;
-    // FIXME: Support starting at an unaligned address.
-    if (!(dest & 0x3) && n >= 12) {
+    if (n >= 12) {
+        // Store bytes until the destination is aligned, and then whole words from there.
+        size_t prologue = -dest & 0x3;
+        n -= prologue;
+        asm volatile(
+            "rep stosb\n"
+            : "=D"(dest), "=c"(prologue)
+            : "0"(dest), "1"(prologue), "a"(c)
+            : "memory");
         size_t u32s = n / sizeof(u32);
         u32 expanded_c = (u8)c;
         expanded_c |= expanded_c << 8;
         expanded_c |= expanded_c << 16;
         asm volatile(
             "rep stosl\n"
-            : "=D"(dest)
-            : "D"(dest), "c"(u32s), "a"(expanded_c)
+            : "=D"(dest), "=c"(u32s)
+            : "0"(dest), "1"(u32s), "a"(expanded_c)
             : "memory");
-        n -= u32s * sizeof(u32);
+        n %= sizeof(u32);
         if (n == 0)
             return dest_ptr;
     }
@@ -233,7 +233,7 @@ void* memset(void* dest_ptr, int c, size_t n)
     return dest_ptr;
 }
 #else
-void* memcpy(void* dest_ptr, const void* src_ptr, size_t n)
+static void* scalar_memcpy(void* dest_ptr, const void* src_ptr, size_t n)
 {
     auto* dest = (u8*)dest_ptr;
     auto* src = (const u8*)src_ptr;
@@ -242,7 +242,7 @@ void* memcpy(void* dest_ptr, const void* src_ptr, size_t n)
     return dest_ptr;
 }
 
-void* memset(void* dest_ptr, int c, size_t n)
+static void* scalar_memset(void* dest_ptr, int c, size_t n)
 {
     auto* dest = (u8*)dest_ptr;
     for (size_t i = 0; i < n; ++i)
@@ -251,6 +251,84 @@ void* memset(void* dest_ptr, int c, size_t n)
 }
 #endif
 
+static size_t scalar_strlen(const char* str)
+{
+    size_t len = 0;
+    while (*(str++))
+        ++len;
+    return len;
+}
+
+static int scalar_memcmp(const void* v1, const void* v2, size_t n)
+{
+    auto* s1 = (const uint8_t*)v1;
+    auto* s2 = (const uint8_t*)v2;
+    while (n-- > 0) {
+        if (*s1++ != *s2++)
+            return s1[-1] < s2[-1] ? -1 : 1;
+    }
+    return 0;
+}
+
+static const void* scalar_memchr(const void* ptr, int c, size_t size)
+{
+    char ch = c;
+    auto* cptr = (const char*)ptr;
+    for (size_t i = 0; i < size; ++i) {
+        if (cptr[i] == ch)
+            return cptr + i;
+    }
+    return nullptr;
+}
+
+// These start out with the portable versions, so anything that runs before
+// __string_init() still works, and are then pointed at the best versions the CPU has.
+static void* (*s_memcpy)(void*, const void*, size_t) = scalar_memcpy;
+static void* (*s_memset)(void*, int, size_t) = scalar_memset;
+static int (*s_memcmp)(const void*, const void*, size_t) = scalar_memcmp;
+static size_t (*s_strlen)(const char*) = scalar_strlen;
+static const void* (*s_memchr)(const void*, int, size_t) = scalar_memchr;
+
+void __string_init()
+{
+#if ARCH(I386)
+    auto features = AK::SIMD::detect_cpu_features();
+    if (features.avx2) {
+        s_memcpy = AK::SIMD::avx2_memcpy;
+        s_memset = AK::SIMD::avx2_memset;
+        s_memcmp = AK::SIMD::avx2_memcmp;
+        s_strlen = AK::SIMD::avx2_strlen;
+        s_memchr = AK::SIMD::avx2_memchr;
+    } else if (features.sse2) {
+        s_memcpy = AK::SIMD::sse2_memcpy;
+        s_memset = AK::SIMD::sse2_memset;
+        s_memcmp = AK::SIMD::sse2_memcmp;
+        s_strlen = AK::SIMD::sse2_strlen;
+        s_memchr = AK::SIMD::sse2_memchr;
+    }
+#endif
+}
+
+void* memcpy(void* dest_ptr, const void* src_ptr, size_t n)
+{
+    return s_memcpy(dest_ptr, src_ptr, n);
+}
+
+void* memset(void* dest_ptr, int c, size_t n)
+{
+    return s_memset(dest_ptr, c, n);
+}
+
+int memcmp(const void* v1, const void* v2, size_t n)
+{
+    return s_memcmp(v1, v2, n);
+}
+
+size_t strlen(const char* str)
+{
+    return s_strlen(str);
+}
+
 void* memmove(void* dest, const void* src, size_t n)
 {
     if (dest < src)
@@ -294,13 +372,7 @@ char* strchr(const char* str, int c)
 
 void* memchr(const void* ptr, int c, size_t size)
 {
-    char ch = c;
-    auto* cptr = (const char*)ptr;
-    for (size_t i = 0; i < size; ++i) {
-        if (cptr[i] == ch)
-            return const_cast<char*>(cptr + i);
-    }
-    return nullptr;
+    return const_cast<void*>(s_memchr(ptr, c, size));
 }
 
 char* strrchr(const char* str, int ch)
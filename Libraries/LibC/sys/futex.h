@@ -0,0 +1,21 @@
+#pragma once
+
+#include <stdint.h>
+#include <sys/cdefs.h>
+#include <time.h>
+
+__BEGIN_DECLS
+
+#define FUTEX_WAIT 0
+#define FUTEX_WAKE 1
+#define FUTEX_REQUEUE 3
+
+// FUTEX_WAIT: Sleep as long as *userspace_address == value, for at most the relative `timeout`
+//             (or forever if it's null). Fails with EAGAIN right away if the value differs.
+// FUTEX_WAKE: Wake up to `value` threads sleeping on userspace_address.
+// FUTEX_REQUEUE: Wake up to `value` threads, then move up to `value2` of the remaining ones
+//                over to sleep on userspace_address2 instead.
+// Only threads within the same process can meet on a futex.
+int futex(uint32_t* userspace_address, int futex_op, uint32_t value, const struct timespec* timeout, uint32_t* userspace_address2, uint32_t value2);
+
+__END_DECLS
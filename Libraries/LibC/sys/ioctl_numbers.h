@@ -33,4 +33,9 @@ enum IOCtlNumber {
     FB_IOCTL_SET_RESOLUTION,
     FB_IOCTL_GET_BUFFER,
     FB_IOCTL_SET_BUFFER,
+    SIOCADDRT,
+    SIOCDELRT,
+    TRACE_IOCTL_ENABLE,
+    TRACE_IOCTL_DISABLE,
+    TRACE_IOCTL_GET_DROPPED_COUNT,
 };
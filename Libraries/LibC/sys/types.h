@@ -32,6 +32,7 @@ typedef uint32_t time_t;
 typedef uint32_t useconds_t;
 typedef int32_t suseconds_t;
 typedef uint32_t clock_t;
+typedef int clockid_t;
 
 #define __socklen_t_defined
 #define __socklen_t uint32_t
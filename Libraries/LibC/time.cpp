@@ -1,4 +1,5 @@
 #include <Kernel/Syscall.h>
+#include <Kernel/TimePage.h>
 #include <assert.h>
 #include <errno.h>
 #include <sys/time.h>
@@ -18,12 +19,84 @@ time_t time(time_t* tloc)
     return tv.tv_sec;
 }
 
+static const volatile TimePage* time_page()
+{
+    static const volatile TimePage* s_time_page;
+    static bool s_looked_up;
+    if (!s_looked_up) {
+        s_time_page = (const volatile TimePage*)syscall(SC_get_time_page);
+        s_looked_up = true;
+    }
+    return s_time_page;
+}
+
+static inline u64 read_tsc()
+{
+    u32 lsw, msw;
+    asm volatile("rdtsc"
+                 : "=d"(msw), "=a"(lsw));
+    return ((u64)msw << 32) | lsw;
+}
+
+// Read the time since boot and the boot time from the kernel's time page, without a syscall.
+static bool read_time_page(u32& boot_time, u32& seconds, u32& microseconds)
+{
+    auto* page = time_page();
+    if (!page)
+        return false;
+    for (;;) {
+        u32 sequence = page->sequence;
+        if (sequence & 1)
+            continue;
+        asm volatile("" ::: "memory");
+        boot_time = page->boot_time;
+        seconds = page->seconds_since_boot;
+        u32 ticks = page->ticks_this_second;
+        u32 microseconds_per_tick = 1000000 / page->ticks_per_second;
+        microseconds = ticks * microseconds_per_tick;
+        u32 cycles_per_tick = page->tsc_cycles_per_tick;
+        if (cycles_per_tick) {
+            u64 cycles = read_tsc() - page->tsc_at_last_tick;
+            // Never run past the next tick, or the time could go backwards when it comes.
+            if (cycles >= cycles_per_tick)
+                microseconds += microseconds_per_tick - 1;
+            else
+                microseconds += ((u64)(u32)cycles * page->tsc_to_microseconds) >> 32;
+        }
+        asm volatile("" ::: "memory");
+        if (page->sequence == sequence)
+            return true;
+    }
+}
+
 int gettimeofday(struct timeval* __restrict__ tv, void* __restrict__)
 {
+    u32 boot_time, seconds, microseconds;
+    if (read_time_page(boot_time, seconds, microseconds)) {
+        tv->tv_sec = boot_time + seconds;
+        tv->tv_usec = microseconds;
+        return 0;
+    }
     int rc = syscall(SC_gettimeofday, tv);
     __RETURN_WITH_ERRNO(rc, rc, -1);
 }
 
+int clock_gettime(clockid_t clock_id, struct timespec* ts)
+{
+    if (clock_id != CLOCK_REALTIME && clock_id != CLOCK_MONOTONIC) {
+        errno = EINVAL;
+        return -1;
+    }
+    u32 boot_time, seconds, microseconds;
+    if (!read_time_page(boot_time, seconds, microseconds)) {
+        errno = ENOSYS;
+        return -1;
+    }
+    ts->tv_sec = clock_id == CLOCK_REALTIME ? boot_time + seconds : seconds;
+    ts->tv_nsec = microseconds * 1000;
+    return 0;
+}
+
 char* ctime(const time_t*)
 {
     return const_cast<char*>("ctime() not implemented");
@@ -47,4 +47,9 @@ struct timespec {
     long tv_nsec;
 };
 
+#define CLOCK_REALTIME 0
+#define CLOCK_MONOTONIC 1
+
+int clock_gettime(clockid_t, struct timespec*);
+
 __END_DECLS
@@ -23,6 +23,18 @@ int systrace(pid_t pid)
     __RETURN_WITH_ERRNO(rc, rc, -1);
 }
 
+int profiling_enable(pid_t pid)
+{
+    int rc = syscall(SC_profiling_enable, pid);
+    __RETURN_WITH_ERRNO(rc, rc, -1);
+}
+
+int profiling_disable(pid_t pid)
+{
+    int rc = syscall(SC_profiling_disable, pid);
+    __RETURN_WITH_ERRNO(rc, rc, -1);
+}
+
 int chown(const char* pathname, uid_t uid, gid_t gid)
 {
     int rc = syscall(SC_chown, pathname, uid, gid);
@@ -41,6 +53,28 @@ pid_t fork()
     __RETURN_WITH_ERRNO(rc, rc, -1);
 }
 
+// vfork() can't be an ordinary function. The child returns from it first and carries on
+// using the parent's stack, so by the time the parent wakes up, anything it left in its
+// stack frame (including the return address) may have been overwritten. We keep the
+// return address in %ecx across the syscall instead, which both sides get back intact.
+extern const u32 __vfork_syscall_number = SC_vfork;
+asm(
+    ".pushsection .text\n"
+    ".globl vfork\n"
+    "vfork:\n"
+    "    popl %ecx\n"
+    "    movl __vfork_syscall_number, %eax\n"
+    "    int $0x82\n"
+    "    pushl %ecx\n"
+    "    testl %eax, %eax\n"
+    "    jns 1f\n"
+    "    negl %eax\n"
+    "    movl %eax, errno\n"
+    "    movl $-1, %eax\n"
+    "1:\n"
+    "    ret\n"
+    ".popsection\n");
+
 int execv(const char* path, char* const argv[])
 {
     return execve(path, argv, environ);
@@ -210,6 +244,20 @@ ssize_t write(int fd, const void* buf, size_t count)
     __RETURN_WITH_ERRNO(rc, rc, -1);
 }
 
+ssize_t pread(int fd, void* buf, size_t count, off_t offset)
+{
+    Syscall::SC_pread_params params { fd, buf, (ssize_t)count, offset };
+    int rc = syscall(SC_pread, &params);
+    __RETURN_WITH_ERRNO(rc, rc, -1);
+}
+
+ssize_t pwrite(int fd, const void* buf, size_t count, off_t offset)
+{
+    Syscall::SC_pwrite_params params { fd, buf, (ssize_t)count, offset };
+    int rc = syscall(SC_pwrite, &params);
+    __RETURN_WITH_ERRNO(rc, rc, -1);
+}
+
 int ttyname_r(int fd, char* buffer, size_t size)
 {
     int rc = syscall(SC_ttyname_r, fd, buffer, size);
@@ -510,6 +558,8 @@ int create_thread(int (*entry)(void*), void* argument)
 
 void exit_thread(int code)
 {
+    void __malloc_thread_exit();
+    __malloc_thread_exit();
     syscall(SC_exit_thread, code);
     ASSERT_NOT_REACHED();
 }
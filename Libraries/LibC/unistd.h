@@ -19,6 +19,8 @@ void dump_backtrace();
 int fsync(int fd);
 void sysbeep();
 int systrace(pid_t);
+int profiling_enable(pid_t);
+int profiling_disable(pid_t);
 int gettid();
 int donate(int tid);
 int create_thread(int (*)(void*), void*);
@@ -34,6 +36,7 @@ int set_process_icon(int icon_id);
 int read_tsc(unsigned* lsw, unsigned* msw);
 inline int getpagesize() { return 4096; }
 pid_t fork();
+pid_t vfork();
 int execv(const char* path, char* const argv[]);
 int execve(const char* filename, char* const argv[], char* const envp[]);
 int execvpe(const char* filename, char* const argv[], char* const envp[]);
@@ -64,6 +67,8 @@ int creat_with_path_length(const char* path, size_t path_length, mode_t);
 int open_with_path_length(const char* path, size_t path_length, int options, mode_t);
 ssize_t read(int fd, void* buf, size_t count);
 ssize_t write(int fd, const void* buf, size_t count);
+ssize_t pread(int fd, void* buf, size_t count, off_t);
+ssize_t pwrite(int fd, const void* buf, size_t count, off_t);
 int close(int fd);
 pid_t waitpid(pid_t, int* wstatus, int options);
 pid_t wait(int* wstatus);
@@ -14,6 +14,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/epoll.h>
 #include <sys/select.h>
 #include <sys/socket.h>
 #include <sys/time.h>
@@ -26,7 +27,8 @@
 static CEventLoop* s_main_event_loop;
 static Vector<CEventLoop*>* s_event_loop_stack;
 HashMap<int, NonnullOwnPtr<CEventLoop::EventLoopTimer>>* CEventLoop::s_timers;
-HashTable<CNotifier*>* CEventLoop::s_notifiers;
+HashMap<int, CEventLoop::NotifierFD>* CEventLoop::s_notifier_fds;
+int CEventLoop::s_epoll_fd = -1;
 int CEventLoop::s_next_timer_id = 1;
 int CEventLoop::s_wake_pipe_fds[2];
 CLocalServer CEventLoop::s_rpc_server;
@@ -36,7 +38,7 @@ CEventLoop::CEventLoop()
     if (!s_event_loop_stack) {
         s_event_loop_stack = new Vector<CEventLoop*>;
         s_timers = new HashMap<int, NonnullOwnPtr<CEventLoop::EventLoopTimer>>;
-        s_notifiers = new HashTable<CNotifier*>;
+        s_notifier_fds = new HashMap<int, NotifierFD>;
     }
 
     if (!s_main_event_loop) {
@@ -45,6 +47,16 @@ CEventLoop::CEventLoop()
         ASSERT(rc == 0);
         s_event_loop_stack->append(this);
 
+        s_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        if (s_epoll_fd >= 0) {
+            epoll_event event;
+            event.events = EPOLLIN;
+            event.data.fd = s_wake_pipe_fds[0];
+            rc = epoll_ctl(s_epoll_fd, EPOLL_CTL_ADD, s_wake_pipe_fds[0], &event);
+            ASSERT(rc == 0);
+        } else {
+            perror("epoll_create1");
+        }
 
         auto rpc_path = String::format("/tmp/rpc.%d", getpid());
         rc = unlink(rpc_path.characters());
@@ -193,30 +205,6 @@ void CEventLoop::post_event(CObject& receiver, NonnullOwnPtr<CEvent>&& event)
 
 void CEventLoop::wait_for_event(WaitMode mode)
 {
-    fd_set rfds;
-    fd_set wfds;
-    FD_ZERO(&rfds);
-    FD_ZERO(&wfds);
-
-    int max_fd = 0;
-    auto add_fd_to_set = [&max_fd](int fd, fd_set& set) {
-        FD_SET(fd, &set);
-        if (fd > max_fd)
-            max_fd = fd;
-    };
-
-    int max_fd_added = -1;
-    add_fd_to_set(s_wake_pipe_fds[0], rfds);
-    max_fd = max(max_fd, max_fd_added);
-    for (auto& notifier : *s_notifiers) {
-        if (notifier->event_mask() & CNotifier::Read)
-            add_fd_to_set(notifier->fd(), rfds);
-        if (notifier->event_mask() & CNotifier::Write)
-            add_fd_to_set(notifier->fd(), wfds);
-        if (notifier->event_mask() & CNotifier::Exceptional)
-            ASSERT_NOT_REACHED();
-    }
-
     bool queued_events_is_empty;
     {
         LOCKER(m_lock);
@@ -238,8 +226,15 @@ void CEventLoop::wait_for_event(WaitMode mode)
         should_wait_forever = false;
     }
 
-    int marked_fd_count = CSyscallUtils::safe_syscall(select, max_fd + 1, &rfds, &wfds, nullptr, should_wait_forever ? nullptr : &timeout);
-    if (FD_ISSET(s_wake_pipe_fds[0], &rfds)) {
+    Vector<ReadyFD, 64> ready_fds;
+    if (s_epoll_fd >= 0)
+        wait_with_epoll(should_wait_forever ? nullptr : &timeout, ready_fds);
+    else
+        wait_with_select(should_wait_forever ? nullptr : &timeout, ready_fds);
+
+    for (auto& ready_fd : ready_fds) {
+        if (ready_fd.fd != s_wake_pipe_fds[0])
+            continue;
         char buffer[32];
         auto nread = read(s_wake_pipe_fds[0], buffer, sizeof(buffer));
         if (nread < 0) {
@@ -269,18 +264,87 @@ void CEventLoop::wait_for_event(WaitMode mode)
         }
     }
 
+    for (auto& ready_fd : ready_fds) {
+        auto it = s_notifier_fds->find(ready_fd.fd);
+        if (it == s_notifier_fds->end())
+            continue;
+        for (auto* notifier : it->value.notifiers) {
+            if ((ready_fd.events & CNotifier::Read) && (notifier->event_mask() & CNotifier::Read)) {
+                if (notifier->on_ready_to_read)
+                    post_event(*notifier, make<CNotifierReadEvent>(notifier->fd()));
+            }
+            if ((ready_fd.events & CNotifier::Write) && (notifier->event_mask() & CNotifier::Write)) {
+                if (notifier->on_ready_to_write)
+                    post_event(*notifier, make<CNotifierWriteEvent>(notifier->fd()));
+            }
+        }
+    }
+}
+
+void CEventLoop::wait_with_epoll(const timeval* timeout, Vector<ReadyFD, 64>& ready_fds)
+{
+    int timeout_in_ms = -1;
+    if (timeout) {
+        // Round up, so we don't wake up just before a timer is due and spin until it is.
+        timeout_in_ms = max(0, (int)(timeout->tv_sec * 1000 + (timeout->tv_usec + 999) / 1000));
+    }
+
+    epoll_event events[64];
+    int event_count = CSyscallUtils::safe_syscall(epoll_wait, s_epoll_fd, events, 64, timeout_in_ms);
+    for (int i = 0; i < event_count; ++i) {
+        unsigned mask = 0;
+        if (events[i].events & EPOLLIN)
+            mask |= CNotifier::Read;
+        if (events[i].events & EPOLLOUT)
+            mask |= CNotifier::Write;
+        // Hangups and errors are reported whether or not they were asked for.
+        // Hand them to the notifier like select() would, so it gets to read the EOF
+        // (or the error) instead of epoll_wait() returning the same fd forever.
+        if (events[i].events & (EPOLLHUP | EPOLLERR))
+            mask |= CNotifier::Read | CNotifier::Write;
+        ready_fds.append({ events[i].data.fd, mask });
+    }
+}
+
+void CEventLoop::wait_with_select(const timeval* timeout, Vector<ReadyFD, 64>& ready_fds)
+{
+    fd_set rfds;
+    fd_set wfds;
+    FD_ZERO(&rfds);
+    FD_ZERO(&wfds);
+
+    int max_fd = 0;
+    auto add_fd_to_set = [&max_fd](int fd, fd_set& set) {
+        FD_SET(fd, &set);
+        if (fd > max_fd)
+            max_fd = fd;
+    };
+
+    add_fd_to_set(s_wake_pipe_fds[0], rfds);
+    for (auto& it : *s_notifier_fds) {
+        if (it.value.event_mask & CNotifier::Read)
+            add_fd_to_set(it.key, rfds);
+        if (it.value.event_mask & CNotifier::Write)
+            add_fd_to_set(it.key, wfds);
+        if (it.value.event_mask & CNotifier::Exceptional)
+            ASSERT_NOT_REACHED();
+    }
+
+    timeval select_timeout;
+    if (timeout)
+        select_timeout = *timeout;
+    int marked_fd_count = CSyscallUtils::safe_syscall(select, max_fd + 1, &rfds, &wfds, nullptr, timeout ? &select_timeout : nullptr);
     if (!marked_fd_count)
         return;
 
-    for (auto& notifier : *s_notifiers) {
-        if (FD_ISSET(notifier->fd(), &rfds)) {
-            if (notifier->on_ready_to_read)
-                post_event(*notifier, make<CNotifierReadEvent>(notifier->fd()));
-        }
-        if (FD_ISSET(notifier->fd(), &wfds)) {
-            if (notifier->on_ready_to_write)
-                post_event(*notifier, make<CNotifierWriteEvent>(notifier->fd()));
-        }
+    for (int fd = 0; fd <= max_fd; ++fd) {
+        unsigned mask = 0;
+        if (FD_ISSET(fd, &rfds))
+            mask |= CNotifier::Read;
+        if (FD_ISSET(fd, &wfds))
+            mask |= CNotifier::Write;
+        if (mask)
+            ready_fds.append({ fd, mask });
     }
 }
 
@@ -336,12 +400,68 @@ bool CEventLoop::unregister_timer(int timer_id)
 
 void CEventLoop::register_notifier(Badge<CNotifier>, CNotifier& notifier)
 {
-    s_notifiers->set(&notifier);
+    auto& notifier_fd = s_notifier_fds->ensure(notifier.fd());
+    if (notifier_fd.notifiers.contains_slow(&notifier))
+        return;
+    notifier_fd.notifiers.append(&notifier);
+    // Tell the kernel again even if the mask is unchanged, in case this is a new file
+    // that reused the fd of one that was closed while its notifier was still around.
+    notifier_fd.is_registered = false;
+    update_notifier_fd(notifier.fd());
 }
 
 void CEventLoop::unregister_notifier(Badge<CNotifier>, CNotifier& notifier)
 {
-    s_notifiers->remove(&notifier);
+    auto it = s_notifier_fds->find(notifier.fd());
+    if (it == s_notifier_fds->end())
+        return;
+    it->value.notifiers.remove_first_matching([&](auto* entry) { return entry == &notifier; });
+    update_notifier_fd(notifier.fd());
+}
+
+void CEventLoop::did_change_notifier_event_mask(Badge<CNotifier>, CNotifier& notifier)
+{
+    if (s_notifier_fds->contains(notifier.fd()))
+        update_notifier_fd(notifier.fd());
+}
+
+void CEventLoop::update_notifier_fd(int fd)
+{
+    auto it = s_notifier_fds->find(fd);
+    ASSERT(it != s_notifier_fds->end());
+    auto& notifier_fd = it->value;
+
+    if (notifier_fd.notifiers.is_empty()) {
+        s_notifier_fds->remove(it);
+        // The fd may well have been closed already, which takes it out of the set anyway.
+        if (s_epoll_fd >= 0)
+            epoll_ctl(s_epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+        return;
+    }
+
+    unsigned event_mask = 0;
+    for (auto* notifier : notifier_fd.notifiers)
+        event_mask |= notifier->event_mask();
+    if (notifier_fd.is_registered && event_mask == notifier_fd.event_mask)
+        return;
+    notifier_fd.event_mask = event_mask;
+    bool was_registered = notifier_fd.is_registered;
+    notifier_fd.is_registered = true;
+
+    if (s_epoll_fd < 0)
+        return;
+    epoll_event event;
+    event.events = 0;
+    if (event_mask & CNotifier::Read)
+        event.events |= EPOLLIN;
+    if (event_mask & CNotifier::Write)
+        event.events |= EPOLLOUT;
+    event.data.fd = fd;
+    // If the fd was closed and reused behind our back, the kernel has forgotten it.
+    if (!was_registered || epoll_ctl(s_epoll_fd, EPOLL_CTL_MOD, fd, &event) < 0) {
+        if (epoll_ctl(s_epoll_fd, EPOLL_CTL_ADD, fd, &event) < 0)
+            perror("CEventLoop: epoll_ctl");
+    }
 }
 
 void CEventLoop::wake()
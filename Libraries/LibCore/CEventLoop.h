@@ -43,6 +43,7 @@ public:
 
     static void register_notifier(Badge<CNotifier>, CNotifier&);
     static void unregister_notifier(Badge<CNotifier>, CNotifier&);
+    static void did_change_notifier_event_mask(Badge<CNotifier>, CNotifier&);
 
     void quit(int);
 
@@ -54,9 +55,18 @@ public:
     static void wake();
 
 private:
+    struct ReadyFD {
+        int fd { -1 };
+        unsigned events { 0 };
+    };
+
     void wait_for_event(WaitMode);
+    void wait_with_epoll(const timeval* timeout, Vector<ReadyFD, 64>&);
+    void wait_with_select(const timeval* timeout, Vector<ReadyFD, 64>&);
     void get_next_timer_expiration(timeval&);
 
+    static void update_notifier_fd(int fd);
+
     struct QueuedEvent {
         WeakPtr<CObject> receiver;
         NonnullOwnPtr<CEvent> event;
@@ -85,7 +95,18 @@ private:
     static HashMap<int, NonnullOwnPtr<EventLoopTimer>>* s_timers;
     static int s_next_timer_id;
 
-    static HashTable<CNotifier*>* s_notifiers;
+    // All notifiers, grouped by the fd they watch. The event mask is the union of the
+    // notifiers' masks, and is what we last told the kernel about.
+    struct NotifierFD {
+        Vector<CNotifier*, 1> notifiers;
+        unsigned event_mask { 0 };
+        bool is_registered { false };
+    };
+    static HashMap<int, NotifierFD>* s_notifier_fds;
+
+    // The epoll instance all notifier fds are registered with, or -1 if the kernel
+    // didn't give us one, in which case we fall back to select().
+    static int s_epoll_fd;
 
     static CLocalServer s_rpc_server;
 };
@@ -2,6 +2,8 @@
 #include <errno.h>
 #include <fcntl.h>
 #include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
 #include <unistd.h>
 
 CFile::CFile(const StringView& filename, CObject* parent)
@@ -50,3 +52,40 @@ bool CFile::open(CIODevice::OpenMode mode)
     set_mode(mode);
     return true;
 }
+
+bool CFile::close()
+{
+    m_mapped_file.unmap();
+    return CIODevice::close();
+}
+
+bool CFile::map_for_reading()
+{
+    if (fd() < 0 || !(mode() & CIODevice::ReadOnly))
+        return false;
+    struct stat st;
+    if (fstat(fd(), &st) < 0 || !S_ISREG(st.st_mode) || !st.st_size)
+        return false;
+    off_t position = lseek(fd(), 0, SEEK_CUR);
+    if (position < 0 || position > st.st_size)
+        return false;
+    m_mapped_file = MappedFile(fd());
+    if (!m_mapped_file.is_valid())
+        return false;
+    m_mapped_offset = position;
+    return true;
+}
+
+StringView CFile::read_line_view()
+{
+    if (!is_mapped())
+        return CIODevice::read_line_view();
+    int remaining = (int)m_mapped_file.size() - m_mapped_offset;
+    if (remaining <= 0)
+        return {};
+    auto* start = (const char*)m_mapped_file.pointer() + m_mapped_offset;
+    auto* newline = (const char*)memchr(start, '\n', remaining);
+    int length = newline ? newline - start + 1 : remaining;
+    m_mapped_offset += length;
+    return { start, length };
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <AK/AKString.h>
+#include <AK/MappedFile.h>
 #include <LibCore/CIODevice.h>
 
 class CFile final : public CIODevice {
@@ -23,8 +24,22 @@ public:
         Yes
     };
     bool open(int fd, CIODevice::OpenMode, ShouldCloseFileDescription);
+    virtual bool close() override;
+
+    // Maps an open regular file into memory, so that read_line_view() can hand out lines
+    // straight from the mapping, starting at the current file position, instead of copying
+    // them through our read buffer. Returns false for anything else (pipes, terminals,
+    // devices), which keep working through the read buffer.
+    bool map_for_reading();
+    bool is_mapped() const { return m_mapped_file.is_valid(); }
+    const void* mapped_data() const { return m_mapped_file.pointer(); }
+    size_t mapped_size() const { return m_mapped_file.size(); }
+
+    virtual StringView read_line_view() override;
 
 private:
     String m_filename;
+    MappedFile m_mapped_file;
+    int m_mapped_offset { 0 };
     ShouldCloseFileDescription m_should_close_file_descriptor { ShouldCloseFileDescription::Yes };
 };
@@ -39,12 +39,10 @@ ByteBuffer CIODevice::read(int max_size)
     auto* buffer_ptr = (char*)buffer.pointer();
     int remaining_buffer_space = buffer.size();
     int taken_from_buffered = 0;
-    if (!m_buffered_data.is_empty()) {
-        taken_from_buffered = min(remaining_buffer_space, m_buffered_data.size());
-        memcpy(buffer_ptr, m_buffered_data.data(), taken_from_buffered);
-        Vector<u8> new_buffered_data;
-        new_buffered_data.append(m_buffered_data.data() + taken_from_buffered, m_buffered_data.size() - taken_from_buffered);
-        m_buffered_data = move(new_buffered_data);
+    if (buffered_size()) {
+        taken_from_buffered = min(remaining_buffer_space, buffered_size());
+        memcpy(buffer_ptr, buffered_data(), taken_from_buffered);
+        consume_buffered(taken_from_buffered);
         remaining_buffer_space -= taken_from_buffered;
         buffer_ptr += taken_from_buffered;
     }
@@ -89,21 +87,41 @@ bool CIODevice::can_read_from_fd() const
     return FD_ISSET(m_fd, &rfds);
 }
 
+const u8* CIODevice::find_buffered_newline() const
+{
+    if (!buffered_size())
+        return nullptr;
+    return (const u8*)memchr(buffered_data(), '\n', buffered_size());
+}
+
+void CIODevice::consume_buffered(int size)
+{
+    m_read_start += size;
+    if (m_read_start == m_read_end)
+        clear_buffered();
+}
+
+void CIODevice::clear_buffered()
+{
+    m_read_start = 0;
+    m_read_end = 0;
+}
+
 bool CIODevice::can_read_line()
 {
-    if (m_eof && !m_buffered_data.is_empty())
+    if (m_eof && buffered_size())
         return true;
-    if (m_buffered_data.contains_slow('\n'))
+    if (find_buffered_newline())
         return true;
     if (!can_read_from_fd())
         return false;
     populate_read_buffer();
-    return m_buffered_data.contains_slow('\n');
+    return find_buffered_newline();
 }
 
 bool CIODevice::can_read() const
 {
-    return !m_buffered_data.is_empty() || can_read_from_fd();
+    return buffered_size() || can_read_from_fd();
 }
 
 ByteBuffer CIODevice::read_all()
@@ -117,9 +135,9 @@ ByteBuffer CIODevice::read_all()
     Vector<u8> data;
     data.ensure_capacity(file_size);
 
-    if (!m_buffered_data.is_empty()) {
-        data.append(m_buffered_data.data(), m_buffered_data.size());
-        m_buffered_data.clear();
+    if (buffered_size()) {
+        data.append(buffered_data(), buffered_size());
+        clear_buffered();
     }
 
     while (can_read_from_fd()) {
@@ -146,38 +164,63 @@ ByteBuffer CIODevice::read_line(int max_size)
         return {};
     if (!can_read_line())
         return {};
-    if (m_eof) {
-        if (m_buffered_data.size() > max_size) {
+    auto* newline = find_buffered_newline();
+    if (!newline) {
+        // can_read_line() only says yes without a newline at EOF.
+        if (buffered_size() > max_size) {
             dbgprintf("CIODevice::read_line: At EOF but there's more than max_size(%d) buffered\n", max_size);
             return {};
         }
-        auto buffer = ByteBuffer::copy(m_buffered_data.data(), m_buffered_data.size());
-        m_buffered_data.clear();
+        auto buffer = ByteBuffer::copy(buffered_data(), buffered_size());
+        clear_buffered();
         return buffer;
     }
-    auto line = ByteBuffer::create_uninitialized(max_size + 1);
-    int line_index = 0;
-    while (line_index < max_size) {
-        u8 ch = m_buffered_data[line_index];
-        line[line_index++] = ch;
-        if (ch == '\n') {
-            Vector<u8> new_buffered_data;
-            new_buffered_data.append(m_buffered_data.data() + line_index, m_buffered_data.size() - line_index);
-            m_buffered_data = move(new_buffered_data);
-            line[line_index] = '\0';
-            line.trim(line_index + 1);
+    int line_length = newline - buffered_data() + 1;
+    if (line_length > max_size)
+        return {};
+    auto line = ByteBuffer::create_uninitialized(line_length + 1);
+    memcpy(line.pointer(), buffered_data(), line_length);
+    line[line_length] = '\0';
+    consume_buffered(line_length);
+    return line;
+}
+
+StringView CIODevice::read_line_view()
+{
+    if (m_fd < 0)
+        return {};
+    for (;;) {
+        if (auto* newline = find_buffered_newline()) {
+            StringView line(buffered_data(), newline - buffered_data() + 1);
+            consume_buffered(line.length());
             return line;
         }
+        if (!populate_read_buffer())
+            break;
     }
-    return {};
+    if (!buffered_size())
+        return {};
+    // The last line didn't end in a newline.
+    StringView line(buffered_data(), buffered_size());
+    // Don't reset the buffer here, the view still points into it.
+    m_read_start = m_read_end;
+    return line;
 }
 
 bool CIODevice::populate_read_buffer()
 {
     if (m_fd < 0)
         return false;
-    u8 buffer[1024];
-    int nread = ::read(m_fd, buffer, sizeof(buffer));
+    if (m_read_end == m_read_buffer.size()) {
+        if (m_read_start) {
+            memmove(m_read_buffer.data(), buffered_data(), buffered_size());
+            m_read_end -= m_read_start;
+            m_read_start = 0;
+        } else {
+            m_read_buffer.resize(max(4096, m_read_buffer.size() * 2));
+        }
+    }
+    int nread = ::read(m_fd, m_read_buffer.data() + m_read_end, m_read_buffer.size() - m_read_end);
     if (nread < 0) {
         set_error(errno);
         return false;
@@ -186,7 +229,7 @@ bool CIODevice::populate_read_buffer()
         set_eof(true);
         return false;
     }
-    m_buffered_data.append(buffer, nread);
+    m_read_end += nread;
     return true;
 }
 
@@ -225,7 +268,7 @@ bool CIODevice::seek(i64 offset, SeekMode mode, off_t* pos)
             *pos = -1;
         return false;
     }
-    m_buffered_data.clear();
+    clear_buffered();
     m_eof = false;
     if (pos)
         *pos = rc;
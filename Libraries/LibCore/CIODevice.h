@@ -35,6 +35,11 @@ public:
     ByteBuffer read_line(int max_size);
     ByteBuffer read_all();
 
+    // Returns the next line, including its newline if it has one, or a null StringView
+    // at the end of the input. The view points into our read buffer (or straight into
+    // the file, see CFile::map_for_reading()), so it's only good until the next read.
+    virtual StringView read_line_view();
+
     bool write(const u8*, int size);
     bool write(const StringView& v) { return write((const u8*)v.characters_without_null_termination(), v.length()); }
 
@@ -70,9 +75,19 @@ private:
     bool populate_read_buffer();
     bool can_read_from_fd() const;
 
+    // Unread data lives in m_read_buffer[m_read_start, m_read_end). Consuming data just
+    // moves m_read_start along; it's only shifted back to the front when we need room.
+    const u8* buffered_data() const { return m_read_buffer.data() + m_read_start; }
+    int buffered_size() const { return m_read_end - m_read_start; }
+    const u8* find_buffered_newline() const;
+    void consume_buffered(int);
+    void clear_buffered();
+
     int m_fd { -1 };
     int m_error { 0 };
     bool m_eof { false };
     OpenMode m_mode { NotOpen };
-    Vector<u8> m_buffered_data;
+    Vector<u8> m_read_buffer;
+    int m_read_start { 0 };
+    int m_read_end { 0 };
 };
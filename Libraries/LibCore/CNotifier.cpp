@@ -23,6 +23,12 @@ void CNotifier::set_enabled(bool enabled)
         CEventLoop::unregister_notifier({}, *this);
 }
 
+void CNotifier::set_event_mask(unsigned event_mask)
+{
+    m_event_mask = event_mask;
+    CEventLoop::did_change_notifier_event_mask({}, *this);
+}
+
 void CNotifier::event(CEvent& event)
 {
     if (event.type() == CEvent::NotifierRead && on_ready_to_read) {
@@ -1,6 +1,4 @@
-#include <AK/JsonArray.h>
-#include <AK/JsonObject.h>
-#include <AK/JsonValue.h>
+#include <AK/JsonReader.h>
 #include <LibCore/CFile.h>
 #include <LibCore/CProcessStatisticsReader.h>
 #include <pwd.h>
@@ -18,37 +16,80 @@ HashMap<pid_t, CProcessStatistics> CProcessStatisticsReader::get_all()
 
     HashMap<pid_t, CProcessStatistics> map;
 
+    // /proc/all is an array of flat objects, so rather than building a JsonValue tree
+    // we pick the members we want straight out of the file contents.
     auto file_contents = file.read_all();
-    auto json = JsonValue::from_string({ file_contents.data(), file_contents.size() });
-    json.as_array().for_each([&](auto& value) {
-        const JsonObject& process_object = value.as_object();
+    JsonReader reader({ file_contents.data(), file_contents.size() });
+    if (reader.next() != JsonReader::Token::BeginArray)
+        return map;
+
+    while (reader.next() == JsonReader::Token::BeginObject) {
         CProcessStatistics process;
 
-        // kernel data first
-        process.pid = process_object.get("pid").to_u32();
-        process.times_scheduled = process_object.get("times_scheduled").to_u32();
-        process.pgid = process_object.get("pgid").to_u32();
-        process.pgp = process_object.get("pgp").to_u32();
-        process.sid = process_object.get("sid").to_u32();
-        process.uid = process_object.get("uid").to_u32();
-        process.gid = process_object.get("gid").to_u32();
-        process.state = process_object.get("state").to_string();
-        process.ppid = process_object.get("ppid").to_u32();
-        process.nfds = process_object.get("nfds").to_u32();
-        process.name = process_object.get("name").to_string();
-        process.tty = process_object.get("tty").to_string();
-        process.amount_virtual = process_object.get("amount_virtual").to_u32();
-        process.amount_resident = process_object.get("amount_resident").to_u32();
-        process.amount_shared = process_object.get("amount_shared").to_u32();
-        process.ticks = process_object.get("ticks").to_u32();
-        process.priority = process_object.get("priority").to_string();
-        process.syscall_count = process_object.get("syscall_count").to_u32();
-        process.icon_id = process_object.get("icon_id").to_int();
+        auto to_u32 = [&] {
+            bool ok;
+            return reader.text().to_uint(ok);
+        };
+
+        JsonReader::Token token;
+        while ((token = reader.next()) == JsonReader::Token::Key) {
+            auto key = reader.text();
+            // All the members we care about are strings or numbers.
+            auto value_token = reader.next();
+            if (value_token == JsonReader::Token::BeginObject || value_token == JsonReader::Token::BeginArray) {
+                reader.skip_container();
+                continue;
+            }
+
+            // kernel data first
+            if (key == "pid")
+                process.pid = to_u32();
+            else if (key == "times_scheduled")
+                process.times_scheduled = to_u32();
+            else if (key == "pgid")
+                process.pgid = to_u32();
+            else if (key == "pgp")
+                process.pgp = to_u32();
+            else if (key == "sid")
+                process.sid = to_u32();
+            else if (key == "uid")
+                process.uid = to_u32();
+            else if (key == "gid")
+                process.gid = to_u32();
+            else if (key == "state")
+                process.state = reader.string();
+            else if (key == "ppid")
+                process.ppid = to_u32();
+            else if (key == "nfds")
+                process.nfds = to_u32();
+            else if (key == "name")
+                process.name = reader.string();
+            else if (key == "tty")
+                process.tty = reader.string();
+            else if (key == "amount_virtual")
+                process.amount_virtual = to_u32();
+            else if (key == "amount_resident")
+                process.amount_resident = to_u32();
+            else if (key == "amount_shared")
+                process.amount_shared = to_u32();
+            else if (key == "ticks")
+                process.ticks = to_u32();
+            else if (key == "priority")
+                process.priority = reader.string();
+            else if (key == "syscall_count")
+                process.syscall_count = to_u32();
+            else if (key == "icon_id") {
+                bool ok;
+                process.icon_id = reader.text().to_int(ok);
+            }
+        }
+        if (token != JsonReader::Token::EndObject)
+            break;
 
         // and synthetic data last
         process.username = username_from_uid(process.uid);
         map.set(process.pid, process);
-    });
+    }
 
     return map;
 }
@@ -11,6 +11,11 @@ public:
         : m_rects(move(other.m_rects))
     {
     }
+    DisjointRectSet& operator=(DisjointRectSet&& other)
+    {
+        m_rects = move(other.m_rects);
+        return *this;
+    }
 
     void add(const Rect&);
 
@@ -85,14 +85,13 @@ void GSortingProxyModel::resort()
     quick_sort(m_row_mappings.begin(), m_row_mappings.end(), [&](auto row1, auto row2) -> bool {
         auto data1 = target().data(target().index(row1, m_key_column), GModel::Role::Sort);
         auto data2 = target().data(target().index(row2, m_key_column), GModel::Role::Sort);
-        if (data1 == data2)
-            return 0;
-        bool is_less_than;
-	if (data1.is_string() && data2.is_string() && !m_sorting_case_sensitive)
-	    is_less_than = data1.as_string().to_lowercase() < data2.as_string().to_lowercase();
-	else
-	    is_less_than = data1 < data2;
-        return m_sort_order == GSortOrder::Ascending ? is_less_than : !is_less_than;
+        // quick_sort() needs a strict weak ordering, so descending order swaps the operands
+        // instead of negating the result.
+        auto& left = m_sort_order == GSortOrder::Ascending ? data1 : data2;
+        auto& right = m_sort_order == GSortOrder::Ascending ? data2 : data1;
+        if (left.is_string() && right.is_string() && !m_sorting_case_sensitive)
+            return left.as_string().to_lowercase() < right.as_string().to_lowercase();
+        return left < right;
     });
     if (previously_selected_target_row != -1) {
         // Preserve selection.
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <AK/AKString.h>
+#include <AK/BumpAllocator.h>
 #include <AK/NonnullRefPtrVector.h>
 #include <AK/OwnPtr.h>
 #include <LibHTML/CSS/StyleResolver.h>
@@ -21,7 +22,16 @@ public:
     void add_sheet(const StyleSheet& sheet) { m_sheets.append(sheet); }
     const NonnullRefPtrVector<StyleSheet>& stylesheets() const { return m_sheets; }
 
+    // Every node in the document other than the document itself comes from its arena, and
+    // they're all destroyed together with it. Nothing outside the tree may keep one alive.
+    template<typename T, typename... Args>
+    NonnullRefPtr<T> create_node(Args&&... args)
+    {
+        return adopt(*m_arena.make<T>(forward<Args>(args)...));
+    }
+
 private:
+    BumpAllocator m_arena;
     OwnPtr<StyleResolver> m_style_resolver;
     NonnullRefPtrVector<StyleSheet> m_sheets;
 };
@@ -26,6 +26,9 @@ public:
     explicit Element(const String& tag_name);
     virtual ~Element() override;
 
+    // Elements are made with Document::create_node(), and only ever destroyed with their document.
+    void operator delete(void*) { ASSERT_NOT_REACHED(); }
+
     const String& tag_name() const { return m_tag_name; }
 
     String attribute(const String& name) const;
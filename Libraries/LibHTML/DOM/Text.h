@@ -8,6 +8,9 @@ public:
     explicit Text(const String&);
     virtual ~Text() override;
 
+    // Like elements, text nodes live in their document's arena.
+    void operator delete(void*) { ASSERT_NOT_REACHED(); }
+
     const String& data() const { return m_data; }
 
 private:
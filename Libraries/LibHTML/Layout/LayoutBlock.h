@@ -1,10 +1,13 @@
 #pragma once
 
+#include <AK/ObjectPool.h>
 #include <LibHTML/Layout/LayoutNode.h>
 
 class Element;
 
 class LayoutBlock : public LayoutNode {
+    // The layout tree is rebuilt from scratch on every layout, so its nodes are pooled.
+    AK_MAKE_POOL_ALLOCATED(LayoutBlock)
 public:
     LayoutBlock(const Node*, const StyledNode*);
     virtual ~LayoutBlock() override;
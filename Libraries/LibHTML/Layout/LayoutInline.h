@@ -1,10 +1,12 @@
 #pragma once
 
+#include <AK/ObjectPool.h>
 #include <LibHTML/Layout/LayoutNode.h>
 
 class Element;
 
 class LayoutInline : public LayoutNode {
+    AK_MAKE_POOL_ALLOCATED(LayoutInline)
 public:
     LayoutInline(const Node&, const StyledNode&);
     virtual ~LayoutInline() override;
@@ -5,11 +5,6 @@
 #include <ctype.h>
 #include <stdio.h>
 
-static NonnullRefPtr<Element> create_element(const String& tag_name)
-{
-    return adopt(*new Element(tag_name));
-}
-
 static bool is_valid_in_attribute_name(char ch)
 {
     return isalnum(ch) || ch == '_' || ch == '-';
@@ -75,7 +70,7 @@ NonnullRefPtr<Document> parse_html(const String& html)
         if (new_state == State::BeforeAttributeValue)
             attribute_value_buffer.clear();
         if (state == State::Free && !text_buffer.is_empty()) {
-            auto text_node = adopt(*new Text(String::copy(text_buffer)));
+            auto text_node = doc->create_node<Text>(String::copy(text_buffer));
             text_buffer.clear();
             node_stack.last().append_child(text_node);
         }
@@ -89,7 +84,7 @@ NonnullRefPtr<Document> parse_html(const String& html)
     };
 
     auto open_tag = [&] {
-        auto new_element = create_element(String::copy(tag_name_buffer));
+        auto new_element = doc->create_node<Element>(String::copy(tag_name_buffer));
         tag_name_buffer.clear();
         new_element->set_attributes(move(attributes));
         node_stack.append(new_element);
@@ -4,6 +4,7 @@
 
 #include <AK/Assertions.h>
 #include <AK/Types.h>
+#include <sys/futex.h>
 #include <unistd.h>
 
 #define memory_barrier() asm volatile("" :: \
@@ -31,7 +32,8 @@ public:
     void unlock();
 
 private:
-    volatile u32 m_lock { 0 };
+    // 0: unlocked, 1: locked, 2: locked and somebody may be parked in futex().
+    u32 m_lock { 0 };
     u32 m_level { 0 };
     int m_holder { -1 };
 };
@@ -54,39 +56,35 @@ private:
 [[gnu::always_inline]] inline void Lock::lock()
 {
     int tid = gettid();
-    for (;;) {
-        if (CAS(&m_lock, 1, 0) == 0) {
-            if (m_holder == -1 || m_holder == tid) {
-                m_holder = tid;
-                ++m_level;
-                memory_barrier();
-                m_lock = 0;
-                return;
-            }
-            m_lock = 0;
+    // Only we can have put our own tid in there, so this is safe to check without the lock.
+    if (m_holder == tid) {
+        ++m_level;
+        return;
+    }
+    u32 state = CAS(&m_lock, 1, 0);
+    if (state != 0) {
+        // Somebody else has it. Mark it contended and sleep until it's handed back.
+        if (state != 2)
+            state = __atomic_exchange_n(&m_lock, 2, __ATOMIC_ACQUIRE);
+        while (state != 0) {
+            futex(&m_lock, FUTEX_WAIT, 2, nullptr, nullptr, 0);
+            state = __atomic_exchange_n(&m_lock, 2, __ATOMIC_ACQUIRE);
         }
-        donate(m_holder);
     }
+    m_holder = tid;
+    m_level = 1;
 }
 
 inline void Lock::unlock()
 {
-    for (;;) {
-        if (CAS(&m_lock, 1, 0) == 0) {
-            ASSERT(m_holder == gettid());
-            ASSERT(m_level);
-            --m_level;
-            if (m_level) {
-                memory_barrier();
-                m_lock = 0;
-                return;
-            }
-            m_holder = -1;
-            memory_barrier();
-            m_lock = 0;
-            return;
-        }
-        donate(m_holder);
+    ASSERT(m_holder == gettid());
+    ASSERT(m_level);
+    if (--m_level)
+        return;
+    m_holder = -1;
+    if (__atomic_fetch_sub(&m_lock, 1, __ATOMIC_RELEASE) != 1) {
+        __atomic_store_n(&m_lock, 0, __ATOMIC_RELEASE);
+        futex(&m_lock, FUTEX_WAKE, 1, nullptr, nullptr, 0);
     }
 }
 
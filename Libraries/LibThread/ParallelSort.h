@@ -0,0 +1,79 @@
+#pragma once
+
+#include <AK/MergeSort.h>
+#include <AK/NonnullOwnPtrVector.h>
+#include <AK/QuickSort.h>
+#include <AK/Vector.h>
+#include <LibThread/Thread.h>
+
+namespace LibThread {
+
+// Sorts large arrays on several threads at once: each thread quick_sort()s one slice,
+// and then neighbouring slices are merged together, again in parallel, until there's
+// just one. Like quick_sort(), it's not stable, and the iterators must point into
+// contiguous storage.
+//
+// Below minimum_parallel_size elements the threads cost more than they save, so we just
+// sort in the calling thread.
+
+constexpr int minimum_parallel_size = 32768;
+
+template<typename T, typename LessThan>
+void parallel_sort_impl(T* data, int size, LessThan less_than, int thread_count)
+{
+    // Slice boundaries, so slice i is [bounds[i], bounds[i + 1]).
+    Vector<int> bounds;
+    for (int i = 0; i <= thread_count; ++i)
+        bounds.append((int)((i64)size * i / thread_count));
+
+    // Runs one job per slice (or pair of slices), with the calling thread taking the
+    // first one itself instead of sitting idle.
+    auto run_in_parallel = [&](int job_count, auto job) {
+        NonnullOwnPtrVector<Thread> threads;
+        for (int i = 1; i < job_count; ++i) {
+            threads.append(make<Thread>([i, &job] {
+                job(i);
+                return 0;
+            }));
+            threads.last().start();
+        }
+        job(0);
+        for (auto& thread : threads)
+            thread.join();
+    };
+
+    run_in_parallel(thread_count, [&](int slice) {
+        quick_sort(data + bounds[slice], data + bounds[slice + 1], less_than);
+    });
+
+    for (int width = 1; width < thread_count; width *= 2) {
+        int merge_count = (thread_count + width * 2 - 1) / (width * 2);
+        run_in_parallel(merge_count, [&](int merge) {
+            int left = merge * width * 2;
+            int middle = left + width;
+            int right = min(middle + width, thread_count);
+            if (middle >= thread_count)
+                return;
+            Vector<T> buffer;
+            AK::MergeSort::merge(data + bounds[left], data + bounds[middle], data + bounds[right], buffer, less_than);
+        });
+    }
+}
+
+template<typename Iterator, typename LessThan>
+void parallel_sort(Iterator start, Iterator end, LessThan less_than, int thread_count = 4)
+{
+    int size = end - start;
+    if (size <= 1)
+        return;
+    auto* data = &*start;
+    if (size < minimum_parallel_size || thread_count <= 1) {
+        quick_sort(data, data + size, less_than);
+        return;
+    }
+    parallel_sort_impl(data, size, less_than, thread_count);
+}
+
+}
+
+using LibThread::parallel_sort;
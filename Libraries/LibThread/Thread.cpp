@@ -1,4 +1,5 @@
 #include <LibThread/Thread.h>
+#include <sys/futex.h>
 #include <unistd.h>
 
 LibThread::Thread::Thread(Function<int()> action)
@@ -9,7 +10,7 @@ LibThread::Thread::Thread(Function<int()> action)
 
 LibThread::Thread::~Thread()
 {
-    if (m_tid != -1) {
+    if (m_tid != -1 && !__atomic_load_n(&m_finished, __ATOMIC_ACQUIRE)) {
         dbg() << "trying to destroy a running thread!";
         ASSERT_NOT_REACHED();
     }
@@ -17,10 +18,11 @@ LibThread::Thread::~Thread()
 
 void LibThread::Thread::start()
 {
+    m_finished = 0;
     int rc = create_thread([](void* arg) {
         Thread* self = static_cast<Thread*>(arg);
         int exit_code = self->m_action();
-        self->m_tid = -1;
+        self->finish(exit_code);
         exit_thread(exit_code);
         return exit_code;
     }, static_cast<void*>(this));
@@ -34,6 +36,26 @@ void LibThread::Thread::quit(int code)
 {
     ASSERT(m_tid == gettid());
 
-    m_tid = -1;
+    finish(code);
     exit_thread(code);
 }
+
+void LibThread::Thread::finish(int code)
+{
+    // The thread may not touch this object after we set m_finished, since a joiner is
+    // free to destroy it from then on. Waking the joiner only needs the address.
+    m_exit_code = code;
+    __atomic_store_n(&m_finished, 1, __ATOMIC_RELEASE);
+    futex(&m_finished, FUTEX_WAKE, INT32_MAX, nullptr, nullptr, 0);
+}
+
+int LibThread::Thread::join()
+{
+    ASSERT(m_tid != -1);
+    ASSERT(m_tid != gettid());
+
+    while (!__atomic_load_n(&m_finished, __ATOMIC_ACQUIRE))
+        futex(&m_finished, FUTEX_WAIT, 0, nullptr, nullptr, 0);
+    m_tid = -1;
+    return m_exit_code;
+}
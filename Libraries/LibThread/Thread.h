@@ -15,9 +15,17 @@ public:
     void start();
     void quit(int code = 0);
 
+    // Waits for the thread's action to return (or for it to quit()), and returns its exit code.
+    int join();
+
 private:
+    void finish(int code);
+
     Function<int()> m_action;
     int m_tid { -1 };
+    int m_exit_code { 0 };
+    // Set once the thread is done with this object. join() sleeps on it.
+    u32 m_finished { 0 };
 };
 
 }
@@ -86,7 +86,11 @@ void WSCompositor::compose()
         m_wallpaper_mode = mode_to_enum(wm.wm_config()->read_entry("Background", "Mode", "simple"));
     auto& ws = WSScreen::the();
 
-    auto dirty_rects = move(m_dirty_rects);
+    // Swap the dirty rects with last frame's instead of moving them out, so both sets
+    // keep their storage from one frame to the next.
+    swap(m_dirty_rects, m_rects_to_compose);
+    m_dirty_rects.clear_with_capacity();
+    auto& dirty_rects = m_rects_to_compose;
 
     if (dirty_rects.size() == 0) {
         // nothing dirtied since the last compose pass.
@@ -58,6 +58,7 @@ private:
     OwnPtr<Painter> m_front_painter;
 
     DisjointRectSet m_dirty_rects;
+    DisjointRectSet m_rects_to_compose;
 
     Rect m_last_cursor_rect;
     Rect m_last_geometry_label_rect;
@@ -10,6 +10,7 @@
 #include <fcntl.h>
 #include <pwd.h>
 #include <signal.h>
+#include <spawn.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -190,6 +191,7 @@ public:
         m_fds.clear();
     }
     void add(int fd) { m_fds.append(fd); }
+    const Vector<int, 32>& fds() const { return m_fds; }
 
 private:
     Vector<int, 32> m_fds;
@@ -444,33 +446,35 @@ static int run_command(const String& cmd)
         if (handle_builtin(argv.size() - 1, const_cast<char**>(argv.data()), retval))
             return retval;
 
-        pid_t child = fork();
-        if (!child) {
-            setpgid(0, 0);
-            tcsetpgrp(0, getpid());
-            for (auto& rewiring : subcommand.rewirings) {
+        // Every command gets its own process group, which becomes the terminal's foreground group.
+        posix_spawnattr_t attr;
+        posix_spawnattr_init(&attr);
+        posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETPGROUP);
+        posix_spawnattr_setpgroup(&attr, 0);
+
+        posix_spawn_file_actions_t file_actions;
+        posix_spawn_file_actions_init(&file_actions);
+        for (auto& rewiring : subcommand.rewirings) {
 #ifdef SH_DEBUG
-                dbgprintf("in %s<%d>, dup2(%d, %d)\n", argv[0], getpid(), redirection.rewire_fd, redirection.fd);
+            dbgprintf("in %s, dup2(%d, %d)\n", argv[0], rewiring.rewire_fd, rewiring.fd);
 #endif
-                int rc = dup2(rewiring.rewire_fd, rewiring.fd);
-                if (rc < 0) {
-                    perror("dup2");
-                    return 1;
-                }
-            }
-
-            fds.collect();
-
-            int rc = execvp(argv[0], const_cast<char* const*>(argv.data()));
-            if (rc < 0) {
-                if (errno == ENOENT)
-                    fprintf(stderr, "%s: Command not found.\n", argv[0]);
-                else
-                    fprintf(stderr, "execvp(%s): %s\n", argv[0], strerror(errno));
-                exit(1);
-            }
-            ASSERT_NOT_REACHED();
+            posix_spawn_file_actions_adddup2(&file_actions, rewiring.rewire_fd, rewiring.fd);
+        }
+        for (int fd : fds.fds())
+            posix_spawn_file_actions_addclose(&file_actions, fd);
+
+        pid_t child;
+        int rc = posix_spawnp(&child, argv[0], &file_actions, &attr, const_cast<char* const*>(argv.data()), environ);
+        posix_spawn_file_actions_destroy(&file_actions);
+        posix_spawnattr_destroy(&attr);
+        if (rc) {
+            if (rc == ENOENT)
+                fprintf(stderr, "%s: Command not found.\n", argv[0]);
+            else
+                fprintf(stderr, "posix_spawnp(%s): %s\n", argv[0], strerror(rc));
+            continue;
         }
+        tcsetpgrp(0, child);
         children.append({ argv[0], child });
     }
 
@@ -521,22 +525,26 @@ static int run_command(const String& cmd)
     return return_value;
 }
 
-CFile get_history_file()
+String get_history_path()
 {
     StringBuilder sb;
     sb.append(g.home);
     sb.append("/.history");
-    CFile f(sb.to_string());
+    return sb.to_string();
+}
+
+void open_history_file(CFile& f)
+{
     if (!f.open(CIODevice::ReadWrite)) {
         fprintf(stderr, "Error opening file '%s': '%s'\n", f.filename().characters(), f.error_string());
         exit(1);
     }
-    return f;
 }
 
 void load_history()
 {
-    CFile history_file = get_history_file();
+    CFile history_file(get_history_path());
+    open_history_file(history_file);
     while (history_file.can_read_line()) {
         const auto&b = history_file.read_line(1024);
         // skip the newline and terminating bytes
@@ -546,7 +554,8 @@ void load_history()
 
 void save_history()
 {
-    CFile history_file = get_history_file();
+    CFile history_file(get_history_path());
+    open_history_file(history_file);
     for (const auto& line : editor.history()) {
         history_file.write(line);
         history_file.write("\n");
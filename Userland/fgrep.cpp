@@ -1,22 +1,41 @@
-#include <assert.h>
+#include <AK/StringView.h>
+#include <LibCore/CFile.h>
 #include <stdio.h>
 #include <string.h>
 #include <unistd.h>
 
+static bool contains(const StringView& line, const char* needle, int needle_length)
+{
+    auto* characters = line.characters_without_null_termination();
+    auto* end = characters + line.length() - needle_length + 1;
+    // Let memchr() find candidates for the first character, and check the rest by hand.
+    for (auto* candidate = characters; candidate < end;) {
+        candidate = (const char*)memchr(candidate, needle[0], end - candidate);
+        if (!candidate)
+            return false;
+        if (!memcmp(candidate, needle, needle_length))
+            return true;
+        ++candidate;
+    }
+    return false;
+}
+
 int main(int argc, char** argv)
 {
     if (argc < 2) {
         printf("usage: fgrep <str>\n");
         return 0;
     }
-    for (;;) {
-        char buf[4096];
-        auto* str = fgets(buf, sizeof(buf), stdin);
-        if (str && strstr(str, argv[1]))
-            write(1, buf, strlen(buf));
-        if (feof(stdin))
-            return 0;
-        ASSERT(str);
+    const char* needle = argv[1];
+    int needle_length = strlen(needle);
+
+    CFile input;
+    input.open(STDIN_FILENO, CIODevice::ReadOnly, CFile::ShouldCloseFileDescription::No);
+    input.map_for_reading();
+
+    for (auto line = input.read_line_view(); !line.is_null(); line = input.read_line_view()) {
+        if (!needle_length || contains(line, needle, needle_length))
+            fwrite(line.characters_without_null_termination(), 1, line.length(), stdout);
     }
     return 0;
 }
@@ -0,0 +1,118 @@
+#include <AK/Types.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+static int usage()
+{
+    printf("usage: mallocbench [-n ITERATIONS] [-t THREADS]\n");
+    printf("  Time malloc() and free() in one thread, and then in THREADS threads at once.\n");
+    return 1;
+}
+
+static u64 read_tsc()
+{
+    u32 lsw, msw;
+    asm volatile("rdtsc"
+                 : "=d"(msw), "=a"(lsw));
+    return ((u64)msw << 32) | lsw;
+}
+
+static u32 milliseconds_since(const timeval& start)
+{
+    timeval now;
+    gettimeofday(&now, nullptr);
+    return (now.tv_sec - start.tv_sec) * 1000 + (now.tv_usec - start.tv_usec) / 1000;
+}
+
+// Keep the compiler from optimizing away allocations we never use.
+static void* volatile s_sink;
+
+static void bench_pairs(size_t size, int iterations)
+{
+    u64 start = read_tsc();
+    for (int i = 0; i < iterations; ++i) {
+        void* ptr = malloc(size);
+        s_sink = ptr;
+        free(ptr);
+    }
+    printf("malloc+free %5zu bytes      %8u cycles\n", size, (u32)((read_tsc() - start) / iterations));
+}
+
+static void bench_batch(size_t size, int iterations)
+{
+    static void* pointers[1000];
+    int rounds = iterations / 1000;
+    if (!rounds)
+        rounds = 1;
+    u64 start = read_tsc();
+    for (int round = 0; round < rounds; ++round) {
+        for (int i = 0; i < 1000; ++i)
+            pointers[i] = malloc(size);
+        for (int i = 0; i < 1000; ++i)
+            free(pointers[i]);
+    }
+    printf("1000 x malloc, free %5zu bytes %5u cycles per pair\n", size, (u32)((read_tsc() - start) / (rounds * 1000)));
+}
+
+static int s_iterations;
+static volatile int s_finished_threads;
+
+static int thread_entry(void*)
+{
+    void* pointers[16];
+    for (int i = 0; i < s_iterations; i += 16) {
+        for (int j = 0; j < 16; ++j)
+            pointers[j] = malloc(16 + (j * 24));
+        for (int j = 0; j < 16; ++j)
+            free(pointers[j]);
+    }
+    __atomic_add_fetch(&s_finished_threads, 1, __ATOMIC_RELEASE);
+    exit_thread(0);
+    return 0;
+}
+
+static void bench_threads(int thread_count)
+{
+    s_finished_threads = 0;
+    timeval start;
+    gettimeofday(&start, nullptr);
+    for (int i = 0; i < thread_count; ++i) {
+        if (create_thread(thread_entry, nullptr) < 0) {
+            perror("create_thread");
+            exit(1);
+        }
+    }
+    while (__atomic_load_n(&s_finished_threads, __ATOMIC_ACQUIRE) < thread_count)
+        usleep(1000);
+    printf("%d threads x %d malloc+free     %8u ms\n", thread_count, s_iterations, milliseconds_since(start));
+}
+
+int main(int argc, char** argv)
+{
+    int iterations = 100000;
+    int thread_count = 4;
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "-n") && i + 1 < argc)
+            iterations = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-t") && i + 1 < argc)
+            thread_count = atoi(argv[++i]);
+        else
+            return usage();
+    }
+    if (iterations <= 0 || thread_count <= 0)
+        return usage();
+
+    size_t sizes[] = { 16, 64, 256, 1024, 2000 };
+    for (auto size : sizes)
+        bench_pairs(size, iterations);
+    for (auto size : sizes)
+        bench_batch(size, iterations);
+
+    s_iterations = iterations;
+    bench_threads(1);
+    bench_threads(thread_count);
+    return 0;
+}
@@ -6,7 +6,9 @@
 #include <stdlib.h>
 #include <string.h>
 #include <sys/select.h>
+#include <sys/sendfile.h>
 #include <sys/socket.h>
+#include <sys/stat.h>
 #include <sys/time.h>
 #include <sys/types.h>
 #include <unistd.h>
@@ -164,6 +166,10 @@ int main(int argc, char** argv)
     bool stdin_closed = false;
     bool fd_closed = false;
 
+    // When stdin is a regular file, let the kernel move it straight into the socket.
+    struct stat stdin_stat;
+    bool stdin_is_regular_file = fstat(STDIN_FILENO, &stdin_stat) == 0 && S_ISREG(stdin_stat.st_mode);
+
     fd_set readfds, writefds, exceptfds;
 
     while (!stdin_closed || !fd_closed) {
@@ -195,9 +201,13 @@ int main(int argc, char** argv)
 
         if (!stdin_closed && FD_ISSET(STDIN_FILENO, &readfds)) {
             char buf[1024];
-            int nread = read(STDIN_FILENO, buf, sizeof(buf));
+            int nread;
+            if (stdin_is_regular_file)
+                nread = sendfile(fd, STDIN_FILENO, nullptr, 65536);
+            else
+                nread = read(STDIN_FILENO, buf, sizeof(buf));
             if (nread < 0) {
-                perror("read(STDIN_FILENO)");
+                perror(stdin_is_regular_file ? "sendfile" : "read(STDIN_FILENO)");
                 return 1;
             }
 
@@ -210,7 +220,7 @@ int main(int argc, char** argv)
                     close(fd);
                     fd_closed = true;
                 }
-            } else if (write(fd, buf, nread) < 0) {
+            } else if (!stdin_is_regular_file && write(fd, buf, nread) < 0) {
                 perror("write(fd)");
                 return 1;
             }
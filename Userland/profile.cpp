@@ -0,0 +1,273 @@
+#include <AK/AKString.h>
+#include <AK/ELF/ELFImage.h>
+#include <AK/HashMap.h>
+#include <AK/JsonArray.h>
+#include <AK/JsonObject.h>
+#include <AK/MappedFile.h>
+#include <AK/QuickSort.h>
+#include <AK/StringBuilder.h>
+#include <AK/Vector.h>
+#include <LibCore/CFile.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static int usage()
+{
+    printf("usage: profile -p PID -e     start profiling PID\n");
+    printf("       profile -p PID -d     stop profiling PID\n");
+    printf("       profile -p PID [-f]   show the functions PID spent the most time in,\n");
+    printf("                             or with -f, its stacks folded for flamegraph.pl\n");
+    return 1;
+}
+
+struct Symbol {
+    u32 address;
+    String name;
+};
+
+// Symbols from one image, sorted by address so we can binary search them.
+class SymbolTable {
+public:
+    void add(u32 address, const String& name) { m_symbols.append({ address, name }); }
+    void sort()
+    {
+        quick_sort(m_symbols.begin(), m_symbols.end(), [](auto& a, auto& b) {
+            return a.address < b.address;
+        });
+    }
+
+    bool is_empty() const { return m_symbols.is_empty(); }
+    u32 lowest_address() const { return m_symbols.first().address; }
+    u32 highest_address() const { return m_symbols.last().address; }
+
+    const Symbol* find(u32 address) const
+    {
+        if (m_symbols.is_empty() || address < m_symbols.first().address)
+            return nullptr;
+        int low = 0;
+        int high = m_symbols.size() - 1;
+        while (low < high) {
+            int middle = (low + high + 1) / 2;
+            if (m_symbols[middle].address <= address)
+                low = middle;
+            else
+                high = middle - 1;
+        }
+        return &m_symbols[low];
+    }
+
+private:
+    Vector<Symbol> m_symbols;
+};
+
+// /kernel.map is what the kernel symbolicates its own backtraces with. The first line is
+// the symbol count in hex, and then it's the output of `nm -nC`.
+static SymbolTable load_kernel_symbols()
+{
+    SymbolTable table;
+    CFile file("/kernel.map");
+    if (!file.open(CIODevice::ReadOnly)) {
+        fprintf(stderr, "Failed to open /kernel.map: %s\n", file.error_string());
+        return table;
+    }
+    auto contents = file.read_all();
+    auto lines = String::copy(contents).split('\n');
+    for (int i = 1; i < lines.size(); ++i) {
+        auto& line = lines[i];
+        if (line.length() < 12)
+            continue;
+        u32 address = strtoul(line.substring(0, 8).characters(), nullptr, 16);
+        table.add(address, line.substring(11, line.length() - 11));
+    }
+    table.sort();
+    return table;
+}
+
+static SymbolTable load_executable_symbols(pid_t pid, MappedFile& mapped_file)
+{
+    SymbolTable table;
+    char path[PATH_MAX];
+    char exe_link[32];
+    sprintf(exe_link, "/proc/%d/exe", pid);
+    int length = readlink(exe_link, path, sizeof(path) - 1);
+    if (length < 0) {
+        perror("readlink");
+        return table;
+    }
+    path[length] = '\0';
+
+    mapped_file = MappedFile(path);
+    if (!mapped_file.is_valid()) {
+        fprintf(stderr, "Failed to map %s\n", path);
+        return table;
+    }
+    ELFImage image((const u8*)mapped_file.pointer());
+    if (!image.is_valid()) {
+        fprintf(stderr, "%s is not a valid ELF image\n", path);
+        return table;
+    }
+    image.for_each_symbol([&](const ELFImage::Symbol& symbol) {
+        if (symbol.type() == STT_FUNC && symbol.value())
+            table.add(symbol.value(), symbol.name());
+        return IterationDecision::Continue;
+    });
+    table.sort();
+    return table;
+}
+
+struct Symbolicator {
+    SymbolTable kernel;
+    SymbolTable executable;
+
+    String symbolicate(u32 address) const
+    {
+        // Anything inside the kernel image is the kernel's, and everything else is user code.
+        auto& table = (!kernel.is_empty() && address >= kernel.lowest_address() && address <= kernel.highest_address() + PAGE_SIZE) ? kernel : executable;
+        auto* symbol = table.find(address);
+        if (!symbol)
+            return String::format("%p", address);
+        return symbol->name;
+    }
+};
+
+struct FunctionStats {
+    String name;
+    unsigned self { 0 };
+    unsigned total { 0 };
+};
+
+static void print_top_functions(const JsonArray& samples, const Symbolicator& symbolicator)
+{
+    HashMap<String, FunctionStats> functions;
+    for (auto& sample_value : samples.values()) {
+        auto frames = sample_value.as_object().get("frames").as_array();
+        Vector<String> seen;
+        for (int i = 0; i < frames.size(); ++i) {
+            auto name = symbolicator.symbolicate(frames.at(i).to_u32());
+            if (!functions.contains(name))
+                functions.set(name, { name, 0, 0 });
+            auto it = functions.find(name);
+            if (i == 0)
+                ++it->value.self;
+            // Recursive functions only count once per sample towards their total.
+            if (!seen.contains_slow(name)) {
+                ++it->value.total;
+                seen.append(name);
+            }
+        }
+    }
+
+    Vector<FunctionStats> sorted;
+    for (auto& it : functions)
+        sorted.append(it.value);
+    quick_sort(sorted.begin(), sorted.end(), [](auto& a, auto& b) {
+        if (a.self != b.self)
+            return a.self > b.self;
+        return a.total > b.total;
+    });
+
+    unsigned sample_count = samples.size();
+    if (!sample_count)
+        return;
+    // Percentages in tenths, since our printf doesn't do floating point.
+    auto per_mille = [&](unsigned count) { return count * 1000 / sample_count; };
+    printf("%u samples\n", sample_count);
+    printf("  Self            Total           Function\n");
+    for (int i = 0; i < sorted.size() && i < 40; ++i) {
+        auto& function = sorted[i];
+        printf("%6u %3u.%u%%  %6u %3u.%u%%  %s\n",
+            function.self, per_mille(function.self) / 10, per_mille(function.self) % 10,
+            function.total, per_mille(function.total) / 10, per_mille(function.total) % 10,
+            function.name.characters());
+    }
+}
+
+static void print_folded_stacks(const JsonArray& samples, const Symbolicator& symbolicator)
+{
+    HashMap<String, unsigned> stacks;
+    for (auto& sample_value : samples.values()) {
+        auto frames = sample_value.as_object().get("frames").as_array();
+        StringBuilder builder;
+        for (int i = frames.size() - 1; i >= 0; --i) {
+            builder.append(symbolicator.symbolicate(frames.at(i).to_u32()));
+            if (i)
+                builder.append(';');
+        }
+        auto stack = builder.to_string();
+        auto it = stacks.find(stack);
+        if (it == stacks.end())
+            stacks.set(stack, 1);
+        else
+            ++it->value;
+    }
+    for (auto& it : stacks)
+        printf("%s %u\n", it.key.characters(), it.value);
+}
+
+int main(int argc, char** argv)
+{
+    pid_t pid = -1;
+    bool enable = false;
+    bool disable = false;
+    bool folded = false;
+
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "-p") && i + 1 < argc)
+            pid = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-e"))
+            enable = true;
+        else if (!strcmp(argv[i], "-d"))
+            disable = true;
+        else if (!strcmp(argv[i], "-f"))
+            folded = true;
+        else
+            return usage();
+    }
+    if (pid < 0)
+        return usage();
+
+    if (enable) {
+        if (profiling_enable(pid) < 0) {
+            perror("profiling_enable");
+            return 1;
+        }
+        return 0;
+    }
+
+    if (disable) {
+        if (profiling_disable(pid) < 0) {
+            perror("profiling_disable");
+            return 1;
+        }
+        return 0;
+    }
+
+    auto profile_path = String::format("/proc/%d/profile", pid);
+    CFile file(profile_path);
+    if (!file.open(CIODevice::ReadOnly)) {
+        fprintf(stderr, "Failed to open %s: %s\n", profile_path.characters(), file.error_string());
+        return 1;
+    }
+    auto contents = file.read_all();
+    if (contents.is_empty()) {
+        fprintf(stderr, "Process %d has not been profiled\n", pid);
+        return 1;
+    }
+    auto json = JsonValue::from_string(contents).as_object();
+    auto samples = json.get("samples").as_array();
+    if (json.get("lost_samples").to_u32())
+        fprintf(stderr, "Note: %u older samples were overwritten\n", json.get("lost_samples").to_u32());
+
+    MappedFile executable_file;
+    Symbolicator symbolicator;
+    symbolicator.kernel = load_kernel_symbols();
+    symbolicator.executable = load_executable_symbols(pid, executable_file);
+
+    if (folded)
+        print_folded_stacks(samples, symbolicator);
+    else
+        print_top_functions(samples, symbolicator);
+    return 0;
+}
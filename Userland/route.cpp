@@ -0,0 +1,113 @@
+#include <AK/AKString.h>
+#include <AK/JsonArray.h>
+#include <AK/JsonObject.h>
+#include <LibCore/CFile.h>
+#include <arpa/inet.h>
+#include <net/route.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+static void print_usage()
+{
+    printf("usage: route\n");
+    printf("       route add <destination>/<prefix length> [gw <gateway>] [dev <adapter>]\n");
+    printf("       route del <destination>/<prefix length>\n");
+}
+
+static int print_routes()
+{
+    CFile file("/proc/net/route");
+    if (!file.open(CIODevice::ReadOnly)) {
+        fprintf(stderr, "Error: %s\n", file.error_string());
+        return 1;
+    }
+
+    auto file_contents = file.read_all();
+    auto json = JsonValue::from_string(file_contents).as_array();
+    printf("Destination         Gateway          Adapter\n");
+    json.for_each([](auto& value) {
+        auto route = value.as_object();
+        auto destination = String::format("%s/%u", route.get("destination").to_string().characters(), route.get("prefix_length").to_u32());
+        printf("%-18s  %-15s  %s\n",
+            destination.characters(),
+            route.get("gateway").to_string().characters(),
+            route.get("adapter").to_string().characters());
+    });
+    return 0;
+}
+
+static bool parse_address(const char* string, sockaddr_in& address)
+{
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    return inet_pton(AF_INET, string, &address.sin_addr) == 1;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc == 1)
+        return print_routes();
+
+    bool is_add = !strcmp(argv[1], "add");
+    bool is_del = !strcmp(argv[1], "del");
+    if ((!is_add && !is_del) || argc < 3) {
+        print_usage();
+        return 1;
+    }
+
+    rtentry route;
+    memset(&route, 0, sizeof(route));
+    route.rt_flags = RTF_UP;
+
+    String destination = argv[2];
+    unsigned prefix_length = 32;
+    auto parts = destination.split('/');
+    if (parts.size() == 2) {
+        bool ok;
+        prefix_length = parts[1].to_uint(ok);
+        if (!ok || prefix_length > 32) {
+            fprintf(stderr, "Invalid prefix length '%s'\n", parts[1].characters());
+            return 1;
+        }
+    }
+    if (parts.is_empty() || !parse_address(parts[0].characters(), route.rt_dst)) {
+        fprintf(stderr, "Invalid destination '%s'\n", argv[2]);
+        return 1;
+    }
+    route.rt_genmask.sin_family = AF_INET;
+    route.rt_genmask.sin_addr.s_addr = prefix_length ? htonl(~0u << (32 - prefix_length)) : 0;
+
+    for (int i = 3; i + 1 < argc; i += 2) {
+        if (!strcmp(argv[i], "gw")) {
+            if (!parse_address(argv[i + 1], route.rt_gateway)) {
+                fprintf(stderr, "Invalid gateway '%s'\n", argv[i + 1]);
+                return 1;
+            }
+            route.rt_flags |= RTF_GATEWAY;
+        } else if (!strcmp(argv[i], "dev")) {
+            route.rt_dev = argv[i + 1];
+        } else {
+            print_usage();
+            return 1;
+        }
+    }
+
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) {
+        perror("socket");
+        return 1;
+    }
+
+    if (ioctl(fd, is_add ? SIOCADDRT : SIOCDELRT, &route) < 0) {
+        perror("ioctl");
+        return 1;
+    }
+
+    close(fd);
+    return 0;
+}
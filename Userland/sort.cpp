@@ -1,30 +1,50 @@
 #include <AK/AKString.h>
-#include <AK/QuickSort.h>
 #include <AK/Vector.h>
+#include <LibCore/CFile.h>
+#include <LibThread/ParallelSort.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static StringView without_newline(const StringView& line)
+{
+    if (!line.is_empty() && line[line.length() - 1] == '\n')
+        return line.substring_view(0, line.length() - 1);
+    return line;
+}
 
 int main(int argc, char** argv)
 {
     UNUSED_PARAM(argc);
     UNUSED_PARAM(argv);
 
-    Vector<String> lines;
+    CFile input;
+    input.open(STDIN_FILENO, CIODevice::ReadOnly, CFile::ShouldCloseFileDescription::No);
 
-    for (;;) {
-        char buffer[BUFSIZ];
-        auto* str = fgets(buffer, sizeof(buffer), stdin);
-        if (!str)
-            break;
-        lines.append(buffer);
+    // Lines from a mapped file stay valid for as long as the mapping does, so we can sort
+    // them in place. Anything else has to be copied out of the read buffer first.
+    bool mapped = input.map_for_reading();
+    Vector<String> copies;
+    Vector<StringView> lines;
+    for (auto line = input.read_line_view(); !line.is_null(); line = input.read_line_view()) {
+        line = without_newline(line);
+        if (!mapped) {
+            copies.append(line);
+            line = copies.last();
+        }
+        lines.append(line);
     }
 
-    quick_sort(lines.begin(), lines.end(), [](auto& a, auto& b) {
-        return strcmp(a.characters(), b.characters()) < 0;
+    // Small inputs stay on this thread; parallel_sort() only fans out for big ones.
+    parallel_sort(lines.begin(), lines.end(), [](auto& a, auto& b) {
+        int rc = memcmp(a.characters_without_null_termination(), b.characters_without_null_termination(), min(a.length(), b.length()));
+        return rc ? rc < 0 : a.length() < b.length();
     });
 
     for (auto& line : lines) {
-        fputs(line.characters(), stdout);
+        fwrite(line.characters_without_null_termination(), 1, line.length(), stdout);
+        fputc('\n', stdout);
     }
 
     return 0;
@@ -0,0 +1,96 @@
+#include <AK/AKString.h>
+#include <AK/JsonArray.h>
+#include <AK/JsonObject.h>
+#include <AK/JsonValue.h>
+#include <LibCore/CFile.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+static int usage()
+{
+    printf("usage: stdiobench [-n LINES] [-o PATH]\n");
+    printf("  Write LINES lines with fprintf() to PATH with different buffer sizes,\n");
+    printf("  and count how many write() calls and milliseconds each one took.\n");
+    return 1;
+}
+
+static u32 milliseconds_since(const timeval& start)
+{
+    timeval now;
+    gettimeofday(&now, nullptr);
+    return (now.tv_sec - start.tv_sec) * 1000 + (now.tv_usec - start.tv_usec) / 1000;
+}
+
+// Asks /proc/PID/syscalls how many times we've called write() so far.
+static u32 write_call_count()
+{
+    CFile file(String::format("/proc/%d/syscalls", getpid()));
+    if (!file.open(CIODevice::ReadOnly))
+        return 0;
+    u32 count = 0;
+    auto json = JsonValue::from_string(file.read_all()).as_array();
+    json.for_each([&](auto& value) {
+        auto syscall = value.as_object();
+        if (syscall.get("name").to_string() == "write")
+            count = syscall.get("calls").to_u32();
+    });
+    return count;
+}
+
+static void bench(const char* name, const char* path, int lines, int mode, size_t buffer_size)
+{
+    FILE* fp = fopen(path, "w");
+    if (!fp) {
+        perror("fopen");
+        exit(1);
+    }
+    char* buffer = nullptr;
+    if (buffer_size) {
+        buffer = (char*)malloc(buffer_size);
+        setvbuf(fp, buffer, mode, buffer_size);
+    } else if (mode != _IOFBF) {
+        setvbuf(fp, nullptr, mode, 0);
+    }
+
+    u32 writes_before = write_call_count();
+    timeval start;
+    gettimeofday(&start, nullptr);
+    for (int i = 0; i < lines; ++i)
+        fprintf(fp, "%6d: %s %08x %u\n", i, "the quick brown fox", i * 2654435761u, i * 7);
+    fclose(fp);
+    u32 elapsed = milliseconds_since(start);
+    // Reading /proc/PID/syscalls doesn't write(), so this is just our own calls.
+    u32 writes = write_call_count() - writes_before;
+
+    printf("%-24s %8u %8u\n", name, writes, elapsed);
+    free(buffer);
+}
+
+int main(int argc, char** argv)
+{
+    int lines = 100000;
+    const char* path = "/tmp/stdiobench.out";
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "-n") && i + 1 < argc)
+            lines = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-o") && i + 1 < argc)
+            path = argv[++i];
+        else
+            return usage();
+    }
+    if (lines <= 0)
+        return usage();
+
+    printf("%d lines to %s\n", lines, path);
+    printf("%-24s %8s %8s\n", "", "writes", "ms");
+    bench("unbuffered", path, lines, _IONBF, 0);
+    bench("line buffered", path, lines, _IOLBF, 0);
+    bench("1 KB buffer", path, lines, _IOFBF, 1 * KB);
+    bench("default buffer", path, lines, _IOFBF, 0);
+    bench("64 KB buffer", path, lines, _IOFBF, 64 * KB);
+    unlink(path);
+    return 0;
+}
@@ -0,0 +1,84 @@
+#include <AK/Types.h>
+#include <Kernel/Syscall.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int usage()
+{
+    printf("usage: syscallbench [-n ITERATIONS]\n");
+    printf("  Compare the round-trip cost of getpid() and gettid() through int 0x82 and sysenter.\n");
+    return 1;
+}
+
+static u64 read_tsc()
+{
+    u32 lsw, msw;
+    asm volatile("rdtsc"
+                 : "=d"(msw), "=a"(lsw));
+    return ((u64)msw << 32) | lsw;
+}
+
+static bool has_sysenter()
+{
+    u32 eax, ebx, ecx, edx;
+    asm volatile("cpuid"
+                 : "=a"(eax), "=b"(ebx), "=c"(ecx), "=d"(edx)
+                 : "a"(1), "c"(0));
+    return edx & (1 << 11);
+}
+
+struct Result {
+    u64 total { 0 };
+    u64 min { 0xffffffffffffffffull };
+};
+
+template<typename Callback>
+static Result measure(int iterations, Callback callback)
+{
+    // Warm up the caches and TLB before we start counting.
+    for (int i = 0; i < 100; ++i)
+        callback();
+
+    Result result;
+    for (int i = 0; i < iterations; ++i) {
+        u64 start = read_tsc();
+        callback();
+        u64 cycles = read_tsc() - start;
+        result.total += cycles;
+        if (cycles < result.min)
+            result.min = cycles;
+    }
+    return result;
+}
+
+static void print_result(const char* name, const Result& result, int iterations)
+{
+    printf("%-20s %10u %10u\n", name, (u32)(result.total / iterations), (u32)result.min);
+}
+
+int main(int argc, char** argv)
+{
+    int iterations = 100000;
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "-n") && i + 1 < argc)
+            iterations = atoi(argv[++i]);
+        else
+            return usage();
+    }
+    if (iterations <= 0)
+        return usage();
+
+    printf("%d iterations, in TSC cycles\n", iterations);
+    printf("%-20s %10s %10s\n", "", "average", "min");
+    print_result("getpid (int 0x82)", measure(iterations, [] { Syscall::invoke(Syscall::SC_getpid); }), iterations);
+    print_result("gettid (int 0x82)", measure(iterations, [] { Syscall::invoke(Syscall::SC_gettid); }), iterations);
+
+    if (!has_sysenter()) {
+        printf("This processor doesn't support sysenter\n");
+        return 0;
+    }
+    print_result("getpid (sysenter)", measure(iterations, [] { Syscall::invoke_fast(Syscall::SC_getpid); }), iterations);
+    print_result("gettid (sysenter)", measure(iterations, [] { Syscall::invoke_fast(Syscall::SC_gettid); }), iterations);
+    return 0;
+}
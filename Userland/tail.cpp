@@ -35,6 +35,23 @@ int tail_from_pos(CFile& file, off_t startline, bool want_follow)
     return 0;
 }
 
+off_t find_seek_pos_in_mapping(CFile& file, int wanted_lines)
+{
+    // Same as below, but with the file mapped we can just look at it.
+    auto* data = (const char*)file.mapped_data();
+    off_t end = file.mapped_size();
+    int lines = 0;
+    off_t pos = end - 1;
+    for (; pos >= 0; pos--) {
+        if (data[pos] == '\n' && (end - pos) > 1) {
+            lines++;
+            if (lines == wanted_lines)
+                break;
+        }
+    }
+    return pos;
+}
+
 off_t find_seek_pos(CFile& file, int wanted_lines)
 {
     // Rather than reading the whole file, start at the end and work backwards,
@@ -102,6 +119,6 @@ int main(int argc, char* argv[])
     }
 
     bool flag_follow = args.is_present("f");
-    auto pos = find_seek_pos(f, line_count);
+    auto pos = f.map_for_reading() ? find_seek_pos_in_mapping(f, line_count) : find_seek_pos(f, line_count);
     return tail_from_pos(f, pos, flag_follow);
 }
@@ -0,0 +1,231 @@
+#include <AK/HashMap.h>
+#include <AK/Vector.h>
+#include <Kernel/Syscall.h>
+#include <Kernel/TraceRecord.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+static int usage()
+{
+    printf("usage: trace [-s] [-t SECONDS | command...]\n");
+    printf("  Trace the whole system for SECONDS (default 1), or while command runs.\n");
+    printf("  -s: only print a summary, not the timeline.\n");
+    return 1;
+}
+
+static const char* event_name(u16 type)
+{
+    switch ((TraceEventType)type) {
+    case TraceEventType::ContextSwitch:
+        return "switch";
+    case TraceEventType::PageFault:
+        return "page fault";
+    case TraceEventType::SyscallEntry:
+        return "syscall";
+    case TraceEventType::SyscallExit:
+        return "syscall exit";
+    case TraceEventType::BlockSubmit:
+        return "block submit";
+    case TraceEventType::BlockComplete:
+        return "block done";
+    case TraceEventType::PacketReceive:
+        return "packet rx";
+    case TraceEventType::PacketTransmit:
+        return "packet tx";
+    default:
+        return "???";
+    }
+}
+
+static void print_record(const TraceRecord& record, u64 start)
+{
+    printf("%10u  %4u:%-4u  %-13s ", (u32)((record.timestamp - start) / 1000), record.pid, record.tid, event_name(record.type));
+    auto& args = record.args;
+    switch ((TraceEventType)record.type) {
+    case TraceEventType::ContextSwitch:
+        printf("tid %u -> tid %u\n", args[0], args[1]);
+        break;
+    case TraceEventType::PageFault:
+        printf("%s %s address %#x at eip %#x\n", args[1] & 1 ? "protection violation" : "not present", args[1] & 2 ? "write to" : "read from", args[0], args[2]);
+        break;
+    case TraceEventType::SyscallEntry:
+        printf("%s(%#x, %#x)\n", Syscall::to_string((Syscall::Function)args[0]), args[1], args[2]);
+        break;
+    case TraceEventType::SyscallExit:
+        printf("%s = %d\n", Syscall::to_string((Syscall::Function)args[0]), args[1]);
+        break;
+    case TraceEventType::BlockSubmit:
+        printf("%s %u block(s) at %u\n", args[2] ? "write" : "read", args[1], args[0]);
+        break;
+    case TraceEventType::BlockComplete:
+        printf("%u block(s) at %u%s\n", args[1], args[0], args[2] ? "" : " failed");
+        break;
+    case TraceEventType::PacketReceive:
+    case TraceEventType::PacketTransmit:
+        printf("%u bytes\n", args[0]);
+        break;
+    default:
+        printf("%#x %#x %#x\n", args[0], args[1], args[2]);
+        break;
+    }
+}
+
+struct Latency {
+    u32 count { 0 };
+    u64 total { 0 };
+    u64 max { 0 };
+
+    void add(u64 cycles)
+    {
+        ++count;
+        total += cycles;
+        if (cycles > max)
+            max = cycles;
+    }
+};
+
+static void print_summary(const Vector<TraceRecord>& records)
+{
+    u32 counts[(int)TraceEventType::__Count] = {};
+    // Syscalls and block requests are matched up with their completion by thread.
+    HashMap<u32, const TraceRecord*> pending_syscalls;
+    HashMap<u32, const TraceRecord*> pending_block_requests;
+    HashMap<u32, Latency> syscall_latencies;
+    Latency block_latency;
+
+    for (auto& record : records) {
+        if (record.type < (u16)TraceEventType::__Count)
+            ++counts[record.type];
+        switch ((TraceEventType)record.type) {
+        case TraceEventType::SyscallEntry:
+            pending_syscalls.set(record.tid, &record);
+            break;
+        case TraceEventType::SyscallExit: {
+            auto it = pending_syscalls.find(record.tid);
+            if (it == pending_syscalls.end())
+                break;
+            auto latency = syscall_latencies.get(record.args[0]).value_or({});
+            latency.add(record.timestamp - it->value->timestamp);
+            syscall_latencies.set(record.args[0], latency);
+            pending_syscalls.remove(it);
+            break;
+        }
+        case TraceEventType::BlockSubmit:
+            pending_block_requests.set(record.tid, &record);
+            break;
+        case TraceEventType::BlockComplete: {
+            auto it = pending_block_requests.find(record.tid);
+            if (it == pending_block_requests.end())
+                break;
+            block_latency.add(record.timestamp - it->value->timestamp);
+            pending_block_requests.remove(it);
+            break;
+        }
+        default:
+            break;
+        }
+    }
+
+    printf("\nEvents:\n");
+    for (int i = 1; i < (int)TraceEventType::__Count; ++i)
+        printf("  %-13s %u\n", event_name(i), counts[i]);
+
+    if (block_latency.count)
+        printf("\nBlock I/O: %u requests, average %u kcycles, max %u kcycles\n", block_latency.count, (u32)(block_latency.total / block_latency.count / 1000), (u32)(block_latency.max / 1000));
+
+    if (!syscall_latencies.is_empty()) {
+        printf("\nSyscall             Calls   Avg kcycles   Max kcycles\n");
+        for (auto& it : syscall_latencies) {
+            auto& latency = it.value;
+            printf("%-18s %6u   %11u   %11u\n", Syscall::to_string((Syscall::Function)it.key), latency.count, (u32)(latency.total / latency.count / 1000), (u32)(latency.max / 1000));
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    bool summary_only = false;
+    int seconds = 1;
+    int command_index = 0;
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "-s")) {
+            summary_only = true;
+        } else if (!strcmp(argv[i], "-t") && i + 1 < argc) {
+            seconds = atoi(argv[++i]);
+        } else if (argv[i][0] == '-') {
+            return usage();
+        } else {
+            command_index = i;
+            break;
+        }
+    }
+
+    int fd = open("/dev/trace", O_RDONLY | O_NONBLOCK);
+    if (fd < 0) {
+        perror("open /dev/trace");
+        return 1;
+    }
+
+    // Throw away anything left over from an earlier trace.
+    static TraceRecord buffer[256];
+    while (read(fd, buffer, sizeof(buffer)) > 0)
+        ;
+
+    if (ioctl(fd, TRACE_IOCTL_ENABLE) < 0) {
+        perror("ioctl(TRACE_IOCTL_ENABLE)");
+        return 1;
+    }
+
+    if (command_index) {
+        pid_t pid = fork();
+        if (!pid) {
+            execvp(argv[command_index], &argv[command_index]);
+            perror("execvp");
+            exit(1);
+        }
+        int status;
+        waitpid(pid, &status, 0);
+    } else {
+        sleep(seconds);
+    }
+
+    ioctl(fd, TRACE_IOCTL_DISABLE);
+
+    Vector<TraceRecord> records;
+    for (;;) {
+        int nread = read(fd, buffer, sizeof(buffer));
+        if (nread < 0) {
+            perror("read");
+            return 1;
+        }
+        if (nread == 0)
+            break;
+        for (int i = 0; i < nread / (int)sizeof(TraceRecord); ++i)
+            records.append(buffer[i]);
+    }
+
+    u32 dropped_count = 0;
+    ioctl(fd, TRACE_IOCTL_GET_DROPPED_COUNT, &dropped_count);
+    close(fd);
+
+    if (records.is_empty()) {
+        printf("No events recorded\n");
+        return 0;
+    }
+
+    if (!summary_only) {
+        printf("  kcycles  pid:tid    event\n");
+        u64 start = records.first().timestamp;
+        for (auto& record : records)
+            print_record(record, start);
+    }
+    print_summary(records);
+    if (dropped_count)
+        printf("\n%u events were dropped because the trace buffer was full\n", dropped_count);
+    return 0;
+}
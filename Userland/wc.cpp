@@ -1,6 +1,7 @@
 #include <AK/AKString.h>
 #include <AK/Vector.h>
 #include <LibCore/CArgsParser.h>
+#include <LibCore/CFile.h>
 
 #include <ctype.h>
 #include <stdio.h>
@@ -45,12 +46,12 @@ void report(const Vector<Count>& counts)
     fflush(stdout);
 }
 
-int count_words(const char* s)
+int count_words(const StringView& line)
 {
     int n = 0;
     bool in_word = false;
-    for (; *s; ++s) {
-        if (!isspace(*s)) {
+    for (int i = 0; i < line.length(); ++i) {
+        if (!isspace(line[i])) {
             if (!in_word) {
                 in_word = true;
                 ++n;
@@ -100,27 +101,22 @@ int main(int argc, char** argv)
 
     Vector<Count> counts;
     for (const auto& f : files) {
-        FILE* fp = fopen(f.characters(), "r");
-        if (fp == nullptr) {
+        CFile file(f);
+        if (!file.open(CIODevice::ReadOnly)) {
             fprintf(stderr, "wc: Could not open file '%s'\n", f.characters());
             return 1;
         }
+        file.map_for_reading();
 
         Count count { f };
-        char* line = nullptr;
-        size_t len = 0;
-        ssize_t n_read = 0;
-        while ((n_read = getline(&line, &len, fp)) != -1) {
+        for (auto line = file.read_line_view(); !line.is_null(); line = file.read_line_view()) {
             count.lines++;
-            count.words += count_words(line);
-            count.chars += n_read;
+            if (output_words)
+                count.words += count_words(line);
+            count.chars += line.length();
         }
 
         counts.append(count);
-        fclose(fp);
-        if (line) {
-            free(line);
-        }
     }
 
     report(counts);